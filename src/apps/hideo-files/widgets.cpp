@@ -78,20 +78,21 @@ Ui::Child directorEntry(Sys::DirEntry const &entry, bool odd) {
            Kr::contextMenu(slot$(directoryContextMenu()));
 }
 
-Ui::Child directoryListing(State const &s, Sys::Dir const &dir) {
+Ui::Child directoryListing(State const &s, Sys::Dir dir) {
     if (dir.entries().len() == 0)
         return Ui::bodyMedium(Ui::GRAY500, "This directory is empty.") | Ui::center();
 
-    Ui::Children children;
-    bool odd = true;
-    for (auto const &entry : dir.entries()) {
-        children.pushBack(directorEntry(entry, odd));
-        odd = !odd;
-    }
-
-    return Ui::vflow(children) |
-           Ui::align(Math::Align::TOP | Math::Align::HFILL) |
-           Ui::vscroll() | Ui::key(s.currentIndex);
+    // NOTE: Only the entries in view get built, so large directories open
+    //       as fast as small ones. The builder shares the listing instead
+    //       of holding a copy of it.
+    auto len = dir.entries().len();
+    return Ui::vlist(
+               len,
+               [dir = makeStrong<Sys::Dir>(std::move(dir))](usize i) {
+                   return directorEntry(dir->entries()[i], i % 2 == 0);
+               }
+           ) |
+           Ui::key(s.currentIndex);
 }
 
 Ui::Child breadcrumbItem(Str text, isize index) {
@@ -246,7 +247,7 @@ Ui::Child openFileDialog() {
                     Kr::dialogTitleBar("Open file…"s),
                     toolbar(d),
                     maybeDir
-                        ? directoryListing(d, maybeDir.unwrap()) |
+                        ? directoryListing(d, maybeDir.take()) |
                               Ui::grow()
                         : alert(
                               d,
@@ -9,7 +9,7 @@ namespace Hideo::Files {
 
 // MARK: Common Widgets --------------------------------------------------------
 
-Ui::Child directoryListing(State const &, Sys::Dir const &);
+Ui::Child directoryListing(State const &, Sys::Dir);
 
 Ui::Child breadcrumb(State const &);
 
@@ -1,7 +1,5 @@
 #include <hideo-base/row.h>
 #include <hideo-base/scafold.h>
-#include <karm-sys/entry.h>
-#include <karm-ui/app.h>
 #include <karm-ui/dialog.h>
 #include <karm-ui/input.h>
 #include <karm-ui/scroll.h>
@@ -172,8 +170,8 @@ Ui::Child tabs(State const &state) {
     );
 }
 
-Ui::Child app() {
-    return Ui::reducer<Model>({}, [](auto const &s) {
+Ui::Child app(State state) {
+    return Ui::reducer<Model>(std::move(state), [](auto const &s) {
         auto tb = titlebar(Mdi::TABLE, "Spreadsheet"s, tabs(s));
         auto body = table(s) | Ui::grow();
         if (s.propertiesVisible) {
@@ -190,7 +188,3 @@ Ui::Child app() {
 }
 
 } // namespace Hideo::Spreadsheet
-
-Async::Task<> entryPointAsync(Sys::Context &ctx) {
-    co_return Ui::runApp(ctx, Hideo::Spreadsheet::app());
-}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <karm-base/array.h>
+#include <karm-base/box.h>
 #include <karm-base/checked.h>
 #include <karm-base/map.h>
 #include <karm-base/string.h>
@@ -14,7 +16,9 @@ namespace Hideo::Spreadsheet {
 
 // MARK: Reducer ---------------------------------------------------------------
 
-using Value = Union<None, String, f64, bool>;
+using Value = Union<None, String, f64, bool, Error>;
+
+String formatValue(Value const &value);
 
 struct Pos {
     usize row;
@@ -23,6 +27,116 @@ struct Pos {
     auto operator<=>(Pos const &) const = default;
 };
 
+// Columns are named A to Z, then AA to ZZ, then AAA, and so on.
+String colName(usize col);
+
+struct Range {
+    Pos start;
+    Pos end;
+
+    Range() = default;
+
+    Range(Pos pos)
+        : start(pos), end(pos) {}
+
+    Range(Pos start, Pos end)
+        : start(start), end(end) {}
+
+    Range normalised() const {
+        return {
+            Pos{
+                min(start.row, end.row),
+                min(start.col, end.col),
+            },
+            Pos{
+                max(start.row, end.row),
+                max(start.col, end.col),
+            },
+        };
+    }
+
+    usize rows() const {
+        auto n = normalised();
+        return n.end.row - n.start.row + 1;
+    }
+
+    usize cols() const {
+        auto n = normalised();
+        return n.end.col - n.start.col + 1;
+    }
+
+    bool contains(Pos pos) const {
+        auto n = normalised();
+        return n.start.row <= pos.row and pos.row <= n.end.row and
+               n.start.col <= pos.col and pos.col <= n.end.col;
+    }
+
+    auto operator<=>(Range const &) const = default;
+};
+
+// MARK: Formulas --------------------------------------------------------------
+
+struct Expr;
+
+struct UnaryExpr {
+    enum struct Op {
+        NEG,
+        PERCENT,
+    };
+
+    Op op;
+    Box<Expr> expr;
+};
+
+struct BinaryExpr {
+    enum struct Op {
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        POW,
+        CONCAT,
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE,
+    };
+
+    Op op;
+    Box<Expr> lhs;
+    Box<Expr> rhs;
+};
+
+struct CallExpr {
+    String name;
+    Vec<Expr> args;
+};
+
+using _Expr = Union<
+    f64,
+    String,
+    bool,
+    Pos,
+    Range,
+    UnaryExpr,
+    BinaryExpr,
+    CallExpr>;
+
+struct Expr : public _Expr {
+    using _Expr::_Expr;
+};
+
+struct Formula {
+    String src;
+    Expr expr;
+    Vec<Range> precedents; //< Every cell and range the formula reads
+};
+
+// Parse a formula, without the leading '='.
+Res<Strong<Formula>> parseFormula(Str src);
+
 enum struct Wheight {
     NONE,
     THIN,
@@ -60,8 +174,174 @@ struct Style {
 };
 
 struct Cell {
-    Value value = NONE;
+    Value value = NONE; //< For formulas, the result of the last evaluation
+    Opt<Strong<Formula>> formula = NONE;
     Style style;
+
+    usize _epoch = 0;   //< Last recalculation that reached this cell
+    usize _pending = 0; //< Precedents that still have to be recalculated
+};
+
+// Cells are stored in fixed size tiles that are only allocated once
+// something is written to them, so huge sparse sheets stay cheap, and
+// finding a cell doesn't depend on how many there are.
+struct Tile {
+    static constexpr usize ROWS = 64;
+    static constexpr usize COLS = 16;
+
+    Array<Opt<Cell>, ROWS * COLS> cells = {};
+    usize len = 0;
+
+    static usize index(Pos pos) {
+        return (pos.row % ROWS) * COLS + (pos.col % COLS);
+    }
+};
+
+struct Cells {
+    Vec<Vec<Opt<Box<Tile>>>> _tiles = {}; //< Indexed by row block, then column block
+    Vec<Vec<Vec<Pos>>> _watchers = {};    //< Formulas reading from each block, sorted
+    usize _len = 0;
+
+    Tile const *tile(Pos pos) const {
+        usize r = pos.row / Tile::ROWS;
+        usize c = pos.col / Tile::COLS;
+        if (r >= _tiles.len() or c >= _tiles[r].len() or not _tiles[r][c])
+            return nullptr;
+        return &**_tiles[r][c];
+    }
+
+    Tile &ensureTile(Pos pos) {
+        usize r = pos.row / Tile::ROWS;
+        usize c = pos.col / Tile::COLS;
+        while (_tiles.len() <= r)
+            _tiles.pushBack(Vec<Opt<Box<Tile>>>{});
+        auto &band = _tiles[r];
+        while (band.len() <= c)
+            band.pushBack(NONE);
+        if (not band[c])
+            band[c] = makeBox<Tile>();
+        return **band[c];
+    }
+
+    Cell const *get(Pos pos) const {
+        auto *t = tile(pos);
+        if (not t or not t->cells[Tile::index(pos)])
+            return nullptr;
+        return &*t->cells[Tile::index(pos)];
+    }
+
+    Cell *get(Pos pos) {
+        return const_cast<Cell *>(const_cast<Cells const *>(this)->get(pos));
+    }
+
+    Cell &ensure(Pos pos) {
+        auto &t = ensureTile(pos);
+        auto &slot = t.cells[Tile::index(pos)];
+        if (not slot) {
+            slot = Cell{};
+            t.len++;
+            _len++;
+        }
+        return *slot;
+    }
+
+    void del(Pos pos) {
+        usize r = pos.row / Tile::ROWS;
+        usize c = pos.col / Tile::COLS;
+        if (not tile(pos))
+            return;
+
+        auto &t = **_tiles[r][c];
+        auto &slot = t.cells[Tile::index(pos)];
+        if (not slot)
+            return;
+
+        slot = NONE;
+        t.len--;
+        _len--;
+
+        if (t.len == 0)
+            _tiles[r][c] = NONE;
+    }
+
+    Slice<Pos> watchers(Pos pos) const {
+        usize r = pos.row / Tile::ROWS;
+        usize c = pos.col / Tile::COLS;
+        if (r >= _watchers.len() or c >= _watchers[r].len())
+            return {};
+        return _watchers[r][c];
+    }
+
+    // Let the formula at `by` know about changes in the block of `pos`.
+    void watch(Pos pos, Pos by) {
+        usize r = pos.row / Tile::ROWS;
+        usize c = pos.col / Tile::COLS;
+        while (_watchers.len() <= r)
+            _watchers.pushBack(Vec<Vec<Pos>>{});
+        auto &band = _watchers[r];
+        while (band.len() <= c)
+            band.pushBack(Vec<Pos>{});
+
+        auto &watchers = band[c];
+        auto cmp = [&](Pos const &p) {
+            return p <=> by;
+        };
+        if (search(watchers, cmp))
+            return;
+        auto upper = searchUpperBound(watchers, cmp);
+        watchers.insert(upper ? *upper : watchers.len(), by);
+    }
+
+    void unwatch(Pos pos, Pos by) {
+        usize r = pos.row / Tile::ROWS;
+        usize c = pos.col / Tile::COLS;
+        if (r >= _watchers.len() or c >= _watchers[r].len())
+            return;
+        auto &watchers = _watchers[r][c];
+        auto i = search(watchers, [&](Pos const &p) {
+            return p <=> by;
+        });
+        if (i)
+            watchers.removeAt(*i);
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    // Calls `f` with every cell present in `range`, tiles that were never
+    // written to are skipped entirely.
+    void iter(Range range, auto f) const {
+        range = range.normalised();
+        usize lastBand = min(range.end.row / Tile::ROWS + 1, _tiles.len());
+        for (usize r = range.start.row / Tile::ROWS; r < lastBand; r++) {
+            auto &band = _tiles[r];
+            usize lastTile = min(range.end.col / Tile::COLS + 1, band.len());
+            for (usize c = range.start.col / Tile::COLS; c < lastTile; c++) {
+                if (not band[c] or (*band[c])->len == 0)
+                    continue;
+                auto &t = **band[c];
+
+                usize rowStart = max(range.start.row, r * Tile::ROWS);
+                usize rowEnd = min(range.end.row + 1, (r + 1) * Tile::ROWS);
+                usize colStart = max(range.start.col, c * Tile::COLS);
+                usize colEnd = min(range.end.col + 1, (c + 1) * Tile::COLS);
+
+                for (usize row = rowStart; row < rowEnd; row++) {
+                    for (usize col = colStart; col < colEnd; col++) {
+                        Pos pos{row, col};
+                        auto &slot = t.cells[Tile::index(pos)];
+                        if (slot)
+                            f(pos, *slot);
+                    }
+                }
+            }
+        }
+    }
+
+    void iter(auto f) const {
+        iter(Range{{0, 0}, {Limits<usize>::MAX - 1, Limits<usize>::MAX - 1}}, f);
+    }
 };
 
 static constexpr isize CELL_WIDTH = 96;
@@ -78,15 +358,71 @@ struct Col {
 };
 
 struct Sheet {
-    static constexpr usize MAX_ROWS = Limits<u16>::MAX;
-    static constexpr usize MAX_COLS = 26;
+    static constexpr usize MAX_ROWS = 1 << 20;
+    static constexpr usize MAX_COLS = 1 << 14;
 
     String name;
     usize freezedRows = 0;
     usize freezedCols = 0;
     Vec<Row> rows = {{}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}};
     Vec<Col> cols = {{}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}};
-    Map<Pos, Cell> cells = {};
+    Cells cells = {};
+    usize _epoch = 0;
+
+    // MARK: Cells
+
+    Cell const *cell(Pos pos) const {
+        return cells.get(pos);
+    }
+
+    Value value(Pos pos) const {
+        auto *c = cells.get(pos);
+        return c ? c->value : Value{NONE};
+    }
+
+    // Set the values of a range of cells, dropping their formulas, and
+    // recalculate everything that depends on them.
+    void update(Range range, Value value);
+
+    // Set a cell from what the user typed, a leading '=' makes it a formula.
+    void edit(Pos pos, Str input);
+
+    void clear(Pos pos);
+
+    // Load comma separated values, starting at the top-left cell.
+    Res<> loadCsv(Str csv);
+
+    // MARK: Recalculation
+
+    void _watch(Pos pos, Formula const &formula);
+
+    void _unwatch(Pos pos, Formula const &formula);
+
+    void _setFormula(Pos pos, Opt<Strong<Formula>> formula);
+
+    void _dependents(Pos pos, auto f) const {
+        for (auto w : cells.watchers(pos)) {
+            auto *c = cells.get(w);
+            if (not c or not c->formula)
+                continue;
+            for (auto const &p : (*c->formula)->precedents) {
+                if (p.contains(pos)) {
+                    f(w);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Recalculate the formulas that depend on `roots`, directly or not,
+    // and the formulas in `roots` themselves, every cell at most once.
+    void recalc(Slice<Pos> roots);
+
+    void recalcAll();
+
+    Value eval(Expr const &expr) const;
+
+    // MARK: Geometry
 
     void recompute() {
         i32 y = 0;
@@ -137,51 +473,15 @@ struct Sheet {
     }
 };
 
-struct Range {
-    Pos start;
-    Pos end;
-
-    Range() = default;
-
-    Range(Pos pos)
-        : start(pos), end(pos) {}
-
-    Range(Pos start, Pos end)
-        : start(start), end(end) {}
-
-    Range normalised() const {
-        return {
-            Pos{
-                min(start.row, end.row),
-                min(start.col, end.col),
-            },
-            Pos{
-                max(start.row, end.row),
-                max(start.col, end.col),
-            },
-        };
-    }
-
-    usize rows() const {
-        auto n = normalised();
-        return n.end.row - n.start.row + 1;
-    }
-
-    usize cols() const {
-        auto n = normalised();
-        return n.end.col - n.start.col + 1;
-    }
-
-    auto operator<=>(Range const &) const = default;
-};
-
 struct Book {
     String name;
-    Vec<Sheet> sheets = {
-        {"Sheet 1"s},
-        {"Sheet 2"s},
-        {"Sheet 3"s},
-    };
+    Vec<Sheet> sheets;
+
+    Book() {
+        sheets.pushBack(Sheet{"Sheet 1"s});
+        sheets.pushBack(Sheet{"Sheet 2"s});
+        sheets.pushBack(Sheet{"Sheet 3"s});
+    }
 };
 
 struct State {
@@ -216,6 +516,11 @@ struct UpdateValue {
     Value value;
 };
 
+struct EditCell {
+    Pos pos;
+    String input;
+};
+
 template <typename TAG, typename T>
 struct UpdateStyleField {
     T value;
@@ -251,6 +556,7 @@ using Action = Union<
     UpdateSelection,
 
     UpdateValue,
+    EditCell,
 
     UpdateStyleFg,
     UpdateStyleBg,
@@ -274,4 +580,6 @@ Res<Model> load(Io::Reader &reader);
 
 Ui::Child table(State const &s);
 
+Ui::Child app(State state);
+
 } // namespace Hideo::Spreadsheet
@@ -0,0 +1,524 @@
+#include <karm-io/aton.h>
+#include <karm-io/expr.h>
+#include <karm-io/fmt.h>
+#include <karm-math/funcs.h>
+
+#include "app.h"
+
+namespace Hideo::Spreadsheet {
+
+// MARK: Parser ----------------------------------------------------------------
+
+static void _eatSpaces(Io::SScan &s) {
+    s.eat(Re::space());
+}
+
+static Res<Expr> _parseExpr(Io::SScan &s, Vec<Range> &refs);
+
+static Opt<Pos> _parseRef(Io::SScan &s) {
+    auto rollback = s.rollbackPoint();
+
+    s.skip('$');
+    usize col = 0;
+    usize letters = 0;
+    while (isAsciiAlpha(s.peek())) {
+        col = col * 26 + (toAsciiUpper(s.next()) - 'A' + 1);
+        letters++;
+        if (col > Sheet::MAX_COLS)
+            return NONE;
+    }
+
+    s.skip('$');
+    if (letters == 0 or not isAsciiDigit(s.peek()))
+        return NONE;
+
+    auto row = Io::atou(s);
+    if (not row or *row == 0 or *row > Sheet::MAX_ROWS)
+        return NONE;
+
+    // NOTE: Names like LOG10 look like references, but are followed by
+    //       their arguments.
+    if (s.peek() == '(' or isAsciiAlpha(s.peek()))
+        return NONE;
+
+    rollback.disarm();
+    return Pos{*row - 1, col - 1};
+}
+
+static Res<Expr> _parseCall(Io::SScan &s, String name, Vec<Range> &refs) {
+    CallExpr call{name, {}};
+
+    _eatSpaces(s);
+    if (s.skip(')'))
+        return Ok(Expr{std::move(call)});
+
+    while (true) {
+        call.args.pushBack(try$(_parseExpr(s, refs)));
+        _eatSpaces(s);
+        if (s.skip(')'))
+            break;
+        if (not s.skip(',') and not s.skip(';'))
+            return Error::invalidInput("expected ',' or ')'");
+    }
+
+    return Ok(Expr{std::move(call)});
+}
+
+static Res<Expr> _parsePrimary(Io::SScan &s, Vec<Range> &refs) {
+    _eatSpaces(s);
+
+    if (s.skip('(')) {
+        auto expr = try$(_parseExpr(s, refs));
+        _eatSpaces(s);
+        if (not s.skip(')'))
+            return Error::invalidInput("expected ')'");
+        return Ok(std::move(expr));
+    }
+
+    if (s.skip('"')) {
+        StringBuilder sb;
+        while (true) {
+            if (s.ended())
+                return Error::invalidInput("unterminated string");
+            if (s.skip('"')) {
+                // NOTE: Quotes are escaped by doubling them.
+                if (not s.skip('"'))
+                    break;
+                sb.append('"');
+                continue;
+            }
+            sb.append(s.next());
+        }
+        return Ok(Expr{sb.take()});
+    }
+
+    if (isAsciiDigit(s.peek()) or s.peek() == '.') {
+        auto num = Io::atof(s);
+        if (not num)
+            return Error::invalidInput("expected a number");
+        return Ok(Expr{*num});
+    }
+
+    if (auto start = _parseRef(s)) {
+        _eatSpaces(s);
+        if (not s.skip(':')) {
+            refs.pushBack(Range{*start});
+            return Ok(Expr{*start});
+        }
+
+        _eatSpaces(s);
+        auto end = _parseRef(s);
+        if (not end)
+            return Error::invalidInput("expected the end of the range");
+
+        Range range = Range{*start, *end}.normalised();
+        refs.pushBack(range);
+        return Ok(Expr{range});
+    }
+
+    if (isAsciiAlpha(s.peek())) {
+        StringBuilder sb;
+        while (isAsciiAlphaNum(s.peek()) or s.peek() == '.' or s.peek() == '_')
+            sb.append(toAsciiUpper(s.next()));
+        auto name = sb.take();
+
+        _eatSpaces(s);
+        if (s.skip('('))
+            return _parseCall(s, name, refs);
+
+        if (name == "TRUE")
+            return Ok(Expr{true});
+
+        if (name == "FALSE")
+            return Ok(Expr{false});
+
+        return Error::invalidInput("unknown name");
+    }
+
+    return Error::invalidInput("unexpected character");
+}
+
+static Res<Expr> _parsePostfix(Io::SScan &s, Vec<Range> &refs) {
+    auto expr = try$(_parsePrimary(s, refs));
+    _eatSpaces(s);
+    while (s.skip('%')) {
+        expr = UnaryExpr{UnaryExpr::Op::PERCENT, makeBox<Expr>(std::move(expr))};
+        _eatSpaces(s);
+    }
+    return Ok(std::move(expr));
+}
+
+static Res<Expr> _parseUnary(Io::SScan &s, Vec<Range> &refs) {
+    _eatSpaces(s);
+    if (s.skip('-')) {
+        auto expr = try$(_parseUnary(s, refs));
+        return Ok(Expr{UnaryExpr{UnaryExpr::Op::NEG, makeBox<Expr>(std::move(expr))}});
+    }
+
+    if (s.skip('+'))
+        return _parseUnary(s, refs);
+
+    return _parsePostfix(s, refs);
+}
+
+static Expr _binary(BinaryExpr::Op op, Expr lhs, Expr rhs) {
+    return BinaryExpr{
+        op,
+        makeBox<Expr>(std::move(lhs)),
+        makeBox<Expr>(std::move(rhs)),
+    };
+}
+
+static Res<Expr> _parsePower(Io::SScan &s, Vec<Range> &refs) {
+    auto lhs = try$(_parseUnary(s, refs));
+    _eatSpaces(s);
+    while (s.skip('^')) {
+        auto rhs = try$(_parseUnary(s, refs));
+        lhs = _binary(BinaryExpr::Op::POW, std::move(lhs), std::move(rhs));
+        _eatSpaces(s);
+    }
+    return Ok(std::move(lhs));
+}
+
+static Res<Expr> _parseTerm(Io::SScan &s, Vec<Range> &refs) {
+    auto lhs = try$(_parsePower(s, refs));
+    while (true) {
+        _eatSpaces(s);
+        BinaryExpr::Op op;
+        if (s.skip('*'))
+            op = BinaryExpr::Op::MUL;
+        else if (s.skip('/'))
+            op = BinaryExpr::Op::DIV;
+        else
+            break;
+        auto rhs = try$(_parsePower(s, refs));
+        lhs = _binary(op, std::move(lhs), std::move(rhs));
+    }
+    return Ok(std::move(lhs));
+}
+
+static Res<Expr> _parseAdditive(Io::SScan &s, Vec<Range> &refs) {
+    auto lhs = try$(_parseTerm(s, refs));
+    while (true) {
+        _eatSpaces(s);
+        BinaryExpr::Op op;
+        if (s.skip('+'))
+            op = BinaryExpr::Op::ADD;
+        else if (s.skip('-'))
+            op = BinaryExpr::Op::SUB;
+        else
+            break;
+        auto rhs = try$(_parseTerm(s, refs));
+        lhs = _binary(op, std::move(lhs), std::move(rhs));
+    }
+    return Ok(std::move(lhs));
+}
+
+static Res<Expr> _parseConcat(Io::SScan &s, Vec<Range> &refs) {
+    auto lhs = try$(_parseAdditive(s, refs));
+    _eatSpaces(s);
+    while (s.skip('&')) {
+        auto rhs = try$(_parseAdditive(s, refs));
+        lhs = _binary(BinaryExpr::Op::CONCAT, std::move(lhs), std::move(rhs));
+        _eatSpaces(s);
+    }
+    return Ok(std::move(lhs));
+}
+
+static Res<Expr> _parseExpr(Io::SScan &s, Vec<Range> &refs) {
+    auto lhs = try$(_parseConcat(s, refs));
+    while (true) {
+        _eatSpaces(s);
+        BinaryExpr::Op op;
+        if (s.skip("<>"))
+            op = BinaryExpr::Op::NE;
+        else if (s.skip("<="))
+            op = BinaryExpr::Op::LE;
+        else if (s.skip(">="))
+            op = BinaryExpr::Op::GE;
+        else if (s.skip('<'))
+            op = BinaryExpr::Op::LT;
+        else if (s.skip('>'))
+            op = BinaryExpr::Op::GT;
+        else if (s.skip('='))
+            op = BinaryExpr::Op::EQ;
+        else
+            break;
+        auto rhs = try$(_parseConcat(s, refs));
+        lhs = _binary(op, std::move(lhs), std::move(rhs));
+    }
+    return Ok(std::move(lhs));
+}
+
+Res<Strong<Formula>> parseFormula(Str src) {
+    Io::SScan s{src};
+    Vec<Range> refs;
+    auto expr = try$(_parseExpr(s, refs));
+
+    _eatSpaces(s);
+    if (not s.ended())
+        return Error::invalidInput("unexpected trailing characters");
+
+    return Ok(makeStrong<Formula>(String{src}, std::move(expr), std::move(refs)));
+}
+
+// MARK: Evaluation ------------------------------------------------------------
+
+static Res<f64> _toNumber(Value const &value) {
+    if (auto *num = value.is<f64>())
+        return Ok(*num);
+
+    if (auto *b = value.is<bool>())
+        return Ok(*b ? 1.0 : 0.0);
+
+    if (value.is<None>())
+        return Ok(0.0);
+
+    if (auto *err = value.is<Error>())
+        return *err;
+
+    Io::SScan s{value.unwrap<String>()};
+    auto num = Io::atof(s);
+    if (not num or not s.ended())
+        return Error::invalidInput("#VALUE!");
+    return Ok(*num);
+}
+
+static String _toString(Value const &value) {
+    return value.visit(Visitor{
+        [](None) -> String {
+            return ""s;
+        },
+        [](String const &str) -> String {
+            return str;
+        },
+        [](f64 num) -> String {
+            return Io::format("{}", num).unwrap();
+        },
+        [](bool b) -> String {
+            return b ? "TRUE"s : "FALSE"s;
+        },
+        [](Error const &err) -> String {
+            return String{Str::fromNullterminated(err.msg())};
+        },
+    });
+}
+
+String formatValue(Value const &value) {
+    return _toString(value);
+}
+
+static Value _compare(BinaryExpr::Op op, Value const &lhs, Value const &rhs) {
+    std::partial_ordering ord = std::partial_ordering::unordered;
+
+    auto *ls = lhs.is<String>();
+    auto *rs = rhs.is<String>();
+    if (ls and rs) {
+        ord = Str{*ls} <=> Str{*rs};
+    } else if (not ls and not rs) {
+        auto l = _toNumber(lhs);
+        if (not l)
+            return l.none();
+        auto r = _toNumber(rhs);
+        if (not r)
+            return r.none();
+        ord = l.unwrap() <=> r.unwrap();
+    } else {
+        // NOTE: Text always sorts after numbers.
+        ord = ls ? std::partial_ordering::greater : std::partial_ordering::less;
+    }
+
+    switch (op) {
+    case BinaryExpr::Op::EQ:
+        return ord == 0;
+    case BinaryExpr::Op::NE:
+        return ord != 0;
+    case BinaryExpr::Op::LT:
+        return ord < 0;
+    case BinaryExpr::Op::LE:
+        return ord <= 0;
+    case BinaryExpr::Op::GT:
+        return ord > 0;
+    case BinaryExpr::Op::GE:
+        return ord >= 0;
+    default:
+        return Error::invalidInput("#VALUE!");
+    }
+}
+
+static Value _apply(BinaryExpr::Op op, Value lhs, Value rhs) {
+    if (auto *err = lhs.is<Error>())
+        return *err;
+
+    if (auto *err = rhs.is<Error>())
+        return *err;
+
+    if (op == BinaryExpr::Op::CONCAT) {
+        StringBuilder sb;
+        sb.append(_toString(lhs));
+        sb.append(_toString(rhs));
+        return sb.take();
+    }
+
+    if (op >= BinaryExpr::Op::EQ)
+        return _compare(op, lhs, rhs);
+
+    auto l = _toNumber(lhs);
+    if (not l)
+        return l.none();
+
+    auto r = _toNumber(rhs);
+    if (not r)
+        return r.none();
+
+    switch (op) {
+    case BinaryExpr::Op::ADD:
+        return l.unwrap() + r.unwrap();
+    case BinaryExpr::Op::SUB:
+        return l.unwrap() - r.unwrap();
+    case BinaryExpr::Op::MUL:
+        return l.unwrap() * r.unwrap();
+    case BinaryExpr::Op::DIV:
+        if (r.unwrap() == 0)
+            return Error::invalidInput("#DIV/0!");
+        return l.unwrap() / r.unwrap();
+    case BinaryExpr::Op::POW:
+        return ::pow(l.unwrap(), r.unwrap());
+    default:
+        return Error::invalidInput("#VALUE!");
+    }
+}
+
+// Folds every number in the arguments, cells in ranges that aren't
+// numbers are skipped, like other spreadsheets do.
+static Res<> _fold(Sheet const &sheet, Slice<Expr> args, auto f) {
+    for (auto const &arg : args) {
+        if (auto *range = arg.is<Range>()) {
+            Res<> res = Ok();
+            sheet.cells.iter(*range, [&](Pos, Cell const &cell) {
+                if (not res)
+                    return;
+                if (auto *err = cell.value.is<Error>())
+                    res = *err;
+                else if (auto *num = cell.value.is<f64>())
+                    f(*num);
+            });
+            try$(res);
+            continue;
+        }
+
+        f(try$(_toNumber(sheet.eval(arg))));
+    }
+    return Ok();
+}
+
+static Value _call(Sheet const &sheet, CallExpr const &call) {
+    auto const &name = call.name;
+    Slice<Expr> args = call.args;
+
+    if (name == "SUM") {
+        f64 sum = 0;
+        auto res = _fold(sheet, args, [&](f64 v) {
+            sum += v;
+        });
+        return res ? Value{sum} : Value{res.none()};
+    }
+
+    if (name == "COUNT") {
+        f64 count = 0;
+        auto res = _fold(sheet, args, [&](f64) {
+            count++;
+        });
+        return res ? Value{count} : Value{res.none()};
+    }
+
+    if (name == "AVERAGE") {
+        f64 sum = 0;
+        usize count = 0;
+        auto res = _fold(sheet, args, [&](f64 v) {
+            sum += v;
+            count++;
+        });
+        if (not res)
+            return res.none();
+        if (count == 0)
+            return Error::invalidInput("#DIV/0!");
+        return sum / count;
+    }
+
+    if (name == "MIN" or name == "MAX") {
+        bool isMin = name == "MIN";
+        Opt<f64> acc;
+        auto res = _fold(sheet, args, [&](f64 v) {
+            if (not acc)
+                acc = v;
+            else
+                acc = isMin ? min(*acc, v) : max(*acc, v);
+        });
+        if (not res)
+            return res.none();
+        return acc ? *acc : 0.0;
+    }
+
+    if (name == "IF") {
+        if (args.len() < 2 or args.len() > 3)
+            return Error::invalidInput("#N/A");
+        auto cond = _toNumber(sheet.eval(args[0]));
+        if (not cond)
+            return cond.none();
+        if (cond.unwrap() != 0)
+            return sheet.eval(args[1]);
+        return args.len() == 3 ? sheet.eval(args[2]) : Value{false};
+    }
+
+    if (name == "ABS" or name == "SQRT") {
+        if (args.len() != 1)
+            return Error::invalidInput("#N/A");
+        auto num = _toNumber(sheet.eval(args[0]));
+        if (not num)
+            return num.none();
+        if (name == "ABS")
+            return Math::abs(num.unwrap());
+        if (num.unwrap() < 0)
+            return Error::invalidInput("#NUM!");
+        return Math::sqrt(num.unwrap());
+    }
+
+    return Error::invalidInput("#NAME?");
+}
+
+Value Sheet::eval(Expr const &expr) const {
+    return expr.visit(Visitor{
+        [](f64 num) -> Value {
+            return num;
+        },
+        [](String const &str) -> Value {
+            return str;
+        },
+        [](bool b) -> Value {
+            return b;
+        },
+        [&](Pos const &pos) -> Value {
+            return value(pos);
+        },
+        [](Range const &) -> Value {
+            return Error::invalidInput("#VALUE!");
+        },
+        [&](UnaryExpr const &u) -> Value {
+            auto num = _toNumber(eval(*u.expr));
+            if (not num)
+                return num.none();
+            if (u.op == UnaryExpr::Op::NEG)
+                return -num.unwrap();
+            return num.unwrap() / 100;
+        },
+        [&](BinaryExpr const &b) -> Value {
+            return _apply(b.op, eval(*b.lhs), eval(*b.rhs));
+        },
+        [&](CallExpr const &c) -> Value {
+            return _call(*this, c);
+        },
+    });
+}
+
+} // namespace Hideo::Spreadsheet
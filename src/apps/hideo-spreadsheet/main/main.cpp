@@ -0,0 +1,18 @@
+#include <karm-io/funcs.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/file.h>
+#include <karm-ui/app.h>
+
+#include "../app.h"
+
+Async::Task<> entryPointAsync(Sys::Context &ctx) {
+    auto &args = useArgs(ctx);
+    Hideo::Spreadsheet::State state;
+    if (args.len()) {
+        auto url = co_try$(Mime::parseUrlOrPath(args[0]));
+        auto file = co_try$(Sys::File::open(url));
+        auto csv = co_try$(Io::readAllUtf8(file));
+        co_try$(state.activeSheet().loadCsv(csv));
+    }
+    co_return Ui::runApp(ctx, Hideo::Spreadsheet::app(std::move(state)));
+}
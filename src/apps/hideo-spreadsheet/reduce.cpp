@@ -8,6 +8,12 @@ void reduce(State &s, Action a) {
             [&](UpdateSelection &u) {
                 s.selection = u.range;
             },
+            [&](UpdateValue &u) {
+                s.activeSheet().update(u.range, u.value);
+            },
+            [&](EditCell &u) {
+                s.activeSheet().edit(u.pos, u.input);
+            },
             [&](ToggleProperties &) {
                 s.propertiesVisible = not s.propertiesVisible;
             },
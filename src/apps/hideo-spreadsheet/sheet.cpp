@@ -0,0 +1,270 @@
+#include <karm-io/aton.h>
+
+#include "app.h"
+
+namespace Hideo::Spreadsheet {
+
+String colName(usize col) {
+    Array<char, 16> buf;
+    usize len = 0;
+
+    col++;
+    while (col) {
+        col--;
+        buf[len++] = 'A' + col % 26;
+        col /= 26;
+    }
+
+    StringBuilder sb;
+    while (len)
+        sb.append((Rune)buf[--len]);
+    return sb.take();
+}
+
+static Value _parseLiteral(Str input) {
+    if (eqCi(input, Str{"TRUE"}))
+        return true;
+
+    if (eqCi(input, Str{"FALSE"}))
+        return false;
+
+    Io::SScan s{input};
+    auto num = Io::atof(s);
+    if (num and s.ended())
+        return *num;
+
+    return String{input};
+}
+
+// MARK: Cells -----------------------------------------------------------------
+
+void Sheet::update(Range range, Value value) {
+    range = range.normalised();
+
+    Vec<Pos> roots;
+    for (usize row = range.start.row; row <= range.end.row; row++) {
+        for (usize col = range.start.col; col <= range.end.col; col++) {
+            Pos pos{row, col};
+            _setFormula(pos, NONE);
+            cells.ensure(pos).value = value;
+            roots.pushBack(pos);
+        }
+    }
+
+    recalc(roots);
+}
+
+void Sheet::edit(Pos pos, Str input) {
+    if (not input) {
+        clear(pos);
+        return;
+    }
+
+    if (input[0] != '=') {
+        update(pos, _parseLiteral(input));
+        return;
+    }
+
+    auto formula = parseFormula(next(input));
+    if (formula) {
+        _setFormula(pos, formula.take());
+    } else {
+        _setFormula(pos, NONE);
+        cells.ensure(pos).value = formula.none();
+    }
+
+    recalc({&pos, 1});
+}
+
+void Sheet::clear(Pos pos) {
+    _setFormula(pos, NONE);
+    cells.del(pos);
+    recalc({&pos, 1});
+}
+
+Res<> Sheet::loadCsv(Str csv) {
+    Io::SScan s{csv};
+    usize row = 0;
+    usize col = 0;
+    usize width = 0;
+
+    while (not s.ended()) {
+        if (row >= MAX_ROWS or col >= MAX_COLS)
+            return Error::invalidData("too many rows or columns");
+
+        Pos pos{row, col};
+        if (s.skip('"')) {
+            StringBuilder sb;
+            while (true) {
+                if (s.ended())
+                    return Error::invalidData("unterminated quoted field");
+                if (s.skip('"')) {
+                    if (not s.skip('"'))
+                        break;
+                    sb.append('"');
+                    continue;
+                }
+                sb.append(s.next());
+            }
+
+            // NOTE: Quoting a field is how to keep it as text.
+            cells.ensure(pos).value = sb.take();
+        } else {
+            s.begin();
+            while (not s.ended() and
+                   s.peek() != ',' and
+                   s.peek() != '\n' and
+                   s.peek() != '\r')
+                s.next();
+            auto field = s.end();
+
+            if (field and field[0] == '=') {
+                auto formula = parseFormula(next(field));
+                if (formula)
+                    _setFormula(pos, formula.take());
+                else
+                    cells.ensure(pos).value = formula.none();
+            } else if (field) {
+                cells.ensure(pos).value = _parseLiteral(field);
+            }
+        }
+
+        width = max(width, col + 1);
+        if (s.skip(',')) {
+            col++;
+        } else {
+            s.skip('\r');
+            s.skip('\n');
+            row++;
+            col = 0;
+        }
+    }
+
+    while (rows.len() < row)
+        rows.pushBack({});
+
+    while (cols.len() < width)
+        cols.pushBack({});
+
+    recompute();
+
+    // NOTE: Formulas can refer to cells further down, so they can only be
+    //       evaluated once everything is in.
+    recalcAll();
+    return Ok();
+}
+
+// MARK: Recalculation ---------------------------------------------------------
+
+void Sheet::_watch(Pos pos, Formula const &formula) {
+    for (auto const &p : formula.precedents) {
+        for (usize r = p.start.row / Tile::ROWS; r <= p.end.row / Tile::ROWS; r++)
+            for (usize c = p.start.col / Tile::COLS; c <= p.end.col / Tile::COLS; c++)
+                cells.watch({r * Tile::ROWS, c * Tile::COLS}, pos);
+    }
+}
+
+void Sheet::_unwatch(Pos pos, Formula const &formula) {
+    for (auto const &p : formula.precedents) {
+        for (usize r = p.start.row / Tile::ROWS; r <= p.end.row / Tile::ROWS; r++)
+            for (usize c = p.start.col / Tile::COLS; c <= p.end.col / Tile::COLS; c++)
+                cells.unwatch({r * Tile::ROWS, c * Tile::COLS}, pos);
+    }
+}
+
+void Sheet::_setFormula(Pos pos, Opt<Strong<Formula>> formula) {
+    auto *c = cells.get(pos);
+    if (not c and not formula)
+        return;
+
+    auto &cell = c ? *c : cells.ensure(pos);
+    if (cell.formula)
+        _unwatch(pos, **cell.formula);
+
+    cell.formula = formula;
+    if (formula)
+        _watch(pos, **formula);
+}
+
+void Sheet::recalc(Slice<Pos> roots) {
+    auto epoch = ++_epoch;
+    Vec<Pos> cone;
+
+    for (auto root : roots) {
+        auto *c = cells.get(root);
+        if (c and c->_epoch == epoch)
+            continue;
+
+        if (c) {
+            c->_epoch = epoch;
+            c->_pending = 0;
+        }
+        cone.pushBack(root);
+    }
+
+    // NOTE: Walk everything downstream of the roots, counting for every
+    //       formula how many of its precedents are going to change.
+    for (usize i = 0; i < cone.len(); i++) {
+        _dependents(cone[i], [&](Pos dep) {
+            auto &c = *cells.get(dep);
+            if (c._epoch != epoch) {
+                c._epoch = epoch;
+                c._pending = 0;
+                cone.pushBack(dep);
+            }
+            c._pending++;
+        });
+    }
+
+    // NOTE: Then evaluate them in waves, a formula is ready once all of
+    //       its precedents are, and formulas in the same wave don't depend
+    //       on each other.
+    Vec<Pos> wave;
+    for (auto pos : cone) {
+        auto *c = cells.get(pos);
+        if (not c or c->_pending == 0)
+            wave.pushBack(pos);
+    }
+
+    usize done = 0;
+    while (wave.len()) {
+        for (auto pos : wave) {
+            auto *c = cells.get(pos);
+            if (c and c->formula)
+                c->value = eval((*c->formula)->expr);
+        }
+
+        Vec<Pos> next;
+        for (auto pos : wave) {
+            _dependents(pos, [&](Pos dep) {
+                auto &c = *cells.get(dep);
+                if (--c._pending == 0)
+                    next.pushBack(dep);
+            });
+        }
+
+        done += wave.len();
+        wave = std::move(next);
+    }
+
+    if (done == cone.len())
+        return;
+
+    // NOTE: Whatever is left is part of a cycle, or depends on one.
+    for (auto pos : cone) {
+        auto *c = cells.get(pos);
+        if (c and c->_pending)
+            c->value = Error::invalidData("#CYCLE!");
+    }
+}
+
+void Sheet::recalcAll() {
+    Vec<Pos> roots;
+    cells.iter([&](Pos pos, Cell const &cell) {
+        if (cell.formula)
+            roots.pushBack(pos);
+    });
+    recalc(roots);
+}
+
+} // namespace Hideo::Spreadsheet
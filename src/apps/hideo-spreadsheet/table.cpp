@@ -1,3 +1,5 @@
+#include <karm-io/fmt.h>
+#include <karm-ui/funcs.h>
 #include <karm-ui/input.h>
 #include <karm-ui/view.h>
 
@@ -7,7 +9,7 @@ namespace Hideo::Spreadsheet {
 
 struct Table : public Ui::View<Table> {
     State const *_state;
-    Math::Vec2i _scroll;
+    Math::Vec2i _scroll{};
     Ui::MouseListener _mouseListener;
 
     Table(State const &state)
@@ -43,20 +45,57 @@ struct Table : public Ui::View<Table> {
 
     Math::Recti cellBound(usize row, usize col) {
         return {
-            sheet().cols[col].x + CELL_WIDTH,
-            sheet().rows[row].y + CELL_HEIGHT,
+            sheet().cols[col].x + CELL_WIDTH - _scroll.x,
+            sheet().rows[row].y + CELL_HEIGHT - _scroll.y,
             sheet().cols[col].width,
             sheet().rows[row].height,
         };
     }
 
+    Math::Vec2i contentSize() {
+        auto const &rows = sheet().rows;
+        auto const &cols = sheet().cols;
+        return {
+            cols.len() ? last(cols).x + last(cols).width : 0,
+            rows.len() ? last(rows).y + last(rows).height : 0,
+        };
+    }
+
+    // Rows and columns in view, looked up by binary search so painting
+    // doesn't depend on the size of the sheet.
+    urange visibleRows() {
+        usize first = tryOr(sheet().rowAt(_scroll.y), sheet().rows.len());
+        usize end = first;
+        while (end < sheet().rows.len() and
+               sheet().rows[end].y - _scroll.y < _bound.height - CELL_HEIGHT)
+            end++;
+        return urange::fromStartEnd(first, end);
+    }
+
+    urange visibleCols() {
+        usize first = tryOr(sheet().colAt(_scroll.x), sheet().cols.len());
+        usize end = first;
+        while (end < sheet().cols.len() and
+               sheet().cols[end].x - _scroll.x < _bound.width - CELL_WIDTH)
+            end++;
+        return urange::fromStartEnd(first, end);
+    }
+
+    void scroll(Math::Vec2i delta) {
+        auto limit = (contentSize() - (_bound.wh - Math::Vec2i{CELL_WIDTH, CELL_HEIGHT})).max(Math::Vec2i{});
+        _scroll = (_scroll + delta).max(Math::Vec2i{}).min(limit);
+    }
+
     // MARK: Events ------------------------------------------------------------
 
     void event(Sys::Event &e) override {
         e.handle<Events::MouseEvent>([&](Events::MouseEvent const &m) {
-            auto pos = m.pos - bound().topStart();
+            auto pos = m.pos - bound().topStart() + _scroll;
             if (bound().contains(m.pos)) {
-                if (m.type == Events::MouseEvent::PRESS) {
+                if (m.type == Events::MouseEvent::SCROLL) {
+                    scroll(-(m.scroll * 64).cast<isize>());
+                    Ui::shouldRepaint(*this);
+                } else if (m.type == Events::MouseEvent::PRESS) {
                     auto cell = sheet().cellAt(pos - Math::Vec2i{CELL_WIDTH, CELL_HEIGHT});
                     if (cell) {
                         Model::bubble(*this, UpdateSelection{Range{*cell}});
@@ -82,8 +121,15 @@ struct Table : public Ui::View<Table> {
 
     // MARK: Painting ----------------------------------------------------------
 
-    void paintCell(Gfx::Context &g, Cell const &, Math::Recti bound) {
-        g.rect(bound.cast<f64>());
+    void paintCell(Gfx::Context &g, Cell const &cell, Math::Recti bound) {
+        if (cell.value.is<None>())
+            return;
+
+        g.fillStyle(cell.value.is<Error>() ? Gfx::RED : Ui::GRAY50);
+        g.fill(
+            {bound.x + 6.0, bound.y + bound.height - 7.0},
+            formatValue(cell.value)
+        );
     }
 
     void paintColHeader(Gfx::Context &g, usize idx) {
@@ -143,13 +189,27 @@ struct Table : public Ui::View<Table> {
         g.clip(bound());
         g.origin(bound().xy);
 
-        // Draw columns.
-        isize headerX = CELL_WIDTH;
-        usize index = 0;
-        while (headerX < _bound.width and
-               index < sheet().cols.len()) {
+        auto rows = visibleRows();
+        auto cols = visibleCols();
+
+        // Draw the cells.
+        g.save();
+        g.clip(Math::Recti{CELL_WIDTH, CELL_HEIGHT, _bound.width - CELL_WIDTH, _bound.height - CELL_HEIGHT});
+        for (usize row = rows.start; row < rows.end(); row++) {
+            for (usize col = cols.start; col < cols.end(); col++) {
+                if (auto *cell = sheet().cell({row, col}))
+                    paintCell(g, *cell, cellBound(row, col));
+            }
+        }
 
+        if (_state->selection)
+            paintSelection(g, *_state->selection);
+        g.restore();
+
+        // Draw columns.
+        for (usize index = cols.start; index < cols.end(); index++) {
             auto col = sheet().cols[index];
+            isize headerX = CELL_WIDTH + col.x - _scroll.x;
             Math::Recti colBound = {headerX, 0, col.width, CELL_HEIGHT};
 
             g.fillStyle(Ui::GRAY800);
@@ -157,17 +217,14 @@ struct Table : public Ui::View<Table> {
 
             g.plot(Math::Edgei{headerX + col.width - 1, 0, headerX + col.width - 1, _bound.height}, Gfx::WHITE.withOpacity(0.05));
 
-            headerX += col.width;
-            index++;
+            g.fillStyle(Ui::GRAY400);
+            g.fill({headerX + 6.0, CELL_HEIGHT - 7.0}, colName(index));
         }
 
         // Draw rows.
-        isize headerY = CELL_HEIGHT;
-        index = 0;
-        while (headerY < _bound.height and
-               index < sheet().rows.len()) {
-
+        for (usize index = rows.start; index < rows.end(); index++) {
             auto row = sheet().rows[index];
+            isize headerY = CELL_HEIGHT + row.y - _scroll.y;
             Math::Recti rowBound = {0, headerY, CELL_WIDTH, row.height};
 
             g.fillStyle(Ui::GRAY800);
@@ -175,16 +232,24 @@ struct Table : public Ui::View<Table> {
 
             g.plot(Math::Edgei{0, headerY + row.height - 1, _bound.width, headerY + row.height - 1}, Gfx::WHITE.withOpacity(0.05));
 
-            headerY += row.height;
-            index++;
+            g.fillStyle(Ui::GRAY400);
+            g.fill({6.0, headerY + row.height - 7.0}, Io::format("{}", index + 1).unwrap());
         }
 
-        if (_state->selection)
-            paintSelection(g, *_state->selection);
+        g.fillStyle(Ui::GRAY800);
+        g.fill(Math::Recti{0, 0, CELL_WIDTH, CELL_HEIGHT});
 
         g.restore();
     }
 
+    void layout(Math::Recti bound) override {
+        View<Table>::layout(bound);
+
+        // NOTE: The sheet might have shrunk or the view grown since the
+        //       last scroll.
+        scroll({});
+    }
+
     Math::Vec2i size(Math::Vec2i, Ui::Hint) override {
         return {100, 100};
     }
@@ -0,0 +1,84 @@
+#include <karm-test/macros.h>
+
+#include "../app.h"
+
+namespace Hideo::Spreadsheet::Tests {
+
+static f64 _num(Sheet const &sheet, Pos pos) {
+    auto value = sheet.value(pos);
+    auto *num = value.is<f64>();
+    return num ? *num : -1;
+}
+
+static bool _cycle(Sheet const &sheet, Pos pos) {
+    auto value = sheet.value(pos);
+    auto *err = value.is<Error>();
+    return err and Str{err->msg()} == "#CYCLE!";
+}
+
+test$("spreadsheet-recalc-order") {
+    Sheet sheet;
+    sheet.edit({0, 0}, "1");
+    sheet.edit({0, 1}, "=A1*2");
+    sheet.edit({0, 2}, "=B1+A1");
+    sheet.edit({0, 3}, "=C1+B1");
+    expectEq$(_num(sheet, {0, 3}), 5.0);
+
+    // NOTE: D1 reads both B1 and C1, it must only be evaluated once both
+    //       of them are up to date.
+    sheet.edit({0, 0}, "5");
+    expectEq$(_num(sheet, {0, 1}), 10.0);
+    expectEq$(_num(sheet, {0, 2}), 15.0);
+    expectEq$(_num(sheet, {0, 3}), 25.0);
+
+    sheet.edit({1, 0}, "=SUM(A1:D1)");
+    sheet.update(Range{Pos{0, 0}}, 1.0);
+    expectEq$(_num(sheet, {1, 0}), 1.0 + 2.0 + 3.0 + 5.0);
+
+    return Ok();
+}
+
+test$("spreadsheet-recalc-cycles") {
+    Sheet sheet;
+    sheet.edit({0, 0}, "=B1");
+    sheet.edit({0, 1}, "=A1");
+    sheet.edit({0, 2}, "=A1+1");
+    sheet.edit({0, 3}, "3");
+
+    expect$(_cycle(sheet, {0, 0}));
+    expect$(_cycle(sheet, {0, 1}));
+    expect$(_cycle(sheet, {0, 2}));
+    expectEq$(_num(sheet, {0, 3}), 3.0);
+
+    sheet.edit({0, 1}, "2");
+    expectEq$(_num(sheet, {0, 0}), 2.0);
+    expectEq$(_num(sheet, {0, 2}), 3.0);
+
+    sheet.edit({5, 5}, "=F6");
+    expect$(_cycle(sheet, {5, 5}));
+
+    return Ok();
+}
+
+test$("spreadsheet-watchers") {
+    Cells cells;
+    cells.watch({0, 0}, {3, 0});
+    cells.watch({1, 1}, {1, 0});
+    cells.watch({2, 2}, {3, 0});
+    cells.watch({0, 0}, {2, 5});
+
+    auto watchers = cells.watchers({0, 0});
+    expectEq$(watchers.len(), 3uz);
+    expect$(watchers[0] == (Pos{1, 0}));
+    expect$(watchers[1] == (Pos{2, 5}));
+    expect$(watchers[2] == (Pos{3, 0}));
+
+    cells.unwatch({0, 0}, {2, 5});
+    cells.unwatch({0, 0}, {9, 9});
+    expectEq$(cells.watchers({0, 0}).len(), 2uz);
+    expectEq$(cells.watchers({Tile::ROWS, 0}).len(), 0uz);
+
+    return Ok();
+}
+
+} // namespace Hideo::Spreadsheet::Tests
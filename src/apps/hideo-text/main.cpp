@@ -49,14 +49,14 @@ Ui::Child editor(Strong<Textbox::Model> text) {
            Ui::spacing(16) | Ui::vscroll() | Ui::grow();
 }
 
-Ui::Child app(Opt<Mime::Url> url, Res<String> str) {
+Ui::Child app(Opt<Mime::Url> url) {
     auto text = makeStrong<Textbox::Model>();
     Opt<Error> error = NONE;
 
-    if (str) {
-        text->load(str.unwrap());
-    } else {
-        error = str.none();
+    if (url) {
+        auto res = text->loadFile(*url);
+        if (not res)
+            error = res.none();
     }
 
     return Ui::reducer<Model>(
@@ -108,7 +108,7 @@ Ui::Child app(Opt<Mime::Url> url, Res<String> str) {
                             Math::Align::CENTER,
                             Ui::labelSmall("{}", s.text->dirty() ? "Edited" : ""),
                             Ui::grow(NONE),
-                            Ui::labelSmall("Ln {}, Col {}", 0, 0),
+                            Ui::labelSmall("Ln {}, Col {}", s.text->line() + 1, s.text->col() + 1),
                             Ui::separator(),
                             Ui::labelSmall("UTF-8"),
                             Ui::separator(),
@@ -124,20 +124,12 @@ Ui::Child app(Opt<Mime::Url> url, Res<String> str) {
     );
 }
 
-Res<String> readAllUtf8(Mime::Url const &url) {
-    auto file = try$(Sys::File::open(url));
-    return Io::readAllUtf8(file);
-}
-
 } // namespace Hideo::Text
 
 Async::Task<> entryPointAsync(Sys::Context &ctx) {
     auto &args = useArgs(ctx);
     Opt<Mime::Url> url;
-    Res<String> text = Ok<String>();
-    if (args.len()) {
+    if (args.len())
         url = co_try$(Mime::parseUrlOrPath(args[0]));
-        text = Hideo::Text::readAllUtf8(*url);
-    }
-    co_return Ui::runApp(ctx, Hideo::Text::app(url, text));
+    co_return Ui::runApp(ctx, Hideo::Text::app(url));
 }
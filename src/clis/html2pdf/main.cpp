@@ -1,8 +1,14 @@
+#include <karm-base/atomic.h>
+#include <karm-io/aton.h>
 #include <karm-mime/mime.h>
 #include <karm-sys/entry.h>
 #include <karm-sys/file.h>
+#include <karm-sys/info.h>
+#include <karm-sys/thread.h>
 #include <karm-sys/time.h>
+#include <pdf/printer.h>
 #include <vaev-html/parser.h>
+#include <vaev-json/json.h>
 #include <vaev-view/render.h>
 #include <vaev-xml/parser.h>
 
@@ -20,8 +26,6 @@ Res<Strong<Dom::Document>> fetch(Mime::Url url) {
         return Error::invalidInput("unsupported about page");
     }
 
-    auto start = Sys::now();
-
     auto mime = Mime::sniffSuffix(url.path.suffix());
 
     if (not mime.has())
@@ -34,19 +38,11 @@ Res<Strong<Dom::Document>> fetch(Mime::Url url) {
     if (mime->is("text/html"_mime)) {
         Html::Parser parser{dom};
         parser.write(buf);
-
-        auto elapsed = Sys::now() - start;
-        logDebug("parse time: {}ms", elapsed.toUSecs() / 1000.0);
-
         return Ok(dom);
     } else if (mime->is("application/xhtml+xml"_mime)) {
         Io::SScan scan{buf};
         Xml::Parser parser;
         dom = try$(parser.parse(scan, HTML));
-
-        auto elapsed = Sys::now() - start;
-        logDebug("parse time: {}ms", elapsed.toUSecs() / 1000.0);
-
         return Ok(dom);
     } else {
         logError("unsupported MIME type: {}", mime);
@@ -56,18 +52,208 @@ Res<Strong<Dom::Document>> fetch(Mime::Url url) {
 
 } // namespace Vaev
 
+namespace Html2Pdf {
+
+struct Job {
+    Mime::Url input;
+    Mime::Url output;
+};
+
+struct Timings {
+    TimeSpan parse;
+    TimeSpan style;
+    TimeSpan layout;
+    TimeSpan paint;
+    TimeSpan write;
+};
+
+struct Outcome {
+    Timings timings = {};
+    Res<> result = Ok();
+};
+
+Res<> convert(Job const &job, Strong<Vaev::Style::StyleSheet> userAgent, Timings &timings) {
+    auto start = Sys::now();
+    auto dom = try$(Vaev::fetch(job.input));
+    timings.parse = Sys::now() - start;
+
+    auto paper = Print::A4;
+    Vaev::Vec2Px viewport{
+        Vaev::Px{paper.width / 25.4 * 96},
+        Vaev::Px{paper.height / 25.4 * 96},
+    };
+    auto result = Vaev::View::print(*dom, viewport, userAgent);
+    timings.style = result.stats.style;
+    timings.layout = result.stats.layout;
+    timings.paint = result.stats.paint;
+
+    // NOTE: Words are never broken, one that is wider than the page would
+    //       be cut off by its edge.
+    if (result.paint->bound().end() > viewport.x.toInt<isize>())
+        return Error::invalidData("content is wider than the page");
+
+    start = Sys::now();
+    auto file = try$(Sys::File::create(job.output));
+    Pdf::Printer printer{file, paper};
+    result.paint->print(printer);
+    try$(printer.finish());
+    timings.write = Sys::now() - start;
+
+    return Ok();
+}
+
+Res<Vec<Job>> loadManifest(Mime::Url url) {
+    auto file = try$(Sys::File::open(url));
+    auto buf = try$(Io::readAllUtf8(file));
+    auto manifest = try$(Vaev::Json::parse(buf));
+
+    if (not manifest.isArray())
+        return Error::invalidData("expected an array of jobs");
+
+    Vec<Job> jobs;
+    for (auto const &entry : manifest.asArray()) {
+        auto input = entry.get("input");
+        auto output = entry.get("output");
+        if (not input.isStr() or not output.isStr())
+            return Error::invalidData("expected a job with an input and an output");
+
+        jobs.pushBack({
+            try$(Mime::parseUrlOrPath(input.asStr())),
+            try$(Mime::parseUrlOrPath(output.asStr())),
+        });
+    }
+
+    return Ok(jobs);
+}
+
+// Run the jobs on up to `workers` threads, the calling thread included.
+// Documents are handed out one at a time, so a slow one doesn't hold back
+// the ones queued behind it.
+Vec<Outcome> runBatch(Slice<Job> jobs, usize workers, Strong<Vaev::Style::StyleSheet> userAgent) {
+    Vec<Outcome> outcomes;
+    outcomes.resize(jobs.len());
+
+    Atomic<usize> next = 0;
+    auto work = [&] {
+        while (true) {
+            auto i = next.fetchInc();
+            if (i >= jobs.len())
+                return;
+            outcomes[i].result = convert(jobs[i], userAgent, outcomes[i].timings);
+        }
+    };
+
+    Vec<Strong<Sys::Thread>> threads;
+    for (usize i = 1; i < min(workers, jobs.len()); i++) {
+        auto thread = Sys::spawnThread([&] {
+            work();
+        });
+
+        if (not thread) {
+            logWarn("could not spawn worker: {}", thread.none());
+            break;
+        }
+
+        threads.pushBack(thread.take());
+    }
+
+    work();
+
+    for (auto &thread : threads)
+        thread->join().unwrap("could not join worker");
+
+    return outcomes;
+}
+
+static f64 _ms(TimeSpan span) {
+    return span.toUSecs() / 1000.0;
+}
+
+Vaev::Json::Value report(Slice<Job> jobs, Slice<Outcome> outcomes, usize workers, TimeSpan elapsed) {
+    Vaev::Json::Array documents;
+    usize failed = 0;
+
+    for (usize i = 0; i < jobs.len(); i++) {
+        auto const &outcome = outcomes[i];
+        auto const &timings = outcome.timings;
+
+        Vaev::Json::Object doc;
+        doc.put("input"s, jobs[i].input.str());
+        doc.put("output"s, jobs[i].output.str());
+        doc.put("ok"s, (bool)outcome.result);
+        if (not outcome.result) {
+            failed++;
+            doc.put("error"s, String{outcome.result.none().msg()});
+        }
+        doc.put("parse"s, _ms(timings.parse));
+        doc.put("style"s, _ms(timings.style));
+        doc.put("layout"s, _ms(timings.layout));
+        doc.put("paint"s, _ms(timings.paint));
+        doc.put("write"s, _ms(timings.write));
+        documents.pushBack(doc);
+    }
+
+    Vaev::Json::Object res;
+    res.put("workers"s, (Vaev::Json::Integer)workers);
+    res.put("failed"s, (Vaev::Json::Integer)failed);
+    res.put("elapsed"s, _ms(elapsed));
+    res.put("documents"s, documents);
+    return res;
+}
+
+} // namespace Html2Pdf
+
 Async::Task<> entryPointAsync(Sys::Context &ctx) {
     auto args = Sys::useArgs(ctx);
+
+    if (args.len() >= 2 and args[0] == "--batch") {
+        Opt<usize> workers = NONE;
+        if (args.len() == 4 and args[2] == "--jobs") {
+            workers = Io::atou(args[3]);
+        } else if (args.len() != 2) {
+            Sys::errln("usage: html2pdf --batch <manifest.json> [--jobs <count>]\n");
+            co_return Error::invalidInput();
+        }
+
+        if (not workers or workers.unwrap() == 0) {
+            auto cpus = Sys::cpusinfo();
+            workers = cpus ? max(cpus.unwrap().len(), 1uz) : 1;
+        }
+
+        auto jobs = co_try$(Html2Pdf::loadManifest(co_try$(Mime::parseUrlOrPath(args[1]))));
+        auto userAgent = co_try$(Vaev::View::fetchUserAgentStylesheet());
+
+        auto start = Sys::now();
+        auto outcomes = Html2Pdf::runBatch(jobs, workers.unwrap(), userAgent);
+        auto elapsed = Sys::now() - start;
+
+        Sys::println("{}", Html2Pdf::report(jobs, outcomes, workers.unwrap(), elapsed));
+        co_return Ok();
+    }
+
     if (args.len() != 2) {
         Sys::errln("usage: html2pdf <input.html> <output.pdf>\n");
+        Sys::errln("       html2pdf --batch <manifest.json> [--jobs <count>]\n");
         co_return Error::invalidInput();
     }
 
-    auto input = co_try$(Mime::parseUrlOrPath(args[0]));
-    auto dom = co_try$(Vaev::fetch(input));
+    Html2Pdf::Job job{
+        co_try$(Mime::parseUrlOrPath(args[0])),
+        co_try$(Mime::parseUrlOrPath(args[1])),
+    };
+
+    Html2Pdf::Timings timings;
+    auto userAgent = co_try$(Vaev::View::fetchUserAgentStylesheet());
+    co_try$(Html2Pdf::convert(job, userAgent, timings));
 
-    Vaev::Vec2Px viewport{Vaev::Px{800}, Vaev::Px{600}};
-    Vaev::View::render(*dom, viewport);
+    logDebug(
+        "parse: {}ms, style: {}ms, layout: {}ms, paint: {}ms, write: {}ms",
+        timings.parse.toUSecs() / 1000.0,
+        timings.style.toUSecs() / 1000.0,
+        timings.layout.toUSecs() / 1000.0,
+        timings.paint.toUSecs() / 1000.0,
+        timings.write.toUSecs() / 1000.0
+    );
 
     co_return Ok();
 }
@@ -0,0 +1,87 @@
+#include <karm-io/funcs.h>
+#include <karm-sys/dir.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/file.h>
+#include <karm-sys/resource.h>
+
+struct Resource {
+    String key;
+    Mime::Url url;
+    usize size;
+};
+
+Res<> collect(Mime::Url const &url, String const &key, Vec<Resource> &out) {
+    auto dir = try$(Sys::Dir::open(url));
+    for (auto const &entry : dir.entries()) {
+        auto child = url / entry.name;
+        auto childKey = try$(Io::format("{}/{}", key, entry.name));
+        if (entry.isDir) {
+            try$(collect(child, childKey, out));
+        } else {
+            auto stat = try$(Sys::stat(child));
+            out.pushBack({childKey, child, stat.size});
+        }
+    }
+    return Ok();
+}
+
+Res<> write(Sys::FileWriter &out, auto const &val) {
+    try$(out.write({reinterpret_cast<Byte const *>(&val), sizeof(val)}));
+    return Ok();
+}
+
+// NOTE: The archive is a snapshot, resources that are in it are served
+//       from it even if the bundle has a newer copy. It has to be packed
+//       again after every build, or deleted.
+Async::Task<> entryPointAsync(Sys::Context &ctx) {
+    auto &args = Sys::useArgs(ctx);
+    if (args.len() != 2) {
+        Sys::errln("usage: pack-bundles <bundles> <archive>");
+        co_return Error::invalidInput();
+    }
+
+    // NOTE: Bundles are laid out like the builder leaves them, each with its
+    //       resources under "__res__".
+    auto root = co_try$(Mime::parseUrlOrPath(args[0]));
+    Vec<Resource> resources;
+    for (auto const &bundle : co_try$(Sys::Dir::open(root)).entries()) {
+        if (not bundle.isDir)
+            continue;
+
+        // NOTE: Plenty of bundles come without any resources.
+        auto res = root / bundle.name / "__res__";
+        auto stat = Sys::stat(res);
+        if (stat and stat.unwrap().type == Sys::Stat::DIR)
+            co_try$(collect(res, bundle.name, resources));
+    }
+
+    sort(resources, [](auto const &a, auto const &b) {
+        return a.key <=> b.key;
+    });
+
+    usize keyOff = sizeof(Sys::BundleHeader) + resources.len() * sizeof(Sys::BundleEntry);
+    usize dataOff = keyOff;
+    for (auto const &r : resources)
+        dataOff += r.key.len();
+
+    auto out = co_try$(Sys::File::create(co_try$(Mime::parseUrlOrPath(args[1]))));
+    co_try$(write(out, Sys::BundleHeader{Sys::BundleHeader::MAGIC, resources.len()}));
+
+    for (auto const &r : resources) {
+        co_try$(write(out, Sys::BundleEntry{keyOff, r.key.len(), dataOff, r.size}));
+        keyOff += r.key.len();
+        dataOff += r.size;
+    }
+
+    for (auto const &r : resources)
+        co_try$(out.write(bytes(r.key)));
+
+    for (auto const &r : resources) {
+        auto in = co_try$(Sys::File::open(r.url));
+        if (co_try$(Io::copy(in, out)) != r.size)
+            co_return Error::invalidData("resource changed while packing");
+    }
+
+    Sys::println("packed {} resources", resources.len());
+    co_return Ok();
+}
@@ -6,6 +6,7 @@
 //
 #include <impl-posix/fd.h>
 #include <impl-posix/utils.h>
+#include <karm-base/limits.h>
 #include <karm-sys/async.h>
 #include <karm-sys/time.h>
 
@@ -20,8 +21,35 @@ struct DarwinSched :
     usize _id = 0;
     Map<usize, Async::Promise<>> _promises;
 
+    static constexpr usize WAKE_ID = Limits<usize>::MAX;
+
     DarwinSched(int kqueue)
         : _kqueue(kqueue) {
+        struct kevent64_s ev = {
+            .ident = WAKE_ID,
+            .filter = EVFILT_USER,
+            .flags = EV_ADD | EV_CLEAR,
+            .fflags = 0,
+            .data = 0,
+            .udata = WAKE_ID,
+            .ext = {},
+        };
+        ::kevent64(_kqueue, &ev, 1, nullptr, 0, 0, nullptr);
+    }
+
+    Res<> wake() override {
+        struct kevent64_s ev = {
+            .ident = WAKE_ID,
+            .filter = EVFILT_USER,
+            .flags = 0,
+            .fflags = NOTE_TRIGGER,
+            .data = 0,
+            .udata = WAKE_ID,
+            .ext = {},
+        };
+        if (::kevent64(_kqueue, &ev, 1, nullptr, 0, 0, nullptr) < 0)
+            return Posix::fromLastErrno();
+        return Ok();
     }
 
     ~DarwinSched() {
@@ -36,11 +64,17 @@ struct DarwinSched :
         return Posix::toTimespec(delta);
     }
 
-    Async::Task<> waitFor(struct kevent64_s ev) {
+    Async::Task<> waitFor(struct kevent64_s ev, Async::Cancelation::Token ct) {
+        co_try$(ct.check());
+
         usize id = _id++;
         auto promise = Async::Promise<>();
         auto future = promise.future();
 
+        // NOTE: Timers with the same ident would replace each other.
+        if (ev.filter == EVFILT_TIMER)
+            ev.ident = id;
+
         ev.udata = id;
         ::kevent64(
             _kqueue,
@@ -56,10 +90,20 @@ struct DarwinSched :
         );
 
         _promises.put(id, std::move(promise));
-        return Async::makeTask(future);
+
+        Async::OnCancel onCancel{ct, [&] {
+            auto promise = _promises.take(id);
+            if (not promise)
+                return;
+
+            ev.flags = EV_DELETE;
+            ::kevent64(_kqueue, &ev, 1, nullptr, 0, 0, nullptr);
+            promise.take().resolve(Error::interrupted("operation canceled"));
+        }};
+        co_return co_await future;
     }
 
-    Async::Task<usize> readAsync(Strong<Fd> fd, MutBytes buf) override {
+    Async::Task<usize> readAsync(Strong<Fd> fd, MutBytes buf, Async::Cancelation::Token ct) override {
         co_trya$(waitFor({
             .ident = fd->handle().value(),
             .filter = EVFILT_READ,
@@ -68,11 +112,11 @@ struct DarwinSched :
             .data = 0,
             .udata = 0,
             .ext = {},
-        }));
+        }, ct));
         co_return Ok(co_try$(fd->read(buf)));
     }
 
-    Async::Task<usize> writeAsync(Strong<Fd> fd, Bytes buf) override {
+    Async::Task<usize> writeAsync(Strong<Fd> fd, Bytes buf, Async::Cancelation::Token ct) override {
         co_trya$(waitFor({
             .ident = fd->handle().value(),
             .filter = EVFILT_WRITE,
@@ -81,7 +125,7 @@ struct DarwinSched :
             .data = 0,
             .udata = 0,
             .ext = {},
-        }));
+        }, ct));
         co_return Ok(co_try$(fd->write(buf)));
     }
 
@@ -94,11 +138,11 @@ struct DarwinSched :
             .data = 0,
             .udata = 0,
             .ext = {},
-        }));
+        }, {}));
         co_return Ok(co_try$(fd->flush()));
     }
 
-    Async::Task<_Accepted> acceptAsync(Strong<Fd> fd) override {
+    Async::Task<_Accepted> acceptAsync(Strong<Fd> fd, Async::Cancelation::Token ct) override {
         co_trya$(waitFor({
             .ident = fd->handle().value(),
             .filter = EVFILT_READ,
@@ -107,11 +151,11 @@ struct DarwinSched :
             .data = 0,
             .udata = 0,
             .ext = {},
-        }));
+        }, ct));
         co_return Ok(co_try$(fd->accept()));
     }
 
-    Async::Task<_Sent> sendAsync(Strong<Fd> fd, Bytes buf, Slice<Handle> handles, SocketAddr addr) override {
+    Async::Task<_Sent> sendAsync(Strong<Fd> fd, Bytes buf, Slice<Handle> handles, SocketAddr addr, Async::Cancelation::Token ct) override {
         co_trya$(waitFor({
             .ident = fd->handle().value(),
             .filter = EVFILT_WRITE,
@@ -120,11 +164,11 @@ struct DarwinSched :
             .data = 0,
             .udata = 0,
             .ext = {},
-        }));
+        }, ct));
         co_return Ok(co_try$(fd->send(buf, handles, addr)));
     }
 
-    Async::Task<_Received> recvAsync(Strong<Fd> fd, MutBytes buf, MutSlice<Handle> hnds) override {
+    Async::Task<_Received> recvAsync(Strong<Fd> fd, MutBytes buf, MutSlice<Handle> hnds, Async::Cancelation::Token ct) override {
         co_trya$(waitFor({
             .ident = fd->handle().value(),
             .filter = EVFILT_READ,
@@ -133,11 +177,11 @@ struct DarwinSched :
             .data = 0,
             .udata = 0,
             .ext = {},
-        }));
+        }, ct));
         co_return Ok(co_try$(fd->recv(buf, hnds)));
     }
 
-    Async::Task<> sleepAsync(TimeStamp until) override {
+    Async::Task<> sleepAsync(TimeStamp until, Async::Cancelation::Token ct) override {
         struct timespec ts = _computeTimeout(until);
 
         co_trya$(waitFor({
@@ -148,7 +192,7 @@ struct DarwinSched :
             .data = ts.tv_sec * 1'000'000'000 + ts.tv_nsec,
             .udata = 0,
             .ext = {},
-        }));
+        }, ct));
         co_return Ok();
     }
 
@@ -172,22 +216,19 @@ struct DarwinSched :
         if (n < 0)
             return Posix::fromLastErrno();
 
-        if (n == 0)
+        if (n == 0 or ev.udata == WAKE_ID)
             return Ok();
 
+        // NOTE: The waiter might have been canceled in the meantime.
         usize id = ev.udata;
-        auto promise =
-            _promises
-                .take(id)
-                .take("no promise found for event");
-
-        promise.resolve(Ok());
+        if (auto promise = _promises.take(id))
+            promise.take().resolve(Ok());
         return Ok();
     }
 };
 
 Sched &globalSched() {
-    static DarwinSched sched = []() {
+    static thread_local DarwinSched sched = []() {
         int kqueue = ::kqueue();
         if (kqueue < 0)
             panic("kqueue");
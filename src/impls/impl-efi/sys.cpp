@@ -224,7 +224,7 @@ Res<Strong<Fd>> connectTcp(SocketAddr) {
     notImplemented();
 }
 
-Res<Strong<Fd>> listenTcp(SocketAddr) {
+Res<Strong<Fd>> listenTcp(SocketAddr, bool) {
     notImplemented();
 }
 
@@ -236,6 +236,18 @@ Res<Strong<Fd>> listenIpc(Mime::Url) {
     notImplemented();
 }
 
+Res<Strong<Fd>> connectIpc(Mime::Url) {
+    return Error::notImplemented("ipc sockets are not supported");
+}
+
+Res<Cons<Strong<Fd>, Strong<Fd>>> createIpcPair() {
+    return Error::notImplemented("ipc sockets are not supported");
+}
+
+Res<Strong<Fd>> openTap(Str) {
+    return Error::notImplemented("tap devices are not supported");
+}
+
 // MARK: Files -----------------------------------------------------------------
 
 static Opt<Vaev::Json::Value> _index = NONE;
@@ -378,10 +390,28 @@ Res<> memFlush(void *, usize) {
     return Ok();
 }
 
+Res<Strong<Fd>> createShm(usize) {
+    return Error::notImplemented("shared memory is not supported");
+}
+
+// MARK: Synchronization -------------------------------------------------------
+
+Res<> futexWait(u32 *, u32, TimeStamp) {
+    return Error::notImplemented("futexes are not supported");
+}
+
+Res<> futexWake(u32 *, usize) {
+    return Error::notImplemented("futexes are not supported");
+}
+
 Res<Stat> stat(Mime::Url const &) {
     notImplemented();
 }
 
+Res<Bytes> bundleArchive() {
+    return Error::notFound("no bundle archive");
+}
+
 // MARK: Time ------------------------------------------------------------------
 
 TimeStamp now() {
@@ -457,4 +487,8 @@ Res<> exit(i32) {
         ;
 }
 
+Res<Strong<Sys::Thread>> spawnThread(Func<void()>) {
+    return Error::notImplemented("threads are not supported");
+}
+
 } // namespace Karm::Sys::_Embed
@@ -0,0 +1,328 @@
+#ifdef __ck_sys_linux__
+
+#    include <sys/epoll.h>
+#    include <sys/eventfd.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+
+//
+#    include <karm-base/list.h>
+#    include <karm-sys/time.h>
+
+#    include "epoll.h"
+#    include "fd.h"
+#    include "utils.h"
+
+namespace Posix {
+
+struct EpollSched : public Sys::Sched {
+    static constexpr usize NEVENTS = 128;
+
+    // Someone waiting on the scheduler, it lives in the frame of the
+    // coroutine that waits, which is resumed right from wait().
+    struct _Waiter : public Async::Cancelation::Listener {
+        EpollSched &_sched;
+        Async::Cancelation::Token _ct;
+        int _fd;
+        u32 _event;
+        TimeStamp _until;
+        Res<> _res = Ok();
+        std::coroutine_handle<> _coro = nullptr;
+        LlItem<_Waiter> link;
+
+        // Waits on `event` for `fd`, or until `until` if `fd` is -1.
+        _Waiter(EpollSched &sched, Async::Cancelation::Token ct, int fd, u32 event, TimeStamp until)
+            : _sched(sched), _ct(ct), _fd(fd), _event(event), _until(until) {}
+
+        bool await_ready() {
+            if (not _ct.canceled())
+                return false;
+            _res = Error::interrupted("operation canceled");
+            return true;
+        }
+
+        void await_suspend(std::coroutine_handle<> coro) {
+            _coro = coro;
+            _sched._park(*this);
+            if (_ct._c)
+                _ct._c->attach(*this);
+        }
+
+        Res<> await_resume() {
+            return _res;
+        }
+
+        void cancel() override {
+            _sched._unpark(*this);
+            _res = Error::interrupted("operation canceled");
+            _coro.resume();
+        }
+    };
+
+    using _Waiters = Ll<_Waiter, &_Waiter::link>;
+
+    struct _Watch {
+        u32 events = 0;
+        _Waiters readers;
+        _Waiters writers;
+    };
+
+    int _epoll;
+    int _wakeFd;
+    Vec<_Watch> _watches;
+    _Waiters _timers;
+    Vec<_Waiter *> _ready;
+
+    EpollSched(int epoll, int wakeFd)
+        : _epoll(epoll), _wakeFd(wakeFd) {}
+
+    ~EpollSched() {
+        ::close(_wakeFd);
+        ::close(_epoll);
+    }
+
+    Res<> wake() override {
+        if (::eventfd_write(_wakeFd, 1) < 0)
+            return Posix::fromLastErrno();
+        return Ok();
+    }
+
+    // NOTE: Watches are indexed by fd, the kernel hands out the lowest
+    //       free number so this stays about as long as the fd table.
+    _Watch &_watchOf(int raw) {
+        while (_watches.len() <= (usize)raw)
+            _watches.pushBack(_Watch{});
+        return _watches[raw];
+    }
+
+    _Waiters &_waitersOf(_Waiter &w) {
+        if (w._fd < 0)
+            return _timers;
+        auto &watch = _watchOf(w._fd);
+        return w._event == EPOLLIN ? watch.readers : watch.writers;
+    }
+
+    void _update(int raw, _Watch &w) {
+        if (w.events == 0) {
+            ::epoll_ctl(_epoll, EPOLL_CTL_DEL, raw, nullptr);
+        } else {
+            epoll_event ev{};
+            ev.events = w.events;
+            ev.data.fd = raw;
+            ::epoll_ctl(_epoll, EPOLL_CTL_MOD, raw, &ev);
+        }
+    }
+
+    // Returns false if the fd can't be polled because it's always ready.
+    Res<bool> _arm(int raw, u32 event) {
+        auto &w = _watchOf(raw);
+
+        epoll_event ev{};
+        ev.events = w.events | event;
+        ev.data.fd = raw;
+        int res = ::epoll_ctl(_epoll, w.events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, raw, &ev);
+
+        // NOTE: The fd might have been closed and its number reused while
+        //       nobody was waiting on it anymore.
+        if (res < 0 and errno == ENOENT)
+            res = ::epoll_ctl(_epoll, EPOLL_CTL_ADD, raw, &ev);
+
+        if (res < 0) {
+            if (errno == EPERM)
+                return Ok(false);
+            return Posix::fromLastErrno();
+        }
+
+        w.events = ev.events;
+        return Ok(true);
+    }
+
+    void _park(_Waiter &w) {
+        auto &waiters = _waitersOf(w);
+        waiters.append(&w, waiters.tail());
+    }
+
+    // Stops watching for a canceled waiter, so an idle connection doesn't
+    // keep its watch around.
+    void _unpark(_Waiter &w) {
+        auto &waiters = _waitersOf(w);
+        waiters.detach(&w);
+        if (w._fd < 0 or waiters.len())
+            return;
+
+        auto &watch = _watchOf(w._fd);
+        watch.events &= ~w._event;
+        _update(w._fd, watch);
+    }
+
+    // NOTE: Resuming a waiter might watch or sleep again, so they are all
+    //       collected before any of them is resumed, and can't be canceled
+    //       anymore from that point on.
+    void _collect(_Waiters &waiters) {
+        while (waiters.head()) {
+            auto *w = waiters.detach(waiters.head());
+            if (w->_ct._c)
+                w->_ct._c->detach(*w);
+            _ready.pushBack(w);
+        }
+    }
+
+    Async::Task<> _readyAsync(Strong<Sys::Fd> fd, u32 event, Async::Cancelation::Token ct) {
+        co_try$(ct.check());
+        int raw = fd->handle().value();
+        if (not co_try$(_arm(raw, event)))
+            co_return Ok();
+        co_return co_await _Waiter{*this, ct, raw, event, TimeStamp::endOfTime()};
+    }
+
+    Async::Task<usize> readAsync(Strong<Sys::Fd> fd, MutBytes buf, Async::Cancelation::Token ct) override {
+        int raw = fd->handle().value();
+        while (true) {
+            isize n = ::recv(raw, buf.buf(), buf.len(), MSG_DONTWAIT);
+            if (n >= 0)
+                co_return Ok((usize)n);
+
+            if (errno == ENOTSOCK) {
+                co_trya$(_readyAsync(fd, EPOLLIN, ct));
+                co_return fd->read(buf);
+            }
+
+            if (errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR)
+                co_return Posix::fromLastErrno();
+
+            if (errno != EINTR)
+                co_trya$(_readyAsync(fd, EPOLLIN, ct));
+        }
+    }
+
+    Async::Task<usize> writeAsync(Strong<Sys::Fd> fd, Bytes buf, Async::Cancelation::Token ct) override {
+        int raw = fd->handle().value();
+        while (true) {
+            isize n = ::send(raw, buf.buf(), buf.len(), MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n >= 0)
+                co_return Ok((usize)n);
+
+            if (errno == ENOTSOCK) {
+                co_trya$(_readyAsync(fd, EPOLLOUT, ct));
+                co_return fd->write(buf);
+            }
+
+            if (errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR)
+                co_return Posix::fromLastErrno();
+
+            if (errno != EINTR)
+                co_trya$(_readyAsync(fd, EPOLLOUT, ct));
+        }
+    }
+
+    Async::Task<usize> flushAsync(Strong<Sys::Fd> fd) override {
+        co_return fd->flush();
+    }
+
+    Async::Task<Sys::_Accepted> acceptAsync(Strong<Sys::Fd> fd, Async::Cancelation::Token ct) override {
+        co_trya$(_readyAsync(fd, EPOLLIN, ct));
+        co_return fd->accept();
+    }
+
+    Async::Task<Sys::_Sent> sendAsync(Strong<Sys::Fd> fd, Bytes buf, Slice<Sys::Handle> handles, Sys::SocketAddr addr, Async::Cancelation::Token ct) override {
+        co_trya$(_readyAsync(fd, EPOLLOUT, ct));
+        co_return fd->send(buf, handles, addr);
+    }
+
+    Async::Task<Sys::_Received> recvAsync(Strong<Sys::Fd> fd, MutBytes buf, MutSlice<Sys::Handle> hnds, Async::Cancelation::Token ct) override {
+        co_trya$(_readyAsync(fd, EPOLLIN, ct));
+        co_return fd->recv(buf, hnds);
+    }
+
+    Async::Task<> sleepAsync(TimeStamp until, Async::Cancelation::Token ct) override {
+        co_return co_await _Waiter{*this, ct, -1, 0, until};
+    }
+
+    Res<> wait(TimeStamp until) override {
+        for (auto *w = _timers.head(); w; w = w->link.next)
+            if (w->_until < until)
+                until = w->_until;
+
+        int timeout = -1;
+        if (not until.isEndOfTime()) {
+            auto now = Sys::now();
+            timeout = now < until ? (int)(((until - now).toUSecs() + 999) / 1000) : 0;
+        }
+
+        Array<epoll_event, NEVENTS> events;
+        int n = ::epoll_wait(_epoll, events.buf(), NEVENTS, timeout);
+        if (n < 0 and errno != EINTR)
+            return Posix::fromLastErrno();
+
+        for (int i = 0; i < n; i++) {
+            int raw = events[i].data.fd;
+            if (raw == _wakeFd) {
+                eventfd_t val;
+                ::eventfd_read(_wakeFd, &val);
+                continue;
+            }
+
+            if ((usize)raw >= _watches.len())
+                continue;
+
+            auto &w = _watches[raw];
+            u32 got = events[i].events;
+            bool failed = got & (EPOLLERR | EPOLLHUP);
+            if (got & EPOLLIN or failed) {
+                _collect(w.readers);
+                w.events &= ~EPOLLIN;
+            }
+
+            if (got & EPOLLOUT or failed) {
+                _collect(w.writers);
+                w.events &= ~EPOLLOUT;
+            }
+
+            _update(raw, w);
+        }
+
+        auto now = Sys::now();
+        for (auto *w = _timers.head(); w;) {
+            auto *next = w->link.next;
+            if (w->_until <= now) {
+                _timers.detach(w);
+                if (w->_ct._c)
+                    w->_ct._c->detach(*w);
+                _ready.pushBack(w);
+            }
+            w = next;
+        }
+
+        // NOTE: The list is kept around between calls so that it doesn't
+        //       have to grow again each time.
+        auto ready = std::move(_ready);
+        for (auto *w : ready)
+            w->_coro.resume();
+        ready.clear();
+        _ready = std::move(ready);
+
+        return Ok();
+    }
+};
+
+Sys::Sched &epollSched() {
+    static thread_local EpollSched sched = [] {
+        int epoll = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll < 0) [[unlikely]]
+            panic("failed to initialize epoll");
+
+        int wakeFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wakeFd;
+        if (wakeFd < 0 or ::epoll_ctl(epoll, EPOLL_CTL_ADD, wakeFd, &ev) < 0) [[unlikely]]
+            panic("failed to create eventfd");
+
+        return EpollSched(epoll, wakeFd);
+    }();
+    return sched;
+}
+
+} // namespace Posix
+
+#endif
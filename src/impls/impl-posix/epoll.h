@@ -0,0 +1,12 @@
+#pragma once
+
+#include <karm-sys/async.h>
+
+namespace Posix {
+
+// A readiness based scheduler, for kernels where io_uring is missing or
+// has been disabled. Sockets are read and written without blocking and
+// only waited on when they aren't ready, regular files are always ready.
+Sys::Sched &epollSched();
+
+} // namespace Posix
@@ -1,3 +1,4 @@
+#include <sys/socket.h>
 #include <unistd.h>
 
 #include "fd.h"
@@ -90,30 +91,97 @@ Res<Sys::Stat> Fd::stat() {
 }
 
 Res<Sys::_Sent> Fd::send(Bytes bytes, Slice<Sys::Handle> hnds, Sys::SocketAddr addr) {
-    if (hnds.len() > 0)
-        // TODO: Implement handle passing on POSIX
-        notImplemented();
+    if (hnds.len() > MAX_HNDS)
+        return Error::invalidInput("too many handles");
 
+    struct iovec iov = {
+        .iov_base = const_cast<Byte *>(bytes.buf()),
+        .iov_len = sizeOf(bytes),
+    };
+
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    // NOTE: Connected sockets refuse a destination address, so only
+    //       pass one along when there is somewhere to send to.
     struct sockaddr_in addr_ = Posix::toSockAddr(addr);
-    isize result = ::sendto(_raw, bytes.buf(), sizeOf(bytes), 0, (struct sockaddr *)&addr_, sizeof(addr_));
+    if (addr.port != 0) {
+        msg.msg_name = &addr_;
+        msg.msg_namelen = sizeof(addr_);
+    }
+
+    // NOTE: Handles are passed as SCM_RIGHTS ancillary data, the kernel
+    //       duplicates them into the receiving process.
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_HNDS)];
+    if (hnds.len() > 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * hnds.len());
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * hnds.len());
+
+        int *fds = reinterpret_cast<int *>(CMSG_DATA(cmsg));
+        for (usize i = 0; i < hnds.len(); i++)
+            fds[i] = static_cast<int>(hnds[i].value());
+    }
+
+    isize result = ::sendmsg(_raw, &msg, 0);
 
     if (result < 0)
         return Posix::fromLastErrno();
 
-    return Ok<Sys::_Sent>(static_cast<usize>(result), 0);
+    return Ok<Sys::_Sent>(static_cast<usize>(result), hnds.len());
 }
 
-Res<Sys::_Received> Fd::recv(MutBytes bytes, MutSlice<Sys::Handle>) {
-    struct sockaddr_in addr_;
-    socklen_t len = sizeof(addr_);
-    isize result = ::recvfrom(_raw, bytes.buf(), sizeOf(bytes), 0, (struct sockaddr *)&addr_, &len);
+Res<Sys::_Received> Fd::recv(MutBytes bytes, MutSlice<Sys::Handle> hnds) {
+    struct iovec iov = {
+        .iov_base = bytes.buf(),
+        .iov_len = sizeOf(bytes),
+    };
+
+    struct sockaddr_in addr_ = {};
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_HNDS)];
+
+    struct msghdr msg = {};
+    msg.msg_name = &addr_;
+    msg.msg_namelen = sizeof(addr_);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    int flags = 0;
+#ifdef __ck_sys_linux__
+    flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+    isize result = ::recvmsg(_raw, &msg, flags);
 
     if (result < 0)
         return Posix::fromLastErrno();
 
+    usize nhnds = 0;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+
+        int *fds = reinterpret_cast<int *>(CMSG_DATA(cmsg));
+        usize count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (usize i = 0; i < count; i++) {
+            // NOTE: Don't leak handles the caller has no room for.
+            if (nhnds < hnds.len())
+                hnds[nhnds++] = Sys::Handle{static_cast<usize>(fds[i])};
+            else
+                ::close(fds[i]);
+        }
+    }
+
     return Ok<Sys::_Received>(
         static_cast<usize>(result),
-        0,
+        nhnds,
         Posix::fromSockAddr(addr_)
     );
 }
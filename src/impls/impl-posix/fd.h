@@ -5,6 +5,8 @@
 namespace Posix {
 
 struct Fd : public Sys::Fd {
+    static constexpr usize MAX_HNDS = 16;
+
     isize _raw;
     bool _leak = false; //< Do not close on destruction
 
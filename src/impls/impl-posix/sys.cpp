@@ -3,6 +3,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
@@ -13,7 +14,18 @@
 #include <time.h>
 #include <unistd.h>
 
+#ifdef __ck_sys_linux__
+#    include <linux/futex.h>
+#    include <linux/if.h>
+#    include <linux/if_tun.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#endif
+
 //
+#include <karm-base/defer.h>
+#include <karm-base/limits.h>
+#include <karm-base/lru.h>
 #include <karm-io/funcs.h>
 #include <karm-logger/logger.h>
 
@@ -24,54 +36,81 @@
 
 namespace Karm::Sys::_Embed {
 
-Res<Mime::Path> resolve(Mime::Url const &url) {
-    Mime::Path resolved;
-    if (url.scheme == "file") {
-        resolved = url.path;
-    } else if (url.scheme == "ipc") {
-        auto const *runtimeDir = getenv("XDG_RUNTIME_DIR");
-        if (not runtimeDir) {
-            runtimeDir = "/tmp/";
-            logWarn("XDG_RUNTIME_DIR not set, falling back on {}", runtimeDir);
-        }
+static Opt<Mime::Path> _envPath(char const *name) {
+    auto const *value = getenv(name);
+    if (not value)
+        return NONE;
+    return Mime::Path::parse(value);
+}
 
+// NOTE: The environment is only looked at once, and resolved urls are kept
+//       around since the same resources tend to be asked for over and over.
+struct _Resolver {
+    static constexpr usize CACHE_SIZE = 256;
+
+    Lock _lock;
+    Opt<Mime::Path> _runtimeDir = _envPath("XDG_RUNTIME_DIR");
+    Opt<Mime::Path> _bundles = _envPath("CK_BUILDDIR") ?: _envPath("SKIFT_BUNDLES");
+    Opt<Mime::Path> _home = _envPath("HOME");
+    Lru<String, Mime::Path> _cache{CACHE_SIZE};
+
+    Res<Mime::Path> _resolve(Mime::Url const &url) {
         auto path = url.path;
         path.rooted = false;
 
-        resolved = Mime::Path::parse(runtimeDir).join(path);
-    } else if (url.scheme == "bundle") {
-        auto *maybeRepo = getenv("CK_BUILDDIR");
+        if (url.scheme == "ipc") {
+            if (not _runtimeDir) {
+                logWarn("XDG_RUNTIME_DIR not set, falling back on /tmp/");
+                _runtimeDir = Mime::Path::parse("/tmp/");
+            }
+            return Ok(_runtimeDir->join(path));
+        }
 
-        if (not maybeRepo)
-            maybeRepo = getenv("SKIFT_BUNDLES");
+        if (url.scheme == "bundle") {
+            if (not _bundles)
+                return Error::notFound("SKIFT_BUNDLES not set");
+            return Ok(_bundles->join(url.host).join("__res__").join(path));
+        }
 
-        if (not maybeRepo)
-            return Error::notFound("SKIFT_BUNDLES not set");
+        if (url.scheme == "location") {
+            if (not _home)
+                return Error::notFound("HOME not set");
+            if (url.host == "home")
+                return Ok(_home->join(path));
+            return Ok(_home->join(Io::toPascalCase(url.host).unwrap()).join(path));
+        }
 
-        auto path = url.path;
-        path.rooted = false;
+        return Error::notFound("unknown url scheme");
+    }
 
-        resolved = Mime::Path::parse(maybeRepo)
-                       .join(url.host)
-                       .join("__res__")
-                       .join(path);
-    } else if (url.scheme == "location") {
-        auto *maybeHome = getenv("HOME");
-        if (not maybeHome)
-            return Error::notFound("HOME not set");
+    Res<Mime::Path> resolve(Mime::Url const &url) {
+        LockScope scope(_lock);
 
-        auto path = url.path;
-        path.rooted = false;
+        auto key = url.str();
+        if (auto cached = _cache.get(key))
+            return Ok(cached.take());
 
-        if (url.host == "home")
-            resolved = Mime::Path::parse(maybeHome).join(path);
-        else
-            resolved = Mime::Path::parse(maybeHome).join(Io::toPascalCase(url.host).unwrap()).join(path);
-    } else {
-        return Error::notFound("unknown url scheme");
+        auto resolved = try$(_resolve(url));
+        _cache.access(key, [&] {
+            return resolved;
+        });
+        return Ok(resolved);
+    }
+
+    Opt<Mime::Path> const &bundles() const {
+        return _bundles;
     }
+};
+
+static _Resolver &_resolver() {
+    static _Resolver resolver;
+    return resolver;
+}
 
-    return Ok(resolved);
+Res<Mime::Path> resolve(Mime::Url const &url) {
+    if (url.scheme == "file")
+        return Ok(url.path);
+    return _resolver().resolve(url);
 }
 
 // MARK: Fd --------------------------------------------------------------------
@@ -187,6 +226,31 @@ Res<Stat> stat(Mime::Url const &url) {
     return Ok(Posix::fromStat(buf));
 }
 
+Res<Bytes> bundleArchive() {
+    auto const &bundles = _resolver().bundles();
+    if (not bundles)
+        return Error::notFound("SKIFT_BUNDLES not set");
+
+    String str = bundles->join("_bundles.pack").str();
+    int raw = ::open(str.buf(), O_RDONLY | O_CLOEXEC);
+    if (raw < 0)
+        return Posix::fromLastErrno();
+    defer$(::close(raw));
+
+    struct stat buf;
+    if (::fstat(raw, &buf) < 0)
+        return Posix::fromLastErrno();
+    if (buf.st_size == 0)
+        return Error::invalidData("empty bundle archive");
+
+    // NOTE: Never unmapped, resources handed out from the archive point
+    //       right into it.
+    void *addr = ::mmap(nullptr, buf.st_size, PROT_READ, MAP_PRIVATE, raw, 0);
+    if (addr == MAP_FAILED)
+        return Posix::fromLastErrno();
+    return Ok(Bytes{static_cast<Byte const *>(addr), (usize)buf.st_size});
+}
+
 // MARK: User interactions -----------------------------------------------------
 
 Res<> launch([[maybe_unused]] Mime::Uti const &uti, [[maybe_unused]] Mime::Url const &url) {
@@ -243,7 +307,7 @@ Res<Strong<Fd>> connectTcp(SocketAddr addr) {
     return Ok(makeStrong<Posix::Fd>(fd));
 }
 
-Res<Strong<Fd>> listenTcp(SocketAddr addr) {
+Res<Strong<Fd>> listenTcp(SocketAddr addr, bool shared) {
     int fd = ::socket(AF_INET, SOCK_STREAM, 0);
     if (fd < 0)
         return Posix::fromLastErrno();
@@ -252,6 +316,9 @@ Res<Strong<Fd>> listenTcp(SocketAddr addr) {
     if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
         return Posix::fromLastErrno();
 
+    if (shared and ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+        return Posix::fromLastErrno();
+
     struct sockaddr_in addr_ = Posix::toSockAddr(addr);
 
     if (::bind(fd, (struct sockaddr *)&addr_, sizeof(addr_)) < 0)
@@ -283,6 +350,58 @@ Res<Strong<Fd>> listenIpc(Mime::Url url) {
     return Ok(makeStrong<Posix::Fd>(fd));
 }
 
+Res<Strong<Fd>> connectIpc(Mime::Url url) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return Posix::fromLastErrno();
+    auto res = makeStrong<Posix::Fd>(fd);
+
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    String path = try$(resolve(url)).str();
+    auto sunPath = MutSlice(addr.sun_path, sizeof(addr.sun_path) - 1);
+    copy(sub(path), sunPath);
+
+    if (::connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+        return Posix::fromLastErrno();
+
+    return Ok(res);
+}
+
+Res<Pair<Strong<Fd>>> createIpcPair() {
+    int fds[2];
+
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+        return Posix::fromLastErrno();
+
+    return Ok(Pair<Strong<Fd>>{
+        makeStrong<Posix::Fd>(fds[0]),
+        makeStrong<Posix::Fd>(fds[1]),
+    });
+}
+
+Res<Strong<Fd>> openTap(Str name) {
+#ifdef __ck_sys_linux__
+    int fd = ::open("/dev/net/tun", O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+        return Posix::fromLastErrno();
+    auto res = makeStrong<Posix::Fd>(fd);
+
+    struct ifreq ifr = {};
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    auto ifrName = MutSlice(ifr.ifr_name, sizeof(ifr.ifr_name) - 1);
+    copy(sub(name), ifrName);
+
+    if (::ioctl(fd, TUNSETIFF, &ifr) < 0)
+        return Posix::fromLastErrno();
+
+    return Ok(res);
+#else
+    (void)name;
+    return Error::notImplemented("tap devices are only supported on linux");
+#endif
+}
+
 // MARK: Time ------------------------------------------------------------------
 
 TimeSpan fromTimeSpec(struct timespec const &ts) {
@@ -362,6 +481,84 @@ Res<> memFlush(void *flush, usize len) {
     return Ok();
 }
 
+Res<Strong<Fd>> createShm(usize size) {
+#ifdef __ck_sys_linux__
+    int raw = ::memfd_create("karm-shm", MFD_CLOEXEC);
+    if (raw < 0)
+        return Posix::fromLastErrno();
+#else
+    // NOTE: There is no memfd outside of linux, so create a named object
+    //       and unlink it right away, leaving only the descriptor behind.
+    auto name = try$(Io::format("/karm-shm-{}-{}", getpid(), now().val()));
+    int raw = ::shm_open(name.buf(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (raw < 0)
+        return Posix::fromLastErrno();
+    ::shm_unlink(name.buf());
+#endif
+
+    auto fd = makeStrong<Posix::Fd>(raw);
+    if (::ftruncate(raw, size) < 0)
+        return Posix::fromLastErrno();
+
+    return Ok(fd);
+}
+
+// MARK: Synchronization -------------------------------------------------------
+
+#ifdef __ck_sys_linux__
+
+Res<> futexWait(u32 *addr, u32 expected, TimeStamp until) {
+    struct timespec ts;
+    struct timespec *timeout = nullptr;
+    if (not until.isEndOfTime()) {
+        ts = Posix::toTimespec(until);
+        timeout = &ts;
+    }
+
+    // NOTE: FUTEX_WAIT_BITSET takes an absolute deadline instead of a
+    //       relative one, and lets us pick the same clock as now().
+    long res = ::syscall(
+        SYS_futex, addr,
+        FUTEX_WAIT_BITSET | FUTEX_CLOCK_REALTIME,
+        expected, timeout, nullptr, FUTEX_BITSET_MATCH_ANY
+    );
+
+    if (res < 0 and errno == ETIMEDOUT)
+        return Error::timedOut("futex wait timed out");
+
+    // NOTE: EAGAIN means the word already changed, and EINTR is just a
+    //       spurious wakeup, the caller has to check the word again anyway.
+    if (res < 0 and errno != EAGAIN and errno != EINTR)
+        return Posix::fromLastErrno();
+
+    return Ok();
+}
+
+Res<> futexWake(u32 *addr, usize count) {
+    long res = ::syscall(
+        SYS_futex, addr,
+        FUTEX_WAKE,
+        (int)min(count, (usize)Limits<int>::MAX), nullptr, nullptr, 0
+    );
+
+    if (res < 0)
+        return Posix::fromLastErrno();
+
+    return Ok();
+}
+
+#else
+
+Res<> futexWait(u32 *, u32, TimeStamp) {
+    return Error::notImplemented("futexes are not supported");
+}
+
+Res<> futexWake(u32 *, usize) {
+    return Error::notImplemented("futexes are not supported");
+}
+
+#endif
+
 Res<> populate(SysInfo &infos) {
     struct utsname uts;
     if (uname(&uts) < 0)
@@ -382,8 +579,18 @@ Res<> populate(MemInfo &) {
     return Error::notImplemented();
 }
 
-Res<> populate(Vec<CpuInfo> &) {
-    return Error::notImplemented();
+Res<> populate(Vec<CpuInfo> &infos) {
+    auto count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count < 0)
+        return Posix::fromLastErrno();
+
+    for (isize i = 0; i < count; i++) {
+        infos.pushBack({
+            .name = try$(Io::format("cpu{}", i)),
+        });
+    }
+
+    return Ok();
 }
 
 Res<> populate(UserInfo &infos) {
@@ -420,4 +627,51 @@ Res<> exit(i32 res) {
     return Ok();
 }
 
+struct PosixThread : public Sys::Thread {
+    pthread_t _thread{};
+    Func<void()> _fn;
+    bool _joined = false;
+
+    PosixThread(Func<void()> fn)
+        : _fn(std::move(fn)) {}
+
+    ~PosixThread() {
+        if (not _joined)
+            pthread_detach(_thread);
+    }
+
+    Res<> join() override {
+        if (_joined)
+            return Ok();
+
+        if (auto err = pthread_join(_thread, nullptr); err != 0)
+            return Posix::fromErrno(err);
+
+        _joined = true;
+        return Ok();
+    }
+};
+
+static void *_threadEntry(void *arg) {
+    // NOTE: The thread holds a reference on itself so the entry point stays
+    //       alive even if the handle is dropped before it's done.
+    auto *self = static_cast<Strong<PosixThread> *>(arg);
+    (*self)->_fn();
+    delete self;
+    return nullptr;
+}
+
+Res<Strong<Sys::Thread>> spawnThread(Func<void()> fn) {
+    auto thread = makeStrong<PosixThread>(std::move(fn));
+    auto *self = new Strong<PosixThread>(thread);
+
+    if (auto err = pthread_create(&thread->_thread, nullptr, _threadEntry, self); err != 0) {
+        delete self;
+        thread->_joined = true;
+        return Posix::fromErrno(err);
+    }
+
+    return Ok(thread);
+}
+
 } // namespace Karm::Sys::_Embed
@@ -13,18 +13,51 @@ enum struct _FdType : u8 {
 
 struct VmoFd : public Sys::NullFd {
     Hj::Vmo _vmo;
+    usize _size = 0; //< Of the data, zero when it fills the whole vmo
+    Opt<Hj::Mapped> _mapped = NONE;
+    usize _pos = 0;
 
     Hj::Vmo &vmo() {
         return _vmo;
     }
 
-    VmoFd(Hj::Vmo vmo)
-        : _vmo(std::move(vmo)) {}
+    VmoFd(Hj::Vmo vmo, usize size = 0)
+        : _vmo(std::move(vmo)), _size(size) {}
 
     Sys::Handle handle() const override {
         return Sys::Handle(_vmo.raw());
     }
 
+    // NOTE: The vmo is only mapped once it's read from, and then stays
+    //       mapped for as long as the fd is around.
+    Res<Bytes> _bytes() {
+        if (not _mapped)
+            _mapped.emplace(try$(Hj::map(_vmo, Hj::MapFlags::READ)));
+        auto bytes = _mapped->bytes();
+        return Ok(_size ? sub(bytes, 0, _size) : bytes);
+    }
+
+    Res<usize> read(MutBytes buf) override {
+        auto bytes = try$(_bytes());
+        auto n = copy(next(bytes, min(_pos, bytes.len())), buf);
+        _pos += n;
+        return Ok(n);
+    }
+
+    Res<usize> seek(Io::Seek seek) override {
+        auto bytes = try$(_bytes());
+        _pos = min(seek.apply(_pos, bytes.len()), bytes.len());
+        return Ok(_pos);
+    }
+
+    Res<Sys::Stat> stat() override {
+        auto bytes = try$(_bytes());
+        return Ok(Sys::Stat{
+            .type = Sys::Stat::FILE,
+            .size = bytes.len(),
+        });
+    }
+
     Res<> pack(Io::PackEmit &e) override {
         try$(Io::pack(e, _FdType::VMO));
         try$(Io::pack(e, _vmo));
@@ -9,7 +9,7 @@ static constinit Lock _heapLock;
 static constinit Heap _heapImpl = {
     .ctx = nullptr,
     .alloc = [](void *, usize size) -> void * {
-        auto vmo = Hj::Vmo::create(Hj::ROOT, 0, size).take();
+        auto vmo = Hj::Vmo::create(Hj::ROOT, 0, size, Hj::VmoFlags::LAZY).take();
         vmo.label("heap").unwrap();
 
         auto space = Hj::Space::self();
@@ -1,4 +1,5 @@
 #include <handover/hook.h>
+#include <karm-base/align.h>
 #include <hjert-api/api.h>
 #include <karm-logger/logger.h>
 
@@ -22,7 +23,7 @@ Res<Strong<Sys::Fd>> openFile(Mime::Url const &url) {
     auto vmo = try$(Hj::Vmo::create(Hj::ROOT, fileRecord->start, fileRecord->size, Hj::VmoFlags::DMA));
     try$(vmo.label(urlStr));
 
-    return Ok(makeStrong<Skift::VmoFd>(std::move(vmo)));
+    return Ok(makeStrong<Skift::VmoFd>(std::move(vmo), fileRecord->size));
 }
 
 Res<Strong<Sys::Fd>> createFile(Mime::Url const &) {
@@ -53,8 +54,21 @@ Res<Vec<Sys::DirEntry>> readDir(Mime::Url const &) {
     notImplemented();
 }
 
-Res<Stat> stat(Mime::Url const &) {
-    notImplemented();
+// NOTE: The only files are the ones the loader handed over.
+Res<Stat> stat(Mime::Url const &url) {
+    auto urlStr = url.str();
+    auto *fileRecord = useHandover().fileByName(urlStr.buf());
+    if (not fileRecord)
+        return Error::notFound("no such file");
+
+    return Ok(Stat{
+        .type = Stat::FILE,
+        .size = fileRecord->size,
+    });
+}
+
+Res<Bytes> bundleArchive() {
+    return Error::notFound("no bundle archive");
 }
 
 // MARK: User interactions -----------------------------------------------------
@@ -73,7 +87,7 @@ Res<Strong<Sys::Fd>> connectTcp(SocketAddr) {
     notImplemented();
 }
 
-Res<Strong<Sys::Fd>> listenTcp(SocketAddr) {
+Res<Strong<Sys::Fd>> listenTcp(SocketAddr, bool) {
     notImplemented();
 }
 
@@ -85,6 +99,18 @@ Res<Strong<Sys::Fd>> listenIpc(Mime::Url) {
     notImplemented();
 }
 
+Res<Strong<Sys::Fd>> connectIpc(Mime::Url) {
+    return Error::notImplemented("ipc sockets are not supported");
+}
+
+Res<Cons<Strong<Sys::Fd>, Strong<Sys::Fd>>> createIpcPair() {
+    return Error::notImplemented("ipc sockets are not supported");
+}
+
+Res<Strong<Sys::Fd>> openTap(Str) {
+    return Error::notImplemented("tap devices are not supported");
+}
+
 // MARK: Time ------------------------------------------------------------------
 
 TimeStamp now() {
@@ -124,6 +150,24 @@ Res<> memFlush(void *, usize) {
     notImplemented();
 }
 
+// NOTE: Pages are only committed once they are touched, like anonymous
+//       shared memory on posix.
+Res<Strong<Sys::Fd>> createShm(usize size) {
+    auto vmo = try$(Hj::Vmo::create(Hj::ROOT, 0, alignUp(size, Hal::PAGE_SIZE), Hj::VmoFlags::LAZY));
+    try$(vmo.label("shm"));
+    return Ok(makeStrong<Skift::VmoFd>(std::move(vmo)));
+}
+
+// MARK: Synchronization -------------------------------------------------------
+
+Res<> futexWait(u32 *, u32, TimeStamp) {
+    return Error::notImplemented("futexes are not supported");
+}
+
+Res<> futexWake(u32 *, usize) {
+    return Error::notImplemented("futexes are not supported");
+}
+
 // MARK: System Informations ---------------------------------------------------
 
 Res<> populate(Sys::SysInfo &) {
@@ -156,4 +200,8 @@ Res<> exit(i32) {
     notImplemented();
 }
 
+Res<Strong<Sys::Thread>> spawnThread(Func<void()>) {
+    return Error::notImplemented("threads are not supported");
+}
+
 } // namespace Karm::Sys::_Embed
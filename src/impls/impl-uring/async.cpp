@@ -1,9 +1,14 @@
 
 #include <liburing.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 //
+#include <impl-posix/epoll.h>
 #include <impl-posix/fd.h>
 #include <impl-posix/utils.h>
+#include <karm-base/limits.h>
 #include <karm-logger/logger.h>
 #include <karm-sys/async.h>
 #include <karm-sys/time.h>
@@ -41,276 +46,252 @@ struct __kernel_timespec toKernelTimespec(TimeSpan ts) {
 struct UringSched : public Sys::Sched {
     static constexpr auto NCQES = 128;
 
-    struct _Job {
-        virtual ~_Job() = default;
-        virtual void submit(io_uring_sqe *sqe) = 0;
-        virtual void complete(io_uring_cqe *cqe) = 0;
+    static constexpr usize WAKE_ID = Limits<usize>::MAX;
+    static constexpr usize CANCEL_ID = Limits<usize>::MAX - 1;
+
+    // An operation in flight, it lives in the frame of the coroutine that
+    // waits on it, which is resumed right from wait() once it's complete.
+    struct _Op : public Async::Cancelation::Listener {
+        UringSched &_sched;
+        Async::Cancelation::Token _ct;
+        i32 _res = 0;
+        std::coroutine_handle<> _coro = nullptr;
+
+        _Op(UringSched &sched, Async::Cancelation::Token ct)
+            : _sched(sched), _ct(ct) {}
+
+        // NOTE: The operation still completes, with -ECANCELED unless it was
+        //       already done, so its buffers are not in use anymore once
+        //       the coroutine is resumed.
+        void cancel() override {
+            auto *sqe = _sched._sqe();
+            io_uring_prep_cancel64(sqe, (u64)this, 0);
+            sqe->user_data = CANCEL_ID;
+            io_uring_submit(&_sched._ring);
+        }
+    };
+
+    template <typename F>
+    struct _Submit : public _Op {
+        F _prep;
+
+        _Submit(UringSched &sched, Async::Cancelation::Token ct, F prep)
+            : _Op(sched, ct), _prep(std::move(prep)) {}
+
+        bool await_ready() {
+            if (not _ct.canceled())
+                return false;
+            _res = -ECANCELED;
+            return true;
+        }
+
+        void await_suspend(std::coroutine_handle<> coro) {
+            _coro = coro;
+            auto *sqe = _sched._sqe();
+            _prep(sqe);
+            sqe->user_data = (u64)static_cast<_Op *>(this);
+            io_uring_submit(&_sched._ring);
+            if (_ct._c)
+                _ct._c->attach(*this);
+        }
+
+        i32 await_resume() {
+            if (_ct._c)
+                _ct._c->detach(*this);
+            return _res;
+        }
     };
 
     io_uring _ring;
-    usize _id = 0;
-    Map<usize, Strong<_Job>> _jobs;
+    int _wakeFd;
+    u64 _wakeBuf = 0;
 
-    UringSched(io_uring ring)
-        : _ring(ring) {}
+    UringSched(io_uring ring, int wakeFd)
+        : _ring(ring), _wakeFd(wakeFd) {
+        _armWake();
+    }
 
     ~UringSched() {
         io_uring_queue_exit(&_ring);
+        ::close(_wakeFd);
     }
 
-    void submit(Strong<_Job> job) {
-        auto id = _id++;
+    io_uring_sqe *_sqe() {
         auto *sqe = io_uring_get_sqe(&_ring);
         if (not sqe) [[unlikely]]
             panic("failed to get sqe");
-        sqe->user_data = id;
-        _jobs.put(id, job);
-        job->submit(sqe);
-        io_uring_submit(&_ring);
+        return sqe;
     }
 
-    Async::Task<usize> readAsync(Strong<Fd> fd, MutBytes buf) override {
-        struct Job : public _Job {
-            Strong<Fd> _fd;
-            MutBytes _buf;
-            Async::Promise<usize> _promise;
-
-            Job(Strong<Fd> fd, MutBytes buf)
-                : _fd(fd), _buf(buf) {}
-
-            void submit(io_uring_sqe *sqe) override {
-                io_uring_prep_read(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), 0);
-            }
-
-            void complete(io_uring_cqe *cqe) override {
-                auto res = cqe->res;
-                if (res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else
-                    _promise.resolve(Ok(cqe->res));
-            }
-
-            auto future() {
-                return _promise.future();
-            }
-        };
-
-        auto job = makeStrong<Job>(fd, buf);
-        submit(job);
-        return Async::makeTask(job->future());
+    // NOTE: There is always a read pending on the eventfd, so writing to it
+    //       from any thread completes it and gets the ring out of wait().
+    void _armWake() {
+        auto *sqe = _sqe();
+        io_uring_prep_read(sqe, _wakeFd, &_wakeBuf, sizeof(_wakeBuf), 0);
+        sqe->user_data = WAKE_ID;
+        io_uring_submit(&_ring);
     }
 
-    Async::Task<usize> writeAsync(Strong<Fd> fd, Bytes buf) override {
-        struct Job : public _Job {
-            Strong<Fd> _fd;
-            Bytes _buf;
-            Async::Promise<usize> _promise;
+    Res<> wake() override {
+        if (::eventfd_write(_wakeFd, 1) < 0)
+            return Posix::fromLastErrno();
+        return Ok();
+    }
 
-            Job(Strong<Fd> fd, Bytes buf)
-                : _fd(fd), _buf(buf) {}
+    // Prepares an operation with `prep` and submits it when awaited.
+    template <typename F>
+    _Submit<F> _submit(Async::Cancelation::Token ct, F prep) {
+        return {*this, ct, std::move(prep)};
+    }
 
-            void submit(io_uring_sqe *sqe) override {
-                io_uring_prep_write(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), 0);
-            }
+    // NOTE: Canceled operations fail the same way on every scheduler.
+    static Error _error(i32 res) {
+        if (res == -ECANCELED)
+            return Error::interrupted("operation canceled");
+        return Posix::fromErrno(-res);
+    }
 
-            void complete(io_uring_cqe *cqe) override {
-                auto res = cqe->res;
-                if (res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else
-                    _promise.resolve(Ok(cqe->res));
-            }
+    static Res<usize> _result(i32 res) {
+        if (res < 0)
+            return _error(res);
+        return Ok((usize)res);
+    }
 
-            auto future() {
-                return _promise.future();
-            }
-        };
+    Async::Task<usize> readAsync(Strong<Fd> fd, MutBytes buf, Async::Cancelation::Token ct) override {
+        auto res = co_await _submit(ct, [&](io_uring_sqe *sqe) {
+            // NOTE: -1 reads from the current position of the file.
+            io_uring_prep_read(sqe, fd->handle().value(), buf.buf(), buf.len(), -1);
+        });
+        co_return _result(res);
+    }
 
-        auto job = makeStrong<Job>(fd, buf);
-        submit(job);
-        return Async::makeTask(job->future());
+    Async::Task<usize> writeAsync(Strong<Fd> fd, Bytes buf, Async::Cancelation::Token ct) override {
+        auto res = co_await _submit(ct, [&](io_uring_sqe *sqe) {
+            io_uring_prep_write(sqe, fd->handle().value(), buf.buf(), buf.len(), -1);
+        });
+        co_return _result(res);
     }
 
     Async::Task<usize> flushAsync(Strong<Fd> fd) override {
-        struct Job : public _Job {
-            Strong<Fd> _fd;
-            Async::Promise<usize> _promise;
-
-            Job(Strong<Fd> fd)
-                : _fd(fd) {}
-
-            void submit(io_uring_sqe *sqe) override {
-                io_uring_prep_fsync(sqe, _fd->handle().value(), 0);
-            }
-
-            void complete(io_uring_cqe *cqe) override {
-                auto res = cqe->res;
-                if (res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else
-                    _promise.resolve(Ok(cqe->res));
-            }
-
-            auto future() {
-                return _promise.future();
-            }
-        };
-
-        auto job = makeStrong<Job>(fd);
-        submit(job);
-        return Async::makeTask(job->future());
+        auto res = co_await _submit({}, [&](io_uring_sqe *sqe) {
+            io_uring_prep_fsync(sqe, fd->handle().value(), 0);
+        });
+        co_return _result(res);
     }
 
-    Async::Task<_Accepted> acceptAsync(Strong<Fd> fd) override {
-        struct Job : public _Job {
-            Strong<Fd> _fd;
-            sockaddr_in _addr{};
-            unsigned _addrLen = sizeof(sockaddr_in);
-            Async::Promise<_Accepted> _promise;
+    Async::Task<_Accepted> acceptAsync(Strong<Fd> fd, Async::Cancelation::Token ct) override {
+        sockaddr_in addr{};
+        socklen_t addrLen = sizeof(sockaddr_in);
+        auto res = co_await _submit(ct, [&](io_uring_sqe *sqe) {
+            io_uring_prep_accept(sqe, fd->handle().value(), (struct sockaddr *)&addr, &addrLen, 0);
+        });
 
-            Job(Strong<Fd> fd)
-                : _fd(fd) {}
+        if (res < 0)
+            co_return _error(res);
 
-            void submit(io_uring_sqe *sqe) override {
-                io_uring_prep_accept(sqe, _fd->handle().value(), (struct sockaddr *)&_addr, &_addrLen, 0);
-            }
+        _Accepted accepted = {makeStrong<Posix::Fd>(res), Posix::fromSockAddr(addr)};
+        co_return Ok(accepted);
+    }
 
-            void complete(io_uring_cqe *cqe) override {
-                auto res = cqe->res;
-                if (res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else {
-                    _Accepted accepted = {makeStrong<Posix::Fd>(res), Posix::fromSockAddr(_addr)};
-                    _promise.resolve(Ok(accepted));
-                }
-            }
+    Async::Task<_Sent> sendAsync(Strong<Fd> fd, Bytes buf, Slice<Handle> handles, SocketAddr addr, Async::Cancelation::Token ct) override {
+        if (handles.len() > Posix::Fd::MAX_HNDS)
+            co_return Error::invalidInput("too many handles");
 
-            auto future() {
-                return _promise.future();
-            }
+        iovec iov = {
+            .iov_base = const_cast<Byte *>(buf.begin()),
+            .iov_len = buf.len(),
         };
 
-        auto job = makeStrong<Job>(fd);
-        submit(job);
-        return Async::makeTask(job->future());
-    }
+        msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
 
-    Async::Task<_Sent> sendAsync(Strong<Fd> fd, Bytes buf, Slice<Handle> handles, SocketAddr addr) override {
-        if (handles.len() > 0)
-            notImplemented(); // TODO: Implement handle passing on POSIX
+        // NOTE: Connected sockets refuse a destination address.
+        sockaddr_in sa = Posix::toSockAddr(addr);
+        if (addr.port != 0) {
+            msg.msg_name = &sa;
+            msg.msg_namelen = sizeof(sockaddr_in);
+        }
 
-        struct Job : public _Job {
-            Strong<Fd> _fd;
-            Bytes _buf;
-            iovec _iov;
-            msghdr _msg;
-            sockaddr_in _addr;
-            Async::Promise<_Sent> _promise;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * Posix::Fd::MAX_HNDS)];
+        if (handles.len()) {
+            msg.msg_control = control;
+            msg.msg_controllen = CMSG_SPACE(sizeof(int) * handles.len());
 
-            Job(Strong<Fd> fd, Bytes buf, SocketAddr addr)
-                : _fd(fd), _buf(buf), _addr(Posix::toSockAddr(addr)) {}
+            cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int) * handles.len());
 
-            void submit(io_uring_sqe *sqe) override {
-                _iov.iov_base = const_cast<Byte *>(_buf.begin());
-                _iov.iov_len = _buf.len();
+            int *fds = reinterpret_cast<int *>(CMSG_DATA(cmsg));
+            for (usize i = 0; i < handles.len(); i++)
+                fds[i] = static_cast<int>(handles[i].value());
+        }
 
-                _msg.msg_name = &_addr;
-                _msg.msg_namelen = sizeof(sockaddr_in);
-                _msg.msg_iov = &_iov;
-                _msg.msg_iovlen = 1;
+        auto res = co_await _submit(ct, [&](io_uring_sqe *sqe) {
+            io_uring_prep_sendmsg(sqe, fd->handle().value(), &msg, 0);
+        });
 
-                io_uring_prep_sendmsg(sqe, _fd->handle().value(), &_msg, 0);
-            }
+        if (res < 0)
+            co_return _error(res);
+        co_return Ok<_Sent>(res, handles.len());
+    }
 
-            void complete(io_uring_cqe *cqe) override {
-                if (cqe->res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
+    static usize _collect(msghdr &msg, MutSlice<Handle> hnds) {
+        usize nhnds = 0;
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+
+            int *fds = reinterpret_cast<int *>(CMSG_DATA(cmsg));
+            usize count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (usize i = 0; i < count; i++) {
+                if (nhnds < hnds.len())
+                    hnds[nhnds++] = Handle{static_cast<usize>(fds[i])};
                 else
-                    _promise.resolve(Ok<_Sent>(cqe->res, 0));
+                    ::close(fds[i]);
             }
-
-            auto future() {
-                return _promise.future();
-            }
-        };
-
-        auto job = makeStrong<Job>(fd, buf, addr);
-        submit(job);
-        return Async::makeTask(job->future());
+        }
+        return nhnds;
     }
 
-    Async::Task<_Received> recvAsync(Strong<Fd> fd, MutBytes buf, MutSlice<Handle>) override {
-        struct Job : public _Job {
-            Strong<Fd> _fd;
-            MutBytes _buf;
-            iovec _iov;
-            msghdr _msg;
-            sockaddr_in _addr;
-            Async::Promise<_Received> _promise;
-
-            Job(Strong<Fd> fd, MutBytes buf)
-                : _fd(fd), _buf(buf) {}
-
-            void submit(io_uring_sqe *sqe) override {
-                _iov.iov_base = _buf.begin();
-                _iov.iov_len = _buf.len();
-
-                _msg.msg_name = &_addr;
-                _msg.msg_namelen = sizeof(sockaddr_in);
-                _msg.msg_iov = &_iov;
-                _msg.msg_iovlen = 1;
-
-                io_uring_prep_recvmsg(sqe, _fd->handle().value(), &_msg, 0);
-            }
-
-            void complete(io_uring_cqe *cqe) override {
-                if (cqe->res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else {
-                    _Received received = {(usize)cqe->res, 0, Posix::fromSockAddr(_addr)};
-                    _promise.resolve(Ok(received));
-                }
-            }
-
-            auto future() {
-                return _promise.future();
-            }
+    Async::Task<_Received> recvAsync(Strong<Fd> fd, MutBytes buf, MutSlice<Handle> hnds, Async::Cancelation::Token ct) override {
+        iovec iov = {
+            .iov_base = buf.begin(),
+            .iov_len = buf.len(),
         };
 
-        auto job = makeStrong<Job>(fd, buf);
-        submit(job);
-        return Async::makeTask(job->future());
-    }
+        sockaddr_in addr{};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * Posix::Fd::MAX_HNDS)];
 
-    Async::Task<> sleepAsync(TimeStamp until) override {
-        struct Job : public _Job {
-            TimeStamp _until;
-            Async::Promise<> _promise;
-            struct __kernel_timespec _ts {};
+        msghdr msg = {};
+        msg.msg_name = &addr;
+        msg.msg_namelen = sizeof(sockaddr_in);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
 
-            Job(TimeStamp until)
-                : _until(until) {}
+        auto res = co_await _submit(ct, [&](io_uring_sqe *sqe) {
+            io_uring_prep_recvmsg(sqe, fd->handle().value(), &msg, MSG_CMSG_CLOEXEC);
+        });
 
-            void submit(io_uring_sqe *sqe) override {
-                _ts = toKernelTimespec(_until);
-                io_uring_prep_timeout(sqe, &_ts, 0, IORING_TIMEOUT_ABS | IORING_TIMEOUT_REALTIME);
-            }
+        if (res < 0)
+            co_return _error(res);
 
-            void complete(io_uring_cqe *cqe) override {
-                if (cqe->res < 0 and cqe->res != -ETIME)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else
-                    _promise.resolve(Ok());
-            }
+        _Received received = {(usize)res, _collect(msg, hnds), Posix::fromSockAddr(addr)};
+        co_return Ok(received);
+    }
 
-            auto future() {
-                return _promise.future();
-            }
-        };
+    Async::Task<> sleepAsync(TimeStamp until, Async::Cancelation::Token ct) override {
+        struct __kernel_timespec ts = toKernelTimespec(until);
+        auto res = co_await _submit(ct, [&](io_uring_sqe *sqe) {
+            io_uring_prep_timeout(sqe, &ts, 0, IORING_TIMEOUT_ABS | IORING_TIMEOUT_REALTIME);
+        });
 
-        auto job = makeStrong<Job>(until);
-        submit(job);
-        return Async::makeTask(job->future());
+        if (res < 0 and res != -ETIME)
+            co_return _error(res);
+        co_return Ok();
     }
 
     Res<> wait(TimeStamp until) override {
@@ -331,22 +312,41 @@ struct UringSched : public Sys::Sched {
                 break;
 
             auto id = cqe->user_data;
-            auto job = _jobs.get(id).unwrap("invalid job id");
-            job->complete(cqe);
-            _jobs.del(id);
+            auto res = cqe->res;
             io_uring_cqe_seen(&_ring, cqe);
+
+            if (id == WAKE_ID) {
+                _armWake();
+                continue;
+            }
+
+            if (id == CANCEL_ID)
+                continue;
+
+            auto *op = reinterpret_cast<_Op *>(id);
+            op->_res = res;
+            op->_coro.resume();
         }
         return Ok();
     }
 };
 
+// NOTE: Every thread gets its own ring, see Sys::Executor.
 Sched &globalSched() {
-    static UringSched sched = [] {
+    static thread_local Sched &sched = []() -> Sched & {
         io_uring ring{};
         auto res = io_uring_queue_init(UringSched::NCQES, &ring, 0);
-        if (res < 0) [[unlikely]]
-            panic("failed to initialize io_uring");
-        return UringSched(ring);
+        if (res < 0) [[unlikely]] {
+            logWarn("io_uring unavailable ({}), falling back to epoll", Posix::fromErrno(-res));
+            return Posix::epollSched();
+        }
+
+        int wakeFd = ::eventfd(0, EFD_CLOEXEC);
+        if (wakeFd < 0) [[unlikely]]
+            panic("failed to create eventfd");
+
+        static thread_local UringSched sched{ring, wakeFd};
+        return sched;
     }();
     return sched;
 }
@@ -56,6 +56,12 @@ struct Vmm : public Hal::Vmm {
         return Ok();
     }
 
+    Res<Pml<1> *> pml1At(usize vaddr) {
+        auto pml3 = try$(pml(*_pml4, vaddr));
+        auto pml2 = try$(pml(*pml3, vaddr));
+        return pml(*pml2, vaddr);
+    }
+
     Res<> freePage(usize vaddr) {
         auto pml3 = try$(pml(*_pml4, vaddr));
         auto pml2 = try$(pml(*pml3, vaddr));
@@ -94,13 +100,36 @@ struct Vmm : public Hal::Vmm {
 
     Res<> free(Hal::VmmRange vaddr) override {
         for (usize page = 0; page < vaddr.size; page += Hal::PAGE_SIZE) {
+            // NOTE: Lazily committed ranges might have holes in them
+            if (not virt2phys(vaddr.start + page))
+                continue;
             try$(freePage(vaddr.start + page));
         }
         return Ok();
     }
 
-    Res<> update(Hal::VmmRange, Hal::VmmFlags) override {
-        notImplemented();
+    Res<> update(Hal::VmmRange vaddr, Hal::VmmFlags flags) override {
+        for (usize page = 0; page < vaddr.size; page += Hal::PAGE_SIZE) {
+            auto res = pml1At(vaddr.start + page);
+            if (not res)
+                continue;
+
+            auto *pml1 = res.unwrap();
+            auto entry = pml1->pageAt(vaddr.start + page);
+            if (not entry.present())
+                continue;
+
+            pml1->putPage(vaddr.start + page, {entry.paddr(), Entry::makeFlags(flags) | Entry::PRESENT});
+        }
+        return Ok();
+    }
+
+    Res<usize> virt2phys(usize vaddr) override {
+        auto *pml1 = try$(pml1At(vaddr));
+        auto entry = pml1->pageAt(vaddr);
+        if (not entry.present())
+            return Error::invalidInput("page not present");
+        return Ok(entry.paddr() + (vaddr & (Hal::PAGE_SIZE - 1)));
     }
 
     Res<> flush(Hal::VmmRange vaddr) override {
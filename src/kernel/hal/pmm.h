@@ -16,6 +16,7 @@ enum struct PmmFlags : u64 {
     LOWER = (1 << 0),
     UPPER = (1 << 1),
     DMA = (1 << 2),
+    LAZY = (1 << 3), //< Don't commit physical memory until it's first accessed
 };
 
 FlagsEnum$(PmmFlags);
@@ -50,6 +50,8 @@ struct Vmm {
 
     virtual Res<> update(VmmRange vaddr, VmmFlags flags) = 0;
 
+    virtual Res<usize> virt2phys(usize vaddr) = 0;
+
     virtual Res<> flush(VmmRange vaddr) = 0;
 
     virtual void dump() = 0;
@@ -135,6 +135,12 @@ struct Vmo : public Object {
     static Res<Vmo> create(Cap dest, usize phys, usize len, VmoFlags flags = VmoFlags::NONE) {
         return create<Vmo>(dest, phys, len, flags);
     }
+
+    Res<Vmo> clone(Cap dest) {
+        Cap c;
+        try$(_clone(dest, &c, _cap));
+        return Ok(Vmo{c});
+    }
 };
 
 struct Space : public Object {
@@ -290,11 +296,16 @@ struct Listener : public Object {
     }
 
     Res<> poll(TimeStamp deadline) {
-        _evs.resize(256);
+        if (_evs.len() == 0)
+            _evs.resize(256);
         _len = 0;
         return _poll(_cap, _evs.buf(), _evs.len(), &_len, deadline);
     }
 
+    Slice<Event> events() const {
+        return sub(_evs, 0, _len);
+    }
+
     Opt<Event> next() {
         if (_len) {
             auto ev = _evs[_len - 1];
@@ -140,4 +140,8 @@ Res<> _poll(Cap cap, Event *ev, usize evCap, usize *evLen, TimeStamp deadline) {
     return _syscall(Syscall::POLL, cap.raw(), (Arg)ev, evCap, (usize)evLen, deadline.val());
 }
 
+Res<> _clone(Cap dest, Cap *out, Cap cap) {
+    return _syscall(Syscall::CLONE, dest.raw(), (Arg)out, cap.raw());
+}
+
 } //  namespace Hj
@@ -40,4 +40,6 @@ Res<> _listen(Cap cap, Cap target, Flags<Sigs> set, Flags<Sigs> unset);
 
 Res<> _poll(Cap cap, Event *ev, usize evCap, usize *evLen, TimeStamp deadline);
 
+Res<> _clone(Cap dest, Cap *out, Cap cap);
+
 } // namespace Hj
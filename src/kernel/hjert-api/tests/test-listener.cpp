@@ -0,0 +1,50 @@
+#include <hjert-api/api.h>
+#include <karm-base/size.h>
+#include <karm-test/macros.h>
+
+namespace Hj::Tests {
+
+[[noreturn]] static void _raise(usize cap) {
+    _signal(Cap{cap}, Sigs::USER0, Sigs::NONE).unwrap();
+    Task::self().ret().unwrap();
+    unreachable();
+}
+
+test$("hjert-listener-small-buffer") {
+    auto vmo = try$(Vmo::create(ROOT, 0, kib(4), VmoFlags::LAZY));
+    auto listener = try$(Listener::create(ROOT));
+    try$(listener.listen(vmo, Sigs::USER0, Sigs::USER1));
+    try$(vmo.signal(Sigs::USER0, Sigs::NONE));
+
+    // NOTE: The vmo has both a set and an unset event pending, they don't
+    //       fit in a single slot.
+    Event ev;
+    usize len = 0;
+    expect$(not _poll(listener, &ev, 1, &len, TimeStamp::endOfTime()));
+
+    try$(listener.poll(TimeStamp::endOfTime()));
+    expectEq$(listener.events().len(), 2uz);
+
+    return Ok();
+}
+
+test$("hjert-listener-wakes-on-signal") {
+    auto stack = try$(Vmo::create(ROOT, 0, kib(16), VmoFlags::LAZY));
+    auto stackMap = try$(map(stack, MapFlags::READ | MapFlags::WRITE));
+    auto vmo = try$(Vmo::create(ROOT, 0, kib(4), VmoFlags::LAZY));
+    auto listener = try$(Listener::create(ROOT));
+    try$(listener.listen(vmo, Sigs::USER0, Sigs::NONE));
+
+    auto task = try$(Task::create(ROOT, ROOT, ROOT));
+    try$(task.start((usize)_raise, stackMap.range().end() - 8, {vmo.raw()}));
+
+    // NOTE: Nothing is pending yet, only the signal raised by the other
+    //       task can end this poll.
+    try$(listener.poll(TimeStamp::endOfTime()));
+    expectEq$(listener.events().len(), 1uz);
+    expect$(listener.events()[0].cap == vmo.cap());
+
+    return Ok();
+}
+
+} // namespace Hj::Tests
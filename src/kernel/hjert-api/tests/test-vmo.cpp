@@ -0,0 +1,47 @@
+#include <hal/mem.h>
+#include <hjert-api/api.h>
+#include <karm-base/size.h>
+#include <karm-test/macros.h>
+
+namespace Hj::Tests {
+
+static constexpr usize ROUNDS = 256;
+
+// Runs as a task of its own in our space, its write is the first access to
+// the page, so it takes the fault that commits it.
+[[noreturn]] static void _touch(usize addr) {
+    *(u8 volatile *)addr = 0xaa;
+    Task::self().ret().unwrap();
+    unreachable();
+}
+
+test$("hjert-vmo-clone-races-first-write") {
+    auto stack = try$(Vmo::create(ROOT, 0, kib(16), VmoFlags::LAZY));
+    auto stackMap = try$(map(stack, MapFlags::READ | MapFlags::WRITE));
+    auto listener = try$(Listener::create(ROOT));
+
+    for (usize i = 0; i < ROUNDS; i++) {
+        auto vmo = try$(Vmo::create(ROOT, 0, Hal::PAGE_SIZE, VmoFlags::LAZY));
+        auto mapped = try$(map(vmo, MapFlags::READ | MapFlags::WRITE));
+
+        auto task = try$(Task::create(ROOT, ROOT, ROOT));
+        try$(listener.listen(task, Sigs::EXITED, Sigs::NONE));
+        try$(task.start((usize)_touch, stackMap.range().end() - 8, {mapped.range().start}));
+
+        auto clone = try$(vmo.clone(ROOT));
+        try$(listener.poll(TimeStamp::endOfTime()));
+        try$(listener.mute(task));
+
+        // NOTE: Whether the first write made it in the clone depends on who
+        //       won, but anything written after cloning must stay private.
+        mapped.mutBytes()[1] = 0x55;
+        auto cloneMap = try$(map(clone, MapFlags::READ));
+        expect$(cloneMap.bytes()[0] == 0x00 or cloneMap.bytes()[0] == 0xaa);
+        expectEq$(cloneMap.bytes()[1], 0x00);
+        expectEq$(mapped.bytes()[0], 0xaa);
+    }
+
+    return Ok();
+}
+
+} // namespace Hj::Tests
@@ -59,7 +59,8 @@ static inline char const *toStr(Type type) {
     SYSCALL(CLOSE)               \
     SYSCALL(SIGNAL)              \
     SYSCALL(LISTEN)              \
-    SYSCALL(POLL)
+    SYSCALL(POLL)                \
+    SYSCALL(CLONE)
 
 // clang-format off
 
@@ -104,6 +104,7 @@ Res<Hj::SentRecv> Channel::recv(Domain &dom, MutBytes bytes, MutSlice<Hj::Cap> c
 Res<> Channel::close() {
     ObjectLockScope scope{*this};
     _closed = true;
+    _updateSignalsUnlock();
     return Ok();
 }
 
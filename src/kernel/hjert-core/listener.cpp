@@ -6,41 +6,148 @@ Res<Strong<Listener>> Listener::create() {
     return Ok(makeStrong<Listener>());
 }
 
-Res<> Listener::listen(Hj::Cap cap, Strong<Object> obj, Flags<Hj::Sigs> set, Flags<Hj::Sigs> unset) {
+Listener::~Listener() {
+    for (auto &l : _listened)
+        l->obj->unwatch(*l);
+}
+
+void Listener::_update(Listened &listened, Flags<Hj::Sigs> sigs) {
     ObjectLockScope scope{*this};
 
-    for (usize i = 0; i < _listened.len(); ++i) {
-        if (_listened[i].cap == cap) {
-            auto &listened = _listened[i];
+    if (listened.muted)
+        return;
+
+    listened.sigs = sigs;
+    bool ready = listened.ready();
+
+    if (ready and not listened.queued) {
+        _queueUnlock(listened);
+    } else if (not ready and listened.queued) {
+        _ready.removeAll(&listened);
+        listened.queued = false;
+    }
+}
+
+Res<> Listener::listen(Hj::Cap cap, Strong<Object> obj, Flags<Hj::Sigs> set, Flags<Hj::Sigs> unset) {
+    Opt<Box<Listened>> muted;
+
+    {
+        ObjectLockScope scope{*this};
+
+        for (usize i = 0; i < _listened.len(); ++i) {
+            auto &listened = *_listened[i];
+            if (listened.cap != cap)
+                continue;
+
             listened.set = set;
             listened.unset = unset;
 
+            if (listened.queued) {
+                _ready.removeAll(&listened);
+                listened.queued = false;
+            }
+
             if (listened.set.empty() and
                 listened.unset.empty()) {
-                _listened.removeAt(i);
-                return Ok();
+                listened.muted = true;
+                muted = _listened.removeAt(i);
+                break;
             }
+
+            if (listened.ready())
+                _queueUnlock(listened);
+
+            return Ok();
         }
     }
 
-    _listened.pushBack(Listened{cap, obj, set, unset});
+    // NOTE: Attaching and detaching takes the object lock, which must
+    //       never be acquired while holding our own. The entry is kept
+    //       alive until it's unwatched, notifications that race with us
+    //       see it muted and leave it out of the ready list.
+    if (muted) {
+        (*muted)->obj->unwatch(**muted);
+        return Ok();
+    }
+
+    auto listened = makeBox<Listened>(*this, cap, obj, set, unset);
+    auto &ref = *listened;
+
+    {
+        ObjectLockScope scope{*this};
+        _listened.pushBack(std::move(listened));
+    }
+
+    obj->watch(ref);
     return Ok();
 }
 
-Slice<Hj::Event> Listener::pollEvents() {
+void Listener::_queueUnlock(Listened &listened) {
+    _ready.pushBack(&listened);
+    listened.queued = true;
+    _wakeUnlock();
+}
+
+void Listener::_wakeUnlock() {
+    for (auto &task : _waiters)
+        task->wake();
+    _waiters.clear();
+}
+
+bool Listener::wait(Strong<Task> task) {
     ObjectLockScope scope{*this};
-    _events.clear();
+    if (_ready.len())
+        return false;
 
-    for (auto &l : _listened) {
-        auto sigs = l.obj->poll();
-        if (sigs & l.set) {
-            _events.pushBack(Hj::Event{l.cap, sigs & l.set, true});
-        }
+    // NOTE: A wake-up left over from an earlier poll must not cut this
+    //       one short.
+    {
+        ObjectLockScope taskScope{*task};
+        task->_woken = false;
+    }
+
+    _waiters.pushBack(task);
+    return true;
+}
 
-        if (~sigs & l.unset) {
-            _events.pushBack(Hj::Event{l.cap, sigs & l.unset, false});
+void Listener::unwait(Task &task) {
+    ObjectLockScope scope{*this};
+    for (usize i = 0; i < _waiters.len(); i++) {
+        if (&*_waiters[i] == &task) {
+            _waiters.removeAt(i);
+            return;
         }
     }
+}
+
+Slice<Hj::Event> Listener::pollEvents(usize limit) {
+    ObjectLockScope scope{*this};
+    _events.clear();
+
+    usize n = 0;
+    for (; n < _ready.len(); ++n) {
+        auto &l = *_ready[n];
+        auto set = l.sigs & l.set;
+        auto unset = ~l.sigs & l.unset;
+
+        if (_events.len() + (set ? 1 : 0) + (unset ? 1 : 0) > limit)
+            break;
+
+        if (set)
+            _events.pushBack(Hj::Event{l.cap, set, true});
+
+        if (unset)
+            _events.pushBack(Hj::Event{l.cap, unset, false});
+    }
+
+    // NOTE: Objects stay ready until their signals change, rotate the ones
+    //       we just reported to the back so a small batch can't starve
+    //       the others.
+    if (n < _ready.len()) {
+        reverse(mutSub(_ready, 0, n));
+        reverse(mutSub(_ready, n, _ready.len()));
+        reverse(mutSub(_ready));
+    }
 
     return _events;
 }
@@ -1,30 +1,76 @@
 #pragma once
 
+#include <karm-base/box.h>
 #include <karm-base/vec.h>
 
 #include "object.h"
+#include "task.h"
 
 namespace Hjert::Core {
 
 struct Listener :
     public BaseObject<Listener, Hj::Type::LISTENER> {
+    // An object can have both set and unset events pending at once.
+    static constexpr usize EVENTS_PER_OBJECT = 2;
 
-    struct Listened {
+    struct Listened : public Watcher {
+        Listener &listener;
         Hj::Cap cap;
         Strong<Object> obj;
 
         Flags<Hj::Sigs> set;
         Flags<Hj::Sigs> unset;
+
+        Flags<Hj::Sigs> sigs{};
+        bool queued = false;
+
+        // Set once it's no longer listened to, it can still be notified
+        // until it's unwatched but must not be queued anymore.
+        bool muted = false;
+
+        Listened(Listener &listener, Hj::Cap cap, Strong<Object> obj, Flags<Hj::Sigs> set, Flags<Hj::Sigs> unset)
+            : listener(listener), cap(cap), obj(obj), set(set), unset(unset) {}
+
+        bool ready() const {
+            return (sigs & set) or (~sigs & unset);
+        }
+
+        void _notify(Object &, Flags<Hj::Sigs> curr) override {
+            listener._update(*this, curr);
+        }
     };
 
-    Vec<Listened> _listened;
+    Vec<Box<Listened>> _listened;
+
+    // The listened objects that currently have events pending, objects push
+    // their signal changes here so polling doesn't have to visit them all.
+    Vec<Listened *> _ready;
+
     Vec<Hj::Event> _events;
 
+    // Tasks blocked polling this listener, they are woken as soon as
+    // something is ready instead of checking back on every tick.
+    Vec<Strong<Task>> _waiters;
+
     static Res<Strong<Listener>> create();
 
+    ~Listener() override;
+
+    void _update(Listened &listened, Flags<Hj::Sigs> sigs);
+
+    void _queueUnlock(Listened &listened);
+
+    void _wakeUnlock();
+
+    // Registers `task` to be woken once events are pending, returns false
+    // without registering it if some already are.
+    bool wait(Strong<Task> task);
+
+    void unwait(Task &task);
+
     Res<> listen(Hj::Cap cap, Strong<Object> obj, Flags<Hj::Sigs> set, Flags<Hj::Sigs> unset);
 
-    Slice<Hj::Event> pollEvents();
+    Slice<Hj::Event> pollEvents(usize limit);
 
     Slice<Hj::Event> events() {
         return _events;
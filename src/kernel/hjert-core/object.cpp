@@ -16,8 +16,15 @@ String Object::label() const {
 }
 
 void Object::_signalUnlock(Flags<Hj::Sigs> set, Flags<Hj::Sigs> unset) {
+    auto old = _signals;
     _signals |= set;
     _signals &= ~unset;
+
+    if (old == _signals)
+        return;
+
+    for (auto *watcher : _watchers)
+        watcher->_notify(*this, _signals);
 }
 
 Flags<Hj::Sigs> Object::_pollUnlock() {
@@ -34,4 +41,18 @@ Flags<Hj::Sigs> Object::poll() {
     return _pollUnlock();
 }
 
+void Object::watch(Watcher &watcher) {
+    LockScope scope(_lock);
+    _watchers.pushBack(&watcher);
+
+    // NOTE: Notifying under the lock keeps this ordered with the changes
+    //       that come after.
+    watcher._notify(*this, _signals);
+}
+
+void Object::unwatch(Watcher &watcher) {
+    LockScope scope(_lock);
+    _watchers.removeAll(&watcher);
+}
+
 } // namespace Hjert::Core
@@ -4,10 +4,21 @@
 #include <karm-base/atomic.h>
 #include <karm-base/lock.h>
 #include <karm-base/rc.h>
+#include <karm-base/vec.h>
 #include <karm-io/fmt.h>
 
 namespace Hjert::Core {
 
+struct Object;
+
+// Something that wants to be told about signal changes of an object,
+// the object lock is held while it's being notified.
+struct Watcher {
+    virtual ~Watcher() = default;
+
+    virtual void _notify(Object &obj, Flags<Hj::Sigs> sigs) = 0;
+};
+
 struct Object : Meta::Static {
     static Atomic<usize> _counter;
 
@@ -15,6 +26,7 @@ struct Object : Meta::Static {
     usize _id = _counter.fetchAdd(1);
     Opt<String> _label;
     Flags<Hj::Sigs> _signals;
+    Vec<Watcher *> _watchers;
 
     virtual ~Object() = default;
 
@@ -33,6 +45,12 @@ struct Object : Meta::Static {
     void signal(Flags<Hj::Sigs> set, Flags<Hj::Sigs> unset);
 
     Flags<Hj::Sigs> poll();
+
+    // Attach a watcher, it's notified of the current signals right
+    // away and then every time they change.
+    void watch(Watcher &watcher);
+
+    void unwatch(Watcher &watcher);
 };
 
 template <typename Crtp, Hj::Type _TYPE>
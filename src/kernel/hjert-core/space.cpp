@@ -32,6 +32,17 @@ Res<usize> Space::_lookup(Hal::VmmRange vrange) {
     return Error::invalidInput("no such mapping");
 }
 
+Res<usize> Space::_lookupAddr(usize addr) {
+    for (usize i = 0; i < _maps.len(); i++) {
+        auto &map = _maps[i];
+        if (map.vrange.contains(addr)) {
+            return Ok(i);
+        }
+    }
+
+    return Error::invalidInput("bad address");
+}
+
 Res<> Space::_ensureNotMapped(Hal::VmmRange vrange) {
     for (usize i = 0; i < _maps.len(); i++) {
         auto &map = _maps[i];
@@ -43,28 +54,107 @@ Res<> Space::_ensureNotMapped(Hal::VmmRange vrange) {
     return Ok();
 }
 
-Res<> Space::_validate(Hal::VmmRange vrange) {
+Res<> Space::_validate(Hal::VmmRange vrange, bool write) {
     for (auto &map : _maps) {
-        if (map.vrange.contains(vrange)) {
-            return Ok();
+        if (not map.vrange.contains(vrange))
+            continue;
+
+        if (write and not map.flags.has(Hj::MapFlags::WRITE))
+            return Error::invalidInput("write to read-only mapping");
+
+        // NOTE: The kernel is about to access this range on behalf of the
+        //       task, make sure it doesn't fault on pages that were never
+        //       touched or, when writing, are still shared with a clone.
+        if (map.lazy()) {
+            auto start = Hal::pageAlignDown(vrange.start);
+            for (usize addr = start; addr < vrange.end(); addr += Hal::PAGE_SIZE)
+                try$(_commitUnlock(map, addr, write));
         }
+
+        return Ok();
     }
 
     return Error::invalidInput("bad address");
 }
 
+Res<bool> Space::_commitUnlock(Map &map, usize addr, bool write) {
+    auto page = Hal::pageAlignDown(addr);
+    auto off = map.off + (page - map.vrange.start);
+
+    // NOTE: The vmo stays locked until the page is mapped, a clone made in
+    //       between would share the page while it's still writable here.
+    ObjectLockScope vmoScope(*map.vmo);
+    auto commit = try$(map.vmo->_commitUnlock(off, write));
+
+    // NOTE: The vmo got its own copy of the page, other mappings are
+    //       still pointing at the shared one.
+    if (commit.copied) {
+        for (auto &mapping : map.vmo->_mappings) {
+            if (mapping.space == this and mapping.vrange == map.vrange)
+                continue;
+
+            if (off < mapping.off or off >= mapping.off + mapping.vrange.size)
+                continue;
+
+            try$(mapping.space->_invalidate(mapping.vrange.start + (off - mapping.off)));
+        }
+    }
+
+    auto flags = map.flags;
+    if (not commit.writable)
+        flags &= ~(Hj::MapFlags::READ | Hj::MapFlags::WRITE);
+
+    LockScope scope(_vmmLock);
+    bool present = (bool)_vmm->virt2phys(page);
+
+    if (present)
+        try$(_vmm->free({page, Hal::PAGE_SIZE}));
+
+    try$(_vmm->mapRange({page, Hal::PAGE_SIZE}, {commit.paddr, Hal::PAGE_SIZE}, flags | Hal::VmmFlags::USER));
+    try$(_vmm->flush({page, Hal::PAGE_SIZE}));
+
+    if (not present)
+        _resident += Hal::PAGE_SIZE;
+
+    return Ok(not present);
+}
+
+Res<> Space::_protect(Hal::VmmRange vrange, Flags<Hj::MapFlags> flags) {
+    LockScope scope(_vmmLock);
+
+    flags &= ~(Hj::MapFlags::READ | Hj::MapFlags::WRITE);
+    try$(_vmm->update(vrange, flags | Hal::VmmFlags::USER));
+    try$(_vmm->flush(vrange));
+
+    return Ok();
+}
+
+Res<> Space::_invalidate(usize addr) {
+    LockScope scope(_vmmLock);
+
+    Hal::VmmRange page = {addr, Hal::PAGE_SIZE};
+    if (not _vmm->virt2phys(page.start))
+        return Ok();
+
+    try$(_vmm->free(page));
+    try$(_vmm->flush(page));
+    _resident -= Hal::PAGE_SIZE;
+
+    return Ok();
+}
+
 Res<Hal::VmmRange> Space::map(Hal::VmmRange vrange, Strong<Vmo> vmo, usize off, Hj::MapFlags flags) {
     ObjectLockScope scope(*this);
 
     try$(vrange.ensureAligned(Hal::PAGE_SIZE));
 
     if (vrange.size == 0) {
-        vrange.size = vmo->range().size;
+        vrange.size = vmo->len();
     }
 
     auto end = try$(checkedAdd(off, vrange.size));
 
-    if (end > vmo->range().size) {
+    if (end > vmo->len()) {
         return Error::invalidInput("mapping too large");
     }
 
@@ -75,12 +165,21 @@ Res<Hal::VmmRange> Space::map(Hal::VmmRange vrange, Strong<Vmo> vmo, usize off,
         _ranges.remove(vrange);
     }
 
-    Map map = {vrange, off, std::move(vmo)};
+    Map map = {vrange, off, std::move(vmo), flags};
 
-    Hal::PmmRange prange = {map.vmo->range().start + map.off, vrange.size};
-    try$(_vmm->mapRange(map.vrange, prange, flags | Hal::VmmFlags::USER));
-    try$(_vmm->flush(map.vrange));
+    if (map.lazy()) {
+        // NOTE: Pages are mapped on first access by the page fault handler.
+        ObjectLockScope vmoScope(*map.vmo);
+        map.vmo->_attachUnlock({this, map.vrange, map.off, map.flags});
+    } else {
+        Hal::PmmRange prange = {map.vmo->range().start + map.off, vrange.size};
+        LockScope vmmScope(_vmmLock);
+        try$(_vmm->mapRange(map.vrange, prange, flags | Hal::VmmFlags::USER));
+        try$(_vmm->flush(map.vrange));
+        _resident += vrange.size;
+    }
 
+    _committed += vrange.size;
     _maps.pushBack(std::move(map));
 
     return Ok(vrange);
@@ -94,24 +193,74 @@ Res<> Space::unmap(Hal::VmmRange vrange) {
     auto id = try$(_lookup(vrange));
     auto &map = _maps[id];
 
-    try$(_vmm->free(map.vrange));
-    try$(_vmm->flush(map.vrange));
+    // NOTE: Detach first, so the vmo doesn't reach into page tables that
+    //       are going away.
+    if (map.lazy()) {
+        ObjectLockScope vmoScope(*map.vmo);
+        map.vmo->_detachUnlock(*this, map.vrange);
+    }
+
+    {
+        LockScope vmmScope(_vmmLock);
+        if (map.lazy()) {
+            for (usize addr = map.vrange.start; addr < map.vrange.end(); addr += Hal::PAGE_SIZE)
+                if (_vmm->virt2phys(addr))
+                    _resident -= Hal::PAGE_SIZE;
+        } else {
+            _resident -= map.vrange.size;
+        }
 
+        try$(_vmm->free(map.vrange));
+        try$(_vmm->flush(map.vrange));
+    }
+
+    _committed -= map.vrange.size;
     _ranges.add(map.vrange);
     _maps.removeAt(id);
+
+    return Ok();
+}
+
+Res<> Space::fault(usize addr, bool write) {
+    ObjectLockScope scope(*this);
+
+    auto &map = _maps[try$(_lookupAddr(addr))];
+
+    if (not map.lazy())
+        return Error::invalidInput("fault in non-lazy mapping");
+
+    if (write and not map.flags.has(Hj::MapFlags::WRITE))
+        return Error::invalidInput("write to read-only mapping");
+
+    try$(_commitUnlock(map, addr, write));
     return Ok();
 }
 
+usize Space::committed() {
+    ObjectLockScope scope(*this);
+    return _committed;
+}
+
+usize Space::resident() {
+    LockScope scope(_vmmLock);
+    return _resident;
+}
+
 void Space::activate() {
     _vmm->activate();
 }
 
 void Space::dump() {
     ObjectLockScope scope(*this);
+    logDebug("space {}: committed: {}kib resident: {}kib", id(), _committed / 1024, resident() / 1024);
     for (auto &map : _maps) {
         auto vrange = map.vrange;
-        auto prange = map.prange();
         auto size = vrange.size / 1024;
+        if (map.lazy()) {
+            logDebug("space {}: map: {x}-{x} -> lazy {} {}kib", id(), vrange.start, vrange.end(), map.vmo->label(), size);
+            continue;
+        }
+        auto prange = map.prange();
         logDebug("space {}: map: {x}-{x} -> {x}-{x} {} {}kib", id(), vrange.start, vrange.end(), prange.start, prange.end(), map.vmo->label(), size);
     }
     _vmm->dump();
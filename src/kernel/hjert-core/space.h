@@ -12,16 +12,28 @@ struct Space : public BaseObject<Space, Hj::Type::SPACE> {
         Hal::VmmRange vrange;
         usize off;
         Strong<Vmo> vmo;
+        Flags<Hj::MapFlags> flags;
 
         Hal::PmmRange prange() {
             return vmo->range().slice(off, vrange.size);
         }
+
+        bool lazy() {
+            return vmo->isLazy();
+        }
     };
 
+    // NOTE: Locks are always taken in the order space, vmo, then the vmm
+    //       lock of a space. Vmos reach into the page tables of every
+    //       space they are mapped into, which only needs the vmm lock.
+    Lock _vmmLock;
     Strong<Hal::Vmm> _vmm;
     Ranges<Hal::VmmRange> _ranges;
     Vec<Map> _maps;
 
+    usize _committed = 0; //< Bytes of address space backed by a mapping
+    usize _resident = 0;  //< Bytes of physical memory currently mapped, under the vmm lock
+
     static Res<Strong<Space>> create();
 
     Space(Strong<Hal::Vmm> vmm);
@@ -30,14 +42,33 @@ struct Space : public BaseObject<Space, Hj::Type::SPACE> {
 
     Res<usize> _lookup(Hal::VmmRange vrange);
 
+    Res<usize> _lookupAddr(usize addr);
+
     Res<> _ensureNotMapped(Hal::VmmRange vrange);
 
-    Res<> _validate(Hal::VmmRange vrange);
+    // Make sure the kernel can access `vrange` on behalf of the task
+    // without faulting, `write` tells whether it's going to write to it.
+    Res<> _validate(Hal::VmmRange vrange, bool write);
+
+    Res<bool> _commitUnlock(Map &map, usize addr, bool write);
+
+    // Make a mapping read-only, called by vmos with their lock held.
+    Res<> _protect(Hal::VmmRange vrange, Flags<Hj::MapFlags> flags);
+
+    // Drop the page at `addr` if it's mapped, called by vmos with their
+    // lock held.
+    Res<> _invalidate(usize addr);
 
     Res<Hal::VmmRange> map(Hal::VmmRange vrange, Strong<Vmo> vmo, usize off, Hj::MapFlags flags);
 
     Res<> unmap(Hal::VmmRange vrange);
 
+    Res<> fault(usize addr, bool write);
+
+    usize committed();
+
+    usize resident();
+
     void activate();
 
     void dump();
@@ -233,19 +233,28 @@ Res<> doListen(Task &self, Hj::Cap cap, Hj::Cap target, Flags<Hj::Sigs> set, Fla
 Res<> doPoll(Task &self, Hj::Cap cap, UserSlice<MutSlice<Hj::Event>> events, User<usize> evLen, TimeStamp deadline) {
     auto obj = try$(self.domain().get<Listener>(cap));
 
-    try$(self.block([&] {
-        auto events = obj->pollEvents();
-        if (events.len() > 0)
-            return TimeStamp::epoch();
-        return deadline;
-    }));
+    // NOTE: Events of an object aren't split across polls, a buffer that
+    //       can't hold them would never get any.
+    if (events.len() < Listener::EVENTS_PER_OBJECT)
+        return Error::invalidInput("event buffer too small");
+
+    // NOTE: Signaling an object wakes us up right away, the deadline is
+    //       the only thing left for the scheduler to check.
+    if (obj->wait(Sched::instance()._curr)) {
+        auto res = self.block([&] {
+            return deadline;
+        });
+        obj->unwait(self);
+        try$(res);
+    }
+
+    auto ready = obj->pollEvents(events.len());
 
     ObjectLockScope lock{*obj};
-    auto l = min(events.len(), obj->events().len());
-    try$(evLen.store(self.space(), l));
+    try$(evLen.store(self.space(), ready.len()));
     try$(events.with(self.space(), [&](auto events) {
-        for (usize i = 0; i < l; ++i) {
-            events[i] = obj->events()[i];
+        for (usize i = 0; i < ready.len(); ++i) {
+            events[i] = ready[i];
         }
         obj->flush();
         return Ok();
@@ -254,6 +263,13 @@ Res<> doPoll(Task &self, Hj::Cap cap, UserSlice<MutSlice<Hj::Event>> events, Use
     return Ok();
 }
 
+Res<> doClone(Task &self, Hj::Cap dest, User<Hj::Cap> out, Hj::Cap cap) {
+    try$(self.ensure(Hj::Pledge::MEM));
+    auto obj = try$(self.domain().get<Vmo>(cap));
+    auto clone = try$(obj->clone());
+    return out.store(self.space(), try$(self.domain().add(dest, clone)));
+}
+
 Res<> dispatchSyscall(Task &self, Hj::Syscall id, Hj::Args args) {
     switch (id) {
     case Hj::Syscall::NOW:
@@ -320,6 +336,9 @@ Res<> dispatchSyscall(Task &self, Hj::Syscall id, Hj::Args args) {
     case Hj::Syscall::POLL:
         return doPoll(self, Hj::Cap{args[0]}, {args[1], args[2]}, args[3], args[4]);
 
+    case Hj::Syscall::CLONE:
+        return doClone(self, Hj::Cap{args[0]}, args[1], Hj::Cap{args[2]});
+
     default:
         return Error::invalidInput("invalid syscall id");
     }
@@ -63,12 +63,23 @@ Res<> Task::block(Blocker blocker) {
     // NOTE: Can't use ObjectLockScope here because we need to yield
     //       outside of the lock.
     _lock.acquire();
+    if (_woken) {
+        _woken = false;
+        _lock.release();
+        return Ok();
+    }
     _block = std::move(blocker);
     _lock.release();
     Arch::yield();
     return Ok();
 }
 
+void Task::wake() {
+    ObjectLockScope scope(*this);
+    _woken = not _block;
+    _block = NONE;
+}
+
 void Task::crash() {
     logError("{}: crashed", *this);
     signal(
@@ -84,7 +95,7 @@ State Task::eval(TimeStamp now) {
         return State::EXITED;
 
     if (_block) {
-        if ((*_block)() == now) {
+        if ((*_block)() > now) {
             return State::BLOCKED;
         }
         _block = NONE;
@@ -29,6 +29,7 @@ struct Task :
     Opt<Strong<Space>> _space;
     Opt<Strong<Domain>> _domain;
     Opt<Blocker> _block;
+    bool _woken = false;
 
     Flags<Hj::Pledge> _pledges = Hj::Pledge::ALL;
 
@@ -71,8 +72,14 @@ struct Task :
 
     Res<> ready(usize ip, usize sp, Hj::Args args);
 
+    // Blocks until the time returned by `blocker` is reached, or until
+    // the task is woken.
     Res<> block(Blocker blocker);
 
+    // Cuts the current block short, or the next one if the task isn't
+    // blocked yet, so a wake-up can't get lost in between.
+    void wake();
+
     void crash();
 
     State eval(TimeStamp now);
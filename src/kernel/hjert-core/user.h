@@ -20,21 +20,21 @@ struct User {
 
     Res<T> load(Space &space) {
         ObjectLockScope scope(space);
-        auto &v = *try$(_acquire(space));
+        auto &v = *try$(_acquire(space, false));
         return Ok(v);
     }
 
     Res<> store(Space &space, T const &val) {
         ObjectLockScope scope(space);
-        auto &v = *try$(_acquire(space));
+        auto &v = *try$(_acquire(space, true));
         v = val;
         return Ok();
     }
 
-    Res<T *> _acquire(Space &space) {
+    Res<T *> _acquire(Space &space, bool write = true) {
         if (_addr == 0)
             return Error::invalidInput("null pointer");
-        try$(space._validate(vrange()));
+        try$(space._validate(vrange(), write));
         return Ok(reinterpret_cast<T *>(_addr));
     }
 };
@@ -45,6 +45,9 @@ template <typename Slice>
 struct UserSlice {
     using Inner = typename Slice::Inner;
 
+    // Only mutable slices are written to by the kernel.
+    static constexpr bool WRITE = Meta::Same<Slice, MutSlice<Inner>>;
+
     usize _addr;
     usize _len;
 
@@ -70,7 +73,7 @@ struct UserSlice {
         if (_addr == 0)
             return Error::invalidInput("null pointer");
 
-        try$(space._validate(vrange()));
+        try$(space._validate(vrange(), WRITE));
         return Ok(Slice{reinterpret_cast<Inner *>(_addr), _len});
     }
 };
@@ -1,6 +1,8 @@
-#include "vmo.h"
+#include <karm-logger/logger.h>
 
 #include "mem.h"
+#include "space.h"
+#include "vmo.h"
 
 namespace Hjert::Core {
 
@@ -10,6 +12,13 @@ Res<Strong<Vmo>> Vmo::alloc(usize size, Hj::VmoFlags flags) {
     }
 
     try$(ensureAlign(size, Hal::PAGE_SIZE));
+
+    if ((flags & Hj::VmoFlags::LAZY) == Hj::VmoFlags::LAZY) {
+        Lazy lazy{size, {}};
+        lazy.pages.resize(size / Hal::PAGE_SIZE, NONE);
+        return Ok(makeStrong<Vmo>(std::move(lazy)));
+    }
+
     Hal::PmmMem mem = try$(pmm().allocOwned(size, flags | Hal::PmmFlags::UPPER));
     return Ok(makeStrong<Vmo>(std::move(mem)));
 }
@@ -32,8 +41,114 @@ Hal::PmmRange Vmo::range() {
             [](Hal::DmaRange const &range) {
                 return range.as<Hal::PmmRange>();
             },
+            [](Lazy const &) -> Hal::PmmRange {
+                panic("lazy vmo doesn't have a contiguous range");
+            },
         }
     );
 }
 
+usize Vmo::len() {
+    return _mem.visit(
+        Visitor{
+            [](Hal::PmmMem const &mem) {
+                return mem.range().size;
+            },
+            [](Hal::DmaRange const &range) {
+                return range.size;
+            },
+            [](Lazy const &lazy) {
+                return lazy.len;
+            },
+        }
+    );
+}
+
+usize Vmo::committed() {
+    ObjectLockScope scope(*this);
+
+    if (not isLazy())
+        return len();
+
+    usize res = 0;
+    for (auto &page : _mem.unwrap<Lazy>().pages)
+        if (page)
+            res += Hal::PAGE_SIZE;
+    return res;
+}
+
+Res<Strong<Vmo>> Vmo::clone() {
+    ObjectLockScope scope(*this);
+
+    if (not isLazy())
+        return Error::invalidInput("only lazy vmos can be cloned");
+
+    // NOTE: Pages are now shared, so existing writable mappings must fault
+    //       on the next write to give this vmo its own copy.
+    for (auto &mapping : _mappings)
+        if (mapping.flags.has(Hj::MapFlags::WRITE))
+            try$(mapping.space->_protect(mapping.vrange, mapping.flags));
+
+    auto &lazy = _mem.unwrap<Lazy>();
+    Lazy copy{lazy.len, {}};
+    copy.pages.ensure(lazy.pages.len());
+    for (auto &page : lazy.pages)
+        copy.pages.pushBack(page);
+
+    auto vmo = makeStrong<Vmo>(std::move(copy));
+    return Ok(vmo);
+}
+
+static Res<Strong<Vmo::Page>> _allocPage() {
+    auto mem = try$(pmm().allocOwned(Hal::PAGE_SIZE, Hal::PmmFlags::UPPER));
+    zeroFill(try$(kmm().pmm2Kmm(mem.range())).mutBytes());
+    return Ok(makeStrong<Vmo::Page>(std::move(mem)));
+}
+
+Res<Vmo::Commit> Vmo::_commitUnlock(usize off, bool write) {
+    if (not isLazy())
+        return Error::invalidInput("vmo is not lazy");
+
+    auto &lazy = _mem.unwrap<Lazy>();
+    usize index = off / Hal::PAGE_SIZE;
+    if (index >= lazy.pages.len())
+        return Error::invalidInput("offset out of range");
+
+    auto &slot = lazy.pages[index];
+
+    if (not slot) {
+        slot = try$(_allocPage());
+        return Ok(Commit{slot.unwrap()->paddr(), true, false});
+    }
+
+    auto &page = slot.unwrap();
+
+    if (page.refs() == 1)
+        return Ok(Commit{page->paddr(), true, false});
+
+    if (not write)
+        return Ok(Commit{page->paddr(), false, false});
+
+    auto priv = try$(_allocPage());
+    auto src = try$(kmm().pmm2Kmm(page->mem.range()));
+    auto dst = try$(kmm().pmm2Kmm(priv->mem.range()));
+    copy(src.bytes(), dst.mutBytes());
+    slot = priv;
+
+    return Ok(Commit{priv->paddr(), true, true});
+}
+
+void Vmo::_attachUnlock(Mapping mapping) {
+    _mappings.pushBack(mapping);
+}
+
+void Vmo::_detachUnlock(Space &space, Hal::VmmRange vrange) {
+    for (usize i = 0; i < _mappings.len(); i++) {
+        if (_mappings[i].space == &space and _mappings[i].vrange == vrange) {
+            _mappings.removeAt(i);
+            return;
+        }
+    }
+}
+
 } // namespace Hjert::Core
@@ -1,26 +1,86 @@
 #pragma once
 
 #include <hal/io.h>
+#include <karm-base/vec.h>
 
 #include "object.h"
 
 namespace Hjert::Core {
 
+struct Space;
+
 struct Vmo : public BaseObject<Vmo, Hj::Type::VMO> {
-    using _Mem = Union<Hal::PmmMem, Hal::DmaRange>;
+    // A physical page backing a lazily-committed vmo, it's shared between
+    // copy-on-write clones until one of them writes to it.
+    struct Page {
+        Hal::PmmMem mem;
+
+        Page(Hal::PmmMem mem)
+            : mem(std::move(mem)) {}
+
+        usize paddr() const {
+            return mem.range().start;
+        }
+    };
+
+    struct Lazy {
+        usize len;
+        Vec<Opt<Strong<Page>>> pages;
+    };
+
+    struct Commit {
+        usize paddr;
+        bool writable;
+        bool copied;
+    };
+
+    using _Mem = Union<Hal::PmmMem, Hal::DmaRange, Lazy>;
     _Mem _mem;
 
+    // Where this vmo is mapped, those mappings need to be updated when
+    // pages are shared with a clone or made private again.
+    struct Mapping {
+        Space *space;
+        Hal::VmmRange vrange;
+        usize off;
+        Flags<Hj::MapFlags> flags;
+    };
+
+    Vec<Mapping> _mappings;
+
     static Res<Strong<Vmo>> alloc(usize size, Hj::VmoFlags);
 
     static Res<Strong<Vmo>> makeDma(Hal::DmaRange prange);
 
     Vmo(_Mem mem) : _mem(std::move(mem)) {}
 
+    // Physical range of an eagerly allocated or dma vmo.
     Hal::PmmRange range();
 
+    usize len();
+
+    // Number of bytes currently backed by physical memory.
+    usize committed();
+
     bool isDma() {
         return _mem.is<Hal::DmaRange>();
     }
+
+    bool isLazy() {
+        return _mem.is<Lazy>();
+    }
+
+    // Create a copy-on-write clone of a lazy vmo.
+    Res<Strong<Vmo>> clone();
+
+    // Return the physical page backing `off`, allocating and zeroing it
+    // if it was never accessed. When `write` is set, pages shared with a
+    // clone are copied first so the write stays private to this vmo.
+    Res<Commit> _commitUnlock(usize off, bool write);
+
+    void _attachUnlock(Mapping mapping);
+
+    void _detachUnlock(Space &space, Hal::VmmRange vrange);
 };
 
 } // namespace Hjert::Core
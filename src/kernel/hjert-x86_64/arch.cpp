@@ -183,16 +183,27 @@ void kPanic(Frame &frame) {
     panic("cpu exception");
 }
 
+static constexpr usize PAGE_FAULT = 14;
+static constexpr usize PAGE_FAULT_WRITE = 1 << 1;
+
+// Give the task's space a chance to commit lazily mapped pages or to break
+// copy-on-write sharing before treating the fault as a crash.
+bool handlePageFault(Frame &frame) {
+    auto addr = x86_64::rdcr2();
+    bool write = frame.errNo & PAGE_FAULT_WRITE;
+    return (bool)Core::Task::self().space().fault(addr, write);
+}
+
 extern "C" void _intDispatch(usize sp) {
     auto &frame = *reinterpret_cast<Frame *>(sp);
 
     globalCpu().beginInterrupt();
 
     if (frame.intNo < 32) {
-        if (frame.cs == (x86_64::Gdt::UCODE * 8 | 3))
-            uPanic(frame);
-        else
+        if (frame.cs != (x86_64::Gdt::UCODE * 8 | 3))
             kPanic(frame);
+        else if (frame.intNo != PAGE_FAULT or not handlePageFault(frame))
+            uPanic(frame);
     } else if (frame.intNo == 100) {
         switchTask(0_ms, frame);
     } else {
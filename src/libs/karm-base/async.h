@@ -3,9 +3,13 @@
 // Based on https://github.com/managarm/libasync
 // Copyright 2016-2020 libasync Contributors
 
+#include "array.h"
+#include "limits.h"
 #include "list.h"
+#include "macros.h"
 #include "rc.h"
 #include "res.h"
+#include "vec.h"
 
 namespace Karm::Async {
 
@@ -205,6 +209,14 @@ static inline void detach(S s) {
 // MARK: Cancelation -----------------------------------------------------------
 
 struct Cancelation : public Meta::Static {
+    struct Listener {
+        LlItem<Listener> item;
+
+        virtual ~Listener() = default;
+
+        virtual void cancel() = 0;
+    };
+
     struct Token {
         Cancelation *_c = nullptr;
 
@@ -214,12 +226,56 @@ struct Cancelation : public Meta::Static {
         bool canceled() const {
             return _c and _c->canceled();
         }
+
+        Res<> check() const {
+            if (canceled())
+                return Error::interrupted("operation canceled");
+            return Ok();
+        }
+    };
+
+    struct _Parent : public Listener {
+        Cancelation &_self;
+
+        _Parent(Cancelation &self) : _self{self} {}
+
+        void cancel() override {
+            _self.cancel();
+        }
     };
 
     bool _canceled = false;
+    Ll<Listener> _listeners;
+    Token _parent;
+    _Parent _link{*this};
+
+    Cancelation() = default;
+
+    // Gets canceled along with `parent`.
+    Cancelation(Token parent) : _parent{parent} {
+        if (not _parent._c)
+            return;
+        if (_parent.canceled())
+            _canceled = true;
+        else
+            _parent._c->attach(_link);
+    }
+
+    ~Cancelation() {
+        if (_parent._c)
+            _parent._c->detach(_link);
+    }
 
     void cancel() {
+        if (_canceled)
+            return;
         _canceled = true;
+
+        // NOTE: A listener usually resumes whoever was waiting, which can
+        //       attach or detach other listeners, so each one is taken off
+        //       the list before it's called.
+        while (_listeners.head())
+            _listeners.detach(_listeners.head())->cancel();
     }
 
     void reset() {
@@ -233,6 +289,43 @@ struct Cancelation : public Meta::Static {
     Token token() {
         return Token{*this};
     }
+
+    void attach(Listener &listener) {
+        _listeners.append(&listener, _listeners.tail());
+    }
+
+    void detach(Listener &listener) {
+        if (listener.item or _listeners.head() == &listener)
+            _listeners.detach(&listener);
+    }
+};
+
+// Calls `fn` if the token gets canceled while this is alive, or right away
+// if it already was.
+template <typename F>
+struct OnCancel :
+    public Cancelation::Listener,
+    Meta::Static {
+
+    Cancelation::Token _ct;
+    F _fn;
+
+    OnCancel(Cancelation::Token ct, F fn)
+        : _ct{ct}, _fn{std::move(fn)} {
+        if (_ct.canceled())
+            _fn();
+        else if (_ct._c)
+            _ct._c->attach(*this);
+    }
+
+    ~OnCancel() {
+        if (_ct._c)
+            _ct._c->detach(*this);
+    }
+
+    void cancel() override {
+        _fn();
+    }
 };
 
 // MARK: Promise ---------------------------------------------------------------
@@ -342,6 +435,85 @@ struct _Promise : public Meta::NoCopy {
 template <typename V = None, typename E = Error>
 using Promise = _Promise<Res<V, E>>;
 
+// MARK: Frames ----------------------------------------------------------------
+
+struct FrameStats {
+    usize allocs = 0; // Frames that had to come from the heap
+    usize reuses = 0; // Frames that were recycled from the pool
+};
+
+// Keeps the frames of finished coroutines around, sorted by size, so that
+// the next coroutines of the same size don't go through the heap.
+struct _FramePool : public Meta::Static {
+    static constexpr usize GRANULE = 64;
+    static constexpr usize BUCKETS = 32;
+    static constexpr usize DEPTH = 256;
+
+    struct _Free {
+        _Free *next;
+    };
+
+    Array<_Free *, BUCKETS> _free{};
+    Array<usize, BUCKETS> _len{};
+    FrameStats _stats{};
+
+    _FramePool() = default;
+
+    ~_FramePool() {
+        for (auto *f : _free) {
+            while (f)
+                ::operator delete(std::exchange(f, f->next));
+        }
+    }
+
+    static usize _bucket(usize size) {
+        return (size + GRANULE - 1) / GRANULE - 1;
+    }
+
+    void *alloc(usize size) {
+        usize b = _bucket(size);
+        if (b >= BUCKETS) {
+            _stats.allocs++;
+            return ::operator new(size);
+        }
+
+        if (auto *f = _free[b]) {
+            _free[b] = f->next;
+            _len[b]--;
+            _stats.reuses++;
+            return f;
+        }
+
+        _stats.allocs++;
+        return ::operator new((b + 1) * GRANULE);
+    }
+
+    void free(void *ptr, usize size) {
+        usize b = _bucket(size);
+        if (b >= BUCKETS or _len[b] >= DEPTH) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        auto *f = static_cast<_Free *>(ptr);
+        f->next = _free[b];
+        _free[b] = f;
+        _len[b]++;
+    }
+};
+
+// NOTE: A frame freed on another thread than the one that allocated it
+//       simply ends up in the pool of that thread.
+inline _FramePool &_framePool() {
+    static threadLocal$ _FramePool pool;
+    return pool;
+}
+
+// Frame allocations of the calling thread since it started.
+inline FrameStats const &frameStats() {
+    return _framePool()._stats;
+}
+
 // MARK: Task ------------------------------------------------------------------
 
 enum struct Cfp {
@@ -358,6 +530,14 @@ struct _Task {
         Continuation<T> *_resume = nullptr;
         Cfp _cfp = Cfp::INDETERMINATE;
 
+        static void *operator new(usize size) {
+            return _framePool().alloc(size);
+        }
+
+        static void operator delete(void *ptr, usize size) {
+            _framePool().free(ptr, size);
+        }
+
         _Task get_return_object() {
             return _Task{std::coroutine_handle<promise_type>::from_promise(*this)};
         }
@@ -463,4 +643,195 @@ _Task<typename S::Inner> makeTask(S s) {
     co_return co_await std::move(s);
 }
 
+// MARK: Combinators -----------------------------------------------------------
+
+// Runs every task and returns the result of the first one to finish, the
+// others are canceled through `c` and waited for, so none of them outlives
+// the race.
+template <typename T>
+_Task<T> race(Cancelation &c, Vec<_Task<T>> tasks) {
+    if (not tasks.len()) [[unlikely]]
+        panic("race() called without any task");
+
+    struct State {
+        usize pending;
+        Opt<T> first = NONE;
+        Promise<> done{};
+    };
+
+    auto state = makeStrong<State>(tasks.len());
+    auto done = state->done.future();
+    for (auto &task : tasks) {
+        detach(std::move(task), [state, &c](T r) mutable {
+            if (not state->first) {
+                state->first = std::move(r);
+                c.cancel();
+            }
+
+            if (--state->pending == 0)
+                state->done.resolve(Ok());
+        });
+    }
+
+    (void)co_await done;
+    co_return state->first.take();
+}
+
+template <typename T, typename... Ts>
+_Task<T> race(Cancelation &c, _Task<T> task, Ts... others) {
+    Vec<_Task<T>> tasks;
+    tasks.pushBack(std::move(task));
+    (tasks.pushBack(std::move(others)), ...);
+    return race(c, std::move(tasks));
+}
+
+// Runs every task and returns their values in order, on the first error
+// the others are canceled through `c` and waited for.
+template <typename V, typename E>
+_Task<Res<Vec<V>, E>> all(Cancelation &c, Vec<_Task<Res<V, E>>> tasks) {
+    struct State {
+        usize pending;
+        Vec<Opt<V>> values{};
+        Opt<E> error = NONE;
+        Promise<> done{};
+    };
+
+    auto state = makeStrong<State>(tasks.len() + 1);
+    auto done = state->done.future();
+    auto settle = [state]() mutable {
+        if (--state->pending == 0)
+            state->done.resolve(Ok());
+    };
+
+    for (usize i = 0; i < tasks.len(); i++)
+        state->values.pushBack(NONE);
+
+    for (usize i = 0; i < tasks.len(); i++) {
+        detach(std::move(tasks[i]), [state, settle, &c, i](Res<V, E> r) mutable {
+            if (r) {
+                state->values[i] = r.take();
+            } else if (not state->error) {
+                state->error = r.none();
+                c.cancel();
+            }
+            settle();
+        });
+    }
+
+    // NOTE: The extra pending count keeps tasks that finish inline from
+    //       resolving the promise before all of them are started.
+    settle();
+    (void)co_await done;
+
+    if (state->error)
+        co_return state->error.take();
+
+    Vec<V> values;
+    for (auto &v : state->values)
+        values.pushBack(v.take());
+    co_return Ok(std::move(values));
+}
+
+template <typename V, typename E, typename... Ts>
+_Task<Res<Vec<V>, E>> all(Cancelation &c, _Task<Res<V, E>> task, Ts... others) {
+    Vec<_Task<Res<V, E>>> tasks;
+    tasks.pushBack(std::move(task));
+    (tasks.pushBack(std::move(others)), ...);
+    return all(c, std::move(tasks));
+}
+
+// MARK: Group -----------------------------------------------------------------
+
+// Runs detached tasks, at most `max` at the same time, and cancels all of
+// them at once. Their results are dropped, errors are for the tasks to
+// handle themselves.
+struct Group : public Meta::Static {
+    struct _State : public Cancelation::Listener {
+        usize max;
+        usize running = 0;
+        Cancelation cancelation;
+        Vec<Promise<>> slots{};
+        Vec<Promise<>> idle{};
+
+        _State(usize max, Cancelation::Token parent)
+            : max{max}, cancelation{parent} {
+            if (not cancelation.canceled())
+                cancelation.attach(*this);
+        }
+
+        ~_State() {
+            cancelation.detach(*this);
+        }
+
+        // Tasks waiting for a slot would never get one.
+        void cancel() override {
+            _wake(slots, slots.len());
+        }
+    };
+
+    Strong<_State> _state;
+
+    // Also gets canceled along with `parent`.
+    Group(usize max = Limits<usize>::MAX, Cancelation::Token parent = {})
+        : _state{makeStrong<_State>(max, parent)} {}
+
+    ~Group() {
+        cancel();
+    }
+
+    // The tasks of the group must be made with this token.
+    Cancelation::Token token() {
+        return _state->cancelation.token();
+    }
+
+    usize len() const {
+        return _state->running;
+    }
+
+    bool canceled() const {
+        return _state->cancelation.canceled();
+    }
+
+    void cancel() {
+        _state->cancelation.cancel();
+    }
+
+    // Waits for a free slot and starts `task` in it.
+    _Task<Res<>> spawnAsync(_Task<Res<>> task) {
+        auto state = _state;
+        while (state->running >= state->max and not state->cancelation.canceled()) {
+            state->slots.pushBack(Promise<>{});
+            (void)co_await state->slots[state->slots.len() - 1].future();
+        }
+
+        if (state->cancelation.canceled())
+            co_return Error::interrupted("group canceled");
+
+        state->running++;
+        detach(std::move(task), [state](Res<>) mutable {
+            state->running--;
+            _wake(state->slots, 1);
+            if (state->running == 0)
+                _wake(state->idle, state->idle.len());
+        });
+
+        co_return Ok();
+    }
+
+    // Waits until none of the tasks are running.
+    _Task<Res<>> joinAsync() {
+        auto state = _state;
+        while (state->running) {
+            state->idle.pushBack(Promise<>{});
+            (void)co_await state->idle[state->idle.len() - 1].future();
+        }
+        co_return Ok();
+    }
+
+    static void _wake(Vec<Promise<>> &waiters, usize n) {
+        for (usize i = 0; i < n and waiters.len(); i++)
+            waiters.removeAt(0).resolve(Ok());
+    }
+};
+
 } // namespace Karm::Async
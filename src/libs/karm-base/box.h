@@ -102,7 +102,7 @@ struct Box {
 };
 
 template <typename T, typename... Args>
-constexpr static Box<T> makeBox(Args... args) {
+constexpr static Box<T> makeBox(Args &&...args) {
     return {MOVE, new T(std::forward<Args>(args)...)};
 }
 
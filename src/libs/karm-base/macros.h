@@ -65,6 +65,16 @@ namespace Karm {
 // inserts commas between the results.
 #define mapList$(f, ...) eval$(__mapList1(f, __VA_ARGS__, ()()(), ()()(), ()()(), 0))
 
+// MARK: Storage ---------------------------------------------------------------
+
+// Per-thread storage where there are threads, the other systems run a
+// single one and don't set up tls, they get a plain static instead.
+#if defined(__ck_sys_linux__) || defined(__ck_sys_darwin__)
+#    define threadLocal$ thread_local
+#else
+#    define threadLocal$
+#endif
+
 // MARK: Utilities -------------------------------------------------------------
 
 template <typename T, typename U>
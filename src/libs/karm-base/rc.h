@@ -236,6 +236,13 @@ struct Strong {
         return _cell->inspect();
     }
 
+    /// Returns the number of strong references to the object.
+    usize refs() const {
+        ensure();
+        LockScope scope(_cell->_lock);
+        return _cell->_strong;
+    }
+
     template <typename U>
     constexpr Opt<Strong<U>> cast() {
         if (not is<U>()) {
@@ -30,6 +30,19 @@ test$("task-outer") {
     return Ok();
 }
 
+test$("task-frame-reuse") {
+    expectEq$(Async::run(taskOuter()), 42);
+
+    auto allocs = Async::frameStats().allocs;
+    auto reuses = Async::frameStats().reuses;
+    for (usize i = 0; i < 8; i++)
+        expectEq$(Async::run(taskOuter()), 42);
+
+    expectEq$(Async::frameStats().allocs, allocs);
+    expectEq$(Async::frameStats().reuses, reuses + 16);
+    return Ok();
+}
+
 test$("task-detach") {
     int res = 0xdead;
     Async::detach(taskValue(), [&](int r) {
@@ -73,4 +86,92 @@ test$("promise-multiple-futures") {
 
     return Ok();
 }
+
+// Waits on `promise` until it's resolved or the token is canceled.
+Async::Task<int> taskPending(Async::Promise<int> &promise, Async::Cancelation::Token ct) {
+    auto future = promise.future();
+    Async::OnCancel onCancel{ct, [&] {
+        promise.resolve(Error::interrupted("operation canceled"));
+    }};
+    co_return co_await future;
+}
+
+Async::Task<int> taskReady(int value) {
+    co_return Ok(value);
+}
+
+test$("cancelation-parent") {
+    Async::Cancelation parent;
+    Async::Cancelation child{parent.token()};
+    expect$(not child.canceled());
+    parent.cancel();
+    expect$(child.canceled());
+    return Ok();
+}
+
+test$("race-first-wins") {
+    Async::Cancelation c;
+    Async::Promise<int> slow;
+    auto res = Async::run(Async::race(c, taskPending(slow, c.token()), taskReady(42)));
+    expectEq$(res.unwrap(), 42);
+    expect$(c.canceled());
+    return Ok();
+}
+
+test$("all-values") {
+    Async::Cancelation c;
+    auto res = Async::run(Async::all(c, taskReady(1), taskReady(2), taskReady(3)));
+    auto values = res.unwrap();
+    expectEq$(values.len(), 3uz);
+    expectEq$(values[0], 1);
+    expectEq$(values[2], 3);
+    expect$(not c.canceled());
+    return Ok();
+}
+
+test$("all-error-cancels") {
+    Async::Cancelation c;
+    Async::Promise<int> slow;
+    Async::Promise<int> failing;
+    Opt<Res<Vec<int>>> res;
+    Async::detach(Async::all(c, taskPending(slow, c.token()), taskPending(failing, c.token())), [&](Res<Vec<int>> r) {
+        res = std::move(r);
+    });
+
+    expect$(not res);
+    failing.resolve(Error::invalidData("bad"));
+    expect$(res);
+    expect$(not res.unwrap());
+    expect$(c.canceled());
+    return Ok();
+}
+
+test$("group-bounded") {
+    Async::Group group{1};
+    Async::Promise<int> first;
+    Async::Promise<int> second;
+
+    auto wrap = [](Async::Task<int> task) -> Async::Task<> {
+        co_trya$(std::move(task));
+        co_return Ok();
+    };
+
+    expect$(Async::run(group.spawnAsync(wrap(taskPending(first, group.token())))));
+    expectEq$(group.len(), 1uz);
+
+    bool spawned = false;
+    Async::detach(group.spawnAsync(wrap(taskPending(second, group.token()))), [&](Res<> r) {
+        spawned = r.has();
+    });
+    expect$(not spawned);
+
+    first.resolve(Ok(1));
+    expect$(spawned);
+    expectEq$(group.len(), 1uz);
+
+    group.cancel();
+    expectEq$(group.len(), 0uz);
+    expect$(Async::run(group.joinAsync()));
+    return Ok();
+}
 } // namespace Karm::Base::Tests
@@ -0,0 +1,68 @@
+#include "adler32.h"
+
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+
+#    include <immintrin.h>
+
+namespace Karm::Crypto {
+
+[[gnu::target("ssse3")]]
+usize _adler32Ssse3(u32 &state, Bytes bytes) {
+    static constexpr usize BLOCK = 32;
+
+    u32 s1 = state & 0xffff;
+    u32 s2 = state >> 16;
+
+    auto const *buf = bytes.buf();
+    usize blocks = bytes.len() / BLOCK;
+
+    // NOTE: Each byte of a block adds its weight, from 32 down to 1, times
+    //       itself to s2, and s1 as it was before the block 32 times.
+    auto const tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    auto const tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    auto const zero = _mm_setzero_si128();
+    auto const ones = _mm_set1_epi16(1);
+
+    while (blocks) {
+        usize n = min(Adler32::NMAX / BLOCK, blocks);
+        blocks -= n;
+
+        auto vps = _mm_set_epi32(0, 0, 0, s1 * n);
+        auto vs2 = _mm_set_epi32(0, 0, 0, s2);
+        auto vs1 = _mm_setzero_si128();
+
+        do {
+            auto b1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(buf));
+            auto b2 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(buf + 16));
+
+            vps = _mm_add_epi32(vps, vs1);
+
+            vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(b1, zero));
+            vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(b1, tap1), ones));
+
+            vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(b2, zero));
+            vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(b2, tap2), ones));
+
+            buf += BLOCK;
+        } while (--n);
+
+        vs2 = _mm_add_epi32(vs2, _mm_slli_epi32(vps, 5));
+
+        vs1 = _mm_add_epi32(vs1, _mm_shuffle_epi32(vs1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += _mm_cvtsi128_si32(vs1);
+
+        vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(2, 3, 0, 1)));
+        vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = _mm_cvtsi128_si32(vs2);
+
+        s1 %= Adler32::BASE;
+        s2 %= Adler32::BASE;
+    }
+
+    state = (s2 << 16) | s1;
+    return buf - bytes.buf();
+}
+
+} // namespace Karm::Crypto
+
+#endif
@@ -3,26 +3,53 @@
 #include <karm-base/endian.h>
 
 #include "base.h"
+#include "cpu.h"
 
 // https://en.wikipedia.org/wiki/Adler-32
 
 namespace Karm::Crypto {
 
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+// Sums 32 bytes per iteration with horizontal adds, only whole blocks of
+// 32 bytes are consumed, returns how many bytes were.
+usize _adler32Ssse3(u32 &state, Bytes bytes);
+#endif
+
 struct Adler32 {
     using Digest = Digest<32, struct Adler32>;
 
+    static constexpr u32 BASE = 65521;
+
+    // NOTE: Largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits in
+    //       32 bits, the sums only need to be reduced that often.
+    static constexpr usize NMAX = 5552;
+
     u32 _state = 1;
 
-    void add(Bytes bytes) {
-        u32 s1 = _state & 0xffff;
-        u32 s2 = _state >> 16;
+    static u32 _scalar(u32 state, Bytes bytes) {
+        u32 s1 = state & 0xffff;
+        u32 s2 = state >> 16;
 
-        for (usize i = 0; i < bytes.len(); ++i) {
-            s1 = (s1 + bytes[i]) % 65521;
-            s2 = (s2 + s1) % 65521;
+        while (bytes.len() > 0) {
+            auto chunk = sub(bytes, 0, NMAX);
+            for (auto b : chunk) {
+                s1 += b;
+                s2 += s1;
+            }
+            s1 %= BASE;
+            s2 %= BASE;
+            bytes = next(bytes, chunk.len());
         }
 
-        _state = (s2 << 16) + s1;
+        return (s2 << 16) | s1;
+    }
+
+    void add(Bytes bytes) {
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+        if (cpuFeatures().ssse3)
+            bytes = next(bytes, _adler32Ssse3(_state, bytes));
+#endif
+        _state = _scalar(_state, bytes);
     }
 
     void reset() {
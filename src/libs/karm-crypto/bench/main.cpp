@@ -0,0 +1,44 @@
+#include <karm-crypto/hash.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+static constexpr usize SIZE = 64 * 1024 * 1024;
+static constexpr usize ROUNDS = 8;
+
+static Str _yesNo(bool value) {
+    return value ? "yes"s : "no"s;
+}
+
+void bench(Str name, Crypto::AnyHash hash, Bytes buf) {
+    auto start = Sys::now();
+    for (usize i = 0; i < ROUNDS; i++) {
+        hash.reset();
+        hash.add(buf);
+    }
+    auto elapsed = Sys::now() - start;
+    auto usecs = max(elapsed.toUSecs(), 1uz);
+
+    // NOTE: Bytes per microsecond are megabytes per second.
+    f64 throughput = (f64)(buf.len() * ROUNDS) / usecs / 1e3;
+    Sys::println("{}: {} GB/s ({})", name, throughput, hash.digest());
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    auto const &features = Crypto::cpuFeatures();
+    Sys::println("pclmul: {}, ssse3: {}, sse4.1: {}, sha: {}",
+                 _yesNo(features.pclmul),
+                 _yesNo(features.ssse3),
+                 _yesNo(features.sse41),
+                 _yesNo(features.sha));
+
+    Vec<u8> buf;
+    buf.ensure(SIZE);
+    for (usize i = 0; i < SIZE; i++)
+        buf.pushBack((i * 2654435761u) >> 13);
+
+#define ITER(NAME, TYPE) bench(#NAME, Crypto::HashType::NAME, buf);
+    FOR_EACH_HASH(ITER)
+#undef ITER
+
+    co_return Ok();
+}
@@ -0,0 +1,51 @@
+#include "cpu.h"
+
+namespace Karm::Crypto {
+
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+
+struct _Cpuid {
+    u32 eax, ebx, ecx, edx;
+};
+
+static _Cpuid _cpuid(u32 leaf, u32 subleaf = 0) {
+    _Cpuid r;
+    asm volatile("cpuid"
+                 : "=a"(r.eax), "=b"(r.ebx), "=c"(r.ecx), "=d"(r.edx)
+                 : "a"(leaf), "c"(subleaf));
+    return r;
+}
+
+static CpuFeatures _detect() {
+    CpuFeatures features{};
+    auto maxLeaf = _cpuid(0).eax;
+
+    if (maxLeaf >= 1) {
+        auto r = _cpuid(1);
+        features.pclmul = r.ecx & (1 << 1);
+        features.ssse3 = r.ecx & (1 << 9);
+        features.sse41 = r.ecx & (1 << 19);
+    }
+
+    if (maxLeaf >= 7) {
+        auto r = _cpuid(7);
+        features.sha = r.ebx & (1 << 29);
+    }
+
+    return features;
+}
+
+#else
+
+static CpuFeatures _detect() {
+    return {};
+}
+
+#endif
+
+CpuFeatures const &cpuFeatures() {
+    static CpuFeatures features = _detect();
+    return features;
+}
+
+} // namespace Karm::Crypto
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <karm-base/std.h>
+
+namespace Karm::Crypto {
+
+// Instruction set extensions the accelerated paths rely on, they are
+// detected once and all false on targets without such paths.
+struct CpuFeatures {
+    bool ssse3;
+    bool sse41;
+    bool pclmul;
+    bool sha;
+};
+
+CpuFeatures const &cpuFeatures();
+
+} // namespace Karm::Crypto
@@ -0,0 +1,86 @@
+#include "crc32.h"
+
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+
+#    include <immintrin.h>
+
+namespace Karm::Crypto {
+
+// NOTE: Constants are x^n mod P for the bit-reflected polynomial, see
+//       the paper linked in the header for how they are derived.
+alignas(16) static u64 const K1K2[] = {0x0154442bd4, 0x01c6e41596};
+alignas(16) static u64 const K3K4[] = {0x01751997d0, 0x00ccaa009e};
+alignas(16) static u64 const K5K0[] = {0x0163cd6124, 0x0000000000};
+alignas(16) static u64 const POLY[] = {0x01db710641, 0x01f7011641};
+
+[[gnu::target("pclmul")]]
+static inline __m128i _fold(__m128i x, __m128i k, __m128i data) {
+    auto lo = _mm_clmulepi64_si128(x, k, 0x00);
+    auto hi = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(hi, lo), data);
+}
+
+[[gnu::target("pclmul,sse4.1")]]
+u32 _crc32Clmul(u32 state, Bytes bytes) {
+    auto const *buf = bytes.buf();
+    usize len = bytes.len();
+
+    auto load = [&](usize off) {
+        return _mm_loadu_si128(reinterpret_cast<__m128i const *>(buf + off));
+    };
+
+    auto x1 = _mm_xor_si128(load(0x00), _mm_cvtsi32_si128(state));
+    auto x2 = load(0x10);
+    auto x3 = load(0x20);
+    auto x4 = load(0x30);
+    buf += 64;
+    len -= 64;
+
+    // Fold four lanes at once while there are whole blocks of 64 bytes
+    auto k = _mm_load_si128(reinterpret_cast<__m128i const *>(K1K2));
+    while (len >= 64) {
+        x1 = _fold(x1, k, load(0x00));
+        x2 = _fold(x2, k, load(0x10));
+        x3 = _fold(x3, k, load(0x20));
+        x4 = _fold(x4, k, load(0x30));
+        buf += 64;
+        len -= 64;
+    }
+
+    // Fold the lanes into one, then the remaining blocks of 16 bytes
+    k = _mm_load_si128(reinterpret_cast<__m128i const *>(K3K4));
+    x1 = _fold(x1, k, x2);
+    x1 = _fold(x1, k, x3);
+    x1 = _fold(x1, k, x4);
+
+    while (len >= 16) {
+        x1 = _fold(x1, k, load(0));
+        buf += 16;
+        len -= 16;
+    }
+
+    // Fold 128 bits down to 64
+    auto mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    k = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(K5K0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask);
+    x1 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction down to 32 bits
+    k = _mm_load_si128(reinterpret_cast<__m128i const *>(POLY));
+    x2 = _mm_and_si128(x1, mask);
+    x2 = _mm_clmulepi64_si128(x2, k, 0x10);
+    x2 = _mm_and_si128(x2, mask);
+    x2 = _mm_clmulepi64_si128(x2, k, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return _mm_extract_epi32(x1, 1);
+}
+
+} // namespace Karm::Crypto
+
+#endif
@@ -1,42 +1,80 @@
 #pragma once
 
+#include <karm-base/align.h>
 #include <karm-base/endian.h>
 
 #include "base.h"
+#include "cpu.h"
 
 // https://en.wikipedia.org/wiki/Cyclic_redundancy_check
+// https://www.intel.com/content/dam/www/public/us/en/documents/white-papers/fast-crc-computation-generic-polynomials-pclmulqdq-paper.pdf
 
 namespace Karm::Crypto {
 
+static constexpr u32 CRC32_POLY = 0xedb88320;
+
+// Tables for slicing-by-16, table n gives the crc of a byte followed by n
+// zero bytes, which lets 16 bytes be folded in with independent lookups.
+static constexpr Array<Array<u32, 256>, 16> CRC32_TABLES = [] {
+    Array<Array<u32, 256>, 16> tables{};
+    for (u32 i = 0; i < 256; ++i) {
+        u32 c = i;
+        for (u32 j = 0; j < 8; ++j)
+            c = (c & 1) ? (c >> 1) ^ CRC32_POLY : c >> 1;
+        tables[0][i] = c;
+    }
+
+    for (u32 i = 0; i < 256; ++i)
+        for (usize n = 1; n < 16; ++n)
+            tables[n][i] = (tables[n - 1][i] >> 8) ^ tables[0][tables[n - 1][i] & 0xff];
+
+    return tables;
+}();
+
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+// Folds the bytes four lanes at a time with carry-less multiplications,
+// needs at least 64 bytes and a length that is a multiple of 16.
+u32 _crc32Clmul(u32 state, Bytes bytes);
+#endif
+
 struct Crc32 {
     using Digest = Digest<32, struct Crc32>;
 
+    static constexpr usize CLMUL_MIN = 64;
+
     u32 _state = 0xffffffff;
-    Array<u32, 256> _table{};
-
-    Crc32(u32 poly = 0xedb88320)
-        : _table(makeTable(poly)) {}
-
-    static constexpr Array<u32, 256> makeTable(u32 poly) {
-        Array<u32, 256> table;
-        for (u32 i = 0; i < 256; ++i) {
-            u32 c = i;
-            for (u32 j = 0; j < 8; ++j) {
-                if (c & 1) {
-                    c = (c >> 1) ^ poly;
-                } else {
-                    c >>= 1;
-                }
-            }
-            table[i] = c;
+
+    static u32 _sliced(u32 state, Bytes bytes) {
+        auto const &t = CRC32_TABLES;
+        auto const *b = bytes.buf();
+        usize len = bytes.len();
+
+        while (len >= 16) {
+            u32 a = state ^ (b[0] | b[1] << 8 | b[2] << 16 | (u32)b[3] << 24);
+            state = t[15][a & 0xff] ^ t[14][(a >> 8) & 0xff] ^
+                    t[13][(a >> 16) & 0xff] ^ t[12][a >> 24] ^
+                    t[11][b[4]] ^ t[10][b[5]] ^ t[9][b[6]] ^ t[8][b[7]] ^
+                    t[7][b[8]] ^ t[6][b[9]] ^ t[5][b[10]] ^ t[4][b[11]] ^
+                    t[3][b[12]] ^ t[2][b[13]] ^ t[1][b[14]] ^ t[0][b[15]];
+            b += 16;
+            len -= 16;
         }
-        return table;
+
+        while (len--)
+            state = t[0][(state ^ *b++) & 0xff] ^ (state >> 8);
+
+        return state;
     }
 
     void add(Bytes bytes) {
-        for (usize i = 0; i < bytes.len(); ++i) {
-            _state = _table[(_state ^ bytes[i]) & 0xff] ^ (_state >> 8);
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+        if (bytes.len() >= CLMUL_MIN and cpuFeatures().pclmul and cpuFeatures().sse41) {
+            auto n = alignDown(bytes.len(), 16);
+            _state = _crc32Clmul(_state, sub(bytes, 0, n));
+            bytes = next(bytes, n);
         }
+#endif
+        _state = _sliced(_state, bytes);
     }
 
     void reset() {
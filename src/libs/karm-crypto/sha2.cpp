@@ -0,0 +1,67 @@
+#include "sha2.h"
+
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+
+#    include <immintrin.h>
+
+// https://www.intel.com/content/www/us/en/developer/articles/technical/intel-sha-extensions.html
+
+namespace Karm::Crypto {
+
+[[gnu::target("sha,ssse3,sse4.1")]]
+void _sha256ShaNi(Array<u32, 8> &state, Bytes blocks) {
+    auto const MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+    auto const *buf = blocks.buf();
+
+    // NOTE: The instructions want the state as ABEF and CDGH.
+    auto tmp = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&state[0]));
+    auto state1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xb1);
+    state1 = _mm_shuffle_epi32(state1, 0x1b);
+    auto state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    for (usize i = 0; i + Sha256::BLOCK_SIZE <= blocks.len(); i += Sha256::BLOCK_SIZE) {
+        auto abef = state0;
+        auto cdgh = state1;
+
+        Array<__m128i, 4> m;
+        for (usize j = 0; j < 4; ++j)
+            m[j] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(buf + i + j * 16)), MASK);
+
+        // NOTE: Four rounds at a time, the message schedule for the rounds
+        //       to come is computed in the same pass.
+        for (usize g = 0; g < 16; ++g) {
+            auto k = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&SHA256_K[g * 4]));
+            auto msg = _mm_add_epi32(m[g % 4], k);
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+
+            if (g >= 3 and g <= 14) {
+                auto &w = m[(g + 1) % 4];
+                w = _mm_add_epi32(w, _mm_alignr_epi8(m[g % 4], m[(g + 3) % 4], 4));
+                w = _mm_sha256msg2_epu32(w, m[g % 4]);
+            }
+
+            msg = _mm_shuffle_epi32(msg, 0x0e);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+            if (g >= 1 and g <= 12)
+                m[(g + 3) % 4] = _mm_sha256msg1_epu32(m[(g + 3) % 4], m[g % 4]);
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), state1);
+}
+
+} // namespace Karm::Crypto
+
+#endif
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <karm-base/align.h>
 #include <karm-base/endian.h>
 #include <karm-base/vec.h>
 
 #include "base.h"
+#include "cpu.h"
 
 namespace Karm::Crypto {
 
@@ -18,31 +20,40 @@ static constexpr Array<u32, 64> SHA256_K = {
     0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+// Compresses whole blocks with the SHA extensions.
+void _sha256ShaNi(Array<u32, 8> &state, Bytes blocks);
+#endif
+
+static constexpr Array<u32be, 8> SHA256_INIT = {
+    0x6a09e667,
+    0xbb67ae85,
+    0x3c6ef372,
+    0xa54ff53a,
+    0x510e527f,
+    0x9b05688c,
+    0x1f83d9ab,
+    0x5be0cd19
+};
+
 struct Sha256 {
     static usize const BLOCK_SIZE = 64;
     static usize const ROUNDS = 64;
 
     using Digest = Digest<256, struct Sha256>;
 
-    Array<u32be, 8> _state{};
+    Array<u32be, 8> _state = SHA256_INIT;
     Array<Byte, BLOCK_SIZE> _buf;
     usize _curr = 0;
     usize _total = 0;
 
     void reset() {
-        _state = {
-            0x6a09e667,
-            0xbb67ae85,
-            0x3c6ef372,
-            0xa54ff53a,
-            0x510e527f,
-            0x9b05688c,
-            0x1f83d9ab,
-            0x5be0cd19
-        };
+        _state = SHA256_INIT;
+        _curr = 0;
+        _total = 0;
     }
 
-    void _proc() {
+    void _proc(Bytes block) {
         auto const SIGN0 = [](u32 x) {
             return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3);
         };
@@ -71,7 +82,7 @@ struct Sha256 {
 
         usize i = 0;
         for (usize j = 0; i < 16; ++i, j += 4) {
-            m[i] = (_buf[j] << 24) | (_buf[j + 1] << 16) | (_buf[j + 2] << 8) | _buf[j + 3];
+            m[i] = ((u32)block[j] << 24) | (block[j + 1] << 16) | (block[j + 2] << 8) | block[j + 3];
         }
 
         for (; i < BLOCK_SIZE; ++i) {
@@ -106,34 +117,63 @@ struct Sha256 {
         _state[7] = _state[7] + h;
     }
 
+    // Compresses whole blocks straight from `blocks`.
+    void _compress(Bytes blocks) {
+#if defined(__ck_arch_x86_64__) and not defined(__ck_freestanding__)
+        if (cpuFeatures().sha and cpuFeatures().sse41) {
+            Array<u32, 8> state;
+            for (usize i = 0; i < 8; ++i)
+                state[i] = _state[i];
+            _sha256ShaNi(state, blocks);
+            for (usize i = 0; i < 8; ++i)
+                _state[i] = state[i];
+            return;
+        }
+#endif
+        for (usize i = 0; i < blocks.len(); i += BLOCK_SIZE)
+            _proc(sub(blocks, i, i + BLOCK_SIZE));
+    }
+
     usize _step(Bytes bytes) {
         auto n = copy(bytes, mutSub(_buf, _curr, BLOCK_SIZE));
         _curr += n;
         _total += n;
         if (_curr == BLOCK_SIZE) {
-            _proc();
+            _compress(_buf);
             _curr = 0;
         }
         return n;
     }
 
     void _pad() {
-        auto total = _total;
+        u64be len = _total * 8;
+
         Byte pad = 0x80;
-        _step({&pad, 1});
+        add({&pad, 1});
 
-        Array<u8, 64> zeros{};
-        _step(sub(zeros, 0, ((64 - (_total + 1 + 8)) % 64)));
+        // NOTE: Leave exactly 8 bytes in the last block for the length.
+        Array<u8, BLOCK_SIZE> zeros{};
+        add(sub(zeros, 0, (2 * BLOCK_SIZE - 8 - _curr) % BLOCK_SIZE));
 
-        u32be len = total * 8;
-        _step(len.bytes());
+        add(len.bytes());
     }
 
     void add(Bytes bytes) {
-        while (bytes.len() > 0) {
+        if (_curr) {
             auto n = _step(bytes);
             bytes = next(bytes, n);
         }
+
+        // NOTE: Whole blocks don't need to go through the buffer.
+        if (_curr == 0 and bytes.len() >= BLOCK_SIZE) {
+            auto n = alignDown(bytes.len(), BLOCK_SIZE);
+            _compress(sub(bytes, 0, n));
+            _total += n;
+            bytes = next(bytes, n);
+        }
+
+        if (bytes.len() > 0)
+            _step(bytes);
     }
 
     auto sum() const {
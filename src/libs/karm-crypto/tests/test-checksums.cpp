@@ -0,0 +1,43 @@
+#include <karm-crypto/hash.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Crypto::Tests {
+
+// NOTE: Long enough to go through the accelerated paths, with an odd
+//       length so that they leave a tail behind.
+static Vec<u8> _pattern() {
+    Vec<u8> buf;
+    for (usize i = 0; i < 10000; i++)
+        buf.pushBack((i * 31 + 7) & 0xff);
+    return buf;
+}
+
+test$("crc32-checksum") {
+    expectEq$(checksum<Crc32>(bytes("123456789"s)), 0xcbf43926u);
+
+    auto buf = _pattern();
+    expectEq$(checksum<Crc32>(buf), 0x38e68819u);
+
+    Crc32 crc;
+    crc.add(sub(buf, 0, 77));
+    crc.add(next(buf, 77));
+    expectEq$(crc.sum(), 0x38e68819u);
+
+    return Ok();
+}
+
+test$("adler32-checksum") {
+    expectEq$(checksum<Adler32>(bytes("Wikipedia"s)), 0x11e60398u);
+
+    auto buf = _pattern();
+    expectEq$(checksum<Adler32>(buf), 0x41977596u);
+
+    Adler32 adler;
+    adler.add(sub(buf, 0, 77));
+    adler.add(next(buf, 77));
+    expectEq$(adler.sum(), 0x41977596u);
+
+    return Ok();
+}
+
+} // namespace Karm::Crypto::Tests
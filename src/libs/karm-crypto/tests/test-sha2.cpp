@@ -4,8 +4,6 @@
 namespace Karm::Crypto::Tests {
 
 test$("sha256-hash") {
-    return Ok(); // FIXME: disabled until we have a proper implementation
-
     Sha256 sha256;
 
     Str text1 = "abc";
@@ -35,7 +33,8 @@ test$("sha256-hash") {
     };
 
     sha256.reset();
-    sha256.add(bytes(text3));
+    for (usize i = 0; i < 100000; i++)
+        sha256.add(bytes(text3));
     expectEq$(AnyDigest{sha256.digest()}, hash3);
 
     return Ok();
@@ -308,38 +308,18 @@ void Context::fill(Math::Vec2f baseline, Rune rune) {
 
 void Context::stroke(Math::Vec2f baseline, Str str) {
     auto f = textFont();
-
-    bool first = true;
-    Media::Glyph prev{0};
-    for (auto rune : iterRunes(str)) {
-        auto curr = f.glyph(rune);
-        if (not first)
-            baseline.x += f.kern(prev, curr);
-        else
-            first = false;
-
-        stroke(baseline, curr);
-        baseline.x += f.advance(curr);
-        prev = curr;
-    }
+    auto run = f.shape(str);
+    auto scale = f.scale();
+    for (auto &g : run->glyphs)
+        stroke(baseline + Math::Vec2f{g.pos * scale, 0}, g.glyph);
 }
 
 void Context::fill(Math::Vec2f baseline, Str str) {
     auto f = textFont();
-
-    bool first = true;
-    Media::Glyph prev{0};
-    for (auto rune : iterRunes(str)) {
-        auto curr = f.glyph(rune);
-        if (not first)
-            baseline.x += f.kern(prev, curr);
-        else
-            first = false;
-
-        fill(baseline, curr);
-        baseline.x += f.advance(curr);
-        prev = curr;
-    }
+    auto run = f.shape(str);
+    auto scale = f.scale();
+    for (auto &g : run->glyphs)
+        fill(baseline + Math::Vec2f{g.pos * scale, 0}, g.glyph);
 }
 
 // MARK: Debug -----------------------------------------------------------------
@@ -36,6 +36,7 @@ void Text::append(Rune rune) {
     _runes.pushBack(rune);
     last(_blocks).cellRange.size++;
     last(_blocks).runeRange.end(_runes.len());
+    _blocksMeasured = false;
 }
 
 void Text::clear() {
@@ -57,23 +58,51 @@ void Text::append(Slice<Rune> runes) {
 // MARK: Layout -------------------------------------------------------------
 
 void Text::_measureBlocks() {
+    auto scale = _style.font.scale();
+
+    // NOTE: Shaping can merge several runes into a single glyph, so the
+    //       cells are rebuilt from the shaped runs.
+    Vec<Cell> cells;
+    cells.ensure(_cells.len());
+
     for (auto &block : _blocks) {
-        auto adv = 0.0f;
-        bool first = true;
-        Media::Glyph prev{0};
-        for (auto &cell : block.cells(*this)) {
-            if (not first)
-                adv += _style.font.kern(prev, cell.glyph);
-            else
-                first = false;
-
-            cell.pos = adv;
-            cell.adv = _style.font.advance(cell.glyph);
-            adv += cell.adv;
-            prev = cell.glyph;
+        auto runes = sub(_runes, block.runeRange);
+        bool newline = runes and last(runes) == '\n';
+        if (newline)
+            runes = sub(runes, 0, runes.len() - 1);
+
+        auto run = _style.font.shape(runes);
+
+        block.cellRange = {cells.len(), 0};
+        for (usize i = 0; i < run->glyphs.len(); i++) {
+            auto &g = run->glyphs[i];
+            auto end = i + 1 < run->glyphs.len()
+                           ? run->glyphs[i + 1].cluster
+                           : runes.len();
+
+            cells.pushBack({
+                .runeRange = {block.runeRange.start + g.cluster, end - g.cluster},
+                .glyph = g.glyph,
+                .pos = g.pos * scale,
+                .adv = g.adv * scale,
+            });
         }
-        block.width = adv;
+        block.width = run->width * scale;
+
+        if (newline) {
+            cells.pushBack({
+                .runeRange = {block.runeRange.end() - 1, 1},
+                .glyph = _style.font.glyph(' '),
+                .pos = block.width,
+                .adv = _spaceWidth,
+            });
+            block.width += _spaceWidth;
+        }
+
+        block.cellRange.size = cells.len() - block.cellRange.start;
     }
+
+    _cells = std::move(cells);
 }
 
 void Text::_wrapLines(f64 width) {
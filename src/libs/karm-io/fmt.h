@@ -463,9 +463,14 @@ struct Formatter<f64> {
     Res<usize> format(Io::TextWriter &writer, f64 const &val) {
         NumberFormatter formatter;
         usize written = 0;
-        isize ipart = (isize)val;
-        written += try$(formatter.formatSigned(writer, ipart));
-        f64 fpart = val - (f64)ipart;
+        f64 mag = val;
+        if (val < 0) {
+            written += try$(writer.writeRune('-'));
+            mag = -val;
+        }
+        usize ipart = (usize)mag;
+        written += try$(formatter.formatUnsigned(writer, ipart));
+        f64 fpart = mag - (f64)ipart;
         if (fpart != 0.0) {
             written += try$(writer.writeRune('.'));
             formatter.width = 6;
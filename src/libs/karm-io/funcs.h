@@ -114,4 +114,73 @@ inline Res<usize> copy(Readable auto &reader, Writable auto &writer, usize size)
     return Ok(result);
 }
 
+// MARK: Async -----------------------------------------------------------------
+
+// NOTE: Unlike their sync counterpart these never stop half way, a short
+//       write is retried and an early end of stream is an error.
+
+inline Async::Task<usize> writeAllAsync(AsyncWritable auto &writer, Bytes bytes) {
+    usize written = 0;
+    while (written < bytes.len()) {
+        auto n = co_trya$(writer.writeAsync(next(bytes, written)));
+        if (n == 0)
+            co_return Error::writeZero("failed to write whole buffer");
+        written += n;
+    }
+    co_return Ok(written);
+}
+
+inline Async::Task<usize> readExactAsync(AsyncReadable auto &reader, MutBytes bytes) {
+    usize readed = 0;
+    while (readed < bytes.len()) {
+        auto n = co_trya$(reader.readAsync(mutNext(bytes, readed)));
+        if (n == 0)
+            co_return Error::unexpectedEof("failed to fill whole buffer");
+        readed += n;
+    }
+    co_return Ok(readed);
+}
+
+inline Async::Task<usize> copyAsync(AsyncReadable auto &reader, AsyncWritable auto &writer) {
+    Array<Byte, 16384> buf;
+    usize result = 0;
+    while (true) {
+        auto read = co_trya$(reader.readAsync(mutBytes(buf)));
+        if (read == 0)
+            co_return Ok(result);
+
+        co_trya$(writeAllAsync(writer, sub(buf, 0, read)));
+        result += read;
+    }
+}
+
+// NOTE: For sinks that never block, like buffers in memory.
+inline Async::Task<usize> copyAsync(AsyncReadable auto &reader, Writable auto &writer)
+    requires(not AsyncWritable<decltype(writer)>)
+{
+    Array<Byte, 16384> buf;
+    usize result = 0;
+    while (true) {
+        auto read = co_trya$(reader.readAsync(mutBytes(buf)));
+        if (read == 0)
+            co_return Ok(result);
+
+        auto written = co_try$(writer.write(sub(buf, 0, read)));
+        result += written;
+        if (written != read)
+            co_return Ok(result);
+    }
+}
+
+inline Async::Task<String> readAllUtf8Async(AsyncReadable auto &reader) {
+    StringWriter writer;
+    Array<Utf8::Unit, 4096> buf;
+    while (true) {
+        usize read = co_trya$(reader.readAsync(buf.mutBytes()));
+        if (read == 0)
+            co_return Ok(writer.take());
+        co_try$(writer.writeUnit({buf.buf(), read}));
+    }
+}
+
 } // namespace Karm::Io
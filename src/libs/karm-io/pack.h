@@ -240,17 +240,21 @@ struct Packer<Cons<Car, Cdr>> {
 template <typename... Ts>
 struct Packer<Tuple<Ts...>> {
     static Res<> pack(PackEmit &e, Tuple<Ts...> const &val) {
-        return val.visit([&](auto const &f) {
-            return Io::pack(e, f);
-        });
+        if constexpr (sizeof...(Ts) == 0)
+            return Ok();
+        else
+            return val.visit([&](auto const &f) {
+                return Io::pack(e, f);
+            });
     }
 
     static Res<Tuple<Ts...>> unpack(PackScan &s) {
         Tuple<Ts...> res;
-        try$(res.visit([&]<typename T>(T &f) -> Res<> {
-            f = try$(Io::unpack<T>(s));
-            return Ok();
-        }));
+        if constexpr (sizeof...(Ts) > 0)
+            try$(res.visit([&]<typename T>(T &f) -> Res<> {
+                f = try$(Io::unpack<T>(s));
+                return Ok();
+            }));
         return Ok(res);
     }
 };
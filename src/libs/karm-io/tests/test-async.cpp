@@ -0,0 +1,75 @@
+#include <karm-io/funcs.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Io::Tests {
+
+static Str HELLO = "hello world";
+
+// Hands out at most a few bytes at a time, like a socket under load.
+struct TrickleReader : public AsyncReader {
+    Bytes _data;
+    usize _step;
+
+    TrickleReader(Bytes data, usize step)
+        : _data(data), _step(step) {}
+
+    Async::Task<usize> readAsync(MutBytes buf) override {
+        usize n = min(buf.len(), _step, _data.len());
+        copy(sub(_data, 0, n), buf);
+        _data = next(_data, n);
+        co_return Ok(n);
+    }
+};
+
+struct TrickleWriter : public AsyncWriter {
+    BufferWriter _buf;
+    usize _step;
+
+    TrickleWriter(usize step)
+        : _step(step) {}
+
+    Async::Task<usize> writeAsync(Bytes bytes) override {
+        usize n = min(bytes.len(), _step);
+        co_return _buf.write(sub(bytes, 0, n));
+    }
+};
+
+test$("io-async-write-all") {
+    TrickleWriter writer{3};
+    auto written = try$(Async::run(writeAllAsync(writer, bytes(HELLO))));
+    expectEq$(written, 11uz);
+    expectEq$(writer._buf.bytes(), bytes(HELLO));
+
+    TrickleWriter stuck{0};
+    expect$(not Async::run(writeAllAsync(stuck, bytes(HELLO))));
+
+    return Ok();
+}
+
+test$("io-async-copy") {
+    TrickleReader reader{bytes(HELLO), 2};
+    TrickleWriter writer{3};
+    expectEq$(try$(Async::run(copyAsync(reader, writer))), 11uz);
+    expectEq$(writer._buf.bytes(), bytes(HELLO));
+
+    Str accented = "héllo";
+    TrickleReader text{bytes(accented), 1};
+    expectEq$(try$(Async::run(readAllUtf8Async(text))), "héllo"s);
+
+    return Ok();
+}
+
+test$("io-async-read-exact") {
+    Array<Byte, 4> buf;
+
+    TrickleReader reader{bytes(HELLO), 1};
+    expectEq$(try$(Async::run(readExactAsync(reader, mutBytes(buf)))), 4uz);
+    expectEq$(bytes(buf), sub(bytes(HELLO), 0, 4));
+
+    TrickleReader shortReader{sub(bytes(HELLO), 0, 2), 1};
+    expect$(not Async::run(readExactAsync(shortReader, mutBytes(buf))));
+
+    return Ok();
+}
+
+} // namespace Karm::Io::Tests
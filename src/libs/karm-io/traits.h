@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/async.h>
 #include <karm-base/rune.h>
 #include <karm-base/string.h>
 #include <karm-sys/defs.h>
@@ -28,6 +29,16 @@ concept Flushable = requires(T &flusher) {
     { flusher.flush() } -> Meta::Same<Res<usize>>;
 };
 
+template <typename T>
+concept AsyncWritable = requires(T &writer, Bytes bytes) {
+    { writer.writeAsync(bytes) } -> Meta::Same<Async::Task<usize>>;
+};
+
+template <typename T>
+concept AsyncReadable = requires(T &reader, MutBytes bytes) {
+    { reader.readAsync(bytes) } -> Meta::Same<Async::Task<usize>>;
+};
+
 template <typename T>
 concept Duplexable = Writable<T> and Readable<T>;
 
@@ -57,6 +68,22 @@ struct Reader {
 
 static_assert(Readable<Reader>);
 
+struct AsyncWriter {
+    virtual ~AsyncWriter() = default;
+
+    virtual Async::Task<usize> writeAsync(Bytes) = 0;
+};
+
+static_assert(AsyncWritable<AsyncWriter>);
+
+struct AsyncReader {
+    virtual ~AsyncReader() = default;
+
+    virtual Async::Task<usize> readAsync(MutBytes) = 0;
+};
+
+static_assert(AsyncReadable<AsyncReader>);
+
 struct Seeker {
     virtual ~Seeker() = default;
 
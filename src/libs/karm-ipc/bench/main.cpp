@@ -0,0 +1,71 @@
+#include <karm-ipc/ring.h>
+#include <karm-logger/logger.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/shm.h>
+#include <karm-sys/time.h>
+
+static constexpr usize ROUNDS = 10000;
+static constexpr Array SIZES = {16uz, 256uz, 1024uz, 4096uz};
+
+Async::Task<> pongAsync(Ipc::Channel &chan, usize rounds) {
+    Array<u8, Sys::IpcConnection::MAX_BUF_SIZE> buf;
+    Array<Sys::Handle, Sys::IpcConnection::MAX_HND_SIZE> hnds;
+
+    for (usize i = 0; i < rounds; i++) {
+        auto [len, _] = co_trya$(chan.recvAsync(buf, hnds));
+        co_trya$(chan.sendAsync(sub(buf, 0, len), {}));
+    }
+
+    co_return Ok();
+}
+
+Async::Task<TimeSpan> pingAsync(Ipc::Channel &chan, usize size, usize rounds) {
+    Array<u8, Sys::IpcConnection::MAX_BUF_SIZE> payload;
+    Array<u8, Sys::IpcConnection::MAX_BUF_SIZE> buf;
+    Array<Sys::Handle, Sys::IpcConnection::MAX_HND_SIZE> hnds;
+    fill<u8>(mutSub(payload, 0, size), 0x2a);
+
+    auto start = Sys::now();
+    for (usize i = 0; i < rounds; i++) {
+        co_trya$(chan.sendAsync(sub(payload, 0, size), {}));
+        auto [len, _] = co_trya$(chan.recvAsync(buf, hnds));
+        if (len != size)
+            co_return Error::invalidData("short pong");
+    }
+    co_return Ok(Sys::now() - start);
+}
+
+Async::Task<> benchAsync(Str name, Ipc::Channel &ping, Ipc::Channel &pong) {
+    for (auto size : SIZES) {
+        Async::detach(pongAsync(pong, ROUNDS), [](Res<> res) {
+            if (not res)
+                logError("pong failed: {}", res.none().msg());
+        });
+
+        auto elapsed = co_trya$(pingAsync(ping, size, ROUNDS));
+        auto usecs = max(elapsed.toUSecs(), 1uz);
+
+        // NOTE: Every round moves the payload twice, once each way.
+        f64 latency = (f64)usecs / ROUNDS;
+        f64 throughput = (f64)(size * ROUNDS * 2) / usecs * 1e6 / (1024 * 1024);
+
+        Sys::println("{} {} bytes: {} us/rt, {} MiB/s", name, size, latency, throughput);
+    }
+
+    co_return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    auto [a, b] = co_try$(Sys::IpcConnection::pair());
+
+    Ipc::SocketChannel socketA{a};
+    Ipc::SocketChannel socketB{b};
+    co_trya$(benchAsync("socket", socketA, socketB));
+
+    auto shm = co_try$(Sys::createShm(Ipc::RingChannel::SIZE));
+    auto ringA = co_try$(Ipc::RingChannel::create(a, shm, true));
+    auto ringB = co_try$(Ipc::RingChannel::create(b, shm, false));
+    co_trya$(benchAsync("ring", *ringA, *ringB));
+
+    co_return Ok();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <karm-sys/socket.h>
+
+namespace Karm::Ipc {
+
+// The medium messages travel over, it can be switched out on a live
+// connection, see Server::upgradeAsync().
+enum struct Link : u64 {
+    SOCKET, //< Every message goes through the ipc socket
+    RING,   //< Messages go through a pair of rings in shared memory
+};
+
+struct Channel {
+    virtual ~Channel() = default;
+
+    virtual Async::Task<> sendAsync(Bytes buf, Slice<Sys::Handle> hnds) = 0;
+
+    virtual Async::Task<Cons<usize>> recvAsync(MutBytes buf, MutSlice<Sys::Handle> hnds) = 0;
+};
+
+struct SocketChannel : public Channel {
+    Sys::IpcConnection _con;
+
+    SocketChannel(Sys::IpcConnection con)
+        : _con(std::move(con)) {}
+
+    Async::Task<> sendAsync(Bytes buf, Slice<Sys::Handle> hnds) override {
+        return _con.sendAsync(buf, hnds);
+    }
+
+    Async::Task<Cons<usize>> recvAsync(MutBytes buf, MutSlice<Sys::Handle> hnds) override {
+        return _con.recvAsync(buf, hnds);
+    }
+};
+
+} // namespace Karm::Ipc
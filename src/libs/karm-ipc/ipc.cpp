@@ -1,4 +1,7 @@
+#include <karm-sys/shm.h>
+
 #include "ipc.h"
+#include "ring.h"
 
 namespace Karm::Ipc {
 
@@ -18,48 +21,375 @@ void Server::detach(_Object &obj) {
 }
 
 void Server::attach(_Pending &p) {
-    _pending.put(p.seq, &p);
+    _pending.put(p);
 }
 
 void Server::detach(_Pending &p) {
-    _pending.del(p.seq);
+    _pending.take(p.seq);
 }
 
-Async::Task<> Server::runAsync() {
-    Array<u8, 4096> reqBuf;
-    Array<Sys::Handle, 16> hnds;
+Box<Message> Server::acquire() {
+    if (_pool.len())
+        return _pool.popBack();
+    return makeBox<Message>();
+}
 
-    while (true) {
-        auto [bufLen, hndsLen] = co_trya$(_con.recvAsync(reqBuf, hnds));
-        logInfo("received {} bytes and {} handles", bufLen, hndsLen);
+void Server::release(Box<Message> msg) {
+    if (_pool.len() >= POOL_SIZE)
+        return;
+    msg->clear();
+    _pool.pushBack(std::move(msg));
+}
 
-        Io::PackScan req{
-            sub(reqBuf, 0, bufLen),
-            sub(hnds, 0, hndsLen),
-        };
+void Server::beginBatch() {
+    _batching++;
+}
 
-        Header header = co_try$(Io::unpack<Header>(req));
-        auto maybeObject = _objects.get(header.oid);
+Async::Task<> Server::endBatchAsync() {
+    if (_batching == 0)
+        co_return Error::invalidInput("no batch to end");
 
-        if (maybeObject) {
-            auto *object = *maybeObject;
+    if (--_batching)
+        co_return Ok();
 
-            Io::BufferWriter respBuf;
-            Io::PackEmit resp{respBuf};
-            co_trya$(object->handleRequest(header, req, resp));
-            co_trya$(_con.sendAsync(respBuf.bytes(), resp.handles()));
-            continue;
+    co_return co_await flushAsync();
+}
+
+Async::Task<> Server::flushAsync() {
+    if (not _batch)
+        co_return Ok();
+
+    auto batch = _batch.take();
+    auto res = co_await _channel->sendAsync(batch->buf.bytes(), batch->pack.handles());
+    release(std::move(batch));
+    co_return res;
+}
+
+void Server::concurrent(usize n) {
+    _concurrency = max(n, 1uz);
+}
+
+void Server::trace(bool enabled) {
+    _tracer.record(enabled);
+}
+
+Res<> Server::dumpTrace(Mime::Url url) const {
+    return _tracer.dump(url);
+}
+
+Slice<MethodStats> Server::stats() const {
+    return _tracer._stats;
+}
+
+Async::Task<> Server::sendAsync(Box<Message> msg) {
+    if (not _batching) {
+        auto res = co_await _channel->sendAsync(msg->buf.bytes(), msg->pack.handles());
+        release(std::move(msg));
+        co_return res;
+    }
+
+    usize entryLen = sizeof(u64) * 2 + msg->buf.bytes().len();
+    if (_batch and
+        ((*_batch)->buf.bytes().len() + entryLen > Sys::IpcConnection::MAX_BUF_SIZE or
+         (*_batch)->pack.handles().len() + msg->pack.handles().len() > Sys::IpcConnection::MAX_HND_SIZE)) {
+        co_trya$(flushAsync());
+    }
+
+    if (not _batch) {
+        auto batch = acquire();
+        co_try$(Io::pack(batch->pack, Header{.kind = Kind::BATCH}));
+        _batch = std::move(batch);
+    }
+
+    auto &batch = *_batch;
+    co_try$(Io::pack<u64>(batch->pack, msg->buf.bytes().len()));
+    co_try$(Io::pack<u64>(batch->pack, msg->pack.handles().len()));
+    co_try$(batch->buf.write(msg->buf.bytes()));
+    for (auto hnd : msg->pack.handles())
+        batch->pack.give(hnd);
+
+    release(std::move(msg));
+    co_return Ok();
+}
+
+Call &Server::call() {
+    if (not _call) [[unlikely]]
+        panic("not handling a call");
+    return *_call;
+}
+
+Async::Task<> Server::upgradeAsync(Link link) {
+    if (link == Link::SOCKET)
+        co_return Ok();
+
+    if (link != Link::RING)
+        co_return Error::invalidInput("unknown link");
+
+    auto shm = co_try$(Sys::createShm(RingChannel::SIZE));
+    Box<Channel> ring = co_try$(RingChannel::create(_con, shm, true));
+
+    auto req = acquire();
+    co_try$(Io::pack(
+        req->pack,
+        Header{
+            .from = 0,
+            .to = 0,
+            .oid = 0,
+            .uid = 0,
+            .mid = (u64)link,
+            .seq = _seq++,
+            .kind = Kind::UPGRADE,
+        }
+    ));
+    co_try$(shm->pack(req->pack));
+    auto sent = co_await _channel->sendAsync(req->buf.bytes(), req->pack.handles());
+    release(std::move(req));
+    co_try$(sent);
+
+    // NOTE: Nothing else is in flight yet, so the next message has to be
+    //       the answer of the other side.
+    Array<u8, 128> buf;
+    Array<Sys::Handle, Sys::IpcConnection::MAX_HND_SIZE> hnds;
+    auto [bufLen, hndsLen] = co_trya$(_channel->recvAsync(buf, hnds));
+
+    Io::PackScan resp{sub(buf, 0, bufLen), sub(hnds, 0, hndsLen)};
+    auto header = co_try$(Io::unpack<Header>(resp));
+    if (header.kind != Kind::UPGRADE)
+        co_return Error::invalidData("expected an answer to the upgrade");
+
+    auto res = co_try$(Io::unpack<Res<>>(resp));
+    co_try$(res);
+
+    _channel = std::move(ring);
+    co_return Ok();
+}
+
+Res<Box<Channel>> Server::_openLink(Link link, Io::PackScan &msg) {
+    if (link != Link::RING)
+        return Error::unsupported("unknown link");
+
+    auto shm = try$(Sys::Fd::unpack(msg));
+    Box<Channel> ring = try$(RingChannel::create(_con, shm, false));
+    return Ok(std::move(ring));
+}
+
+Async::Task<> Server::_acceptUpgradeAsync(Header header, Io::PackScan &msg) {
+    auto link = _openLink((Link)header.mid, msg);
+
+    auto resp = acquire();
+    co_try$(Io::pack(
+        resp->pack,
+        Header{
+            .from = header.to,
+            .to = header.from,
+            .oid = header.oid,
+            .uid = header.uid,
+            .mid = header.mid,
+            .seq = header.seq,
+            .kind = Kind::UPGRADE,
+        }
+    ));
+    co_try$(Io::pack(resp->pack, link ? Res<>{Ok()} : Res<>{link.none()}));
+
+    // NOTE: The answer still goes over the old link, the other side only
+    //       switches once it got it, so it's safe to switch right after.
+    auto sent = co_await _channel->sendAsync(resp->buf.bytes(), resp->pack.handles());
+    release(std::move(resp));
+    co_try$(sent);
+
+    if (link)
+        _channel = link.take();
+    co_return Ok();
+}
+
+Async::Task<> Server::_replyStatsAsync(Header header) {
+    auto resp = acquire();
+    co_try$(Io::pack(
+        resp->pack,
+        Header{
+            .from = header.to,
+            .to = header.from,
+            .oid = header.oid,
+            .uid = header.uid,
+            .mid = header.mid,
+            .seq = header.seq,
+            .kind = Kind::RESPONSE,
         }
+    ));
+    co_try$(Io::pack(resp->pack, Res<Vec<MethodStats>>{Ok(_tracer._stats)}));
+    co_return co_await sendAsync(std::move(resp));
+}
+
+Async::Task<> Server::_replyLocateAsync(Header header) {
+    Res<u64> oid = Error::notFound("no object implements this interface");
+    for (auto &[id, obj] : _objects.iter()) {
+        if (obj->implements(header.uid)) {
+            oid = Ok(id);
+            break;
+        }
+    }
+
+    auto resp = acquire();
+    co_try$(Io::pack(
+        resp->pack,
+        Header{
+            .from = header.to,
+            .to = header.from,
+            .oid = header.oid,
+            .uid = header.uid,
+            .mid = header.mid,
+            .seq = header.seq,
+            .kind = Kind::RESPONSE,
+        }
+    ));
+    co_try$(Io::pack(resp->pack, oid));
+    co_return co_await sendAsync(std::move(resp));
+}
+
+Async::Task<> Server::_dispatchAsync(Io::PackScan &msg, TimeStamp received) {
+    usize reqLen = msg.rem();
+    Header header = co_try$(Io::unpack<Header>(msg));
+
+    if (header.kind == Kind::UPGRADE)
+        co_return co_await _acceptUpgradeAsync(header, msg);
+
+    if (header.kind == Kind::BATCH) {
+        // NOTE: Responses to a batch are batched too.
+        beginBatch();
+
+        while (not msg.ended()) {
+            auto len = msg.nextU64le();
+            auto hndsLen = msg.nextU64le();
+
+            if (len > msg.rem() or hndsLen > msg._handles.rem()) {
+                co_trya$(endBatchAsync());
+                co_return Error::invalidData("malformed batch");
+            }
+
+            Io::PackScan call{msg.nextBytes(len), msg._handles.next(hndsLen)};
+            auto res = co_await _dispatchAsync(call, received);
+            if (not res)
+                logWarn("dropping message in batch: {}", res.none().msg());
+        }
+
+        co_return co_await endBatchAsync();
+    }
+
+    if (header.kind == Kind::RESPONSE) {
+        auto maybePending = _pending.take(header.seq);
+        if (not maybePending) {
+            logWarn("dropping response to unknown call {}", header.seq);
+            co_return Ok();
+        }
+
+        (*maybePending)->complete(msg);
+        co_return Ok();
+    }
+
+    if (header.mid == STATS_MID and header.kind == Kind::REQUEST)
+        co_return co_await _replyStatsAsync(header);
+
+    if (header.mid == LOCATE_MID and header.kind == Kind::REQUEST)
+        co_return co_await _replyLocateAsync(header);
 
-        auto maybePending = _pending.get(header.seq);
-        if (maybePending) {
-            auto *pending = *maybePending;
-            pending->complete(req);
-            detach(*pending);
+    auto maybeObject = _objects.get(header.oid);
+    if (not maybeObject) {
+        logWarn("dropping message for unknown object {}", header.oid);
+        co_return Ok();
+    }
+
+    auto resp = acquire();
+    co_try$(Io::pack(
+        resp->pack,
+        Header{
+            .from = header.to,
+            .to = header.from,
+            .oid = header.oid,
+            .uid = header.uid,
+            .mid = header.mid,
+            .seq = header.seq,
+            .kind = Kind::RESPONSE,
+        }
+    ));
+    auto headerLen = resp->buf.bytes().len();
+
+    // NOTE: The sender's clock can't be compared with ours, calls are
+    //       only accounted for from the moment they got to us.
+    auto started = Sys::now();
+    _tracer.begin(header.uid, header.mid, started - received);
+
+    Call call{header};
+    _call = &call;
+    auto res = co_await (*maybeObject)->handleRequest(header, msg, resp->pack);
+    _call = nullptr;
+
+    _tracer.end({
+        .uid = header.uid,
+        .mid = header.mid,
+        .seq = header.seq,
+        .received = received,
+        .started = started,
+        .ended = Sys::now(),
+        .reqLen = reqLen,
+        .respLen = header.kind == Kind::ONEWAY ? 0 : resp->buf.bytes().len(),
+        .ok = (bool)res,
+    });
+
+    if (header.kind == Kind::ONEWAY) {
+        release(std::move(resp));
+        co_return res;
+    }
+
+    if (not res) {
+        // NOTE: Any Res<T> can be unpacked from an error, so let the
+        //       caller know instead of leaving it waiting forever.
+        resp->buf._buf.trunc(headerLen);
+        resp->pack.clear();
+        co_try$(Io::pack(resp->pack, Res<>{res.none()}));
+    }
+
+    auto sent = co_await sendAsync(std::move(resp));
+    if (not sent and call._undelivered)
+        (*call._undelivered)();
+    co_return sent;
+}
+
+Async::Task<> Server::_spawnedAsync(Vec<u8> buf, Vec<Sys::Handle> hnds, TimeStamp received) {
+    Io::PackScan msg{buf, hnds};
+    auto res = co_await _dispatchAsync(msg, received);
+    if (not res)
+        logWarn("dropping message: {}", res.none().msg());
+    co_return Ok();
+}
+
+Async::Task<> Server::runAsync() {
+    Array<u8, Sys::IpcConnection::MAX_BUF_SIZE> buf;
+    Array<Sys::Handle, Sys::IpcConnection::MAX_HND_SIZE> hnds;
+    Async::Group group{_concurrency};
+
+    while (true) {
+        auto [bufLen, hndsLen] = co_trya$(_channel->recvAsync(buf, hnds));
+        auto received = Sys::now();
+
+        Io::PackScan msg{
+            sub(buf, 0, bufLen),
+            sub(hnds, 0, hndsLen),
+        };
+
+        // NOTE: Only requests get a task of their own, everything else
+        //       changes the state of the connection and has to happen in
+        //       the order it came in. The message is copied out of the
+        //       buffer, the next one is received into it right away.
+        Io::PackScan peek = msg;
+        auto header = Io::unpack<Header>(peek);
+        if (_concurrency > 1 and header and header.unwrap().kind == Kind::REQUEST) {
+            co_trya$(group.spawnAsync(_spawnedAsync(sub(buf, 0, bufLen), sub(hnds, 0, hndsLen), received)));
             continue;
         }
 
-        logWarn("dropping message");
+        auto res = co_await _dispatchAsync(msg, received);
+        if (not res)
+            logWarn("dropping message: {}", res.none().msg());
     }
 }
 
@@ -77,8 +407,4 @@ _Object::~_Object() {
     _server.detach(*this);
 }
 
-// MARK: Client ----------------------------------------------------------------
-
-usize Transport::_seq = 0;
-
 } // namespace Karm::Ipc
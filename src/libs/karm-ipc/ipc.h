@@ -1,18 +1,37 @@
 #pragma once
 
+#include <karm-base/box.h>
+#include <karm-base/defer.h>
+#include <karm-base/func.h>
 #include <karm-logger/logger.h>
 #include <karm-sys/context.h>
 #include <karm-sys/socket.h>
+#include <karm-sys/time.h>
 
+#include "channel.h"
 #include "hook.h"
+#include "trace.h"
 
 namespace Karm::Ipc {
 
 struct _Object;
 
+enum struct Kind : u64 {
+    REQUEST,  //< A call expecting a response
+    RESPONSE, //< The response to a previous request
+    ONEWAY,   //< A call that doesn't expect any response
+    BATCH,    //< Several messages coalesced into a single one
+    UPGRADE,  //< Switch the connection over to another link
+};
+
+// NOTE: Calls to this method are answered by the server itself with the id
+//       of its object implementing the interface they were made through.
+static constexpr u64 LOCATE_MID = ~1uz;
+
 struct Header {
     u64 from, to;
     u64 oid, uid, mid, seq;
+    Kind kind;
 };
 
 struct _Pending {
@@ -34,13 +53,121 @@ struct Pending : public _Pending {
     }
 };
 
+// Outstanding calls indexed by their sequence number, in an open addressed
+// table. A call goes in the first free slot from its home slot onward, so
+// lookups walk the run of taken slots from there until they find it.
+struct PendingTable {
+    Vec<_Pending *> _slots;
+    usize _len = 0;
+
+    usize _index(u64 seq) const {
+        return seq & (_slots.len() - 1);
+    }
+
+    void _insert(_Pending &p) {
+        auto i = _index(p.seq);
+        while (_slots[i])
+            i = (i + 1) & (_slots.len() - 1);
+        _slots[i] = &p;
+    }
+
+    void _grow() {
+        Vec<_Pending *> old = std::move(_slots);
+        _slots.resize(max(old.len() * 2, 16uz), nullptr);
+        for (auto *p : old)
+            if (p)
+                _insert(*p);
+    }
+
+    // NOTE: Linear probing, the table is kept at most half full so probe
+    //       sequences stay short.
+    void put(_Pending &p) {
+        if ((_len + 1) * 2 > _slots.len())
+            _grow();
+
+        _insert(p);
+        _len++;
+    }
+
+    Opt<_Pending *> take(u64 seq) {
+        if (_slots.len() == 0)
+            return NONE;
+
+        usize mask = _slots.len() - 1;
+        auto i = _index(seq);
+        while (_slots[i] and _slots[i]->seq != seq)
+            i = (i + 1) & mask;
+
+        if (not _slots[i])
+            return NONE;
+
+        auto *p = std::exchange(_slots[i], nullptr);
+        _len--;
+
+        // NOTE: Shift the rest of the run back so lookups never stop at
+        //       the hole we just left.
+        auto hole = i;
+        for (auto j = (i + 1) & mask; _slots[j]; j = (j + 1) & mask) {
+            auto home = _index(_slots[j]->seq);
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                _slots[hole] = std::exchange(_slots[j], nullptr);
+                hole = j;
+            }
+        }
+
+        return p;
+    }
+
+    usize len() const {
+        return _len;
+    }
+};
+
+// A reusable buffer for building outgoing messages.
+struct Message {
+    Io::BufferWriter buf;
+    Io::PackEmit pack{buf};
+
+    void clear() {
+        buf.clear();
+        pack.clear();
+    }
+};
+
+// A request being handled, see Server::call().
+struct Call {
+    Header header;
+    Opt<Func<void()>> _undelivered = NONE;
+
+    // Runs `f` if the response can't be sent, so that whatever it hands
+    // over to the caller can be taken back.
+    //
+    // NOTE: A batched response is only sent once the batch closes, it
+    //       isn't known by then which call it belonged to.
+    void onUndelivered(Func<void()> f) {
+        _undelivered = std::move(f);
+    }
+};
+
 struct Server {
+    static constexpr usize POOL_SIZE = 16;
+
     Sys::IpcConnection _con;
+    Box<Channel> _channel;
     Map<u64, _Object *> _objects;
-    Map<u64, _Pending *> _pending;
+    PendingTable _pending;
+    u64 _seq = 0;
+    Call *_call = nullptr;
+
+    Vec<Box<Message>> _pool;
+    usize _batching = 0;
+    Opt<Box<Message>> _batch;
+    usize _concurrency = 1;
+
+    Tracer _tracer;
 
     Server(Sys::IpcConnection con)
-        : _con(std::move(con)) {}
+        : _con(con), _channel(makeBox<SocketChannel>(con)) {}
 
     static Res<Server> create(Sys::Context &ctx);
 
@@ -52,6 +179,55 @@ struct Server {
 
     void detach(_Pending &p);
 
+    Box<Message> acquire();
+
+    void release(Box<Message> msg);
+
+    // While a batch is open, outgoing messages are queued up instead of
+    // being sent. They go out all at once as a single message when the
+    // outermost batch closes, or as soon as the batch is full.
+    void beginBatch();
+
+    Async::Task<> endBatchAsync();
+
+    Async::Task<> flushAsync();
+
+    // Requests are handled one after the other by default. Past 1, each of
+    // them runs in its own task, at most `n` at the same time, so a call
+    // that waits on something doesn't hold up the others.
+    void concurrent(usize n);
+
+    // Keep a trace of the last calls around for dumpTrace(), stats about
+    // every method are collected regardless.
+    void trace(bool enabled);
+
+    Res<> dumpTrace(Mime::Url url) const;
+
+    Slice<MethodStats> stats() const;
+
+    Async::Task<> sendAsync(Box<Message> msg);
+
+    // The call being handled, handlers must get it before they first
+    // suspend, other calls might be handled from then on.
+    Call &call();
+
+    // Move this connection over to another link, both sides must agree on
+    // it before it happens. This must be called before anything else is
+    // sent or received, the other side upgrades from its run loop.
+    Async::Task<> upgradeAsync(Link link);
+
+    Res<Box<Channel>> _openLink(Link link, Io::PackScan &msg);
+
+    Async::Task<> _acceptUpgradeAsync(Header header, Io::PackScan &msg);
+
+    Async::Task<> _replyStatsAsync(Header header);
+
+    Async::Task<> _replyLocateAsync(Header header);
+
+    Async::Task<> _dispatchAsync(Io::PackScan &msg, TimeStamp received);
+
+    Async::Task<> _spawnedAsync(Vec<u8> buf, Vec<Sys::Handle> hnds, TimeStamp received);
+
     Async::Task<> runAsync();
 };
 
@@ -65,6 +241,8 @@ struct _Object : public Meta::Static {
 
     ~_Object();
 
+    virtual bool implements(u64 uid) const = 0;
+
     virtual Async::Task<> handleRequest(Header header, Io::PackScan &req, Io::PackEmit &res) = 0;
 };
 
@@ -80,7 +258,8 @@ struct Dispatch {
     template <typename... Args>
     Async::Task<> call(auto &&f) {
         auto args = co_try$(Io::unpack<Tuple<Args...>>(req));
-        auto res = co_trya$(args.apply(f));
+        auto ret = co_await args.apply(f);
+        co_try$(Io::pack(res, ret));
         co_return Ok();
     }
 
@@ -94,6 +273,10 @@ struct Object : public I, public _Object {
     using _Object::_Object;
     using I::_dispatch;
 
+    bool implements(u64 uid) const override {
+        return uid == I::_UID;
+    }
+
     Async::Task<> handleRequest(Header header, Io::PackScan &req, Io::PackEmit &resp) override {
         Dispatch d{header, req, resp};
         return I::_dispatch(d);
@@ -106,8 +289,6 @@ struct Transport {
     usize _oid;
     Server &_server;
 
-    static usize _seq;
-
     template <typename I, u64 MID, typename Ret, typename... Args>
     Ret invoke(Args &&...args) {
         Header header{
@@ -116,22 +297,50 @@ struct Transport {
             .oid = _oid,
             .uid = I::_UID,
             .mid = MID,
-            .seq = _seq++,
+            .seq = _server._seq++,
+            .kind = Kind::REQUEST,
         };
 
         Tuple<Args...> params{std::forward<Args>(args)...};
 
-        Io::BufferWriter reqBuf;
-        Io::PackEmit reqPack{reqBuf};
-
-        co_try$(Io::pack(reqPack, header));
-        co_try$(Io::pack(reqPack, params));
+        auto msg = _server.acquire();
+        co_try$(Io::pack(msg->pack, header));
+        co_try$(Io::pack(msg->pack, params));
 
-        co_trya$(_server._con.sendAsync(reqBuf.bytes(), reqPack.handles()));
+        // NOTE: Register the call before sending it, so the response
+        //       can't arrive before we are waiting for it.
         Pending<typename Ret::Inner> pending;
+        pending.seq = header.seq;
         _server.attach(pending);
+        defer$(_server.detach(pending));
+
+        // NOTE: Inside a batch the request only leaves once the batch
+        //       closes, so calls made in one must be started, not awaited,
+        //       until then.
+        co_trya$(_server.sendAsync(std::move(msg)));
         co_return co_trya$(pending.promise.future());
     }
+
+    // Call a method without waiting for, nor expecting any response.
+    template <typename I, u64 MID, typename... Args>
+    Async::Task<> notify(Args &&...args) {
+        Header header{
+            .from = 0,
+            .to = 0,
+            .oid = _oid,
+            .uid = I::_UID,
+            .mid = MID,
+            .seq = _server._seq++,
+            .kind = Kind::ONEWAY,
+        };
+
+        Tuple<Args...> params{std::forward<Args>(args)...};
+
+        auto msg = _server.acquire();
+        co_try$(Io::pack(msg->pack, header));
+        co_try$(Io::pack(msg->pack, params));
+        co_return co_await _server.sendAsync(std::move(msg));
+    }
 };
 
 template <typename I>
@@ -139,4 +348,23 @@ Strong<I> open(Server &srv, u64 oid) {
     return makeStrong<typename I::template _Client<Transport>>(Transport{oid, srv});
 }
 
+// Ask the server on the other end for its object implementing `I`, instead
+// of relying on the order it created its objects in.
+template <typename I>
+Async::Task<Strong<I>> locateAsync(Server &srv) {
+    Transport transport{0, srv};
+    auto oid = co_trya$((transport.invoke<I, LOCATE_MID, Async::Task<u64>>()));
+    co_return Ok(open<I>(srv, oid));
+}
+
+struct _Stats {
+    static constexpr u64 _UID = 0;
+};
+
+// Ask the server on the other end for its method stats.
+inline Async::Task<Vec<MethodStats>> statsAsync(Server &srv, u64 oid = 0) {
+    Transport transport{oid, srv};
+    co_return co_await transport.invoke<_Stats, STATS_MID, Async::Task<Vec<MethodStats>>>();
+}
+
 } // namespace Karm::Ipc
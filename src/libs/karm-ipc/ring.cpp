@@ -0,0 +1,311 @@
+#include <karm-sys/proc.h>
+#include <karm-sys/shm.h>
+#include <karm-sys/time.h>
+
+#include "ring.h"
+
+namespace Karm::Ipc {
+
+// NOTE: Bytes sent on the socket only matter for the handles attached to
+//       them or for waking up the other side, their value is informative.
+static constexpr u8 DOORBELL = 'D';
+static constexpr u8 HANDLES = 'H';
+static constexpr u8 ROOM = 'R';
+
+Res<Box<RingChannel>> RingChannel::create(Sys::IpcConnection con, Strong<Sys::Fd> shm, bool initiator) {
+    // NOTE: Touching pages past the end of the object would fault.
+    auto stat = try$(shm->stat());
+    if (stat.size < SIZE)
+        return Error::invalidInput("shared memory is too small");
+
+    auto mmap = try$(Sys::mmap().read().write().size(SIZE).mapMut(shm));
+
+    // NOTE: Shared memory starts out zeroed, which is two empty rings.
+    auto *rings = mmap.as<Ring>();
+    auto *tx = initiator ? &rings[0] : &rings[1];
+    auto *rx = initiator ? &rings[1] : &rings[0];
+
+    return Ok(makeBox<RingChannel>(std::move(con), std::move(shm), std::move(mmap), tx, rx));
+}
+
+RingChannel::~RingChannel() {
+    // NOTE: Close handles whose frame never showed up.
+    Io::PackScan s{Bytes{}, _hnds};
+    while (not s._handles.ended())
+        (void)Sys::Fd::unpack(s);
+}
+
+bool RingChannel::_fits(usize len) {
+    auto &r = *_tx;
+    u32 tail = r.tail.load(RELAXED);
+    u32 head = r.head.load(ACQUIRE);
+
+    usize need = Ring::frameLen(len);
+    usize contiguous = Ring::CAP - (tail & (Ring::CAP - 1));
+
+    // NOTE: Frames are never split, if one doesn't fit before the end of
+    //       the ring, what's left is skipped and it starts over from the
+    //       beginning.
+    usize total = contiguous < need ? contiguous + need : need;
+    return Ring::CAP - (u32)(tail - head) >= total;
+}
+
+void RingChannel::_write(Bytes buf, usize hnds) {
+    auto &r = *_tx;
+    u32 tail = r.tail.load(RELAXED);
+
+    usize need = Ring::frameLen(buf.len());
+    usize off = tail & (Ring::CAP - 1);
+    usize contiguous = Ring::CAP - off;
+
+    if (contiguous < need) {
+        auto &wrap = *reinterpret_cast<Ring::Frame *>(&r.buf[off]);
+        wrap = {Ring::Frame::WRAP, 0};
+        tail += contiguous;
+        off = 0;
+    }
+
+    auto &frame = *reinterpret_cast<Ring::Frame *>(&r.buf[off]);
+    frame = {static_cast<u32>(buf.len()), static_cast<u32>(hnds)};
+    copy(buf, MutBytes{&r.buf[off + sizeof(Ring::Frame)], buf.len()});
+
+    // NOTE: Must be sequentially consistent with the load of the waiting
+    //       word in _wake(), or we could miss a consumer going to sleep.
+    r.tail.store(tail + need, SEQ_CST);
+}
+
+Res<Opt<Ring::Frame>> RingChannel::_tryRead(MutBytes buf) {
+    auto &r = *_rx;
+    u32 head = r.head.load(RELAXED);
+
+    while (true) {
+        u32 tail = r.tail.load(ACQUIRE);
+        if (head == tail)
+            return Ok(NONE);
+
+        usize off = head & (Ring::CAP - 1);
+
+        // NOTE: The other side can scribble over the ring at any time,
+        //       read the frame header once and don't trust it.
+        auto const volatile *raw = reinterpret_cast<Ring::Frame const volatile *>(&r.buf[off]);
+        Ring::Frame frame{raw->len, raw->hnds};
+
+        if (frame.len == Ring::Frame::WRAP) {
+            head += Ring::CAP - off;
+            r.head.store(head, RELEASE);
+            continue;
+        }
+
+        usize len = Ring::frameLen(frame.len);
+        if (len > Ring::CAP - off or (u32)(tail - head) < len)
+            return Error::invalidData("malformed frame in ring");
+
+        if (frame.len > buf.len()) {
+            r.head.store(head + len, RELEASE);
+            return Error::invalidData("frame is larger than the buffer");
+        }
+
+        copy(Bytes{&r.buf[off + sizeof(Ring::Frame)], frame.len}, buf);
+
+        // NOTE: Must be sequentially consistent with the load of the
+        //       blocked word in _release(), same as in _write().
+        r.head.store(head + len, SEQ_CST);
+        try$(_release());
+        return Ok(frame);
+    }
+}
+
+Res<> RingChannel::_sendHandles(Slice<Sys::Handle> hnds) {
+    // NOTE: Sent synchronously so nothing else can publish a frame between
+    //       the handles going out and their own frame, these are tiny
+    //       messages so the socket buffer is never going to be full.
+    return _con.send(Bytes{&HANDLES, 1}, hnds);
+}
+
+Res<> RingChannel::_wake() {
+    auto &r = *_tx;
+    if (r.waiting.load(SEQ_CST) == (u32)Ring::Wait::NONE)
+        return Ok();
+
+    auto wait = (Ring::Wait)r.waiting.xchg((u32)Ring::Wait::NONE);
+    if (wait == Ring::Wait::FUTEX)
+        return Sys::futexWake(r.tail);
+
+    if (wait == Ring::Wait::DOORBELL)
+        return _con.send(Bytes{&DOORBELL, 1}, {});
+
+    return Ok();
+}
+
+bool RingChannel::_park(Ring::Wait how, u32 &tail) {
+    auto &r = *_rx;
+    r.waiting.store((u32)how, SEQ_CST);
+
+    tail = r.tail.load(SEQ_CST);
+    if (tail == r.head.load(RELAXED))
+        return true;
+
+    // NOTE: Something came in meanwhile. If the producer already took the
+    //       flag, a wakeup is on its way anyway, and is merely spurious.
+    r.waiting.xchg((u32)Ring::Wait::NONE);
+    return false;
+}
+
+bool RingChannel::_block(Ring::Wait how, usize len, u32 &head) {
+    auto &r = *_tx;
+    r.blocked.store((u32)how, SEQ_CST);
+
+    head = r.head.load(SEQ_CST);
+    if (not _fits(len))
+        return true;
+
+    r.blocked.xchg((u32)Ring::Wait::NONE);
+    return false;
+}
+
+Res<> RingChannel::_release() {
+    auto &r = *_rx;
+    if (r.blocked.load(SEQ_CST) == (u32)Ring::Wait::NONE)
+        return Ok();
+
+    auto wait = (Ring::Wait)r.blocked.xchg((u32)Ring::Wait::NONE);
+    if (wait == Ring::Wait::FUTEX)
+        return Sys::futexWake(r.head);
+
+    if (wait == Ring::Wait::DOORBELL)
+        return _con.send(Bytes{&ROOM, 1}, {});
+
+    return Ok();
+}
+
+Res<usize> RingChannel::_takeHandles(usize count, MutSlice<Sys::Handle> hnds) {
+    if (count > hnds.len())
+        return Error::invalidData("too many handles in frame");
+
+    for (usize i = 0; i < count; i++)
+        hnds[i] = _hnds.popFront();
+
+    return Ok(count);
+}
+
+void RingChannel::_stash(Slice<Sys::Handle> hnds) {
+    for (auto hnd : hnds)
+        _hnds.pushBack(hnd);
+}
+
+Res<> RingChannel::_pump() {
+    Array<u8, 64> buf;
+    Array<Sys::Handle, Sys::IpcConnection::MAX_HND_SIZE> hnds;
+    auto [len, hndsLen] = try$(_con.recv(buf, hnds));
+    if (len == 0)
+        return Error::unexpectedEof("peer closed the connection");
+    _stash(sub(hnds, 0, hndsLen));
+    return Ok();
+}
+
+Async::Task<> RingChannel::_pumpAsync() {
+    if (_pumping) {
+        if (not _pumped)
+            _pumped = Async::Promise<>{};
+        auto pumped = _pumped->future();
+        co_return co_await pumped;
+    }
+
+    _pumping = true;
+    Array<u8, 64> buf;
+    Array<Sys::Handle, Sys::IpcConnection::MAX_HND_SIZE> hnds;
+    auto res = co_await _con.recvAsync(buf, hnds);
+    _pumping = false;
+
+    Res<> ret = Ok();
+    if (not res)
+        ret = res.none();
+    else if (res.unwrap().car == 0)
+        ret = Error::unexpectedEof("peer closed the connection");
+    else
+        _stash(sub(hnds, 0, res.unwrap().cdr));
+
+    if (_pumped)
+        _pumped.take().resolve(ret);
+    co_return ret;
+}
+
+Async::Task<> RingChannel::sendAsync(Bytes buf, Slice<Sys::Handle> hnds) {
+    if (Ring::frameLen(buf.len()) > MAX_FRAME)
+        co_return Error::invalidInput("message is too large");
+
+    // NOTE: The ring is full, wait for the consumer to ring back once it
+    //       made some room, the rest of the scheduler keeps going.
+    while (not _fits(buf.len())) {
+        u32 head;
+        if (_block(Ring::Wait::DOORBELL, buf.len(), head))
+            co_trya$(_pumpAsync());
+    }
+
+    if (hnds.len())
+        co_try$(_sendHandles(hnds));
+
+    _write(buf, hnds.len());
+    co_return _wake();
+}
+
+Async::Task<Cons<usize>> RingChannel::recvAsync(MutBytes buf, MutSlice<Sys::Handle> hnds) {
+    while (true) {
+        for (usize i = 0; i < SPIN; i++) {
+            auto frame = co_try$(_tryRead(buf));
+            if (not frame)
+                continue;
+
+            while (_hnds.len() < frame->hnds)
+                co_trya$(_pumpAsync());
+
+            auto hndsLen = co_try$(_takeHandles(frame->hnds, hnds));
+            co_return Ok<Cons<usize>>(frame->len, hndsLen);
+        }
+
+        // NOTE: A futex would block the whole scheduler, so wait for the
+        //       producer to ring on the socket instead.
+        u32 tail;
+        if (_park(Ring::Wait::DOORBELL, tail))
+            co_trya$(_pumpAsync());
+    }
+}
+
+Res<> RingChannel::send(Bytes buf, Slice<Sys::Handle> hnds) {
+    if (Ring::frameLen(buf.len()) > MAX_FRAME)
+        return Error::invalidInput("message is too large");
+
+    while (not _fits(buf.len())) {
+        u32 head;
+        if (_block(Ring::Wait::FUTEX, buf.len(), head))
+            try$(Sys::futexWait(_tx->head, head));
+    }
+
+    if (hnds.len())
+        try$(_sendHandles(hnds));
+
+    _write(buf, hnds.len());
+    return _wake();
+}
+
+Res<Cons<usize>> RingChannel::recv(MutBytes buf, MutSlice<Sys::Handle> hnds) {
+    while (true) {
+        for (usize i = 0; i < SPIN; i++) {
+            auto frame = try$(_tryRead(buf));
+            if (not frame)
+                continue;
+
+            while (_hnds.len() < frame->hnds)
+                try$(_pump());
+
+            auto hndsLen = try$(_takeHandles(frame->hnds, hnds));
+            return Ok<Cons<usize>>(frame->len, hndsLen);
+        }
+
+        u32 tail;
+        if (_park(Ring::Wait::FUTEX, tail))
+            try$(Sys::futexWait(_rx->tail, tail));
+    }
+}
+
+} // namespace Karm::Ipc
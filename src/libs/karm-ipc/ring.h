@@ -0,0 +1,107 @@
+#pragma once
+
+#include <karm-base/atomic.h>
+#include <karm-sys/mmap.h>
+
+#include "channel.h"
+
+namespace Karm::Ipc {
+
+// A single producer, single consumer ring of length prefixed frames.
+// Positions are free running and wrap around at 2^32, only their
+// difference matters.
+struct Ring {
+    static constexpr usize CAP = 64 * 1024;
+
+    enum struct Wait : u32 {
+        NONE,     //< Nobody is waiting, no need to wake anyone up
+        FUTEX,    //< Sleeping on the word that is going to change
+        DOORBELL, //< Waiting for a byte on the socket
+    };
+
+    struct Frame {
+        static constexpr u32 WRAP = ~0u; //< Skip to the start of the ring
+
+        u32 len;
+        u32 hnds; //< Handles sent ahead through the socket
+    };
+
+    // NOTE: Each word gets its own cache line, so the two sides don't keep
+    //       stealing it from each other.
+    alignas(64) Atomic<u32> head; //< Read position, owned by the consumer
+    alignas(64) Atomic<u32> tail; //< Write position, owned by the producer
+    alignas(64) Atomic<u32> waiting; //< How the consumer waits for frames
+    alignas(64) Atomic<u32> blocked; //< How the producer waits for room
+    alignas(64) u8 buf[CAP];
+
+    static usize frameLen(usize len) {
+        return alignUp(sizeof(Frame) + len, alignof(u64));
+    }
+};
+
+// Carries messages through shared memory, the ipc socket is only used to
+// pass handles along, and to wake up a consumer that went to sleep.
+struct RingChannel : public Channel {
+    static constexpr usize SIZE = alignUp(sizeof(Ring) * 2, 4096);
+    static constexpr usize MAX_FRAME = Ring::CAP / 4;
+    static constexpr usize SPIN = 64;
+
+    Sys::IpcConnection _con;
+    Strong<Sys::Fd> _shmFd;
+    Sys::MutMmap _shm;
+    Ring *_tx;
+    Ring *_rx;
+    Vec<Sys::Handle> _hnds; //< Handles that arrived ahead of their frame
+    bool _pumping = false;
+    Opt<Async::Promise<>> _pumped; //< Waiters on the read already in flight
+
+    // The initiator is the side that allocated the shared memory, both sides
+    // must disagree on it so they end up on opposite rings.
+    static Res<Box<RingChannel>> create(Sys::IpcConnection con, Strong<Sys::Fd> shm, bool initiator);
+
+    RingChannel(Sys::IpcConnection con, Strong<Sys::Fd> shmFd, Sys::MutMmap shm, Ring *tx, Ring *rx)
+        : _con(std::move(con)),
+          _shmFd(std::move(shmFd)),
+          _shm(std::move(shm)),
+          _tx(tx), _rx(rx) {}
+
+    ~RingChannel() override;
+
+    bool _fits(usize len);
+
+    void _write(Bytes buf, usize hnds);
+
+    Res<Opt<Ring::Frame>> _tryRead(MutBytes buf);
+
+    Res<> _sendHandles(Slice<Sys::Handle> hnds);
+
+    Res<> _wake();
+
+    bool _park(Ring::Wait how, u32 &tail);
+
+    bool _block(Ring::Wait how, usize len, u32 &head);
+
+    Res<> _release();
+
+    Res<usize> _takeHandles(usize count, MutSlice<Sys::Handle> hnds);
+
+    void _stash(Slice<Sys::Handle> hnds);
+
+    Res<> _pump();
+
+    // Only one read is ever pending on the socket, whoever comes next
+    // waits for it to complete, then checks the rings again.
+    Async::Task<> _pumpAsync();
+
+    Async::Task<> sendAsync(Bytes buf, Slice<Sys::Handle> hnds) override;
+
+    Async::Task<Cons<usize>> recvAsync(MutBytes buf, MutSlice<Sys::Handle> hnds) override;
+
+    // Blocking variants, for callers without a scheduler, they sleep on a
+    // futex rather than on the socket.
+    Res<> send(Bytes buf, Slice<Sys::Handle> hnds);
+
+    Res<Cons<usize>> recv(MutBytes buf, MutSlice<Sys::Handle> hnds);
+};
+
+} // namespace Karm::Ipc
@@ -0,0 +1,102 @@
+#include <karm-ipc/ipc.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Ipc::Tests {
+
+static constexpr usize CALLS = 8;
+
+struct _Echo {
+    static constexpr u64 _UID = 0xec40ec40ec40ec40;
+};
+
+struct CountingChannel : public Channel {
+    usize sent = 0;
+
+    Async::Task<> sendAsync(Bytes, Slice<Sys::Handle>) override {
+        sent++;
+        co_return Ok();
+    }
+
+    Async::Task<Cons<usize>> recvAsync(MutBytes, MutSlice<Sys::Handle>) override {
+        co_return Error::notImplemented();
+    }
+};
+
+struct Bench {
+    Server server{Sys::IpcConnection{makeStrong<Sys::NullFd>(), NONE}};
+    CountingChannel *channel;
+    usize answered = 0;
+
+    Bench() {
+        auto channel = makeBox<CountingChannel>();
+        this->channel = &*channel;
+        server._channel = Box<Channel>{std::move(channel)};
+    }
+
+    void call() {
+        Transport transport{0, server};
+        Async::detach(
+            transport.invoke<_Echo, 0, Async::Task<u64>>(),
+            [&](Res<u64> res) {
+                if (res)
+                    answered++;
+            }
+        );
+    }
+
+    Res<> reply(u64 seq) {
+        Message msg;
+        try$(Io::pack(msg.pack, Header{.seq = seq, .kind = Kind::RESPONSE}));
+        try$(Io::pack(msg.pack, Res<u64>{Ok(seq)}));
+        Io::PackScan scan{msg.buf.bytes(), msg.pack.handles()};
+        return Async::run(server._dispatchAsync(scan, Sys::now()));
+    }
+};
+
+test$("ipc-calls-send-one-packet-each") {
+    Bench bench;
+    for (usize i = 0; i < CALLS; i++)
+        bench.call();
+    expectEq$(bench.channel->sent, CALLS);
+
+    for (u64 seq = 0; seq < CALLS; seq++)
+        try$(bench.reply(seq));
+    expectEq$(bench.answered, CALLS);
+    return Ok();
+}
+
+test$("ipc-batched-calls-send-one-packet") {
+    Bench bench;
+    bench.server.beginBatch();
+    for (usize i = 0; i < CALLS; i++)
+        bench.call();
+    expectEq$(bench.channel->sent, 0uz);
+
+    try$(Async::run(bench.server.endBatchAsync()));
+    expectEq$(bench.channel->sent, 1uz);
+
+    for (u64 seq = 0; seq < CALLS; seq++)
+        try$(bench.reply(seq));
+    expectEq$(bench.answered, CALLS);
+    return Ok();
+}
+
+test$("ipc-nested-batches-send-on-outermost-end") {
+    Bench bench;
+    bench.server.beginBatch();
+    bench.server.beginBatch();
+    bench.call();
+    try$(Async::run(bench.server.endBatchAsync()));
+    expectEq$(bench.channel->sent, 0uz);
+
+    bench.call();
+    try$(Async::run(bench.server.endBatchAsync()));
+    expectEq$(bench.channel->sent, 1uz);
+
+    try$(bench.reply(0));
+    try$(bench.reply(1));
+    expectEq$(bench.answered, 2uz);
+    return Ok();
+}
+
+} // namespace Karm::Ipc::Tests
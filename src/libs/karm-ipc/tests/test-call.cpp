@@ -0,0 +1,73 @@
+#include <karm-ipc/ipc.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Ipc::Tests {
+
+struct DroppingChannel : public Channel {
+    bool broken = false;
+
+    Async::Task<> sendAsync(Bytes, Slice<Sys::Handle>) override {
+        if (broken)
+            co_return Error::brokenPipe("channel is broken");
+        co_return Ok();
+    }
+
+    Async::Task<Cons<usize>> recvAsync(MutBytes, MutSlice<Sys::Handle>) override {
+        co_return Error::notImplemented();
+    }
+};
+
+struct _Lender {
+    static constexpr u64 _UID = 0x1e4d1e4d1e4d1e4d;
+
+    virtual ~_Lender() = default;
+
+    virtual Async::Task<u64> lendAsync(u64 n) = 0;
+
+    Async::Task<> _dispatch(Dispatch &d) {
+        return d.call<u64>([&](u64 n) {
+            return lendAsync(n);
+        });
+    }
+};
+
+struct Lender : public Object<_Lender> {
+    usize takenBack = 0;
+
+    using Object<_Lender>::Object;
+
+    Async::Task<u64> lendAsync(u64 n) override {
+        auto &call = _server.call();
+        call.onUndelivered([this] {
+            takenBack++;
+        });
+        co_return Ok(n);
+    }
+};
+
+static Res<> _callLender(Server &server, Lender &lender) {
+    Message msg;
+    try$(Io::pack(msg.pack, Header{.oid = lender._oid, .uid = _Lender::_UID, .kind = Kind::REQUEST}));
+    try$(Io::pack(msg.pack, Tuple<u64>{42}));
+    Io::PackScan scan{msg.buf.bytes(), msg.pack.handles()};
+    return Async::run(server._dispatchAsync(scan, Sys::now()));
+}
+
+test$("ipc-call-undelivered") {
+    Server server{Sys::IpcConnection{makeStrong<Sys::NullFd>(), NONE}};
+    auto channel = makeBox<DroppingChannel>();
+    auto &dropping = *channel;
+    server._channel = Box<Channel>{std::move(channel)};
+    Lender lender{server};
+
+    try$(_callLender(server, lender));
+    expectEq$(lender.takenBack, 0uz);
+
+    dropping.broken = true;
+    expect$(not _callLender(server, lender));
+    expectEq$(lender.takenBack, 1uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Ipc::Tests
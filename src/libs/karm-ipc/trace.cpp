@@ -0,0 +1,217 @@
+#include <karm-io/fmt.h>
+#include <karm-sys/file.h>
+
+#include "trace.h"
+
+namespace Karm::Ipc {
+
+// MARK: Histogram -------------------------------------------------------------
+
+void Histogram::record(TimeSpan span) {
+    u64 usecs = span.toUSecs();
+    usize bucket = 0;
+    while (usecs >> (bucket + 1) and bucket + 1 < BUCKETS)
+        bucket++;
+
+    buckets[bucket]++;
+    count++;
+    sum += usecs;
+    max = Karm::max(max, usecs);
+}
+
+TimeSpan Histogram::mean() const {
+    if (count == 0)
+        return TimeSpan::zero();
+    return TimeSpan::fromUSecs(sum / count);
+}
+
+TimeSpan Histogram::percentile(f64 p) const {
+    if (count == 0)
+        return TimeSpan::zero();
+
+    u64 rank = (u64)(p * count);
+    u64 seen = 0;
+    for (usize i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > rank)
+            return TimeSpan::fromUSecs(min((u64)(1uz << (i + 1)) - 1, max));
+    }
+    return TimeSpan::fromUSecs(max);
+}
+
+// MARK: Tracer ----------------------------------------------------------------
+
+MethodStats &Tracer::stats(u64 uid, u64 mid) {
+    auto cmp = [&](MethodStats const &s) {
+        auto c = s.uid <=> uid;
+        return c != 0 ? c : s.mid <=> mid;
+    };
+
+    if (auto i = search(_stats, cmp))
+        return _stats[*i];
+
+    auto upper = searchUpperBound(_stats, cmp);
+    auto at = upper ? *upper : _stats.len();
+    _stats.insert(at, MethodStats{.uid = uid, .mid = mid});
+    return _stats[at];
+}
+
+void Tracer::record(bool enabled) {
+    _recording = enabled;
+    if (not enabled)
+        _events.clear();
+}
+
+void Tracer::begin(u64 uid, u64 mid, TimeSpan queued) {
+    auto &s = stats(uid, mid);
+    s.calls++;
+    s.inflight++;
+    s.peakInflight = max(s.peakInflight, s.inflight);
+    s.queueing.record(queued);
+}
+
+void Tracer::end(TraceEvent const &event) {
+    auto &s = stats(event.uid, event.mid);
+    s.inflight--;
+    s.reqBytes += event.reqLen;
+    s.respBytes += event.respLen;
+    s.handling.record(event.ended - event.started);
+    if (not event.ok)
+        s.errors++;
+
+    if (not _recording)
+        return;
+
+    if (_events.len() == EVENTS)
+        _events.popFront();
+    _events.pushBack(event);
+}
+
+// NOTE: Braces can't be escaped in format strings, so the json is written
+//       out piece by piece.
+struct _Json {
+    Io::TextWriter &_w;
+    bool _first = true;
+
+    Res<> raw(Str str) {
+        try$(_w.writeStr(str));
+        return Ok();
+    }
+
+    Res<> key(Str name) {
+        if (not std::exchange(_first, false))
+            try$(raw(","));
+        try$(Io::format(_w, "\"{}\":", name));
+        return Ok();
+    }
+
+    Res<> field(Str name, auto const &val) {
+        try$(key(name));
+        try$(Io::format(_w, "{}", val));
+        return Ok();
+    }
+
+    Res<> string(Str name, Str val) {
+        try$(key(name));
+        try$(Io::format(_w, "\"{}\"", val));
+        return Ok();
+    }
+
+    Res<> begin(Str open) {
+        try$(raw(open));
+        _first = true;
+        return Ok();
+    }
+
+    Res<> end(Str close) {
+        try$(raw(close));
+        _first = false;
+        return Ok();
+    }
+
+    Res<> item() {
+        if (not std::exchange(_first, false))
+            try$(raw(","));
+        return Ok();
+    }
+};
+
+static Res<> _dumpSpan(_Json &json, Str name, TimeStamp start, TimeStamp end, u64 tid) {
+    try$(json.item());
+    try$(json.begin("{"));
+    try$(json.string("name", name));
+    try$(json.string("cat", "ipc"));
+    try$(json.string("ph", "X"));
+    try$(json.field("ts", start.val()));
+    try$(json.field("dur", (end - start).toUSecs()));
+    try$(json.field("pid", 0));
+    try$(json.field("tid", tid));
+    return Ok();
+}
+
+static Res<> _dumpHistogram(_Json &json, Str name, Histogram const &h) {
+    try$(json.key(name));
+    try$(json.begin("{"));
+    try$(json.field("count", h.count));
+    try$(json.field("mean", h.mean().toUSecs()));
+    try$(json.field("p50", h.percentile(0.5).toUSecs()));
+    try$(json.field("p99", h.percentile(0.99).toUSecs()));
+    try$(json.field("max", h.max));
+    try$(json.end("}"));
+    return Ok();
+}
+
+Res<> Tracer::dump(Mime::Url url) const {
+    Io::StringWriter sw;
+    _Json json{sw};
+
+    try$(json.begin("{"));
+    try$(json.key("traceEvents"));
+    try$(json.begin("["));
+    for (usize i = 0; i < _events.len(); i++) {
+        auto const &e = _events.peek(i);
+
+        // NOTE: Waiting and handling are two back to back spans, on one
+        //       track per interface.
+        try$(_dumpSpan(json, "queued", e.received, e.started, e.uid));
+        try$(json.end("}"));
+
+        auto name = try$(Io::format("{:#x}.{}", e.uid, e.mid));
+        try$(_dumpSpan(json, name, e.started, e.ended, e.uid));
+        try$(json.key("args"));
+        try$(json.begin("{"));
+        try$(json.field("seq", e.seq));
+        try$(json.field("req", e.reqLen));
+        try$(json.field("resp", e.respLen));
+        try$(json.field("ok", Str{e.ok ? "true" : "false"}));
+        try$(json.end("}"));
+        try$(json.end("}"));
+    }
+    try$(json.end("]"));
+
+    try$(json.key("ipcStats"));
+    try$(json.begin("["));
+    for (auto const &s : _stats) {
+        try$(json.item());
+        try$(json.begin("{"));
+        try$(json.string("uid", try$(Io::format("{:#x}", s.uid))));
+        try$(json.field("mid", s.mid));
+        try$(json.field("calls", s.calls));
+        try$(json.field("errors", s.errors));
+        try$(json.field("inflight", s.inflight));
+        try$(json.field("peakInflight", s.peakInflight));
+        try$(json.field("reqBytes", s.reqBytes));
+        try$(json.field("respBytes", s.respBytes));
+        try$(_dumpHistogram(json, "queueing", s.queueing));
+        try$(_dumpHistogram(json, "handling", s.handling));
+        try$(json.end("}"));
+    }
+    try$(json.end("]"));
+    try$(json.end("}\n"));
+
+    auto file = try$(Sys::File::create(url));
+    try$(file.write(bytes(sw.str())));
+    return Ok();
+}
+
+} // namespace Karm::Ipc
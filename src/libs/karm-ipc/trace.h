@@ -0,0 +1,83 @@
+#pragma once
+
+#include <karm-base/array.h>
+#include <karm-base/ring.h>
+#include <karm-base/time.h>
+#include <karm-base/vec.h>
+#include <karm-mime/url.h>
+
+namespace Karm::Ipc {
+
+// NOTE: Calls to this method are answered by the server itself with its
+//       MethodStats, whatever object they are addressed to.
+static constexpr u64 STATS_MID = ~0uz;
+
+// Latencies bucketed by powers of two of microseconds, coarse, but constant
+// in size, cheap to record, and good enough to tell the tail from the median.
+struct Histogram {
+    static constexpr usize BUCKETS = 40;
+
+    Array<u64, BUCKETS> buckets{};
+    u64 count = 0;
+    u64 sum = 0; //< In microseconds
+    u64 max = 0; //< In microseconds
+
+    void record(TimeSpan span);
+
+    TimeSpan mean() const;
+
+    // Upper bound of the bucket the p-th percentile falls into.
+    TimeSpan percentile(f64 p) const;
+};
+
+struct MethodStats {
+    u64 uid;
+    u64 mid;
+
+    u64 calls = 0;
+    u64 errors = 0;
+    u64 inflight = 0;
+    u64 peakInflight = 0;
+
+    u64 reqBytes = 0;
+    u64 respBytes = 0;
+
+    Histogram queueing; //< From the message coming in until the handler starts
+    Histogram handling; //< From the handler starting until it returns
+};
+
+struct TraceEvent {
+    u64 uid;
+    u64 mid;
+    u64 seq;
+    TimeStamp received;
+    TimeStamp started;
+    TimeStamp ended;
+    u64 reqLen;
+    u64 respLen;
+    bool ok;
+};
+
+struct Tracer {
+    static constexpr usize EVENTS = 4096;
+
+    Vec<MethodStats> _stats; //< Sorted by uid, then mid
+    bool _recording = false;
+    Karm::Ring<TraceEvent> _events{EVENTS};
+
+    MethodStats &stats(u64 uid, u64 mid);
+
+    // Keep a trace of the last EVENTS calls around, on top of the stats,
+    // for dump() to write out.
+    void record(bool enabled);
+
+    void begin(u64 uid, u64 mid, TimeSpan queued);
+
+    void end(TraceEvent const &event);
+
+    // Write the recorded calls and the stats out in the chrome trace event
+    // format, which most trace viewers can open.
+    Res<> dump(Mime::Url url) const;
+};
+
+} // namespace Karm::Ipc
@@ -0,0 +1,58 @@
+#include <karm-math/bigint.h>
+#include <karm-math/rand.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+static Math::UBig _random(Math::Rand &rand, usize bits) {
+    Math::UBig res;
+    for (usize i = 0; i < bits / 64; i++)
+        res._value.pushBack(rand.nextU64());
+    res._trim();
+    return res;
+}
+
+static void _bench(Str name, usize bits, usize rounds, auto f) {
+    auto start = Sys::now();
+    for (usize i = 0; i < rounds; i++)
+        f();
+    auto elapsed = Sys::now() - start;
+    auto usecs = max(elapsed.toUSecs(), 1uz);
+    Sys::println("{} {}: {} us/op", name, bits, (f64)usecs / rounds);
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    Math::Rand rand{0x5eed};
+
+    for (usize bits : {2048uz, 4096uz}) {
+        auto a = _random(rand, bits);
+        auto b = _random(rand, bits);
+
+        // NOTE: RSA moduli are odd and have their top bit set.
+        auto mod = _random(rand, bits);
+        mod._value[0] |= 1;
+        mod._setBit(bits - 1);
+
+        Math::UBig res, quotient, remainder;
+
+        _bench("mul", bits, 1000, [&] {
+            res = a * b;
+        });
+
+        auto wide = a * b;
+        _bench("div", bits, 1000, [&] {
+            Math::_div(wide, mod, quotient, remainder);
+        });
+
+        // Public exponent, as used to verify signatures.
+        _bench("modexp e=65537", bits, 100, [&] {
+            Math::_powMod(a, 65537_ubig, mod, res);
+        });
+
+        // Full size exponent, as used to sign.
+        _bench("modexp", bits, bits == 2048 ? 10 : 2, [&] {
+            Math::_powMod(a, b, mod, res);
+        });
+    }
+
+    co_return Ok();
+}
@@ -1,170 +1,309 @@
+#include <karm-base/align.h>
+
 #include "bigint.h"
 
 namespace Karm::Math {
 
-// MARK: Unsigned Big Integer --------------------------------------------------
+// MARK: Limbs -----------------------------------------------------------------
 
-void _add(UBig &lhs, usize rhs) {
-    auto lhsLen = lhs._len();
+// NOTE: Everything below works on raw runs of limbs, least significant
+//       first, so the operations on UBig can reuse their storage instead
+//       of going through temporaries.
+
+using Limb = usize;
+using Wide = u128;
 
-    usize carry = 0;
-    usize curr = 0;
-    if (willAddOverflow(rhs, lhs._value[0]))
-        curr = 1;
+static_assert(sizeof(Wide) == 2 * sizeof(Limb));
 
-    usize res = rhs + lhs._value[0];
-    if (willAddOverflow(res, carry))
-        curr = 1;
+static constexpr usize LIMB_BITS = Limits<Limb>::BITS;
 
-    res += carry;
-    carry = curr;
-    lhs._value[0] = res;
+// Below this many limbs, the bookkeeping of karatsuba costs more than
+// the multiplications it saves.
+static constexpr usize KARATSUBA_THRESHOLD = 32;
 
-    for (usize i = 1; carry and lhsLen > i; i++) {
-        usize curr = 0;
-        if (willAddOverflow(lhs._value[i], carry))
-            curr = 1;
-        lhs._value[i] += carry;
-        carry = curr;
+// r = a + b, returns the carry
+static Limb _addLimbs(Limb *r, Limb const *a, Limb const *b, usize n) {
+    Limb carry = 0;
+    for (usize i = 0; i < n; i++) {
+        Wide sum = (Wide)a[i] + b[i] + carry;
+        r[i] = (Limb)sum;
+        carry = (Limb)(sum >> LIMB_BITS);
     }
+    return carry;
+}
 
-    if (carry)
-        lhs._value.pushBack(carry);
+// r = a - b, returns the borrow
+static Limb _subLimbs(Limb *r, Limb const *a, Limb const *b, usize n) {
+    Limb borrow = 0;
+    for (usize i = 0; i < n; i++) {
+        Limb d = a[i] - b[i];
+        Limb b1 = a[i] < b[i];
+        r[i] = d - borrow;
+        borrow = b1 | (d < borrow);
+    }
+    return borrow;
 }
 
-void _add(UBig &lhs, UBig const &rhs) {
-    auto lhsLen = lhs._len();
-    auto rhsLen = rhs._len();
+// Adds `carry` to r, stopping as soon as it stops carrying, returns what
+// is left of it.
+static Limb _carryLimbs(Limb *r, usize n, Limb carry) {
+    for (usize i = 0; carry and i < n; i++) {
+        r[i] += carry;
+        carry = r[i] < carry;
+    }
+    return carry;
+}
 
-    usize carry = 0;
-    for (usize i = 0; i < rhsLen; ++i) {
-        usize curr = 0;
-        if (willAddOverflow(rhs._value[i], lhs._value[i]))
-            curr = 1;
+// Subtracts `borrow` from r, stopping as soon as it stops borrowing,
+// returns what is left of it.
+static Limb _borrowLimbs(Limb *r, usize n, Limb borrow) {
+    for (usize i = 0; borrow and i < n; i++) {
+        Limb d = r[i] - borrow;
+        borrow = r[i] < borrow;
+        r[i] = d;
+    }
+    return borrow;
+}
 
-        usize res = rhs._value[i] + lhs._value[i];
-        if (willAddOverflow(res, carry))
-            curr = 1;
+// r += a * m, returns the carry out of r[n - 1]
+static Limb _mulAddLimbs(Limb *r, Limb const *a, usize n, Limb m) {
+    Limb carry = 0;
+    for (usize i = 0; i < n; i++) {
+        Wide p = (Wide)a[i] * m + r[i] + carry;
+        r[i] = (Limb)p;
+        carry = (Limb)(p >> LIMB_BITS);
+    }
+    return carry;
+}
 
-        res += carry;
-        carry = curr;
-        lhs._value[i] = res;
+// r = a << bits, with bits < LIMB_BITS, returns the bits shifted out
+static Limb _shlLimbs(Limb *r, Limb const *a, usize n, usize bits) {
+    if (bits == 0) {
+        for (usize i = n; i-- > 0;)
+            r[i] = a[i];
+        return 0;
     }
 
-    while (carry and lhsLen > rhsLen) {
-        usize curr = 0;
-        if (willAddOverflow(lhs._value[rhsLen], carry))
-            curr = 1;
+    Limb out = a[n - 1] >> (LIMB_BITS - bits);
+    for (usize i = n - 1; i > 0; i--)
+        r[i] = (a[i] << bits) | (a[i - 1] >> (LIMB_BITS - bits));
+    r[0] = a[0] << bits;
+    return out;
+}
 
-        lhs._value[rhsLen] += carry;
-        carry = curr;
-        rhsLen++;
+// r = a >> bits, with bits < LIMB_BITS
+static void _shrLimbs(Limb *r, Limb const *a, usize n, usize bits) {
+    if (bits == 0) {
+        for (usize i = 0; i < n; i++)
+            r[i] = a[i];
+        return;
     }
 
-    if (carry) {
-        lhs._value.pushBack(carry);
-    }
+    for (usize i = 0; i + 1 < n; i++)
+        r[i] = (a[i] >> bits) | (a[i + 1] << (LIMB_BITS - bits));
+    r[n - 1] = a[n - 1] >> bits;
 }
 
-SubResult _sub(UBig &lhs, usize rhs) {
-    u8 borrow = 0;
-    for (usize i = 0; i < lhs._len(); i++) {
-        usize rhsV = i < 1 ? rhs : 0;
+static isize _cmpLimbs(Limb const *a, Limb const *b, usize n) {
+    for (usize i = n; i-- > 0;) {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
 
-        usize lhsV = lhs._value[i];
+// r[0..an+bn] = a * b, r must not overlap with the inputs
+static void _schoolbook(Limb *r, Limb const *a, usize an, Limb const *b, usize bn) {
+    for (usize i = 0; i < an; i++)
+        r[i] = 0;
 
-        // apply the borrow
-        if (borrow) {
-            if (lhsV == 0) {
-                lhsV = Limits<usize>::MAX;
-                borrow = 1;
-            } else {
-                lhsV--;
-                borrow = 0;
-            }
-        }
+    for (usize j = 0; j < bn; j++)
+        r[an + j] = _mulAddLimbs(r + j, a, an, b[j]);
+}
 
-        // do we need to borrow?
-        if (lhsV < rhsV) {
-            rhsV -= lhsV;
-            lhsV = (Limits<usize>::MAX - rhsV) + 1;
-            borrow = 1;
-        }
+static usize _karatsubaScratch(usize n) {
+    if (n < KARATSUBA_THRESHOLD)
+        return 0;
+    usize m = n - n / 2;
+    return 4 * m + 1 + _karatsubaScratch(m);
+}
 
-        lhsV -= rhsV;
-        lhs._value[i] = lhsV;
+// r[0..2n] = a * b, where a and b are both n limbs long
+static void _karatsuba(Limb *r, Limb const *a, Limb const *b, usize n, Limb *scratch) {
+    if (n < KARATSUBA_THRESHOLD) {
+        _schoolbook(r, a, n, b, n);
+        return;
     }
 
-    if (borrow)
-        return SubResult::UNDERFLOW;
+    // a = a1 * B^h + a0, b = b1 * B^h + b0, with the high halves being
+    // the longest when n is odd.
+    usize h = n / 2;
+    usize m = n - h;
+
+    Limb *sa = scratch;
+    Limb *sb = sa + m;
+    Limb *t = sb + m;
+    Limb *next = t + 2 * m + 1;
 
-    return SubResult::OK;
+    // z0 = a0 * b0 and z2 = a1 * b1 go straight into their place in r.
+    _karatsuba(r, a, b, h, next);
+    _karatsuba(r + 2 * h, a + h, b + h, m, next);
+
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+    for (usize i = 0; i < m; i++) {
+        sa[i] = i < h ? a[i] : 0;
+        sb[i] = i < h ? b[i] : 0;
+    }
+    Limb ca = _addLimbs(sa, sa, a + h, m);
+    Limb cb = _addLimbs(sb, sb, b + h, m);
+
+    _karatsuba(t, sa, sb, m, next);
+    t[2 * m] = 0;
+
+    // NOTE: The sums may have carried out, fold the extra terms back in.
+    if (ca)
+        t[2 * m] += _addLimbs(t + m, t + m, sb, m);
+    if (cb)
+        t[2 * m] += _addLimbs(t + m, t + m, sa, m);
+    if (ca and cb)
+        t[2 * m] += 1;
+
+    Limb borrow = _subLimbs(t, t, r, 2 * h);
+    _borrowLimbs(t + 2 * h, 2 * m + 1 - 2 * h, borrow);
+    borrow = _subLimbs(t, t, r + 2 * h, 2 * m);
+    _borrowLimbs(t + 2 * m, 1, borrow);
+
+    Limb carry = _addLimbs(r + h, r + h, t, 2 * m + 1);
+    _carryLimbs(r + h + 2 * m + 1, 2 * n - (h + 2 * m + 1), carry);
 }
 
-SubResult _sub(UBig &lhs, UBig const &rhs) {
-    u8 borrow = 0;
-    for (usize i = 0; i < lhs._len(); i++) {
-        usize rhsV = i < rhs._len()
-                         ? rhs._value[i]
-                         : 0;
+// r[0..an+bn] = a * b, r must not overlap with the inputs
+static void _mulLimbs(Limb *r, Limb const *a, usize an, Limb const *b, usize bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
 
-        usize lhsV = lhs._value[i];
+    if (bn < KARATSUBA_THRESHOLD) {
+        _schoolbook(r, a, an, b, bn);
+        return;
+    }
 
-        // apply the borrow
-        if (borrow) {
-            if (lhsV == 0) {
-                lhsV = Limits<usize>::MAX;
-                borrow = 1;
-            } else {
-                lhsV--;
-                borrow = 0;
-            }
-        }
+    if (an == bn) {
+        Vec<Limb> scratch;
+        scratch.resize(_karatsubaScratch(bn));
+        _karatsuba(r, a, b, bn, scratch.buf());
+        return;
+    }
 
-        // do we need to borrow?
-        if (lhsV < rhsV) {
-            rhsV -= lhsV;
-            lhsV = (Limits<usize>::MAX - rhsV) + 1;
-            borrow = 1;
-        }
+    for (usize i = 0; i < an + bn; i++)
+        r[i] = 0;
+
+    // NOTE: Karatsuba wants operands of the same length, so cut the
+    //       longest one in chunks as long as the shortest one.
+    Vec<Limb> scratch;
+    scratch.resize(2 * bn + _karatsubaScratch(bn));
+    Limb *prod = scratch.buf();
+
+    for (usize off = 0; off < an; off += bn) {
+        usize len = min(bn, an - off);
+        if (len == bn)
+            _karatsuba(prod, a + off, b, bn, prod + 2 * bn);
+        else
+            _mulLimbs(prod, b, bn, a + off, len);
+
+        Limb carry = _addLimbs(r + off, r + off, prod, len + bn);
+        _carryLimbs(r + off + len + bn, an + bn - (off + len + bn), carry);
+    }
+}
+
+// MARK: Unsigned Big Integer --------------------------------------------------
+
+void _add(UBig &lhs, usize rhs) {
+    if (rhs == 0)
+        return;
 
-        lhsV -= rhsV;
-        lhs._value[i] = lhsV;
+    if (lhs._len() == 0) {
+        lhs._value.pushBack(rhs);
+        return;
     }
 
-    if (borrow)
+    Limb carry = _carryLimbs(lhs._value.buf(), lhs._len(), rhs);
+    if (carry)
+        lhs._value.pushBack(carry);
+}
+
+void _add(UBig &lhs, UBig const &rhs) {
+    auto rhsLen = rhs._len();
+    if (lhs._len() < rhsLen)
+        lhs._value.resize(rhsLen);
+
+    auto *l = lhs._value.buf();
+    Limb carry = _addLimbs(l, l, rhs._value.buf(), rhsLen);
+    carry = _carryLimbs(l + rhsLen, lhs._len() - rhsLen, carry);
+
+    if (carry)
+        lhs._value.pushBack(carry);
+}
+
+SubResult _sub(UBig &lhs, usize rhs) {
+    if (rhs == 0)
+        return SubResult::OK;
+
+    if (lhs._len() == 0)
         return SubResult::UNDERFLOW;
 
-    return SubResult::OK;
+    Limb borrow = _borrowLimbs(lhs._value.buf(), lhs._len(), rhs);
+    return borrow ? SubResult::UNDERFLOW : SubResult::OK;
+}
+
+SubResult _sub(UBig &lhs, UBig const &rhs) {
+    auto lhsLen = lhs._len();
+    auto rhsLen = rhs._len();
+    auto n = min(lhsLen, rhsLen);
+
+    auto *l = lhs._value.buf();
+    Limb borrow = _subLimbs(l, l, rhs._value.buf(), n);
+    borrow = _borrowLimbs(l + n, lhsLen - n, borrow);
+
+    for (usize i = n; i < rhsLen; i++)
+        borrow |= rhs._value[i] != 0;
+
+    return borrow ? SubResult::UNDERFLOW : SubResult::OK;
 }
 
 void _shl(UBig &lhs, usize bits) {
     if (lhs == 0 or bits == 0)
         return;
 
-    usize carry = 0;
+    usize words = bits / LIMB_BITS;
+    usize len = lhs._len();
 
-    for (usize i = 0; i < lhs._len(); ++i) {
-        usize value = lhs._value[i];
-        lhs._value[i] = (value << bits) | carry;
-        carry = value >> (Limits<usize>::BITS - bits);
-    }
+    lhs._value.resize(len + words + 1);
+    auto *l = lhs._value.buf();
 
-    if (carry)
-        lhs._value.pushBack(carry);
+    l[len + words] = _shlLimbs(l + words, l, len, bits % LIMB_BITS);
+    for (usize i = 0; i < words; i++)
+        l[i] = 0;
+
+    lhs._trim();
 }
 
 void _shr(UBig &lhs, usize bits) {
     if (lhs == 0 or bits == 0)
         return;
 
-    usize carry = 0;
-
-    for (usize i = lhs._len(); i-- > 0;) {
-        usize value = lhs._value[i];
-        lhs._value[i] = (value >> bits) | carry;
-        carry = value << (Limits<usize>::BITS - bits);
+    usize words = bits / LIMB_BITS;
+    usize len = lhs._len();
+    if (words >= len) {
+        lhs.clear();
+        return;
     }
+
+    auto *l = lhs._value.buf();
+    _shrLimbs(l, l + words, len - words, bits % LIMB_BITS);
+    lhs._value.trunc(len - words);
+    lhs._trim();
 }
 
 void _binNot(UBig &lhs) {
@@ -194,34 +333,136 @@ void _binXor(UBig &lhs, UBig const &rhs) {
 }
 
 void _mul(UBig &lhs, UBig const &rhs) {
-    UBig shifted = lhs;
-    for (usize wi = 0; wi < rhs._len(); wi++) {
-        for (usize bi = 0; bi < Limits<usize>::BITS; bi++) {
-            auto bit = (rhs._value[wi] >> bi) & 1;
-            _shl(shifted, 1);
-            if (not bit)
-                continue;
-            _add(lhs, shifted);
+    auto lhsLen = lhs._len();
+    auto rhsLen = rhs._len();
+
+    if (lhsLen == 0 or rhsLen == 0) {
+        lhs.clear();
+        return;
+    }
+
+    // NOTE: A single limb can be multiplied in place.
+    if (rhsLen == 1) {
+        Limb m = rhs._value[0];
+        Limb carry = 0;
+        for (usize i = 0; i < lhsLen; i++) {
+            Wide p = (Wide)lhs._value[i] * m + carry;
+            lhs._value[i] = (Limb)p;
+            carry = (Limb)(p >> LIMB_BITS);
         }
+        if (carry)
+            lhs._value.pushBack(carry);
+        lhs._trim();
+        return;
     }
+
+    Vec<Limb> res;
+    res.resize(lhsLen + rhsLen);
+    _mulLimbs(res.buf(), lhs._value.buf(), lhsLen, rhs._value.buf(), rhsLen);
+    lhs._value = std::move(res);
+    lhs._trim();
 }
 
+// Knuth, The Art of Computer Programming, Vol. 2, 4.3.1, Algorithm D
 void _div(UBig const &numerator, UBig const &denominator, UBig &quotient, UBig &remainder) {
-    quotient = 0_ubig;
-    remainder = numerator;
-
-    for (int wi = numerator._len() - 1; wi >= 0; wi--) {
-        for (int bi = Limits<usize>::BITS - 1; bi >= 0; bi--) {
-            usize shift = wi * Limits<usize>::BITS + bi;
-            UBig shifted = denominator;
-            _shl(shifted, shift);
-            auto tmp = remainder;
-            if (_sub(tmp, shifted) == SubResult::UNDERFLOW)
-                continue;
-            remainder = tmp;
-            quotient._setBit(shift);
+    if (denominator == 0) [[unlikely]]
+        panic("division by zero");
+
+    if (numerator < denominator) {
+        remainder = numerator;
+        remainder._trim();
+        quotient.clear();
+        return;
+    }
+
+    usize n = denominator._len();
+    usize m = numerator._len() - n;
+
+    // NOTE: The numerator and the denominator may alias the outputs.
+    if (n == 1) {
+        Limb d = denominator._value[0];
+        Vec<Limb> q;
+        q.resize(m + 1);
+        Wide rem = 0;
+        for (usize i = m + 1; i-- > 0;) {
+            Wide cur = (rem << LIMB_BITS) | numerator._value[i];
+            q[i] = (Limb)(cur / d);
+            rem = cur % d;
+        }
+        quotient._value = std::move(q);
+        quotient._trim();
+        remainder = (usize)rem;
+        return;
+    }
+
+    // D1. Normalize, so the top limb of the divisor has its high bit set,
+    //     which keeps the estimated quotient digits off by at most two.
+    usize shift = __builtin_clzll(denominator._value[n - 1]);
+
+    Vec<Limb> vn, un;
+    vn.resize(n);
+    un.resize(m + n + 1);
+    _shlLimbs(vn.buf(), denominator._value.buf(), n, shift);
+    un[m + n] = _shlLimbs(un.buf(), numerator._value.buf(), m + n, shift);
+
+    Vec<Limb> q;
+    q.resize(m + 1);
+
+    Limb vTop = vn[n - 1];
+    Limb vNext = vn[n - 2];
+
+    for (usize j = m + 1; j-- > 0;) {
+        // D3. Estimate the quotient digit from the top two limbs.
+        Wide top = ((Wide)un[j + n] << LIMB_BITS) | un[j + n - 1];
+        Wide qhat = top / vTop;
+        Wide rhat = top % vTop;
+
+        while ((qhat >> LIMB_BITS) or
+               qhat * vNext > ((rhat << LIMB_BITS) | un[j + n - 2])) {
+            qhat--;
+            rhat += vTop;
+            if (rhat >> LIMB_BITS)
+                break;
+        }
+
+        // D4. Multiply and subtract.
+        Limb carry = 0;
+        Limb borrow = 0;
+        for (usize i = 0; i < n; i++) {
+            Wide p = qhat * vn[i] + carry;
+            carry = (Limb)(p >> LIMB_BITS);
+            Limb lo = (Limb)p;
+            Limb u = un[i + j];
+            Limb d = u - lo;
+            Limb b1 = u < lo;
+            un[i + j] = d - borrow;
+            borrow = b1 | (d < borrow);
+        }
+
+        Limb u = un[j + n];
+        Limb d = u - carry;
+        Limb b1 = u < carry;
+        un[j + n] = d - borrow;
+        borrow = b1 | (d < borrow);
+
+        // D6. The estimate was one too large, add the divisor back.
+        if (borrow) {
+            qhat--;
+            Limb c = _addLimbs(un.buf() + j, un.buf() + j, vn.buf(), n);
+            un[j + n] += c;
         }
+
+        q[j] = (Limb)qhat;
     }
+
+    // D8. Unnormalize the remainder.
+    _shrLimbs(un.buf(), un.buf(), n, shift);
+    un.trunc(n);
+
+    quotient._value = std::move(q);
+    quotient._trim();
+    remainder._value = std::move(un);
+    remainder._trim();
 }
 
 void _gcd(UBig const &lhs, UBig const &rhs, UBig &gcd) {
@@ -250,6 +491,149 @@ void _pow(UBig const &base, UBig const &exp, UBig &res) {
     }
 }
 
+// MARK: Modular Exponentiation ------------------------------------------------
+
+// Arithmetic modulo an odd number in montgomery form, where x is kept as
+// x * R mod m with R = B^n, so reducing a product only takes
+// multiplications and shifts by whole limbs, never a division.
+struct _Montgomery {
+    usize n;
+    Vec<Limb> m;
+    Limb inv; //< -m^-1 mod B
+    Vec<Limb> t;
+
+    _Montgomery(UBig const &mod)
+        : n(mod._len()), m(mod._value) {
+        // NOTE: Newton's iteration doubles the number of correct bits
+        //       every step, and m0 * m0 = 1 mod 8 gives the first three.
+        Limb m0 = m[0];
+        Limb x = m0;
+        for (usize i = 0; i < 5; i++)
+            x *= 2 - m0 * x;
+        inv = -x;
+
+        t.resize(n + 2);
+    }
+
+    // x * R mod m, for any x
+    void to(UBig const &x, Limb *out) const {
+        UBig shifted = x;
+        _shl(shifted, n * LIMB_BITS);
+
+        UBig q, r;
+        UBig mod;
+        mod._value = m;
+        _div(shifted, mod, q, r);
+
+        for (usize i = 0; i < n; i++)
+            out[i] = i < r._len() ? r._value[i] : 0;
+    }
+
+    // out = a * b / R mod m, out may alias a or b
+    void mul(Limb *out, Limb const *a, Limb const *b) {
+        auto *tt = t.buf();
+        for (usize i = 0; i < n + 2; i++)
+            tt[i] = 0;
+
+        // NOTE: Coarsely integrated operand scanning, interleaving a row
+        //       of the product with a row of the reduction keeps t at
+        //       n + 2 limbs.
+        for (usize i = 0; i < n; i++) {
+            Limb carry = _mulAddLimbs(tt, a, n, b[i]);
+            Wide s = (Wide)tt[n] + carry;
+            tt[n] = (Limb)s;
+            tt[n + 1] = (Limb)(s >> LIMB_BITS);
+
+            Limb u = tt[0] * inv;
+            Wide p = (Wide)u * m[0] + tt[0];
+            carry = (Limb)(p >> LIMB_BITS);
+            for (usize j = 1; j < n; j++) {
+                p = (Wide)u * m[j] + tt[j] + carry;
+                tt[j - 1] = (Limb)p;
+                carry = (Limb)(p >> LIMB_BITS);
+            }
+            s = (Wide)tt[n] + carry;
+            tt[n - 1] = (Limb)s;
+            tt[n] = tt[n + 1] + (Limb)(s >> LIMB_BITS);
+        }
+
+        if (tt[n] or _cmpLimbs(tt, m.buf(), n) >= 0)
+            _subLimbs(tt, tt, m.buf(), n);
+
+        for (usize i = 0; i < n; i++)
+            out[i] = tt[i];
+    }
+};
+
+void _powMod(UBig const &base, UBig const &exp, UBig const &mod, UBig &res) {
+    if (mod == 0) [[unlikely]]
+        panic("modulo zero");
+
+    if (mod == 1) {
+        res.clear();
+        return;
+    }
+
+    // NOTE: Montgomery needs the modulus to be invertible modulo B.
+    if (mod._value[0] % 2 == 0) {
+        UBig b = base % mod;
+        UBig q, r;
+        UBig acc = 1_ubig;
+        for (usize i = exp._len() * LIMB_BITS; i-- > 0;) {
+            _mul(acc, acc);
+            _div(acc, mod, q, acc);
+            if (exp._getBit(i)) {
+                _mul(acc, b);
+                _div(acc, mod, q, acc);
+            }
+        }
+        res = std::move(acc);
+        return;
+    }
+
+    // Fixed window exponentiation, four bits of the exponent at a time.
+    static constexpr usize WINDOW = 4;
+
+    _Montgomery mont{mod};
+    usize n = mont.n;
+
+    Vec<Limb> table;
+    table.resize(n << WINDOW);
+    Limb *powers = table.buf();
+
+    mont.to(1_ubig, powers);
+    mont.to(base, powers + n);
+    for (usize i = 2; i < (1uz << WINDOW); i++)
+        mont.mul(powers + i * n, powers + (i - 1) * n, powers + n);
+
+    Vec<Limb> acc;
+    acc.resize(n);
+    for (usize i = 0; i < n; i++)
+        acc[i] = powers[i];
+
+    usize bits = alignUp(exp._len() * LIMB_BITS, WINDOW);
+    for (usize i = bits; i > 0; i -= WINDOW) {
+        for (usize j = 0; j < WINDOW; j++)
+            mont.mul(acc.buf(), acc.buf(), acc.buf());
+
+        usize window = 0;
+        for (usize j = 0; j < WINDOW; j++)
+            window = (window << 1) | exp._getBit(i - 1 - j);
+
+        if (window)
+            mont.mul(acc.buf(), acc.buf(), powers + window * n);
+    }
+
+    // NOTE: Multiplying by one divides out the last R.
+    Vec<Limb> one;
+    one.resize(n);
+    one[0] = 1;
+    mont.mul(acc.buf(), acc.buf(), one.buf());
+
+    res._value = std::move(acc);
+    res._trim();
+}
+
 // MARK: Signed Big Integer ----------------------------------------------------
 
 void _add(IBig &lhs, IBig const &rhs) {
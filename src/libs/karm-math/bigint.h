@@ -44,6 +44,10 @@ void _gcd(UBig const &lhs, UBig const &rhs, UBig &gcd);
 
 void _pow(UBig const &base, UBig const &exp, UBig &res);
 
+// res = base^exp mod mod, without ever growing past twice the size of the
+// modulus, odd moduli go through montgomery multiplication.
+void _powMod(UBig const &base, UBig const &exp, UBig const &mod, UBig &res);
+
 struct UBig {
     Vec<usize> _value;
 
@@ -77,12 +81,12 @@ struct UBig {
     void _setBit(usize bit) {
         if (bit >= _value.len() * Limits<usize>::BITS)
             _value.resize(bit / Limits<usize>::BITS + 1);
-        _value[bit / Limits<usize>::BITS] |= 1 << (bit % Limits<usize>::BITS);
+        _value[bit / Limits<usize>::BITS] |= 1uz << (bit % Limits<usize>::BITS);
     }
 
     bool _getBit(usize bit) const {
         return bit < _value.len() * Limits<usize>::BITS and
-               (_value[bit / Limits<usize>::BITS] & (1 << (bit % Limits<usize>::BITS))) != 0;
+               (_value[bit / Limits<usize>::BITS] & (1uz << (bit % Limits<usize>::BITS))) != 0;
     }
 
     UBig operator~() {
@@ -279,6 +283,8 @@ struct UBig {
     }
 
     Bool operator==(usize rhs) const {
+        if (rhs == 0)
+            return _len() == 0;
         return _len() == 1 and _value[0] == rhs;
     }
 };
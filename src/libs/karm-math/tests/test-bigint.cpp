@@ -0,0 +1,87 @@
+#include <karm-math/bigint.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Math::Tests {
+
+// 2^bits - 1
+static UBig _ones(usize bits) {
+    UBig res = 1_ubig << bits;
+    --res;
+    return res;
+}
+
+test$("ubig-add-sub") {
+    auto a = _ones(128);
+    auto b = a + 1_ubig;
+    expect$(b == 1_ubig << 128);
+    expect$(b - 1_ubig == a);
+    expect$(b - a == 1_ubig);
+
+    UBig c = 5_ubig;
+    expect$(_sub(c, 6_ubig) == SubResult::UNDERFLOW);
+
+    return Ok();
+}
+
+test$("ubig-shift") {
+    auto a = 0xdeadbeef_ubig;
+    expect$((a << 200) >> 200 == a);
+    expect$((a << 3) == 0x6f56df778_ubig);
+    expect$((a >> 40) == 0_ubig);
+
+    return Ok();
+}
+
+test$("ubig-mul") {
+    // (2^k - 1)^2 = 2^2k - 2^(k+1) + 1, on both sides of the karatsuba
+    // threshold.
+    for (usize k : {64uz, 640uz, 4096uz, 6000uz}) {
+        auto a = _ones(k);
+        auto expected = (1_ubig << (2 * k)) - (1_ubig << (k + 1)) + 1_ubig;
+        expect$(a * a == expected);
+    }
+
+    auto a = _ones(3000);
+    auto b = _ones(200) << 77;
+    expect$(a * b == b * a);
+
+    return Ok();
+}
+
+test$("ubig-div") {
+    auto a = _ones(5000) - (1_ubig << 1234);
+    auto b = _ones(1500) + 12345_ubig;
+    auto r = _ones(700);
+
+    auto n = a * b + r;
+    expect$(n / b == a);
+    expect$(n % b == r);
+
+    expect$(n / 7_ubig * 7_ubig + n % 7_ubig == n);
+    expect$(r / b == 0_ubig);
+    expect$(r % b == r);
+
+    return Ok();
+}
+
+test$("ubig-pow-mod") {
+    // Fermat's little theorem, with mersenne primes.
+    for (usize p : {127uz, 521uz, 607uz}) {
+        auto m = _ones(p);
+        UBig res;
+        _powMod(3_ubig, m - 1_ubig, m, res);
+        expect$(res == 1_ubig);
+    }
+
+    // Even moduli don't go through montgomery.
+    UBig res;
+    _powMod(3_ubig, 100_ubig, 1_ubig << 70, res);
+
+    UBig expected;
+    _pow(3_ubig, 100_ubig, expected);
+    expect$(res == expected % (1_ubig << 70));
+
+    return Ok();
+}
+
+} // namespace Karm::Math::Tests
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <karm-base/array.h>
+#include <karm-base/box.h>
 #include <karm-base/map.h>
 #include <karm-math/rand.h>
 #include <karm-sys/mmap.h>
@@ -10,19 +12,34 @@
 namespace Karm::Media {
 
 struct TtfFontface : public Fontface {
-    Sys::Mmap _mmap;
+    // NOTE: Glyph ids are cached in pages of 256 runes, indexed by the
+    //       rest of the rune, pages are only allocated once a rune in them
+    //       is asked for, which keeps lookups constant time even for
+    //       fonts with tens of thousands of glyphs.
+    static constexpr usize PAGE_LEN = 256;
+    static constexpr usize PAGE_COUNT = 0x110000 / PAGE_LEN;
+    static constexpr u32 UNCACHED = Limits<u32>::MAX;
+
+    using _Page = Array<u32, PAGE_LEN>;
+
+    Strong<Sys::Mmap> _mmap;
     Ttf::Font _ttf;
-    Map<Rune, Media::Glyph> _cachedEntries;
+    Vec<Opt<Box<_Page>>> _cachedPages;
     Map<Media::Glyph, f64> _cachedAdvances;
     Map<Cons<Media::Glyph>, f64> _cachedKerns;
+    Opt<Vec<usize>> _substitutions;
+
+    static Res<Strong<TtfFontface>> load(Strong<Sys::Mmap> mmap) {
+        auto ttf = try$(Ttf::Font::load(mmap->bytes()));
+        return Ok(makeStrong<TtfFontface>(mmap, ttf));
+    }
 
     static Res<Strong<TtfFontface>> load(Sys::Mmap &&mmap) {
-        auto ttf = try$(Ttf::Font::load(mmap.bytes()));
-        return Ok(makeStrong<TtfFontface>(std::move(mmap), ttf));
+        return load(makeStrong<Sys::Mmap>(std::move(mmap)));
     }
 
-    TtfFontface(Sys::Mmap &&mmap, Ttf::Font ttf)
-        : _mmap(std::move(mmap)),
+    TtfFontface(Strong<Sys::Mmap> mmap, Ttf::Font ttf)
+        : _mmap(mmap),
           _ttf(std::move(ttf)) {
     }
 
@@ -38,12 +55,24 @@ struct TtfFontface : public Fontface {
     }
 
     Glyph glyph(Rune rune) override {
-        auto glyph = _cachedEntries.get(rune);
-        if (glyph.has())
-            return glyph.unwrap();
-        auto g = _ttf.glyph(rune);
-        _cachedEntries.put(rune, g);
-        return g;
+        usize page = rune / PAGE_LEN;
+        if (page >= PAGE_COUNT)
+            return _ttf.glyph(rune);
+
+        while (_cachedPages.len() <= page)
+            _cachedPages.pushBack(NONE);
+
+        if (not _cachedPages[page]) {
+            auto p = makeBox<_Page>();
+            for (usize i = 0; i < PAGE_LEN; i++)
+                (*p)[i] = UNCACHED;
+            _cachedPages[page] = std::move(p);
+        }
+
+        auto &entry = (**_cachedPages[page])[rune % PAGE_LEN];
+        if (entry == UNCACHED)
+            entry = _ttf.glyph(rune).value();
+        return Glyph(entry);
     }
 
     f64 advance(Glyph glyph) override {
@@ -65,6 +94,33 @@ struct TtfFontface : public Fontface {
         return k;
     }
 
+    void substitute(GlyphRun &run) override {
+        if (not _ttf._gsub.present())
+            return;
+
+        if (not _substitutions) {
+            Array<Str, 3> features = {"ccmp", "liga", "rlig"};
+            _substitutions = _ttf._gsub.lookups(features);
+        }
+
+        if (isEmpty(*_substitutions))
+            return;
+
+        Vec<usize> glyphs;
+        Vec<usize> clusters;
+        for (auto &g : run.glyphs) {
+            glyphs.pushBack(g.glyph.value());
+            clusters.pushBack(g.cluster);
+        }
+
+        for (auto lookup : *_substitutions)
+            _ttf._gsub.apply(lookup, _ttf._gdef, glyphs, clusters);
+
+        run.glyphs.clear();
+        for (usize i = 0; i < glyphs.len(); i++)
+            run.glyphs.pushBack({.glyph = Glyph(glyphs[i]), .cluster = clusters[i]});
+    }
+
     void contour(Gfx::Context &g, Glyph glyph) const override {
         _ttf.glyphContour(g, glyph);
     }
@@ -72,6 +128,10 @@ struct TtfFontface : public Fontface {
     f64 units() const override {
         return _ttf.unitPerEm();
     }
+
+    Opt<Bytes> program() const override {
+        return _mmap->bytes();
+    }
 };
 
 } // namespace Karm::Media
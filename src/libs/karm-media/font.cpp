@@ -1,3 +1,6 @@
+#include <karm-base/hash.h>
+#include <karm-base/lock.h>
+#include <karm-base/lru.h>
 #include <karm-gfx/context.h>
 
 #include "font-vga.h"
@@ -57,4 +60,90 @@ FontMeasure Font::measure(Glyph r) {
         .baseline = {0, m.ascend},
     };
 }
+
+// MARK: Shaping ---------------------------------------------------------------
+
+static GlyphRun _shape(Strong<Fontface> fontface, Slice<Rune> runes) {
+    GlyphRun run{
+        .fontface = fontface,
+    };
+    run.runes.pushBack(runes);
+
+    run.glyphs.ensure(runes.len());
+    for (usize i = 0; i < runes.len(); i++)
+        run.glyphs.pushBack({.glyph = fontface->glyph(runes[i]), .cluster = i});
+
+    fontface->substitute(run);
+
+    f64 adv = 0;
+    for (usize i = 0; i < run.glyphs.len(); i++) {
+        auto &g = run.glyphs[i];
+        if (i > 0)
+            adv += fontface->kern(run.glyphs[i - 1].glyph, g.glyph);
+        g.pos = adv;
+        g.adv = fontface->advance(g.glyph);
+        adv += g.adv;
+    }
+    run.width = adv;
+
+    return run;
+}
+
+// NOTE: The same labels get laid out again on every frame, keep the most
+//       recent runs around instead of walking the lookup tables each time.
+//       Runs are shared by every thread drawing text, so is the cache, and
+//       fontfaces fill their own caches while shaping, hence the lock
+//       being held for all of it.
+static constexpr usize SHAPED_RUNS_CAP = 256;
+
+static Lock _shapedRunsLock;
+
+static Lru<Hash, Strong<GlyphRun>> &_shapedRuns() {
+    static Lru<Hash, Strong<GlyphRun>> runs{SHAPED_RUNS_CAP};
+    return runs;
+}
+
+static Strong<GlyphRun> _cache(Hash key, Strong<GlyphRun> run) {
+    _shapedRuns().access(key, [&] {
+        return run;
+    }) = run;
+    return run;
+}
+
+Strong<GlyphRun> Font::shape(Slice<Rune> runes) {
+    Bytes bytes{reinterpret_cast<Byte const *>(runes.buf()), runes.len() * sizeof(Rune)};
+    Hash key = hash(bytes) ^ hash((usize)&*fontface);
+
+    LockScope scope{_shapedRunsLock};
+    auto cached = _shapedRuns().get(key);
+    if (cached and &*(*cached)->fontface == &*fontface and (*cached)->runes == runes)
+        return *cached;
+
+    return _cache(key, makeStrong<GlyphRun>(_shape(fontface, runes)));
+}
+
+static bool _sameText(GlyphRun const &run, Str str) {
+    usize i = 0;
+    for (auto rune : iterRunes(str))
+        if (i >= run.runes.len() or run.runes[i++] != rune)
+            return false;
+    return i == run.runes.len();
+}
+
+Strong<GlyphRun> Font::shape(Str str) {
+    // NOTE: Keyed on the utf-8 bytes, a hit costs a hash and a compare,
+    //       nothing gets decoded nor allocated.
+    Hash key = hash(bytes(str)) ^ hash((usize)&*fontface) ^ 1;
+
+    LockScope scope{_shapedRunsLock};
+    auto cached = _shapedRuns().get(key);
+    if (cached and &*(*cached)->fontface == &*fontface and _sameText(**cached, str))
+        return *cached;
+
+    Vec<Rune> runes;
+    for (auto rune : iterRunes(str))
+        runes.pushBack(rune);
+    return _cache(key, makeStrong<GlyphRun>(_shape(fontface, runes)));
+}
+
 } // namespace Karm::Media
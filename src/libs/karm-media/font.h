@@ -2,6 +2,7 @@
 
 #include <karm-base/distinct.h>
 #include <karm-base/rc.h>
+#include <karm-base/vec.h>
 #include <karm-math/rect.h>
 
 namespace Karm::Gfx {
@@ -87,6 +88,15 @@ struct Glyph : public Distinct<usize, struct _GlyphTag> {
 
 constexpr Glyph Glyph::TOFU{Limits<usize>::MIN};
 
+struct ShapedGlyph {
+    Glyph glyph;
+    usize cluster; //< Index of the first rune the glyph comes from
+    f64 pos = 0;   //< Position of the glyph along the run, in font units
+    f64 adv = 0;   //< Advance of the glyph, in font units
+};
+
+struct GlyphRun;
+
 struct Fontface {
     static Strong<Fontface> fallback();
 
@@ -100,9 +110,26 @@ struct Fontface {
 
     virtual f64 kern(Glyph prev, Glyph curr) = 0;
 
+    // Replaces glyphs of the run, by ligatures for example, positions
+    // are computed afterward.
+    virtual void substitute(GlyphRun &) {}
+
     virtual void contour(Gfx::Context &g, Glyph glyph) const = 0;
 
     virtual f64 units() const = 0;
+
+    // The TrueType program of the face, for backends that embed fonts in
+    // their output, like pdf.
+    virtual Opt<Bytes> program() const { return NONE; }
+};
+
+// The result of shaping some text, positions are in font units so that a
+// run can be reused whatever the size of the font.
+struct GlyphRun {
+    Strong<Fontface> fontface;
+    Vec<Rune> runes;
+    Vec<ShapedGlyph> glyphs;
+    f64 width = 0;
 };
 
 struct Font {
@@ -123,6 +150,13 @@ struct Font {
     f64 kern(Glyph prev, Glyph curr);
 
     FontMeasure measure(Glyph glyph);
+
+    // Shapes the runes into a run of positioned glyphs, runs are cached
+    // so that shaping the same text again is only a lookup.
+    Strong<GlyphRun> shape(Slice<Rune> runes);
+
+    // Same as above, but the text is only decoded when it isn't cached yet.
+    Strong<GlyphRun> shape(Str str);
 };
 
 } // namespace Karm::Media
@@ -1,8 +1,8 @@
 #include <bmp/spec.h>
 #include <jpeg/spec.h>
 #include <karm-sys/chan.h>
-#include <karm-sys/file.h>
 #include <karm-sys/mmap.h>
+#include <karm-sys/resource.h>
 #include <karm-sys/time.h>
 #include <png/spec.h>
 #include <qoi/spec.h>
@@ -20,9 +20,8 @@ Res<Strong<Fontface>> loadFontface(Sys::Mmap &&map) {
 
 Res<Strong<Fontface>> loadFontface(Mime::Url url) {
     logInfo("media: loading '{}' as fontface...", url);
-    auto file = try$(Sys::File::open(url));
-    auto map = try$(Sys::mmap().map(file));
-    return loadFontface(std::move(map));
+    auto map = try$(Sys::mapResource(url));
+    return Ok(try$(TtfFontface::load(map)));
 }
 
 Res<Strong<Fontface>> loadFontfaceOrFallback(Mime::Url url) {
@@ -78,24 +77,27 @@ static Res<Image> loadJpeg(Bytes bytes) {
     return Ok(img);
 }
 
-Res<Image> loadImage(Sys::Mmap &&map) {
-    if (Bmp::Image::isBmp(map.bytes())) {
-        return loadBmp(map.bytes());
-    } else if (Qoi::Image::isQoi(map.bytes())) {
-        return loadQoi(map.bytes());
-    } else if (Png::Image::isPng(map.bytes())) {
-        return loadPng(map.bytes());
-    } else if (Jpeg::Image::isJpeg(map.bytes())) {
-        return loadJpeg(map.bytes());
+static Res<Image> loadImage(Bytes bytes) {
+    if (Bmp::Image::isBmp(bytes)) {
+        return loadBmp(bytes);
+    } else if (Qoi::Image::isQoi(bytes)) {
+        return loadQoi(bytes);
+    } else if (Png::Image::isPng(bytes)) {
+        return loadPng(bytes);
+    } else if (Jpeg::Image::isJpeg(bytes)) {
+        return loadJpeg(bytes);
     } else {
         return Error::invalidData("unknown image format");
     }
 }
 
+Res<Image> loadImage(Sys::Mmap &&map) {
+    return loadImage(map.bytes());
+}
+
 Res<Image> loadImage(Mime::Url url) {
-    auto file = try$(Sys::File::open(url));
-    auto map = try$(Sys::mmap().map(file));
-    return loadImage(std::move(map));
+    auto map = try$(Sys::mapResource(url));
+    return loadImage(map->bytes());
 }
 
 Res<Image> loadImageOrFallback(Mime::Url url) {
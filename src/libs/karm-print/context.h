@@ -1,11 +1,24 @@
 #pragma once
 
+#include <karm-gfx/color.h>
+#include <karm-math/rect.h>
+#include <karm-media/font.h>
+
+#include "paper.h"
+
 namespace Karm::Print {
 
+// A surface made of pages, coordinates are in css pixels from the top
+// left corner of the current page.
 struct Context {
     virtual ~Context() = default;
 
-    void pageBreak() {}
+    // Ends the current page, anything drawn after goes on a new one.
+    virtual void pageBreak() {}
+
+    virtual void fill(Math::Rectf, Gfx::Color) {}
+
+    virtual void fill(Math::Vec2f, Media::Font const &, Media::GlyphRun const &, Gfx::Color) {}
 };
 
 } // namespace Karm::Print
@@ -9,6 +9,7 @@
 #include "dir.h"
 #include "fd.h"
 #include "info.h"
+#include "thread.h"
 #include "types.h"
 
 namespace Karm::Sys::_Embed {
@@ -37,6 +38,10 @@ Res<Vec<Sys::DirEntry>> readDir(Mime::Url const &url);
 
 Res<Stat> stat(Mime::Url const &url);
 
+// The archive every bundle was packed into, mapped for as long as the
+// process lives, if there is one.
+Res<Bytes> bundleArchive();
+
 // MARK: User interactions -----------------------------------------------------
 
 Res<> launch(Mime::Uti const &intent, Mime::Url const &url);
@@ -49,10 +54,16 @@ Res<Strong<Sys::Fd>> listenUdp(SocketAddr addr);
 
 Res<Strong<Sys::Fd>> connectTcp(SocketAddr addr);
 
-Res<Strong<Sys::Fd>> listenTcp(SocketAddr addr);
+Res<Strong<Sys::Fd>> listenTcp(SocketAddr addr, bool shared);
 
 Res<Strong<Sys::Fd>> listenIpc(Mime::Url url);
 
+Res<Strong<Sys::Fd>> connectIpc(Mime::Url url);
+
+Res<Cons<Strong<Sys::Fd>, Strong<Sys::Fd>>> createIpcPair();
+
+Res<Strong<Sys::Fd>> openTap(Str name);
+
 // MARK: Time ------------------------------------------------------------------
 
 TimeStamp now();
@@ -69,6 +80,14 @@ Res<> memUnmap(void const *buf, usize len);
 
 Res<> memFlush(void *flush, usize len);
 
+Res<Strong<Sys::Fd>> createShm(usize size);
+
+// MARK: Synchronization -------------------------------------------------------
+
+Res<> futexWait(u32 *addr, u32 expected, TimeStamp until);
+
+Res<> futexWake(u32 *addr, usize count);
+
 // MARK: System Informations ---------------------------------------------------
 
 Res<> populate(Sys::SysInfo &);
@@ -87,6 +106,8 @@ Res<> sleep(TimeSpan);
 
 Res<> exit(i32);
 
+Res<Strong<Sys::Thread>> spawnThread(Func<void()> fn);
+
 // MARK: Asynchronous I/O ------------------------------------------------------
 
 Sched &globalSched();
@@ -4,6 +4,7 @@
 #include <karm-base/endian.h>
 #include <karm-io/aton.h>
 #include <karm-io/fmt.h>
+#include <karm-io/pack.h>
 
 namespace Karm::Sys {
 
@@ -228,3 +229,35 @@ struct Karm::Io::Formatter<Karm::Sys::SocketAddr> {
         return Io::format(writer, "{}:{}", addr.addr, addr.port);
     }
 };
+
+template <>
+struct Karm::Io::Packer<Karm::Sys::Ip> {
+    static Res<> pack(PackEmit &e, Karm::Sys::Ip const &val) {
+        try$(Io::pack<u8>(e, val.index()));
+        return val.visit(Visitor{
+            [&](Karm::Sys::Ip4 const &ip) {
+                return Io::pack(e, ip.bytes);
+            },
+            [&](Karm::Sys::Ip6 const &ip) {
+                return Io::pack(e, ip.words);
+            },
+        });
+    }
+
+    static Res<Karm::Sys::Ip> unpack(PackScan &s) {
+        auto index = try$(Io::unpack<u8>(s));
+        if (index == 0) {
+            Array<u8, 4> bytes;
+            s.readTo(&bytes);
+            return Ok(Karm::Sys::Ip4{bytes});
+        }
+
+        if (index == 1) {
+            Array<u16, 8> words;
+            s.readTo(&words);
+            return Ok(Karm::Sys::Ip6{words});
+        }
+
+        return Error::invalidData("invalid ip address kind");
+    }
+};
@@ -127,23 +127,40 @@ struct Sched :
 
     virtual Res<> wait(TimeStamp until) = 0;
 
-    virtual Async::Task<usize> readAsync(Strong<Fd>, MutBytes) = 0;
+    // Makes the current or next call to wait() return early, this is the
+    // only method that is safe to call from another thread.
+    virtual Res<> wake() = 0;
 
-    virtual Async::Task<usize> writeAsync(Strong<Fd>, Bytes) = 0;
+    // NOTE: Operations that take a token fail with Error::interrupted once
+    //       it's canceled, and are done with their buffers by then.
+    virtual Async::Task<usize> readAsync(Strong<Fd>, MutBytes, Async::Cancelation::Token ct = {}) = 0;
+
+    virtual Async::Task<usize> writeAsync(Strong<Fd>, Bytes, Async::Cancelation::Token ct = {}) = 0;
 
     virtual Async::Task<usize> flushAsync(Strong<Fd>) = 0;
 
-    virtual Async::Task<_Accepted> acceptAsync(Strong<Fd>) = 0;
+    virtual Async::Task<_Accepted> acceptAsync(Strong<Fd>, Async::Cancelation::Token ct = {}) = 0;
 
-    virtual Async::Task<_Sent> sendAsync(Strong<Fd>, Bytes, Slice<Handle>, SocketAddr) = 0;
+    virtual Async::Task<_Sent> sendAsync(Strong<Fd>, Bytes, Slice<Handle>, SocketAddr, Async::Cancelation::Token ct = {}) = 0;
 
-    virtual Async::Task<_Received> recvAsync(Strong<Fd>, MutBytes, MutSlice<Handle>) = 0;
+    virtual Async::Task<_Received> recvAsync(Strong<Fd>, MutBytes, MutSlice<Handle>, Async::Cancelation::Token ct = {}) = 0;
 
-    virtual Async::Task<> sleepAsync(TimeStamp until) = 0;
+    virtual Async::Task<> sleepAsync(TimeStamp until, Async::Cancelation::Token ct = {}) = 0;
 };
 
 Sched &globalSched();
 
+// Runs `task` and fails with Error::timedOut if it isn't done by `until`,
+// `task` must be made with a token of `c` so that it can be canceled.
+template <typename V>
+Async::Task<V> timeoutAsync(TimeStamp until, Async::Cancelation &c, Async::Task<V> task) {
+    auto expire = [](TimeStamp until, Async::Cancelation::Token ct) -> Async::Task<V> {
+        co_trya$(globalSched().sleepAsync(until, ct));
+        co_return Error::timedOut("operation timed out");
+    };
+    return Async::race(c, std::move(task), expire(until, c.token()));
+}
+
 template <Async::Sender S>
 auto run(S s, Sched &sched = globalSched()) {
     return Async::run(std::move(s), [&] {
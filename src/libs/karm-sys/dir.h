@@ -2,6 +2,7 @@
 
 #include <karm-base/res.h>
 #include <karm-base/vec.h>
+#include <karm-io/pack.h>
 #include <karm-mime/url.h>
 
 namespace Karm::Sys {
@@ -23,3 +24,17 @@ struct Dir {
 };
 
 } // namespace Karm::Sys
+
+template <>
+struct Karm::Io::Packer<Karm::Sys::DirEntry> {
+    static Res<> pack(PackEmit &e, Karm::Sys::DirEntry const &val) {
+        try$(Io::pack(e, val.name));
+        return Io::pack(e, val.isDir);
+    }
+
+    static Res<Karm::Sys::DirEntry> unpack(PackScan &s) {
+        auto name = try$(Io::unpack<String>(s));
+        auto isDir = try$(Io::unpack<bool>(s));
+        return Ok(Karm::Sys::DirEntry{name, isDir});
+    }
+};
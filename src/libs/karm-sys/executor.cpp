@@ -0,0 +1,102 @@
+#include "executor.h"
+
+#include "info.h"
+
+namespace Karm::Sys {
+
+Res<Box<Executor>> Executor::create(usize len) {
+    if (len == 0)
+        len = max(try$(cpusinfo()).len(), 1uz);
+
+    auto exec = makeBox<Executor>();
+    for (usize i = 0; i < len; i++)
+        exec->_loops.pushBack(makeBox<_Loop>());
+
+    for (auto &loop : exec->_loops) {
+        auto *self = &*exec;
+        auto *l = &*loop;
+        auto thread = spawnThread([self, l] {
+            self->_run(*l);
+        });
+
+        if (not thread) {
+            exec->stop();
+            (void)exec->join();
+            return thread.none();
+        }
+
+        loop->_thread = thread.take();
+    }
+
+    return Ok(std::move(exec));
+}
+
+Executor::~Executor() {
+    stop();
+    (void)join();
+}
+
+usize Executor::spawn(Async::Task<> task) {
+    usize best = 0;
+    for (usize i = 1; i < len(); i++)
+        if (load(i) < load(best))
+            best = i;
+    spawnOn(best, std::move(task));
+    return best;
+}
+
+void Executor::spawnOn(usize i, Async::Task<> task) {
+    auto &loop = *_loops[i];
+    loop._load.inc();
+    {
+        LockScope scope(loop._lock);
+        loop._queue.pushBack(std::move(task));
+    }
+
+    // NOTE: A loop that isn't running yet picks up its queue when it
+    //       starts, so there is nothing to wake.
+    if (auto *sched = loop._sched.load())
+        (void)sched->wake();
+}
+
+void Executor::stop() {
+    _stopping.store(true);
+    for (auto &loop : _loops)
+        if (auto *sched = loop->_sched.load())
+            (void)sched->wake();
+}
+
+Res<> Executor::join() {
+    for (auto &loop : _loops) {
+        if (loop->_thread)
+            try$(loop->_thread.take()->join());
+    }
+    return Ok();
+}
+
+void Executor::_run(_Loop &loop) {
+    auto &sched = globalSched();
+    loop._sched.store(&sched);
+
+    while (not _stopping.load()) {
+        Vec<Async::Task<>> tasks;
+        {
+            LockScope scope(loop._lock);
+            tasks = std::move(loop._queue);
+        }
+
+        for (auto &task : tasks) {
+            Async::detach(std::move(task), [&loop](Res<>) {
+                loop._load.dec();
+            });
+        }
+
+        // NOTE: spawnOn() wakes the loop after queuing, so a task queued
+        //       since the queue was taken makes this return right away.
+        (void)sched.wait(TimeStamp::endOfTime());
+    }
+
+    loop._sched.store(nullptr);
+}
+
+} // namespace Karm::Sys
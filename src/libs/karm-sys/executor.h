@@ -0,0 +1,67 @@
+#pragma once
+
+#include <karm-base/atomic.h>
+#include <karm-base/box.h>
+#include <karm-base/lock.h>
+#include <karm-base/vec.h>
+
+#include "async.h"
+#include "thread.h"
+
+namespace Karm::Sys {
+
+// A pool of threads that each run their own event loop.
+//
+// A task is handed to one loop and runs there until it's done, everything
+// it does through globalSched() goes to that loop's scheduler. Tasks on
+// different loops run in parallel, so they must not share anything that
+// isn't thread safe.
+struct Executor : public Meta::NoCopy {
+    struct _Loop {
+        Lock _lock;
+        Vec<Async::Task<>> _queue;
+        Atomic<Sched *> _sched = nullptr;
+        Atomic<usize> _load = 0;
+        Opt<Strong<Thread>> _thread;
+    };
+
+    Vec<Box<_Loop>> _loops;
+    Atomic<bool> _stopping = false;
+
+    // Starts `len` loops, one per cpu if zero.
+    static Res<Box<Executor>> create(usize len = 0);
+
+    ~Executor();
+
+    usize len() const {
+        return _loops.len();
+    }
+
+    // Number of tasks that were spawned on the loop and aren't done yet.
+    usize load(usize loop) {
+        return _loops[loop]->_load.load();
+    }
+
+    // Runs `task` on the least busy loop and returns its index.
+    usize spawn(Async::Task<> task);
+
+    void spawnOn(usize loop, Async::Task<> task);
+
+    // Runs a task made by `make` on every loop, `make` is called on the
+    // calling thread.
+    void spawnEach(auto make) {
+        for (usize i = 0; i < len(); i++)
+            spawnOn(i, make(i));
+    }
+
+    // Makes every loop return as soon as it wakes up, tasks that are still
+    // running are abandoned.
+    void stop();
+
+    // Waits for every loop to return, after a call to stop().
+    Res<> join();
+
+    void _run(_Loop &loop);
+};
+
+} // namespace Karm::Sys
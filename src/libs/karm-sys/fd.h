@@ -77,3 +77,14 @@ concept AsFd = requires(T t) {
 };
 
 } // namespace Karm::Sys
+
+template <>
+struct Karm::Io::Packer<Karm::Strong<Karm::Sys::Fd>> {
+    static Res<> pack(PackEmit &e, Karm::Strong<Karm::Sys::Fd> const &val) {
+        return val->pack(e);
+    }
+
+    static Res<Karm::Strong<Karm::Sys::Fd>> unpack(PackScan &s) {
+        return Karm::Sys::Fd::unpack(s);
+    }
+};
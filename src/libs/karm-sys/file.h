@@ -44,7 +44,8 @@ struct _File :
 
 struct FileReader :
     public virtual _File,
-    public Io::Reader {
+    public Io::Reader,
+    public Io::AsyncReader {
 
     using _File::_File;
 
@@ -52,14 +53,15 @@ struct FileReader :
         return _fd->read(bytes);
     }
 
-    auto readAsync(MutBytes bytes, auto &sched = globalSched()) {
-        return sched.readAsync(_fd, bytes);
+    Async::Task<usize> readAsync(MutBytes bytes) override {
+        return globalSched().readAsync(_fd, bytes);
     }
 };
 
 struct FileWriter :
     public virtual _File,
-    public Io::Writer {
+    public Io::Writer,
+    public Io::AsyncWriter {
 
     using _File::_File;
 
@@ -67,8 +69,8 @@ struct FileWriter :
         return _fd->write(bytes);
     }
 
-    auto writeAsync(Bytes bytes, auto &sched = globalSched()) {
-        return sched.writeAsync(_fd, bytes);
+    Async::Task<usize> writeAsync(Bytes bytes) override {
+        return globalSched().writeAsync(_fd, bytes);
     }
 };
 
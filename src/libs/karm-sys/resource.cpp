@@ -0,0 +1,125 @@
+#include <karm-base/lru.h>
+#include <karm-logger/logger.h>
+
+#include "_embed.h"
+#include "file.h"
+#include "resource.h"
+
+namespace Karm::Sys {
+
+// MARK: Bundle Archives -------------------------------------------------------
+
+Res<BundleArchive> BundleArchive::load(Bytes buf) {
+    if (buf.len() < sizeof(BundleHeader))
+        return Error::invalidData("bundle archive too short");
+
+    auto const &header = *reinterpret_cast<BundleHeader const *>(buf.buf());
+    if (header.magic != BundleHeader::MAGIC)
+        return Error::invalidData("not a bundle archive");
+
+    usize len = header.len;
+    if (len > (buf.len() - sizeof(BundleHeader)) / sizeof(BundleEntry))
+        return Error::invalidData("bundle archive index out of bounds");
+
+    auto const *start = reinterpret_cast<BundleEntry const *>(buf.buf() + sizeof(BundleHeader));
+    Slice<BundleEntry> entries{start, len};
+    for (auto const &e : entries) {
+        if (e.keyOff > buf.len() or e.keyLen > buf.len() - e.keyOff or
+            e.dataOff > buf.len() or e.dataLen > buf.len() - e.dataOff)
+            return Error::invalidData("bundle archive entry out of bounds");
+    }
+
+    return Ok(BundleArchive{buf, entries});
+}
+
+String BundleArchive::keyOf(Mime::Url const &url) {
+    auto path = url.path;
+    path.rooted = true;
+    return Io::format("{}{}", url.host, path.str()).unwrap();
+}
+
+Str BundleArchive::_key(BundleEntry const &entry) const {
+    auto bytes = sub(_buf, entry.keyOff, entry.keyOff + entry.keyLen);
+    return {reinterpret_cast<char const *>(bytes.buf()), bytes.len()};
+}
+
+Opt<Bytes> BundleArchive::lookup(Str key) const {
+    auto i = search(_entries, [&](BundleEntry const &entry) {
+        return _key(entry) <=> key;
+    });
+
+    if (not i)
+        return NONE;
+
+    auto const &entry = _entries[*i];
+    return sub(_buf, entry.dataOff, entry.dataOff + entry.dataLen);
+}
+
+// MARK: Resources -------------------------------------------------------------
+
+struct _Resources {
+    static constexpr usize CACHE_SIZE = 64;
+
+    Lock lock;
+    bool loaded = false;
+    Opt<BundleArchive> archive;
+    Lru<String, Strong<Mmap>> cache{CACHE_SIZE};
+};
+
+static _Resources &_resources() {
+    static _Resources resources;
+    return resources;
+}
+
+static Res<Strong<Mmap>> _map(Mime::Url const &url) {
+    auto file = try$(File::open(url));
+
+    // NOTE: Empty files can't be mapped.
+    if (try$(file.stat()).size == 0)
+        return Ok(makeStrong<Mmap>(try$(Mmap::createUnowned(nullptr, 0))));
+
+    return Ok(makeStrong<Mmap>(try$(mmap().map(file))));
+}
+
+Res<Strong<Mmap>> mapResource(Mime::Url const &url) {
+    // NOTE: Anything but a bundle might change under us, so it's mapped
+    //       again every time.
+    if (url.scheme != "bundle")
+        return _map(url);
+
+    auto &res = _resources();
+    LockScope scope(res.lock);
+
+    if (not res.loaded) {
+        res.loaded = true;
+        if (auto buf = _Embed::bundleArchive()) {
+            auto archive = BundleArchive::load(buf.unwrap());
+            if (archive)
+                res.archive = archive.take();
+            else
+                logWarn("ignoring bundle archive: {}", archive.none());
+        }
+    }
+
+    auto key = BundleArchive::keyOf(url);
+
+    // NOTE: The archive is mapped for as long as the process lives, so
+    //       the mapping handed out doesn't own anything. Resources missing
+    //       from it are looked up in the bundles themselves, the ones in it
+    //       win even when the bundle has a newer copy, see pack-bundles.
+    if (res.archive) {
+        if (auto bytes = res.archive->lookup(key))
+            return Ok(makeStrong<Mmap>(try$(Mmap::createUnowned(bytes->buf(), bytes->len()))));
+    }
+
+    if (auto cached = res.cache.get(key))
+        return Ok(cached.take());
+
+    auto map = try$(_map(url));
+    res.cache.access(key, [&] {
+        return map;
+    });
+    return Ok(map);
+}
+
+} // namespace Karm::Sys
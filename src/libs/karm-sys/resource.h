@@ -0,0 +1,52 @@
+#pragma once
+
+#include <karm-base/endian.h>
+#include <karm-mime/url.h>
+
+#include "mmap.h"
+
+namespace Karm::Sys {
+
+// MARK: Bundle Archives -------------------------------------------------------
+
+// Every bundle can be packed into a single file: a header, an index of
+// entries sorted by key ("<bundle>/<path>"), then the keys and the content
+// of the entries. Offsets are from the start of the file.
+struct BundleHeader {
+    static constexpr Array<u8, 8> MAGIC = {'k', 'b', 'u', 'n', 'd', 'l', 'e', '1'};
+
+    Array<u8, 8> magic;
+    u64le len;
+};
+
+struct BundleEntry {
+    u64le keyOff;
+    u64le keyLen;
+    u64le dataOff;
+    u64le dataLen;
+};
+
+struct BundleArchive {
+    Bytes _buf;
+    Slice<BundleEntry> _entries;
+
+    static Res<BundleArchive> load(Bytes buf);
+
+    static String keyOf(Mime::Url const &url);
+
+    Str _key(BundleEntry const &entry) const;
+
+    Opt<Bytes> lookup(Str key) const;
+};
+
+// MARK: Resources -------------------------------------------------------------
+
+// Maps a resource that doesn't change for the lifetime of the process, like
+// the content of a bundle.
+//
+// Bundle resources come out of the bundle archive when there is one, and are
+// otherwise mapped once and shared by everyone who asks for them, for as
+// long as someone holds on to the mapping or it's still cached.
+Res<Strong<Mmap>> mapResource(Mime::Url const &url);
+
+} // namespace Karm::Sys
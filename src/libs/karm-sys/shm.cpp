@@ -0,0 +1,19 @@
+#include "shm.h"
+
+#include "_embed.h"
+
+namespace Karm::Sys {
+
+Res<Strong<Fd>> createShm(usize size) {
+    return _Embed::createShm(size);
+}
+
+Res<> futexWait(Atomic<u32> &word, u32 expected, TimeStamp until) {
+    return _Embed::futexWait(&word._val, expected, until);
+}
+
+Res<> futexWake(Atomic<u32> &word, usize count) {
+    return _Embed::futexWake(&word._val, count);
+}
+
+} // namespace Karm::Sys
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <karm-base/atomic.h>
+#include <karm-base/time.h>
+
+#include "fd.h"
+
+namespace Karm::Sys {
+
+// Anonymous memory that can be shared with other processes by passing its
+// file descriptor around, and mapped with Sys::mmap().
+Res<Strong<Fd>> createShm(usize size);
+
+// Sleep for as long as `word` still holds `expected`, or until the deadline.
+// Spurious wakeups are possible, callers should check the word again.
+Res<> futexWait(Atomic<u32> &word, u32 expected, TimeStamp until = TimeStamp::endOfTime());
+
+// Wake up to `count` threads waiting on `word`, in this or any other process.
+Res<> futexWake(Atomic<u32> &word, usize count = 1);
+
+} // namespace Karm::Sys
@@ -18,13 +18,26 @@ Res<TcpConnection> TcpConnection::connect(SocketAddr addr) {
     return Ok(TcpConnection(std::move(fd), addr));
 }
 
-Res<TcpListener> TcpListener::listen(SocketAddr addr) {
-    auto fd = try$(_Embed::listenTcp(addr));
+Res<TcpListener> TcpListener::listen(SocketAddr addr, bool shared) {
+    auto fd = try$(_Embed::listenTcp(addr, shared));
     return Ok(TcpListener(std::move(fd), addr));
 }
 
 // MARK: Ipc Socket ------------------------------------------------------------
 
+Res<IpcConnection> IpcConnection::connect(Mime::Url url) {
+    auto fd = try$(_Embed::connectIpc(url));
+    return Ok(IpcConnection(std::move(fd), url));
+}
+
+Res<Pair<IpcConnection>> IpcConnection::pair() {
+    auto [a, b] = try$(_Embed::createIpcPair());
+    return Ok(Pair<IpcConnection>{
+        IpcConnection{std::move(a), NONE},
+        IpcConnection{std::move(b), NONE},
+    });
+}
+
 Res<IpcListener> IpcListener::listen(Mime::Url url) {
     auto fd = try$(_Embed::listenIpc(url));
     return Ok(IpcListener(std::move(fd), url));
@@ -12,11 +12,16 @@ struct _Connection :
     public Io::Reader,
     public Io::Writer,
     public Io::Flusher,
+    public Io::AsyncReader,
+    public Io::AsyncWriter,
     Meta::NoCopy {
 
-    virtual Async::Task<usize> readAsync(MutBytes buf) = 0;
+    using Io::AsyncReader::readAsync;
+    using Io::AsyncWriter::writeAsync;
 
-    virtual Async::Task<usize> writeAsync(Bytes buf) = 0;
+    virtual Async::Task<usize> readAsync(MutBytes, Async::Cancelation::Token) = 0;
+
+    virtual Async::Task<usize> writeAsync(Bytes, Async::Cancelation::Token) = 0;
 
     virtual Async::Task<usize> flushAsync() = 0;
 };
@@ -41,6 +46,10 @@ struct Connection :
         return globalSched().readAsync(_fd, buf);
     }
 
+    Async::Task<usize> readAsync(MutBytes buf, Async::Cancelation::Token ct) override {
+        return globalSched().readAsync(_fd, buf, ct);
+    }
+
     Res<usize> write(Bytes buf) override {
         return _fd->write(buf);
     }
@@ -49,6 +58,10 @@ struct Connection :
         return globalSched().writeAsync(_fd, buf);
     }
 
+    Async::Task<usize> writeAsync(Bytes buf, Async::Cancelation::Token ct) override {
+        return globalSched().writeAsync(_fd, buf, ct);
+    }
+
     Res<usize> flush() override {
         return _fd->flush();
     }
@@ -74,8 +87,8 @@ struct _Listener :
         return Ok(C(std::move(fd), addr));
     }
 
-    Async::Task<C> acceptAsync() {
-        auto [fd, addr] = co_trya$(globalSched().acceptAsync(_fd));
+    Async::Task<C> acceptAsync(Async::Cancelation::Token ct = {}) {
+        auto [fd, addr] = co_trya$(globalSched().acceptAsync(_fd, ct));
         co_return Ok(C(std::move(fd), addr));
     }
 
@@ -100,8 +113,8 @@ struct UdpConnection :
         return Ok(nbytes);
     }
 
-    auto sendAsync(Bytes buf, SocketAddr addr) {
-        return globalSched().sendAsync(_fd, buf, {}, addr);
+    auto sendAsync(Bytes buf, SocketAddr addr, Async::Cancelation::Token ct = {}) {
+        return globalSched().sendAsync(_fd, buf, {}, addr, ct);
     }
 
     Res<Cons<usize, SocketAddr>> recv(MutBytes buf) {
@@ -109,8 +122,8 @@ struct UdpConnection :
         return Ok<Cons<usize, SocketAddr>>(nbytes, addr);
     }
 
-    auto recvAsync(MutBytes buf) {
-        return globalSched().recvAsync(_fd, buf, {});
+    auto recvAsync(MutBytes buf, Async::Cancelation::Token ct = {}) {
+        return globalSched().recvAsync(_fd, buf, {}, ct);
     }
 };
 
@@ -136,7 +149,10 @@ struct TcpListener :
 
     SocketAddr _addr;
 
-    static Res<TcpListener> listen(SocketAddr addr);
+    // When `shared`, other listeners can bind the same address and the
+    // kernel spreads incoming connections between them, which lets every
+    // loop of an executor accept on its own.
+    static Res<TcpListener> listen(SocketAddr addr, bool shared = false);
 
     TcpListener(Strong<Sys::Fd> fd, SocketAddr addr)
         : _Listener(std::move(fd)), _addr(addr) {}
@@ -157,6 +173,9 @@ struct IpcConnection {
 
     static Res<IpcConnection> connect(Mime::Url url);
 
+    // Two connected ends, mostly useful for tests and benchmarks.
+    static Res<Pair<IpcConnection>> pair();
+
     IpcConnection(Strong<Sys::Fd> fd, Opt<Mime::Url> url)
         : _fd(std::move(fd)), _url(std::move(url)) {}
 
@@ -170,13 +189,13 @@ struct IpcConnection {
         return Ok<Cons<usize>>(nbytes, nhnds);
     }
 
-    Async::Task<> sendAsync(Bytes buf, Slice<Handle> hnds) {
-        co_trya$(globalSched().sendAsync(_fd, buf, hnds, Ip4::unspecified(0)));
+    Async::Task<> sendAsync(Bytes buf, Slice<Handle> hnds, Async::Cancelation::Token ct = {}) {
+        co_trya$(globalSched().sendAsync(_fd, buf, hnds, Ip4::unspecified(0), ct));
         co_return Ok();
     }
 
-    Async::Task<Cons<usize>> recvAsync(MutBytes buf, MutSlice<Handle> hnds) {
-        auto [nbytes, nhnds, _] = co_trya$(globalSched().recvAsync(_fd, buf, hnds));
+    Async::Task<Cons<usize>> recvAsync(MutBytes buf, MutSlice<Handle> hnds, Async::Cancelation::Token ct = {}) {
+        auto [nbytes, nhnds, _] = co_trya$(globalSched().recvAsync(_fd, buf, hnds, ct));
         co_return Ok<Cons<usize>>(nbytes, nhnds);
     }
 };
@@ -195,8 +214,8 @@ struct IpcListener {
         return Ok(IpcConnection(std::move(fd), NONE));
     }
 
-    Async::Task<IpcConnection> acceptAsync() {
-        auto [fd, _] = co_trya$(globalSched().acceptAsync(_fd));
+    Async::Task<IpcConnection> acceptAsync(Async::Cancelation::Token ct = {}) {
+        auto [fd, _] = co_trya$(globalSched().acceptAsync(_fd, ct));
         co_return Ok(IpcConnection(std::move(fd), NONE));
     }
 
@@ -0,0 +1,11 @@
+#include "tap.h"
+
+#include "_embed.h"
+
+namespace Karm::Sys {
+
+Res<Strong<Fd>> openTap(Str name) {
+    return _Embed::openTap(name);
+}
+
+} // namespace Karm::Sys
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "fd.h"
+
+namespace Karm::Sys {
+
+// Attach to the TAP interface `name`, creating it if it doesn't exist yet.
+// Every read and write on the descriptor is a whole ethernet frame.
+Res<Strong<Fd>> openTap(Str name);
+
+} // namespace Karm::Sys
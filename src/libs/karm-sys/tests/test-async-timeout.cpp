@@ -0,0 +1,47 @@
+#include <karm-sys/async.h>
+#include <karm-sys/time.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+Async::Task<> timeoutExpires() {
+    auto start = Sys::now();
+    Async::Cancelation c;
+    auto res = co_await timeoutAsync(
+        start + TimeSpan::fromMSecs(20), c,
+        globalSched().sleepAsync(start + TimeSpan::fromSecs(10), c.token())
+    );
+
+    if (res or res.none().code() != Error::TIMED_OUT)
+        co_return Error::other("timeoutAsync didn't time out");
+
+    // The sleep must have been canceled rather than waited for.
+    if (Sys::now() - start > TimeSpan::fromSecs(1))
+        co_return Error::other("timeoutAsync waited for the canceled task");
+
+    co_return Ok();
+}
+
+testAsync$("async-timeout-expires") {
+    return timeoutExpires();
+}
+
+Async::Task<> timeoutCompletes() {
+    auto start = Sys::now();
+    Async::Cancelation c;
+    co_trya$(timeoutAsync(
+        start + TimeSpan::fromSecs(10), c,
+        globalSched().sleepAsync(start + TimeSpan::fromMSecs(20), c.token())
+    ));
+
+    if (Sys::now() - start > TimeSpan::fromSecs(1))
+        co_return Error::other("timeoutAsync waited for the timer");
+
+    co_return Ok();
+}
+
+testAsync$("async-timeout-completes") {
+    return timeoutCompletes();
+}
+
+} // namespace Karm::Sys::Tests
@@ -0,0 +1,45 @@
+#include <karm-sys/executor.h>
+#include <karm-sys/proc.h>
+#include <karm-sys/time.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+static Async::Task<> _tickAsync(Atomic<usize> &done, Atomic<Sched *> &sched) {
+    // NOTE: Sleeping goes through the scheduler of the loop, so the task
+    //       has to be woken up on the same thread it was started on.
+    co_trya$(globalSched().sleepAsync(Sys::now() + TimeSpan::fromMSecs(10)));
+    sched.store(&globalSched());
+    done.inc();
+    co_return Ok();
+}
+
+test$("executor-spawn") {
+    auto exec = try$(Executor::create(2));
+    expectEq$(exec->len(), 2uz);
+
+    Atomic<usize> done = 0;
+    Array<Atomic<Sched *>, 4> scheds = {};
+    for (usize i = 0; i < 4; i++)
+        exec->spawnOn(i % 2, _tickAsync(done, scheds[i]));
+
+    auto until = Sys::now() + TimeSpan::fromSecs(5);
+    while (done.load() != 4 and Sys::now() < until)
+        try$(Sys::sleep(TimeSpan::fromMSecs(1)));
+
+    expectEq$(done.load(), 4uz);
+    expectEq$(exec->load(0), 0uz);
+    expectEq$(exec->load(1), 0uz);
+
+    // Each loop has its own scheduler.
+    expect$(scheds[0].load() == scheds[2].load());
+    expect$(scheds[1].load() == scheds[3].load());
+    expect$(scheds[0].load() != scheds[1].load());
+
+    exec->stop();
+    try$(exec->join());
+
+    return Ok();
+}
+
+} // namespace Karm::Sys::Tests
@@ -0,0 +1,53 @@
+#include <karm-io/impls.h>
+#include <karm-sys/resource.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+static Res<> _write(Io::BufferWriter &out, auto const &val) {
+    try$(out.write({reinterpret_cast<Byte const *>(&val), sizeof(val)}));
+    return Ok();
+}
+
+// Packs "a/x" -> "hello" and "b/y/z" -> "world!", keys sorted.
+static Res<Vec<u8>> _archive() {
+    Io::BufferWriter out;
+    usize keys = sizeof(BundleHeader) + 2 * sizeof(BundleEntry);
+    usize data = keys + 3 + 5;
+
+    try$(_write(out, BundleHeader{BundleHeader::MAGIC, 2}));
+    try$(_write(out, BundleEntry{keys, 3, data, 5}));
+    try$(_write(out, BundleEntry{keys + 3, 5, data + 5, 6}));
+    try$(out.write(bytes("a/xb/y/z"s)));
+    try$(out.write(bytes("helloworld!"s)));
+
+    return Ok(Vec<u8>{out.bytes()});
+}
+
+test$("bundle-archive-lookup") {
+    auto buf = try$(_archive());
+    auto archive = try$(BundleArchive::load(buf));
+
+    expectEq$(archive.lookup("a/x").unwrap(), bytes("hello"s));
+    expectEq$(archive.lookup("b/y/z").unwrap(), bytes("world!"s));
+    expect$(not archive.lookup("a/y"));
+    expect$(not archive.lookup("c"));
+
+    expectEq$(BundleArchive::keyOf("bundle://b/y/z"_url), "b/y/z"s);
+
+    return Ok();
+}
+
+test$("bundle-archive-invalid") {
+    auto buf = try$(_archive());
+
+    expect$(not BundleArchive::load(sub(buf, 0, 8)));
+    expect$(not BundleArchive::load(sub(buf, 0, sizeof(BundleHeader) + sizeof(BundleEntry))));
+
+    buf[0] = 'x';
+    expect$(not BundleArchive::load(buf));
+
+    return Ok();
+}
+
+} // namespace Karm::Sys::Tests
@@ -0,0 +1,26 @@
+#include <karm-base/atomic.h>
+#include <karm-base/vec.h>
+#include <karm-sys/thread.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+test$("thread-spawn-join") {
+    Atomic<usize> counter = 0;
+
+    Vec<Strong<Thread>> threads;
+    for (usize i = 0; i < 4; i++) {
+        threads.pushBack(try$(spawnThread([&] {
+            for (usize j = 0; j < 1000; j++)
+                counter.inc();
+        })));
+    }
+
+    for (auto &thread : threads)
+        try$(thread->join());
+
+    expectEq$(counter.load(), 4000uz);
+    return Ok();
+}
+
+} // namespace Karm::Sys::Tests
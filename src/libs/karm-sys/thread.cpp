@@ -0,0 +1,11 @@
+#include "thread.h"
+
+#include "_embed.h"
+
+namespace Karm::Sys {
+
+Res<Strong<Thread>> spawnThread(Func<void()> fn) {
+    return _Embed::spawnThread(std::move(fn));
+}
+
+} // namespace Karm::Sys
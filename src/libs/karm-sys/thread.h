@@ -0,0 +1,22 @@
+#pragma once
+
+#include <karm-base/func.h>
+#include <karm-base/rc.h>
+#include <karm-base/res.h>
+#include <karm-meta/nocopy.h>
+
+namespace Karm::Sys {
+
+struct Thread : Meta::NoCopy {
+    virtual ~Thread() = default;
+
+    // Wait for the thread to return from its entry point.
+    virtual Res<> join() = 0;
+};
+
+// Run `fn` on a new thread sharing the address space of the caller.
+// Dropping the handle without joining lets the thread run to completion
+// on its own.
+Res<Strong<Thread>> spawnThread(Func<void()> fn);
+
+} // namespace Karm::Sys
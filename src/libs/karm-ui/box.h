@@ -122,7 +122,7 @@ struct _Box : public ProxyNode<Crtp> {
         s = s - boxStyle().margin.all();
         s = s - boxStyle().padding.all();
 
-        s = ProxyNode<Crtp>::child().size(s, hint);
+        s = ProxyNode<Crtp>::child().measure(s, hint);
 
         s = s + boxStyle().padding.all();
         s = s + boxStyle().margin.all();
@@ -150,7 +150,7 @@ struct DialogLayer : public LeafNode<DialogLayer> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        return child().size(s, hint);
+        return child().measure(s, hint);
     }
 
     Math::Recti bound() override {
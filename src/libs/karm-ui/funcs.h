@@ -57,6 +57,9 @@ inline void shouldRepaint(Node &n, Math::Recti bound) {
 }
 
 inline void shouldLayout(Node &n) {
+    // NOTE: The size of every ancestor might depend on this node.
+    for (Node *p = &n; p; p = p->parent())
+        p->invalidate();
     bubble<Node::LayoutEvent>(n);
 }
 
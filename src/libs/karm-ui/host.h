@@ -47,6 +47,8 @@ struct PerfGraph {
     usize _index{};
     Array<PerfRecord, 256> _records{};
     f64 _frameTime = 0;
+    int _measures = 0;
+    int _measureMisses = 0;
 
     void record(PerfEvent e) {
         _records[_index % 256] = PerfRecord{e, Sys::now(), 0};
@@ -68,6 +70,16 @@ struct PerfGraph {
         return 1000.0 / _frameTime;
     }
 
+    void beginMeasures() {
+        debugMeasureCount = 0;
+        debugMeasureMissCount = 0;
+    }
+
+    void endMeasures() {
+        _measures = debugMeasureCount;
+        _measureMisses = debugMeasureMissCount;
+    }
+
     Math::Recti bound() {
         return {0, 0, 256, 100};
     }
@@ -96,6 +108,9 @@ struct PerfGraph {
         g.fillStyle(Gfx::WHITE);
         g.fill({8, 16}, text);
 
+        text = Io::format("Measures: {} ({} computed)", _measures, _measureMisses).take();
+        g.fill({8, 32}, text);
+
         g.restore();
     }
 };
@@ -188,11 +203,13 @@ struct Host : public Node {
 
     void layout(Math::Recti r) override {
         _perf.record(PerfEvent::LAYOUT);
+        _perf.beginMeasures();
         _root->layout(r);
+        _perf.endMeasures();
         auto elapsed = _perf.end();
         static usize maxStutter = 1;
         if (elapsed.toMSecs() > maxStutter) {
-            logWarn("Stutter detected, layout took {}ms for {} nodes alive", elapsed.toMSecs(), debugNodeCount);
+            logWarn("Stutter detected, layout took {}ms for {} nodes alive and {} measures", elapsed.toMSecs(), debugNodeCount, debugMeasureCount);
             maxStutter = elapsed.toMSecs();
         }
     }
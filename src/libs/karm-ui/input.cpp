@@ -289,7 +289,9 @@ struct Input : public View<Input> {
     Gfx::Text &_ensureText() {
         if (not _text) {
             _text = Gfx::Text(_style);
-            _text->append(_model->runes());
+            _model->iterChunks([&](Str chunk) {
+                _text->append(chunk);
+            });
         }
         return *_text;
     }
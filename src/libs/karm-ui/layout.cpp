@@ -60,7 +60,7 @@ struct Bound : public ProxyNode<Bound> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        return child().size(s, hint);
+        return child().measure(s, hint);
     }
 };
 
@@ -127,7 +127,7 @@ struct Align : public ProxyNode<Align> {
     Align(Math::Align align, Child child) : ProxyNode(child), _align(align) {}
 
     void layout(Math::Recti bound) override {
-        auto childSize = child().size(
+        auto childSize = child().measure(
             bound.size(), _child.is<Grow>()
                               ? Hint::MAX
                               : Hint::MIN
@@ -143,8 +143,8 @@ struct Align : public ProxyNode<Align> {
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
         if (hint == Hint::MAX)
-            return _align.maxSize(child().size(s, hint), s);
-        return _align.minSize(child().size(s, hint));
+            return _align.maxSize(child().measure(s, hint), s);
+        return _align.minSize(child().measure(s, hint));
     }
 };
 
@@ -216,7 +216,7 @@ struct Sizing : public ProxyNode<Sizing> {
             s.y = min(s.y, _max.y);
         }
 
-        auto result = child().size(s, hint);
+        auto result = child().measure(s, hint);
 
         if (_min.x != UNCONSTRAINED) {
             result.x = max(result.x, _min.x);
@@ -283,7 +283,7 @@ struct Spacing : public ProxyNode<Spacing> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        return child().size(s - _spacing.all(), hint) + _spacing.all();
+        return child().measure(s - _spacing.all(), hint) + _spacing.all();
     }
 
     Math::Recti bound() override {
@@ -409,7 +409,7 @@ struct FlowLayout : public GroupNode<FlowLayout> {
             if (child.is<Grow>()) {
                 grows += child.unwrap<Grow>().grow();
             } else {
-                total += _style.flow.getX(child->size(r.size(), Hint::MIN));
+                total += _style.flow.getX(child->measure(r.size(), Hint::MIN));
             }
         }
 
@@ -426,7 +426,7 @@ struct FlowLayout : public GroupNode<FlowLayout> {
 
         for (auto &child : children()) {
             Math::Recti inner = {};
-            auto childSize = child->size(r.size(), Hint::MIN);
+            auto childSize = child->measure(r.size(), Hint::MIN);
 
             inner = _style.flow.setStart(inner, (isize)start);
             if (child.is<Grow>()) {
@@ -452,7 +452,7 @@ struct FlowLayout : public GroupNode<FlowLayout> {
             if (child.is<Grow>())
                 grow = true;
 
-            auto childSize = child->size(s, Hint::MIN);
+            auto childSize = child->measure(s, Hint::MIN);
             w += _style.flow.getX(childSize);
             h = max(h, _style.flow.getY(childSize));
         }
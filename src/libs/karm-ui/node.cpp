@@ -8,5 +8,7 @@ bool debugShowEmptyBounds = false;
 bool debugShowScrollBounds = false;
 bool debugShowPerfGraph = false;
 int debugNodeCount = 0;
+int debugMeasureCount = 0;
+int debugMeasureMissCount = 0;
 
 } // namespace Karm::Ui
@@ -24,6 +24,8 @@ extern bool debugShowEmptyBounds;
 extern bool debugShowScrollBounds;
 extern bool debugShowPerfGraph;
 extern int debugNodeCount;
+extern int debugMeasureCount;
+extern int debugMeasureMissCount;
 
 struct Node;
 
@@ -38,8 +40,14 @@ using Key = Opt<Hash>;
 struct Node :
     Meta::Static {
 
+    struct _Measure {
+        Math::Vec2i s;
+        Math::Vec2i result;
+    };
+
     Key _key = NONE;
     bool _consumed = false;
+    Array<Opt<_Measure>, 3> _measures = {};
 
     struct PaintEvent {
         Math::Recti bound;
@@ -76,6 +84,27 @@ struct Node :
 
     virtual Math::Vec2i size(Math::Vec2i s, Hint) { return s; }
 
+    // Memoized size(), layouts should go through this when measuring
+    // their children. Results are kept until the node is reconciled or
+    // asks for a new layout, directly or through one of its descendants.
+    Math::Vec2i measure(Math::Vec2i s, Hint hint) {
+        debugMeasureCount++;
+
+        auto &m = _measures[static_cast<usize>(hint)];
+        if (m and m->s == s)
+            return m->result;
+
+        debugMeasureMissCount++;
+        auto result = size(s, hint);
+        m = _Measure{s, result};
+        return result;
+    }
+
+    void invalidate() {
+        for (auto &m : _measures)
+            m = NONE;
+    }
+
     virtual Math::Recti bound() { panic("bound() not implemented"); }
 
     virtual Node *parent() { return nullptr; }
@@ -134,6 +163,7 @@ struct LeafNode : public Node {
 
         reconcile(other.unwrap<Crtp>());
         other->_consumed = true;
+        Node::invalidate();
 
         return NONE;
     }
@@ -279,7 +309,7 @@ struct ProxyNode : public LeafNode<Crtp> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        return child().size(s, hint);
+        return child().measure(s, hint);
     }
 
     Math::Recti bound() override {
@@ -122,7 +122,7 @@ struct PopoverLayer : public LeafNode<PopoverLayer> {
         child().layout(r);
 
         if (popoverVisible()) {
-            auto size = (*_popover)->size(r.size(), Hint::MIN);
+            auto size = (*_popover)->measure(r.size(), Hint::MIN);
             auto pos = _popoverAt;
             pos.y = clamp(pos.y, 0, r.size().y - size.y);
 
@@ -135,7 +135,7 @@ struct PopoverLayer : public LeafNode<PopoverLayer> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        return child().size(s, hint);
+        return child().measure(s, hint);
     }
 
     Math::Recti bound() override {
@@ -134,7 +134,7 @@ struct Reducer :
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
         ensureBuild();
-        return (*_child)->size(s, hint);
+        return (*_child)->measure(s, hint);
     }
 
     Math::Recti bound() override {
@@ -147,7 +147,7 @@ struct Scroll : public ProxyNode<Scroll> {
 
     void layout(Math::Recti r) override {
         _bound = r;
-        auto childSize = child().size(_bound.size(), Hint::MAX);
+        auto childSize = child().measure(_bound.size(), Hint::MAX);
         if (_orient == Math::Orien::HORIZONTAL) {
             childSize.height = r.height;
         } else if (_orient == Math::Orien::VERTICAL) {
@@ -159,7 +159,7 @@ struct Scroll : public ProxyNode<Scroll> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        auto childSize = child().size(s, hint);
+        auto childSize = child().measure(s, hint);
 
         if (hint == Hint::MIN) {
             if (_orient == Math::Orien::HORIZONTAL) {
@@ -191,4 +191,300 @@ Child vscroll(Child child) {
     return makeStrong<Scroll>(child, Math::Orien::VERTICAL);
 }
 
+// MARK: List ------------------------------------------------------------------
+
+// A scrollable list of items all the same size. Only the items intersecting
+// the viewport, plus a few on each side, are built and laid out, and the
+// nodes of items scrolling out of view are reconciled with the ones
+// scrolling in rather than being thrown away.
+struct List : public LeafNode<List> {
+    static constexpr isize SCROLL_BAR_WIDTH = 4;
+    static constexpr usize OVERSCAN = 4;
+
+    struct _Item {
+        usize index;
+        Child child;
+    };
+
+    Math::Orien _orient;
+    usize _len;
+    BuildItem _build;
+
+    Math::Recti _bound{};
+    isize _itemSize = 0;
+    bool _mouseIn = false;
+    bool _animated = false;
+    f64 _scroll = 0;
+    f64 _targetScroll = 0;
+    Easedf _scrollOpacity;
+
+    Vec<_Item> _items;
+    Vec<Child> _pool;
+
+    List(Math::Orien orient, usize len, BuildItem build)
+        : _orient(orient), _len(len), _build(std::move(build)) {}
+
+    ~List() {
+        for (auto &item : _items)
+            item.child->detach(this);
+        for (auto &child : _pool)
+            child->detach(this);
+    }
+
+    // MARK: Geometry ----------------------------------------------------------
+
+    bool _vertical() const {
+        return _orient != Math::Orien::HORIZONTAL;
+    }
+
+    isize _along(Math::Vec2i v) const {
+        return _vertical() ? v.y : v.x;
+    }
+
+    isize _across(Math::Vec2i v) const {
+        return _vertical() ? v.x : v.y;
+    }
+
+    isize _viewport() const {
+        return _along(_bound.wh);
+    }
+
+    isize _contentSize() const {
+        return _itemSize * (isize)_len;
+    }
+
+    f64 _maxScroll() const {
+        return max(0, _contentSize() - _viewport());
+    }
+
+    Math::Recti _itemBound(usize index) const {
+        isize pos = index * _itemSize - (isize)_scroll;
+        if (_vertical())
+            return {_bound.x, _bound.y + pos, _bound.width, _itemSize};
+        return {_bound.x + pos, _bound.y, _itemSize, _bound.height};
+    }
+
+    // MARK: Items -------------------------------------------------------------
+
+    Child _acquire(usize index) {
+        auto fresh = _build(index);
+        if (not _pool.len()) {
+            fresh->attach(this);
+            return fresh;
+        }
+
+        auto recycled = _pool.popBack();
+        if (recycled->reconcile(fresh)) {
+            recycled->detach(this);
+            fresh->attach(this);
+            return fresh;
+        }
+
+        return recycled;
+    }
+
+    // Any item will do to tell the size of all of them.
+    Node &_probe() {
+        if (_items.len())
+            return *_items[0].child;
+
+        if (not _pool.len())
+            _pool.pushBack(_acquire(0));
+
+        return *_pool[0];
+    }
+
+    Math::Vec2i _measureItem(Math::Vec2i s) {
+        if (not _len)
+            return {};
+        return _probe().measure(s, Hint::MIN);
+    }
+
+    void _updateItems() {
+        usize first = 0;
+        usize last = 0;
+
+        if (_len and _itemSize) {
+            usize start = (isize)_scroll / _itemSize;
+            usize end = ((isize)_scroll + _viewport()) / _itemSize + 1;
+            first = start > OVERSCAN ? start - OVERSCAN : 0;
+            last = min(_len, end + OVERSCAN);
+        }
+
+        for (auto &item : _items) {
+            if (item.index < first or item.index >= last) {
+                mouseLeave(*item.child);
+                _pool.pushBack(item.child);
+            }
+        }
+
+        Vec<_Item> items;
+        usize j = 0;
+        for (usize i = first; i < last; i++) {
+            while (j < _items.len() and _items[j].index < i)
+                j++;
+
+            if (j < _items.len() and _items[j].index == i)
+                items.pushBack(_items[j]);
+            else
+                items.pushBack({i, _acquire(i)});
+        }
+        _items = std::move(items);
+
+        // NOTE: Keep enough spare nodes to refill the viewport after a
+        //       long jump, but not a whole directory worth of them.
+        while (_pool.len() > _items.len() + 1)
+            _pool.popBack()->detach(this);
+    }
+
+    void _scrollTo(f64 offset) {
+        _targetScroll = clamp(offset, 0.0, _maxScroll());
+        if (Math::abs(_scroll - _targetScroll) < 0.5) {
+            _scroll = _targetScroll;
+            _animated = false;
+        } else {
+            _animated = true;
+        }
+    }
+
+    // MARK: Node --------------------------------------------------------------
+
+    void reconcile(List &o) override {
+        _orient = o._orient;
+        _len = o._len;
+        _build = std::move(o._build);
+
+        Vec<_Item> items;
+        for (auto &item : _items) {
+            if (item.index >= _len) {
+                _pool.pushBack(item.child);
+                continue;
+            }
+
+            auto fresh = _build(item.index);
+            if (item.child->reconcile(fresh)) {
+                item.child->detach(this);
+                fresh->attach(this);
+                item.child = fresh;
+            }
+            items.pushBack(item);
+        }
+        _items = std::move(items);
+    }
+
+    void paint(Gfx::Context &g, Math::Recti r) override {
+        g.save();
+        g.clip(_bound);
+
+        for (auto &item : _items) {
+            if (not item.child->bound().colide(r))
+                continue;
+            item.child->paint(g, r);
+        }
+
+        auto content = _contentSize();
+        auto viewport = _viewport();
+        if (content > viewport) {
+            isize thumbSize = max(SCROLL_BAR_WIDTH * 2, viewport * viewport / content);
+            isize thumbPos = (viewport - thumbSize) * (_scroll / max(1.0, _maxScroll()));
+
+            g.fillStyle(Ui::GRAY500.withOpacity(0.3 * clamp01(_scrollOpacity.value())));
+            if (_vertical())
+                g.fill(Math::Recti{_bound.end() - SCROLL_BAR_WIDTH, _bound.top() + thumbPos, SCROLL_BAR_WIDTH, thumbSize});
+            else
+                g.fill(Math::Recti{_bound.start() + thumbPos, _bound.bottom() - SCROLL_BAR_WIDTH, thumbSize, SCROLL_BAR_WIDTH});
+        }
+
+        g.restore();
+    }
+
+    void _dispatch(Sys::Event &e) {
+        for (auto &item : _items) {
+            item.child->event(e);
+            if (e.accepted())
+                return;
+        }
+    }
+
+    void event(Sys::Event &e) override {
+        if (_scrollOpacity.needRepaint(*this, e))
+            shouldRepaint(*this);
+
+        if (auto *me = e.is<Events::MouseEvent>()) {
+            if (_bound.contains(me->pos)) {
+                _mouseIn = true;
+                _dispatch(e);
+
+                if (not e.accepted() and me->type == Events::MouseEvent::SCROLL) {
+                    _scrollTo(_targetScroll - (_vertical() ? me->scroll.y : me->scroll.x) * 128);
+                    shouldAnimate(*this);
+                    _scrollOpacity.delay(0).animate(*this, 1, 0.3);
+                }
+            } else if (_mouseIn) {
+                _mouseIn = false;
+                for (auto &item : _items)
+                    mouseLeave(*item.child);
+            }
+        } else if (e.is<Node::AnimateEvent>() and _animated) {
+            _scroll += (_targetScroll - _scroll) * (e.unwrap<Node::AnimateEvent>().dt * 12);
+            if (Math::abs(_scroll - _targetScroll) < 0.5) {
+                _scroll = _targetScroll;
+                _animated = false;
+                _scrollOpacity.delay(1.0).animate(*this, 0, 0.3);
+            } else {
+                shouldAnimate(*this);
+            }
+
+            // NOTE: Scrolling doesn't change the size of the list, there is
+            //       no need to go through the host for a new layout.
+            layout(_bound);
+            shouldRepaint(*this);
+            _dispatch(e);
+        } else {
+            _dispatch(e);
+        }
+    }
+
+    void bubble(Sys::Event &e) override {
+        if (auto *pe = e.is<Node::PaintEvent>())
+            pe->bound = pe->bound.clipTo(bound());
+
+        LeafNode::bubble(e);
+    }
+
+    void layout(Math::Recti r) override {
+        _bound = r;
+        _itemSize = max(1, _along(_measureItem(r.wh)));
+        _scroll = clamp(_scroll, 0.0, _maxScroll());
+        _targetScroll = clamp(_targetScroll, 0.0, _maxScroll());
+
+        _updateItems();
+        for (auto &item : _items)
+            item.child->layout(_itemBound(item.index));
+    }
+
+    Math::Vec2i size(Math::Vec2i s, Hint hint) override {
+        if (hint != Hint::MIN)
+            return s;
+
+        auto item = _measureItem(s);
+        isize along = min(_along(item) * (isize)_len, _along(s));
+        return _vertical()
+                   ? Math::Vec2i{_across(item), along}
+                   : Math::Vec2i{along, _across(item)};
+    }
+
+    Math::Recti bound() override {
+        return _bound;
+    }
+};
+
+Child hlist(usize len, BuildItem child) {
+    return makeStrong<List>(Math::Orien::HORIZONTAL, len, std::move(child));
+}
+
+Child vlist(usize len, BuildItem child) {
+    return makeStrong<List>(Math::Orien::VERTICAL, len, std::move(child));
+}
+
 } // namespace Karm::Ui
@@ -0,0 +1,451 @@
+#include <karm-base/vec.h>
+#include <karm-crypto/adler32.h>
+
+#include "deflate.h"
+
+namespace Flate {
+
+static constexpr usize WINDOW = 32 * 1024;
+static constexpr usize MIN_MATCH = 3;
+static constexpr usize MAX_MATCH = 258;
+
+// NOTE: How far down a hash chain to look for a longer match, longer
+//       chains compress a little better for a lot more time.
+static constexpr usize MAX_CHAIN = 64;
+
+static constexpr usize HASH_BITS = 15;
+static constexpr usize HASH_SIZE = 1 << HASH_BITS;
+static constexpr i32 NO_POS = -1;
+
+static constexpr Array<u16, 29> LENGTH_BASE = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static constexpr Array<u8, 29> LENGTH_EXTRA = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static constexpr Array<u16, 30> DIST_BASE = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+    6145, 8193, 12289, 16385, 24577
+};
+
+static constexpr Array<u8, 30> DIST_EXTRA = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Bits go out least significant first, huffman codes most significant
+// first, so codes are reversed before being put.
+struct BitWriter {
+    Io::Writer &_w;
+    Vec<u8> _buf;
+    u64 _acc = 0;
+    usize _len = 0;
+
+    BitWriter(Io::Writer &w) : _w(w) {
+        _buf.ensure(FLUSH_AT + 8);
+    }
+
+    static constexpr usize FLUSH_AT = 64 * 1024;
+
+    Res<> put(u32 bits, usize n) {
+        _acc |= (u64)bits << _len;
+        _len += n;
+        while (_len >= 8) {
+            _buf.pushBack(_acc & 0xff);
+            _acc >>= 8;
+            _len -= 8;
+        }
+
+        if (_buf.len() >= FLUSH_AT)
+            try$(flush());
+        return Ok();
+    }
+
+    Res<> putCode(u32 code, usize n) {
+        u32 rev = 0;
+        for (usize i = 0; i < n; i++)
+            rev |= ((code >> i) & 1) << (n - 1 - i);
+        return put(rev, n);
+    }
+
+    Res<> align() {
+        if (_len)
+            try$(put(0, 8 - _len));
+        return Ok();
+    }
+
+    Res<> flush() {
+        try$(_w.write(_buf));
+        _buf.clear();
+        return Ok();
+    }
+};
+
+static Res<> _putLiteral(BitWriter &bw, usize sym) {
+    if (sym < 144)
+        return bw.putCode(0x30 + sym, 8);
+    if (sym < 256)
+        return bw.putCode(0x190 + (sym - 144), 9);
+    if (sym < 280)
+        return bw.putCode(sym - 256, 7);
+    return bw.putCode(0xc0 + (sym - 280), 8);
+}
+
+static Res<> _putMatch(BitWriter &bw, usize len, usize dist) {
+    usize l = 0;
+    while (l + 1 < LENGTH_BASE.len() and LENGTH_BASE[l + 1] <= len)
+        l++;
+    try$(_putLiteral(bw, 257 + l));
+    try$(bw.put(len - LENGTH_BASE[l], LENGTH_EXTRA[l]));
+
+    usize d = 0;
+    while (d + 1 < DIST_BASE.len() and DIST_BASE[d + 1] <= dist)
+        d++;
+    try$(bw.putCode(d, 5));
+    try$(bw.put(dist - DIST_BASE[d], DIST_EXTRA[d]));
+
+    return Ok();
+}
+
+static usize _hash(Bytes data, usize i) {
+    u32 v = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+Res<> deflate(Io::Writer &w, Bytes data) {
+    BitWriter bw{w};
+
+    // BFINAL = 1, BTYPE = 01 (fixed huffman codes)
+    try$(bw.put(1, 1));
+    try$(bw.put(1, 2));
+
+    // NOTE: The chains are indexed by position modulo the window, older
+    //       entries get overwritten as the window slides.
+    Vec<i32> head;
+    head.resize(HASH_SIZE, NO_POS);
+    Vec<i32> prev;
+    prev.resize(WINDOW, NO_POS);
+
+    auto insert = [&](usize i) {
+        if (i + MIN_MATCH > data.len())
+            return;
+        auto h = _hash(data, i);
+        prev[i % WINDOW] = head[h];
+        head[h] = i;
+    };
+
+    usize i = 0;
+    while (i < data.len()) {
+        usize bestLen = 0;
+        usize bestDist = 0;
+
+        if (i + MIN_MATCH <= data.len()) {
+            usize maxLen = min(MAX_MATCH, data.len() - i);
+            i32 cand = head[_hash(data, i)];
+            for (usize chain = 0; cand != NO_POS and chain < MAX_CHAIN; chain++) {
+                usize dist = i - cand;
+                if (dist > WINDOW or dist == 0)
+                    break;
+
+                usize len = 0;
+                while (len < maxLen and data[cand + len] == data[i + len])
+                    len++;
+
+                if (len > bestLen) {
+                    bestLen = len;
+                    bestDist = dist;
+                    if (len == maxLen)
+                        break;
+                }
+
+                i32 next = prev[cand % WINDOW];
+                if (next >= cand)
+                    break;
+                cand = next;
+            }
+        }
+
+        if (bestLen >= MIN_MATCH) {
+            try$(_putMatch(bw, bestLen, bestDist));
+            for (usize j = 0; j < bestLen; j++)
+                insert(i + j);
+            i += bestLen;
+        } else {
+            try$(_putLiteral(bw, data[i]));
+            insert(i);
+            i++;
+        }
+    }
+
+    // End of block
+    try$(_putLiteral(bw, 256));
+    try$(bw.align());
+    return bw.flush();
+}
+
+Res<> zlib(Io::Writer &w, Bytes data) {
+    // CM = 8 (deflate), CINFO = 7 (32k window), FLEVEL = 2 (default),
+    // and FCHECK making the header a multiple of 31.
+    Array<u8, 2> header = {0x78, 0x9c};
+    try$(w.write(header));
+
+    try$(deflate(w, data));
+
+    Crypto::Adler32 adler;
+    adler.add(data);
+    auto sum = adler.sum();
+    Array<u8, 4> trailer = {
+        (u8)(sum >> 24),
+        (u8)(sum >> 16),
+        (u8)(sum >> 8),
+        (u8)sum,
+    };
+    try$(w.write(trailer));
+    return Ok();
+}
+
+// MARK: Inflate ---------------------------------------------------------------
+
+struct BitReader {
+    Bytes _data;
+    usize _pos = 0;
+    u32 _acc = 0;
+    usize _len = 0;
+
+    Res<u32> get(usize n) {
+        while (_len < n) {
+            if (_pos >= _data.len())
+                return Error::invalidData("unexpected end of deflate stream");
+            _acc |= (u32)_data[_pos++] << _len;
+            _len += 8;
+        }
+
+        u32 bits = _acc & ((1u << n) - 1);
+        _acc >>= n;
+        _len -= n;
+        return Ok(bits);
+    }
+
+    // NOTE: Bytes are only pulled in when needed, what is left over is
+    //       always part of the current byte.
+    void align() {
+        _acc = 0;
+        _len = 0;
+    }
+};
+
+// Canonical huffman codes, decoded a bit at a time by walking the number
+// of codes of each length.
+struct Huffman {
+    static constexpr usize MAX_BITS = 15;
+
+    Array<u16, MAX_BITS + 1> counts{};
+    Vec<u16> symbols;
+
+    static Res<Huffman> build(Slice<u8> lengths) {
+        Huffman h;
+        for (auto l : lengths)
+            h.counts[l]++;
+        h.counts[0] = 0;
+
+        isize left = 1;
+        for (usize len = 1; len <= MAX_BITS; len++) {
+            left = (left << 1) - h.counts[len];
+            if (left < 0)
+                return Error::invalidData("over-subscribed huffman code");
+        }
+
+        Array<u16, MAX_BITS + 1> offs{};
+        for (usize len = 1; len < MAX_BITS; len++)
+            offs[len + 1] = offs[len] + h.counts[len];
+
+        h.symbols.resize(lengths.len(), 0);
+        for (usize sym = 0; sym < lengths.len(); sym++)
+            if (lengths[sym])
+                h.symbols[offs[lengths[sym]]++] = sym;
+
+        return Ok(h);
+    }
+
+    Res<usize> decode(BitReader &br) const {
+        isize code = 0;
+        isize first = 0;
+        isize index = 0;
+        for (usize len = 1; len <= MAX_BITS; len++) {
+            code |= try$(br.get(1));
+            isize count = counts[len];
+            if (code - first < count)
+                return Ok(symbols[index + code - first]);
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return Error::invalidData("invalid huffman code");
+    }
+};
+
+static Res<> _inflateStored(BitReader &br, Vec<u8> &out) {
+    br.align();
+    auto len = try$(br.get(16));
+    auto nlen = try$(br.get(16));
+    if (len != (~nlen & 0xffff))
+        return Error::invalidData("corrupted stored block length");
+
+    if (br._pos + len > br._data.len())
+        return Error::invalidData("unexpected end of deflate stream");
+
+    auto stored = sub(br._data, br._pos, br._pos + len);
+    out.pushBack(stored);
+    br._pos += len;
+    return Ok();
+}
+
+static Res<> _inflateCodes(BitReader &br, Vec<u8> &out, Huffman const &lit, Huffman const &dist) {
+    while (true) {
+        auto sym = try$(lit.decode(br));
+        if (sym < 256) {
+            out.pushBack(sym);
+            continue;
+        }
+
+        if (sym == 256)
+            return Ok();
+
+        sym -= 257;
+        if (sym >= LENGTH_BASE.len())
+            return Error::invalidData("invalid length code");
+        usize len = LENGTH_BASE[sym] + try$(br.get(LENGTH_EXTRA[sym]));
+
+        auto d = try$(dist.decode(br));
+        if (d >= DIST_BASE.len())
+            return Error::invalidData("invalid distance code");
+        usize back = DIST_BASE[d] + try$(br.get(DIST_EXTRA[d]));
+        if (back > out.len())
+            return Error::invalidData("distance too far back");
+
+        // NOTE: Matches can overlap what they produce, so this can't be a
+        //       single copy.
+        usize from = out.len() - back;
+        for (usize i = 0; i < len; i++)
+            out.pushBack(out[from + i]);
+    }
+}
+
+static Res<> _inflateFixed(BitReader &br, Vec<u8> &out) {
+    Array<u8, 288> litLengths;
+    for (usize i = 0; i < 288; i++)
+        litLengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+
+    Array<u8, 30> distLengths;
+    for (auto &l : distLengths)
+        l = 5;
+
+    auto lit = try$(Huffman::build(litLengths));
+    auto dist = try$(Huffman::build(distLengths));
+    return _inflateCodes(br, out, lit, dist);
+}
+
+static constexpr Array<u8, 19> CODE_LENGTH_ORDER = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+static Res<> _inflateDynamic(BitReader &br, Vec<u8> &out) {
+    usize nlit = try$(br.get(5)) + 257;
+    usize ndist = try$(br.get(5)) + 1;
+    usize ncode = try$(br.get(4)) + 4;
+    if (nlit > 286 or ndist > 30)
+        return Error::invalidData("too many length codes");
+
+    Array<u8, 19> codeLengths{};
+    for (usize i = 0; i < ncode; i++)
+        codeLengths[CODE_LENGTH_ORDER[i]] = try$(br.get(3));
+    auto codes = try$(Huffman::build(codeLengths));
+
+    Array<u8, 286 + 30> lengths{};
+    usize n = 0;
+    while (n < nlit + ndist) {
+        auto sym = try$(codes.decode(br));
+        if (sym < 16) {
+            lengths[n++] = sym;
+            continue;
+        }
+
+        u8 len = 0;
+        usize repeat = 0;
+        if (sym == 16) {
+            if (n == 0)
+                return Error::invalidData("repeat with no previous length");
+            len = lengths[n - 1];
+            repeat = 3 + try$(br.get(2));
+        } else if (sym == 17) {
+            repeat = 3 + try$(br.get(3));
+        } else {
+            repeat = 11 + try$(br.get(7));
+        }
+
+        if (n + repeat > nlit + ndist)
+            return Error::invalidData("too many lengths");
+        while (repeat--)
+            lengths[n++] = len;
+    }
+
+    if (lengths[256] == 0)
+        return Error::invalidData("missing end of block code");
+
+    auto lit = try$(Huffman::build(sub(lengths, 0, nlit)));
+    auto dist = try$(Huffman::build(sub(lengths, nlit, nlit + ndist)));
+    return _inflateCodes(br, out, lit, dist);
+}
+
+Res<Vec<u8>> inflate(Bytes data) {
+    BitReader br{data};
+    Vec<u8> out;
+
+    bool last = false;
+    while (not last) {
+        last = try$(br.get(1));
+        auto type = try$(br.get(2));
+
+        if (type == 0)
+            try$(_inflateStored(br, out));
+        else if (type == 1)
+            try$(_inflateFixed(br, out));
+        else if (type == 2)
+            try$(_inflateDynamic(br, out));
+        else
+            return Error::invalidData("invalid block type");
+    }
+
+    return Ok(out);
+}
+
+Res<Vec<u8>> unzlib(Bytes data) {
+    if (data.len() < 6)
+        return Error::invalidData("zlib stream too short");
+
+    u8 cmf = data[0];
+    u8 flg = data[1];
+    if ((cmf & 0xf) != 8 or ((cmf << 8) | flg) % 31 != 0)
+        return Error::invalidData("invalid zlib header");
+
+    if (flg & 0x20)
+        return Error::notImplemented("preset dictionaries are not supported");
+
+    auto out = try$(inflate(sub(data, 2, data.len() - 4)));
+
+    Crypto::Adler32 adler;
+    adler.add(out);
+    auto trailer = sub(data, data.len() - 4, data.len());
+    u32 expected = ((u32)trailer[0] << 24) | ((u32)trailer[1] << 16) | ((u32)trailer[2] << 8) | trailer[3];
+    if (adler.sum() != expected)
+        return Error::invalidData("zlib checksum mismatch");
+
+    return Ok(out);
+}
+
+} // namespace Flate
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <karm-base/res.h>
+#include <karm-base/vec.h>
+#include <karm-io/traits.h>
+
+// https://www.rfc-editor.org/rfc/rfc1950 (ZLIB)
+// https://www.rfc-editor.org/rfc/rfc1951 (DEFLATE)
+
+namespace Flate {
+
+// Compresses `data` as a single raw deflate block, matching repeats over
+// a 32k window and coding them with the fixed huffman tables.
+Res<> deflate(Io::Writer &w, Bytes data);
+
+// Same as deflate(), wrapped in a zlib header and checksum, which is what
+// FlateDecode in pdf and the IDAT chunks of png expect.
+Res<> zlib(Io::Writer &w, Bytes data);
+
+// Decompresses a raw deflate stream, whatever kind of blocks it is made of.
+Res<Vec<u8>> inflate(Bytes data);
+
+// Same as inflate(), for a zlib stream, the checksum is verified.
+Res<Vec<u8>> unzlib(Bytes data);
+
+} // namespace Flate
@@ -0,0 +1,77 @@
+#include <flate/deflate.h>
+#include <karm-io/impls.h>
+#include <karm-test/macros.h>
+
+namespace Flate::Tests {
+
+static Res<> _roundTrip(Bytes data) {
+    Io::BufferWriter buf;
+    try$(zlib(buf, data));
+
+    auto out = try$(unzlib(buf.bytes()));
+    if (sub(out) != data)
+        return Error::invalidData("data changed in the round trip");
+    return Ok();
+}
+
+test$("deflate-round-trip") {
+    try$(_roundTrip(Bytes{}));
+    try$(_roundTrip(bytes("a"s)));
+    try$(_roundTrip(bytes("hello hello hello hello"s)));
+
+    // NOTE: Runs of a single byte come out as matches that overlap what
+    //       they copy.
+    Vec<u8> run;
+    run.resize(1000, 'a');
+    try$(_roundTrip(run));
+
+    // NOTE: Longer than the window, with repeats further apart than it.
+    Vec<u8> text;
+    for (usize i = 0; i < 100 * 1024; i++)
+        text.pushBack("lorem ipsum dolor sit amet "[(i * 7) % 27] ^ ((i >> 15) & 1));
+    try$(_roundTrip(text));
+
+    Vec<u8> noise;
+    u32 x = 1;
+    for (usize i = 0; i < 70 * 1024; i++) {
+        x = x * 1103515245 + 12345;
+        noise.pushBack(x >> 24);
+    }
+    try$(_roundTrip(noise));
+
+    return Ok();
+}
+
+test$("deflate-inflate-blocks") {
+    // NOTE: Streams from zlib itself, with a stored block, then with
+    //       dynamic huffman codes.
+    Array<u8, 17> stored = {
+        0x78, 0x01, 0x01, 0x06, 0x00, 0xf9, 0xff, 0x73, 0x74,
+        0x6f, 0x72, 0x65, 0x64, 0x09, 0x3c, 0x02, 0x92
+    };
+    expect$(sub(try$(unzlib(stored))) == bytes("stored"s));
+
+    Array<u8, 116> dynamic = {
+        0x78, 0xda, 0x5d, 0x8f, 0x5b, 0x12, 0x80, 0x20, 0x08, 0x45, 0xb7, 0xc2,
+        0xd6, 0x70, 0xc0, 0x9a, 0x46, 0x27, 0xc7, 0xfc, 0x68, 0xf9, 0xc5, 0xa3,
+        0xa4, 0x3e, 0xe4, 0x71, 0x80, 0x0b, 0x12, 0x97, 0x81, 0xb0, 0x60, 0xad,
+        0x08, 0x67, 0xe7, 0x0c, 0x7b, 0xda, 0x20, 0xf1, 0xcd, 0xb0, 0xb4, 0x15,
+        0x35, 0x6d, 0x94, 0x81, 0xb4, 0xcf, 0xac, 0x30, 0x79, 0xc7, 0xe8, 0x8c,
+        0xd5, 0x87, 0x29, 0x08, 0x79, 0xc1, 0x14, 0x54, 0xcc, 0xb8, 0x01, 0x91,
+        0x9b, 0x51, 0x10, 0xfa, 0x3a, 0x29, 0x84, 0xbb, 0xc2, 0x4d, 0x46, 0xa5,
+        0x6e, 0x4b, 0x45, 0xc6, 0x87, 0x42, 0xe8, 0x4e, 0x87, 0x3d, 0xb6, 0x76,
+        0x25, 0xf3, 0x80, 0xff, 0x8e, 0xa9, 0x29, 0x4f, 0x91, 0x9a, 0xe7, 0xd7,
+        0x9a, 0xbc, 0xed, 0x17, 0x13, 0xa5, 0x72, 0xcd
+    };
+    auto text = try$(unzlib(dynamic));
+    expectEq$(text.len(), 320uz);
+    expect$(sub(text, 0, 16) == bytes("delta gamma xref"s));
+
+    // NOTE: The checksum covers the decompressed data.
+    stored[8] ^= 1;
+    expect$(not unzlib(stored));
+
+    return Ok();
+}
+
+} // namespace Flate::Tests
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <karm-base/enum.h>
+#include <karm-gfx/color.h>
 #include <karm-io/emit.h>
 #include <karm-math/trans.h>
 
@@ -42,42 +43,31 @@ struct Graphic {
     // Graphics state operators
 
     void save() {
-        e("q");
+        e.ln("q");
     }
 
     void restore() {
-        e("Q");
+        e.ln("Q");
     }
 
     void transform(Math::Trans2f t) {
-        e(t.xx);
-        e(' ');
-        e(t.xy);
-        e(' ');
-        e(t.yx);
-        e(' ');
-        e(t.yy);
-        e(' ');
-        e(t.ox);
-        e(' ');
-        e(t.oy);
-        e(" cm");
+        e.ln("{} {} {} {} {} {} cm", t.xx, t.xy, t.yx, t.yy, t.ox, t.oy);
     }
 
     void lineWidth(f64 w) {
-        e("{} w", w);
+        e.ln("{} w", w);
     }
 
     void lineCap(LineCap cap) {
-        e("{} J", toUnderlyingType(cap));
+        e.ln("{} J", toUnderlyingType(cap));
     }
 
     void lineJoin(LineJoin join) {
-        e("{} j", toUnderlyingType(join));
+        e.ln("{} j", toUnderlyingType(join));
     }
 
     void miterLimit(f64 m) {
-        e("{} M", m);
+        e.ln("{} M", m);
     }
 
     void dash(Slice<f64> const &d, f64 o) {
@@ -86,131 +76,153 @@ struct Graphic {
             if (i > 0) {
                 e(' ');
             }
-            e(d[i]);
+            e("{}", d[i]);
         }
-        e("] ");
-        e(o);
-        e(" d");
+        e.ln("] {} d", o);
+    }
+
+    // Color operators
+
+    void fillColor(Gfx::Color c) {
+        e.ln("{} {} {} rg", c.red / 255.0, c.green / 255.0, c.blue / 255.0);
+    }
+
+    void strokeColor(Gfx::Color c) {
+        e.ln("{} {} {} RG", c.red / 255.0, c.green / 255.0, c.blue / 255.0);
     }
 
     // Path construction operators
 
     void moveTo(Math::Vec2f p) {
-        e("{} {} m", p.x, p.y);
+        e.ln("{} {} m", p.x, p.y);
     }
 
     void lineTo(Math::Vec2f p) {
-        e("{} {} l", p.x, p.y);
+        e.ln("{} {} l", p.x, p.y);
     }
 
     void curveTo(Math::Vec2f c1, Math::Vec2f c2, Math::Vec2f p) {
-        e("{} {} {} {} {} {} c", c1.x, c1.y, c2.x, c2.y, p.x, p.y);
+        e.ln("{} {} {} {} {} {} c", c1.x, c1.y, c2.x, c2.y, p.x, p.y);
     }
 
     void closePath() {
-        e("h");
+        e.ln("h");
     }
 
     void rectangle(Math::Rectf r) {
-        e("{} {} {} {} re", r.x, r.y, r.width, r.height);
+        e.ln("{} {} {} {} re", r.x, r.y, r.width, r.height);
     }
 
     // Path painting operators
 
     void stroke() {
-        e("S");
+        e.ln("S");
     }
 
     void closeStroke() {
-        e("s");
+        e.ln("s");
     }
 
     void fill(FillRule rule = FillRule::NONZERO) {
         if (rule == FillRule::NONZERO) {
-            e("f");
+            e.ln("f");
         } else {
-            e("f*");
+            e.ln("f*");
         }
     }
 
     void fillStroke(FillRule rule = FillRule::NONZERO) {
         if (rule == FillRule::NONZERO) {
-            e("B");
+            e.ln("B");
         } else {
-            e("B*");
+            e.ln("B*");
         }
     }
 
     void closeFillStroke(FillRule rule = FillRule::NONZERO) {
         if (rule == FillRule::NONZERO) {
-            e("b");
+            e.ln("b");
         } else {
-            e("b*");
+            e.ln("b*");
         }
     }
 
     void endPath() {
-        e("n");
+        e.ln("n");
     }
 
     // Clipping path operators
 
     void clip(FillRule rule = FillRule::NONZERO) {
         if (rule == FillRule::NONZERO) {
-            e("W");
+            e.ln("W");
         } else {
-            e("W*");
+            e.ln("W*");
         }
     }
 
     // Text object operators
 
     void beginText() {
-        e("BT");
+        e.ln("BT");
     }
 
     void endText() {
-        e("ET");
+        e.ln("ET");
     }
 
     // Text state operators
 
     void charSpacing(f64 s) {
-        e("{} Tc", s);
+        e.ln("{} Tc", s);
     }
 
     void wordSpacing(f64 s) {
-        e("{} Tw", s);
+        e.ln("{} Tw", s);
     }
 
     void horizScaling(f64 s) {
-        e("{} Tz", s);
+        e.ln("{} Tz", s);
     }
 
     void textLeading(f64 l) {
-        e("{} TL", l);
+        e.ln("{} TL", l);
     }
 
     void fontSize(Name const &font, f64 size) {
-        e("/{} {} Tf", font.value, size);
+        e.ln("/{} {} Tf", font.value, size);
     }
 
     void textRenderMode(TextRenderMode mode) {
-        e("{} Tr", toUnderlyingType(mode));
+        e.ln("{} Tr", toUnderlyingType(mode));
     }
 
     void rise(f64 r) {
-        e("{} Ts", r);
+        e.ln("{} Ts", r);
     }
 
     // Text-positioning operators
 
     void moveText(Math::Vec2f p) {
-        e("{} {} Td", p.x, p.y);
+        e.ln("{} {} Td", p.x, p.y);
     }
 
-    void moveTextSet(Math::Vec2f p) {
-        e("{} {} Tm", p.x, p.y);
+    void textMatrix(Math::Trans2f t) {
+        e.ln("{} {} {} {} {} {} Tm", t.xx, t.xy, t.yx, t.yy, t.ox, t.oy);
+    }
+
+    // Text-showing operators
+
+    // Shows two byte glyph ids, each one preceded by how much to move the
+    // pen back, in thousandths of the font size, before showing it.
+    void showGlyphs(Slice<Cons<f64, u16>> glyphs) {
+        e("[");
+        for (auto [adjust, glyph] : glyphs) {
+            if (adjust != 0)
+                e("{}", adjust);
+            e("<{04x}>", glyph);
+        }
+        e.ln("] TJ");
     }
 };
 
@@ -8,23 +8,24 @@ void write(Io::Emit &e, Object const &o) {
             e("null");
         },
         [&](Ref const &ref) {
-            e(ref.num);
-            e(' ');
-            e(ref.gen);
-            e(" R");
+            e("{} {} R", ref.num, ref.gen);
         },
         [&](bool b) {
             e(b ? "true" : "false");
         },
         [&](isize i) {
-            e(i);
+            e("{}", i);
         },
         [&](f64 f) {
-            e(f);
+            e("{}", f);
         },
         [&](String const &s) {
             e('(');
-            e(s);
+            for (auto r : iterRunes(s)) {
+                if (r == '(' or r == ')' or r == '\\')
+                    e('\\');
+                e(r);
+            }
             e(')');
         },
         [&](Name const &n) {
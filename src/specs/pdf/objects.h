@@ -14,6 +14,8 @@ struct Ref {
 
 struct Name {
     String value;
+
+    bool operator==(Name const &) const = default;
 };
 
 using Array = Vec<Object>;
@@ -0,0 +1,235 @@
+#include <ttf/subset.h>
+
+#include "printer.h"
+
+namespace Pdf {
+
+// NOTE: Pages are laid out in css pixels, which are 1/96 of an inch,
+//       while pdf units are points, 1/72 of an inch.
+static constexpr f64 PT_PER_PX = 72.0 / 96.0;
+static constexpr f64 PT_PER_MM = 72.0 / 25.4;
+
+// Subsets are named after their font with a tag of six letters in front,
+// which has to be different for every subset in the document.
+static String _subsetName(usize index, Str name) {
+    StringBuilder sb;
+    for (usize i = 0; i < 6; i++) {
+        sb.append((Rune)('A' + index % 26));
+        index /= 26;
+    }
+    sb.append('+');
+    sb.append(name);
+    return sb.take();
+}
+
+Printer::Printer(Io::Writer &out, Print::PaperStock paper)
+    : _writer(out), _paper(paper) {
+    _error = _writer.header();
+    _pages = _writer.alloc();
+    _beginPage();
+}
+
+Math::Vec2f Printer::_pageSize() const {
+    return {_paper.width * PT_PER_MM, _paper.height * PT_PER_MM};
+}
+
+void Printer::_beginPage() {
+    // Flip the y axis and scale to pixels, so that everything below can
+    // be drawn in the same space as on screen.
+    _g.transform({PT_PER_PX, 0, 0, -PT_PER_PX, 0, _pageSize().y});
+    _blank = true;
+}
+
+Res<> Printer::_endPage() {
+    try$(_e.flush());
+    auto content = _content.take();
+
+    auto contentRef = _writer.alloc();
+    try$(_writer.write(contentRef, {}, bytes(content)));
+
+    Dict fonts;
+    for (auto &f : _fonts)
+        fonts.put(f.name, f.ref);
+
+    Dict resources;
+    resources.put(Name{"Font"s}, std::move(fonts));
+
+    auto size = _pageSize();
+    Dict page;
+    page.put(Name{"Type"s}, Name{"Page"s});
+    page.put(Name{"Parent"s}, _pages);
+    page.put(Name{"MediaBox"s}, Array{(isize)0, (isize)0, size.x, size.y});
+    page.put(Name{"Resources"s}, std::move(resources));
+    page.put(Name{"Contents"s}, contentRef);
+
+    auto pageRef = _writer.alloc();
+    try$(_writer.write(pageRef, page));
+    _kids.pushBack(pageRef);
+
+    return Ok();
+}
+
+Printer::_Font &Printer::_font(Strong<Media::Fontface> face) {
+    for (auto &f : _fonts)
+        if (&f.face.unwrap() == &face.unwrap())
+            return f;
+
+    _fonts.pushBack({
+        .face = face,
+        .name = Name{Io::format("F{}", _fonts.len() + 1).unwrap()},
+        .ref = _writer.alloc(),
+        .used = {},
+    });
+    return last(_fonts);
+}
+
+Res<> Printer::_writeFont(_Font &font) {
+    auto program = font.face->program().unwrap();
+    auto ttf = try$(Ttf::Font::load(program));
+    auto units = font.face->units();
+
+    Vec<usize> glyphs;
+    Array widths;
+    for (usize g = 0; g < font.used.len(); g++) {
+        if (not font.used[g])
+            continue;
+        glyphs.pushBack(g);
+        widths.pushBack((isize)g);
+        widths.pushBack(Array{font.face->advance(Media::Glyph(g)) * 1000 / units});
+    }
+
+    auto subset = try$(Ttf::subset(ttf, glyphs));
+
+    auto postscriptName = ttf._name.postscriptName();
+    Name baseName{_subsetName(&font - _fonts.buf(), postscriptName ? Str{*postscriptName} : Str{font.name.value})};
+
+    auto fileRef = _writer.alloc();
+    Dict file;
+    file.put(Name{"Length1"s}, (isize)subset.len());
+    try$(_writer.write(fileRef, std::move(file), subset));
+
+    auto m = font.face->metrics();
+    auto scale = 1000 / units;
+
+    Dict descriptor;
+    descriptor.put(Name{"Type"s}, Name{"FontDescriptor"s});
+    descriptor.put(Name{"FontName"s}, baseName);
+    descriptor.put(Name{"Flags"s}, (isize)4);
+    descriptor.put(Name{"FontBBox"s}, Array{(isize)0, -m.descend * scale, ttf.metrics().maxWidth * scale, m.ascend * scale});
+    descriptor.put(Name{"ItalicAngle"s}, (isize)0);
+    descriptor.put(Name{"Ascent"s}, m.ascend * scale);
+    descriptor.put(Name{"Descent"s}, -m.descend * scale);
+    descriptor.put(Name{"CapHeight"s}, m.captop * scale);
+    descriptor.put(Name{"StemV"s}, (isize)80);
+    descriptor.put(Name{"FontFile2"s}, fileRef);
+
+    auto descriptorRef = _writer.alloc();
+    try$(_writer.write(descriptorRef, descriptor));
+
+    Dict systemInfo;
+    systemInfo.put(Name{"Registry"s}, String{"Adobe"s});
+    systemInfo.put(Name{"Ordering"s}, String{"Identity"s});
+    systemInfo.put(Name{"Supplement"s}, (isize)0);
+
+    // Glyphs are addressed by their id in the font, both in the content
+    // streams and in the subset.
+    Dict cidFont;
+    cidFont.put(Name{"Type"s}, Name{"Font"s});
+    cidFont.put(Name{"Subtype"s}, Name{"CIDFontType2"s});
+    cidFont.put(Name{"BaseFont"s}, baseName);
+    cidFont.put(Name{"CIDSystemInfo"s}, std::move(systemInfo));
+    cidFont.put(Name{"FontDescriptor"s}, descriptorRef);
+    cidFont.put(Name{"W"s}, std::move(widths));
+    cidFont.put(Name{"CIDToGIDMap"s}, Name{"Identity"s});
+
+    auto cidFontRef = _writer.alloc();
+    try$(_writer.write(cidFontRef, cidFont));
+
+    Dict type0;
+    type0.put(Name{"Type"s}, Name{"Font"s});
+    type0.put(Name{"Subtype"s}, Name{"Type0"s});
+    type0.put(Name{"BaseFont"s}, baseName);
+    type0.put(Name{"Encoding"s}, Name{"Identity-H"s});
+    type0.put(Name{"DescendantFonts"s}, Array{cidFontRef});
+
+    return _writer.write(font.ref, type0);
+}
+
+void Printer::pageBreak() {
+    if (not _error)
+        return;
+    _error = _endPage();
+    _beginPage();
+}
+
+void Printer::fill(Math::Rectf rect, Gfx::Color color) {
+    _g.fillColor(color);
+    _g.rectangle(rect);
+    _g.fill();
+    _blank = false;
+}
+
+void Printer::fill(Math::Vec2f baseline, Media::Font const &font, Media::GlyphRun const &run, Gfx::Color color) {
+    // NOTE: Faces that can't be embedded are left out, there is nothing
+    //       to draw them with.
+    if (not run.fontface->program() or not run.glyphs.len())
+        return;
+
+    auto &f = _font(run.fontface);
+    auto units = run.fontface->units();
+
+    Vec<Cons<f64, u16>> glyphs;
+    f64 pen = 0;
+    for (auto const &g : run.glyphs) {
+        auto id = g.glyph.value();
+        if (id >= f.used.len())
+            f.used.resize(id + 1, false);
+        f.used[id] = true;
+
+        // Widths are in thousandths of the font size, move the pen to
+        // where shaping put the glyph, kerning included.
+        auto pos = g.pos * 1000 / units;
+        glyphs.pushBack({pen - pos, (u16)id});
+        pen = pos + run.fontface->advance(g.glyph) * 1000 / units;
+    }
+
+    _g.beginText();
+    _g.fillColor(color);
+    _g.fontSize(f.name, font.fontsize);
+    // Flip the text back up, the page itself is upside down.
+    _g.textMatrix({1, 0, 0, -1, baseline.x, baseline.y});
+    _g.showGlyphs(glyphs);
+    _g.endText();
+    _blank = false;
+}
+
+Res<> Printer::finish() {
+    try$(_error);
+
+    // NOTE: A document needs at least one page, even if it's blank.
+    if (not _blank or _kids.len() == 0)
+        try$(_endPage());
+
+    for (auto &f : _fonts)
+        try$(_writeFont(f));
+
+    Array kids;
+    for (auto ref : _kids)
+        kids.pushBack(ref);
+
+    Dict pages;
+    pages.put(Name{"Type"s}, Name{"Pages"s});
+    pages.put(Name{"Kids"s}, std::move(kids));
+    pages.put(Name{"Count"s}, (isize)_kids.len());
+    try$(_writer.write(_pages, pages));
+
+    Dict catalog;
+    catalog.put(Name{"Type"s}, Name{"Catalog"s});
+    catalog.put(Name{"Pages"s}, _pages);
+    auto catalogRef = _writer.alloc();
+    try$(_writer.write(catalogRef, catalog));
+
+    return _writer.finish(catalogRef);
+}
+
+} // namespace Pdf
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <karm-io/impls.h>
+#include <karm-print/context.h>
+
+#include "graphic.h"
+#include "writer.h"
+
+namespace Pdf {
+
+// Prints straight into a pdf file, pages are written out as soon as they
+// are done, and fonts once the document is, embedding only the glyphs
+// that were used.
+struct Printer : public Print::Context {
+    struct _Font {
+        Strong<Media::Fontface> face;
+        Name name;
+        Ref ref;
+        Vec<bool> used;
+    };
+
+    Writer _writer;
+    Print::PaperStock _paper;
+    Ref _pages;
+    Vec<Ref> _kids;
+    Vec<_Font> _fonts;
+
+    Io::StringWriter _content;
+    Io::Emit _e{_content};
+    Graphic _g{_e};
+    bool _blank = true;
+
+    Res<> _error = Ok();
+
+    Printer(Io::Writer &out, Print::PaperStock paper = Print::A4);
+
+    Math::Vec2f _pageSize() const;
+
+    void _beginPage();
+
+    Res<> _endPage();
+
+    _Font &_font(Strong<Media::Fontface> face);
+
+    Res<> _writeFont(_Font &font);
+
+    void pageBreak() override;
+
+    void fill(Math::Rectf rect, Gfx::Color color) override;
+
+    void fill(Math::Vec2f baseline, Media::Font const &font, Media::GlyphRun const &run, Gfx::Color color) override;
+
+    // Writes what is left of the document, nothing can be printed after.
+    Res<> finish();
+};
+
+} // namespace Pdf
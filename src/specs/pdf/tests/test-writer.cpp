@@ -0,0 +1,87 @@
+#include <karm-io/impls.h>
+#include <karm-test/macros.h>
+#include <pdf/writer.h>
+
+namespace Pdf::Tests {
+
+static Opt<usize> _find(Bytes hay, Str needle) {
+    for (usize i = 0; i + needle.len() <= hay.len(); i++)
+        if (sub(hay, i, i + needle.len()) == bytes(needle))
+            return i;
+    return NONE;
+}
+
+static usize _number(Bytes digits) {
+    usize n = 0;
+    for (auto d : digits) {
+        if (d < '0' or d > '9')
+            break;
+        n = n * 10 + (d - '0');
+    }
+    return n;
+}
+
+test$("pdf-writer-xref") {
+    Io::BufferWriter buf;
+    Writer writer{buf};
+    try$(writer.header());
+
+    auto catalog = writer.alloc();
+    auto pages = writer.alloc();
+    auto content = writer.alloc();
+
+    // NOTE: Objects are written in a different order than they were
+    //       allocated in, the table has to follow the numbers.
+    try$(writer.write(content, Dict{}, bytes("BT /F1 12 Tf (hello) Tj ET"s)));
+
+    Dict pagesDict;
+    pagesDict.put(Name{"Type"s}, Name{"Pages"s});
+    pagesDict.put(Name{"Count"s}, (isize)0);
+    try$(writer.write(pages, pagesDict));
+
+    Dict catalogDict;
+    catalogDict.put(Name{"Type"s}, Name{"Catalog"s});
+    catalogDict.put(Name{"Pages"s}, pages);
+    try$(writer.write(catalog, catalogDict));
+
+    try$(writer.finish(catalog));
+
+    auto out = buf.bytes();
+    auto startxref = _find(out, "startxref\n"s);
+    expect$(startxref);
+    usize start = _number(next(out, *startxref + 10));
+    expect$(sub(out, start, start + 5) == bytes("xref\n"s));
+
+    auto header = try$(Io::format("xref\n0 {}\n", 4));
+    auto entries = start + header.len();
+    expect$(sub(out, start, entries) == bytes(header));
+    expect$(sub(out, entries, entries + 20) == bytes("0000000000 65535 f\r\n"s));
+
+    for (usize num = 1; num <= 3; num++) {
+        auto entry = sub(out, entries + num * 20, entries + num * 20 + 20);
+        expect$(next(entry, 10) == bytes(" 00000 n\r\n"s));
+
+        auto offset = _number(entry);
+        auto obj = try$(Io::format("{} 0 obj\n", num));
+        expect$(sub(out, offset, offset + obj.len()) == bytes(obj));
+    }
+
+    return Ok();
+}
+
+test$("pdf-writer-unwritten") {
+    Io::BufferWriter buf;
+    Writer writer{buf};
+    try$(writer.header());
+
+    auto catalog = writer.alloc();
+    writer.alloc();
+    try$(writer.write(catalog, Dict{}));
+
+    expect$(not writer.write(Ref{3, 0}, Dict{}));
+    expect$(not writer.finish(catalog));
+
+    return Ok();
+}
+
+} // namespace Pdf::Tests
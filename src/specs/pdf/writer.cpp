@@ -0,0 +1,100 @@
+#include <flate/deflate.h>
+#include <karm-io/impls.h>
+
+#include "writer.h"
+
+namespace Pdf {
+
+Ref Writer::alloc() {
+    _xref.pushBack(0);
+    return {_xref.len(), 0};
+}
+
+Res<> Writer::_write(Bytes bytes) {
+    _offset += try$(_out.write(bytes));
+    return Ok();
+}
+
+Res<> Writer::_write(Str str) {
+    return _write(bytes(str));
+}
+
+Res<> Writer::_begin(Ref ref) {
+    if (ref.num == 0 or ref.num > _xref.len())
+        return Error::invalidInput("object number was not allocated");
+    _xref[ref.num - 1] = _offset;
+    return _write(try$(Io::format("{} {} obj\n", ref.num, ref.gen)));
+}
+
+Res<> Writer::header() {
+    // NOTE: The comment with bytes above 127 tells transports the file
+    //       is binary.
+    return _write("%PDF-1.7\n%\xe2\xe3\xcf\xd3\n"s);
+}
+
+Res<> Writer::write(Ref ref, Object const &obj) {
+    try$(_begin(ref));
+
+    Io::StringWriter sw;
+    Io::Emit e{sw};
+    Pdf::write(e, obj);
+    try$(e.flush());
+    try$(_write(sw.str()));
+
+    return _write("\nendobj\n"s);
+}
+
+Res<> Writer::write(Ref ref, Dict dict, Bytes data, bool compress) {
+    Io::BufferWriter deflated;
+    if (compress) {
+        try$(Flate::zlib(deflated, data));
+        data = deflated.bytes();
+        dict.put(Name{"Filter"s}, Name{"FlateDecode"s});
+    }
+    dict.put(Name{"Length"s}, (isize)data.len());
+
+    try$(_begin(ref));
+
+    Io::StringWriter sw;
+    Io::Emit e{sw};
+    Pdf::write(e, dict);
+    try$(e.flush());
+    try$(_write(sw.str()));
+
+    try$(_write("\nstream\n"s));
+    try$(_write(data));
+    return _write("\nendstream\nendobj\n"s);
+}
+
+Res<> Writer::finish(Ref root, Opt<Ref> info) {
+    usize start = _offset;
+
+    // NOTE: Every entry is exactly 20 bytes, so readers can seek to an
+    //       object without parsing the table.
+    try$(_write(try$(Io::format("xref\n0 {}\n", _xref.len() + 1))));
+    try$(_write("0000000000 65535 f\r\n"s));
+    for (auto offset : _xref) {
+        if (not offset)
+            return Error::invalidInput("allocated object was never written");
+        try$(_write(try$(Io::format("{010} 00000 n\r\n", offset))));
+    }
+
+    Dict trailer;
+    trailer.put(Name{"Size"s}, (isize)(_xref.len() + 1));
+    trailer.put(Name{"Root"s}, root);
+    if (info)
+        trailer.put(Name{"Info"s}, *info);
+
+    Io::StringWriter sw;
+    Io::Emit e{sw};
+    Pdf::write(e, trailer);
+    try$(e.flush());
+
+    try$(_write("trailer\n"s));
+    try$(_write(sw.str()));
+    try$(_write(try$(Io::format("\nstartxref\n{}\n%%EOF\n", start))));
+
+    return Ok();
+}
+
+} // namespace Pdf
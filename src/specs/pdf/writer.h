@@ -0,0 +1,39 @@
+#pragma once
+
+#include <karm-io/traits.h>
+
+#include "objects.h"
+
+namespace Pdf {
+
+// Writes a document one object at a time, objects are flushed to the
+// output as soon as they are written, only their offsets are kept around
+// for the cross-reference table at the end.
+struct Writer {
+    Io::Writer &_out;
+    usize _offset = 0;
+    Vec<usize> _xref; //< Offset of object n at n - 1, 0 until written
+
+    Writer(Io::Writer &out) : _out(out) {}
+
+    // Reserves an object number, so that objects can refer to others that
+    // are only written later.
+    Ref alloc();
+
+    Res<> _write(Bytes bytes);
+
+    Res<> _write(Str str);
+
+    Res<> _begin(Ref ref);
+
+    Res<> header();
+
+    Res<> write(Ref ref, Object const &obj);
+
+    // Writes a stream object, deflating the data if asked to.
+    Res<> write(Ref ref, Dict dict, Bytes data, bool compress = true);
+
+    Res<> finish(Ref root, Opt<Ref> info = NONE);
+};
+
+} // namespace Pdf
@@ -0,0 +1,461 @@
+#include "buffer.h"
+
+namespace Textbox {
+
+// NOTE: A rune starts at the first byte of a piece and at every byte that
+//       isn't a continuation byte, so pieces are only ever cut there, and
+//       a rune never straddles two pieces, even in malformed text.
+static bool _isBoundary(u8 b) {
+    return (b & 0xc0) != 0x80;
+}
+
+static Rune _decode(Bytes bytes, usize off) {
+    u8 first = bytes[off];
+    usize len = 1;
+    while (off + len < bytes.len() and not _isBoundary(bytes[off + len]))
+        len++;
+
+    if (len != Utf8::unitLen(first))
+        return U'�';
+
+    if (len == 1)
+        return first;
+
+    Rune rune = first & (0x7f >> len);
+    for (usize i = 1; i < len; i++)
+        rune = (rune << 6) | (bytes[off + i] & 0x3f);
+    return rune;
+}
+
+Buffer::Buffer() {
+    // NOTE: Node zero stands for the empty tree.
+    _nodes.pushBack(Node{});
+}
+
+Buffer::Buffer(Str text) : Buffer() {
+    _text = text;
+    _load(bytes(_text));
+}
+
+Buffer::Buffer(Sys::Mmap mmap) : Buffer() {
+    _mmap = std::move(mmap);
+    _load(_mmap->bytes());
+}
+
+// MARK: Pieces ----------------------------------------------------------------
+
+Bytes Buffer::_bytes(Piece const &p) const {
+    if (p.src == Piece::ORIGINAL)
+        return sub(_original, p.start, p.start + p.bytes);
+    return sub(_added, p.start, p.start + p.bytes);
+}
+
+Piece Buffer::_measure(Piece::Src src, Bytes bytes, usize start, usize len) {
+    Piece p{src, start, len, len ? 1uz : 0uz, 0};
+    for (usize i = start; i < start + len; i++) {
+        if (i != start and _isBoundary(bytes[i]))
+            p.runes++;
+        if (bytes[i] == '\n')
+            p.lines++;
+    }
+    return p;
+}
+
+usize Buffer::_byteOffset(Piece const &p, usize runes) const {
+    if (runes == 0)
+        return 0;
+
+    if (runes >= p.runes)
+        return p.bytes;
+
+    auto bytes = _bytes(p);
+    usize seen = 0;
+    for (usize i = 1; i < bytes.len(); i++)
+        if (_isBoundary(bytes[i]) and ++seen == runes)
+            return i;
+    return bytes.len();
+}
+
+Cons<Piece> Buffer::_cut(Piece const &p, usize runes) const {
+    usize off = _byteOffset(p, runes);
+    auto bytes = _bytes(p);
+
+    usize lines = 0;
+    for (usize i = 0; i < off; i++)
+        if (bytes[i] == '\n')
+            lines++;
+
+    return {
+        Piece{p.src, p.start, off, runes, lines},
+        Piece{p.src, p.start + off, p.bytes - off, p.runes - runes, p.lines - lines},
+    };
+}
+
+// MARK: Tree ------------------------------------------------------------------
+
+u32 Buffer::_alloc(Piece piece) {
+    // NOTE: xorshift32, priorities only have to look random.
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 17;
+    _seed ^= _seed << 5;
+
+    Node node{
+        .piece = piece,
+        .prio = _seed,
+        .runes = piece.runes,
+        .lines = piece.lines,
+    };
+
+    if (_free.len()) {
+        u32 t = _free.popBack();
+        _nodes[t] = node;
+        return t;
+    }
+
+    _nodes.pushBack(node);
+    return _nodes.len() - 1;
+}
+
+void Buffer::_release(u32 t) {
+    if (t == NIL)
+        return;
+    _release(_nodes[t].left);
+    _release(_nodes[t].right);
+    _free.pushBack(t);
+}
+
+void Buffer::_pull(u32 t) {
+    auto &n = _nodes[t];
+    n.runes = _nodes[n.left].runes + n.piece.runes + _nodes[n.right].runes;
+    n.lines = _nodes[n.left].lines + n.piece.lines + _nodes[n.right].lines;
+}
+
+u32 Buffer::_merge(u32 a, u32 b) {
+    if (a == NIL)
+        return b;
+
+    if (b == NIL)
+        return a;
+
+    if (_nodes[a].prio > _nodes[b].prio) {
+        u32 right = _merge(_nodes[a].right, b);
+        _nodes[a].right = right;
+        _pull(a);
+        return a;
+    }
+
+    u32 left = _merge(a, _nodes[b].left);
+    _nodes[b].left = left;
+    _pull(b);
+    return b;
+}
+
+void Buffer::_split(u32 t, usize pos, u32 &l, u32 &r) {
+    if (t == NIL) {
+        l = r = NIL;
+        return;
+    }
+
+    usize leftRunes = _nodes[_nodes[t].left].runes;
+    usize pieceRunes = _nodes[t].piece.runes;
+
+    if (pos <= leftRunes) {
+        u32 ll, lr;
+        _split(_nodes[t].left, pos, ll, lr);
+        _nodes[t].left = lr;
+        _pull(t);
+        l = ll;
+        r = t;
+    } else if (pos >= leftRunes + pieceRunes) {
+        u32 rl, rr;
+        _split(_nodes[t].right, pos - leftRunes - pieceRunes, rl, rr);
+        _nodes[t].right = rl;
+        _pull(t);
+        l = t;
+        r = rr;
+    } else {
+        // NOTE: The cut falls inside of this piece, keep the head here,
+        //       and move the tail along with the right subtree.
+        auto [head, tail] = _cut(_nodes[t].piece, pos - leftRunes);
+        u32 right = _nodes[t].right;
+        u32 node = _alloc(tail);
+
+        _nodes[t].piece = head;
+        _nodes[t].right = NIL;
+        _pull(t);
+
+        l = t;
+        r = _merge(node, right);
+    }
+}
+
+bool Buffer::_extend(u32 t, usize pos, Piece const &add) {
+    if (t == NIL)
+        return false;
+
+    auto &n = _nodes[t];
+    usize leftRunes = _nodes[n.left].runes;
+    usize end = leftRunes + n.piece.runes;
+
+    bool extended = false;
+    if (pos <= leftRunes) {
+        extended = _extend(n.left, pos, add);
+    } else if (pos == end) {
+        extended = n.piece.src == Piece::ADDED and
+                   n.piece.start + n.piece.bytes == add.start;
+        if (extended) {
+            n.piece.bytes += add.bytes;
+            n.piece.runes += add.runes;
+            n.piece.lines += add.lines;
+        }
+    } else if (pos > end) {
+        extended = _extend(n.right, pos - end, add);
+    }
+
+    if (extended) {
+        n.runes += add.runes;
+        n.lines += add.lines;
+    }
+
+    return extended;
+}
+
+void Buffer::_collect(u32 t, Vec<Piece> &pieces) const {
+    if (t == NIL)
+        return;
+    _collect(_nodes[t].left, pieces);
+    pieces.pushBack(_nodes[t].piece);
+    _collect(_nodes[t].right, pieces);
+}
+
+void Buffer::_load(Bytes original) {
+    _original = original;
+
+    usize start = 0;
+    while (start < original.len()) {
+        usize end = min(start + CHUNK, original.len());
+        while (end < original.len() and not _isBoundary(original[end]))
+            end++;
+
+        auto piece = _measure(Piece::ORIGINAL, original, start, end - start);
+        _root = _merge(_root, _alloc(piece));
+        start = end;
+    }
+
+    _version++;
+}
+
+// MARK: Queries ---------------------------------------------------------------
+
+usize Buffer::len() const {
+    return _nodes[_root].runes;
+}
+
+usize Buffer::lines() const {
+    return _nodes[_root].lines + 1;
+}
+
+Rune Buffer::runeAt(usize pos) const {
+    if (pos >= len())
+        return 0;
+
+    auto &h = _hint;
+    if (h.version != _version or
+        pos < h.start or
+        pos >= h.start + _nodes[h.node].piece.runes) {
+        u32 t = _root;
+        usize base = 0;
+        while (true) {
+            auto const &n = _nodes[t];
+            usize leftRunes = _nodes[n.left].runes;
+            if (pos < base + leftRunes) {
+                t = n.left;
+            } else if (pos < base + leftRunes + n.piece.runes) {
+                base += leftRunes;
+                break;
+            } else {
+                base += leftRunes + n.piece.runes;
+                t = n.right;
+            }
+        }
+        h = {_version, t, base, 0, 0};
+    }
+
+    auto bytes = _bytes(_nodes[h.node].piece);
+    usize target = pos - h.start;
+
+    while (h.rune < target) {
+        h.byte++;
+        while (h.byte < bytes.len() and not _isBoundary(bytes[h.byte]))
+            h.byte++;
+        h.rune++;
+    }
+
+    while (h.rune > target) {
+        h.byte--;
+        while (h.byte > 0 and not _isBoundary(bytes[h.byte]))
+            h.byte--;
+        h.rune--;
+    }
+
+    return _decode(bytes, h.byte);
+}
+
+usize Buffer::lineOf(usize pos) const {
+    pos = min(pos, len());
+
+    u32 t = _root;
+    usize lines = 0;
+    while (t != NIL) {
+        auto const &n = _nodes[t];
+        auto const &left = _nodes[n.left];
+
+        if (pos < left.runes) {
+            t = n.left;
+        } else if (pos < left.runes + n.piece.runes) {
+            auto [head, _] = _cut(n.piece, pos - left.runes);
+            return lines + left.lines + head.lines;
+        } else {
+            lines += left.lines + n.piece.lines;
+            pos -= left.runes + n.piece.runes;
+            t = n.right;
+        }
+    }
+
+    return lines;
+}
+
+usize Buffer::lineStart(usize line) const {
+    if (line == 0)
+        return 0;
+
+    u32 t = _root;
+    usize base = 0;
+    while (t != NIL) {
+        auto const &n = _nodes[t];
+        auto const &left = _nodes[n.left];
+
+        if (line <= left.lines) {
+            t = n.left;
+            continue;
+        }
+
+        line -= left.lines;
+        base += left.runes;
+
+        if (line <= n.piece.lines) {
+            // NOTE: The newline we are after is in this piece.
+            auto bytes = _bytes(n.piece);
+            usize rune = 0;
+            for (usize i = 0; i < bytes.len(); i++) {
+                if (i != 0 and _isBoundary(bytes[i]))
+                    rune++;
+                if (bytes[i] == '\n' and --line == 0)
+                    return base + rune + 1;
+            }
+        }
+
+        line -= n.piece.lines;
+        base += n.piece.runes;
+        t = n.right;
+    }
+
+    return len();
+}
+
+void Buffer::_slice(u32 t, usize start, usize end, StringBuilder &sb) const {
+    if (t == NIL or start >= end)
+        return;
+
+    auto const &n = _nodes[t];
+    usize pieceStart = _nodes[n.left].runes;
+    usize pieceEnd = pieceStart + n.piece.runes;
+
+    if (start < pieceStart)
+        _slice(n.left, start, min(end, pieceStart), sb);
+
+    if (start < pieceEnd and end > pieceStart) {
+        usize from = _byteOffset(n.piece, max(start, pieceStart) - pieceStart);
+        usize to = _byteOffset(n.piece, min(end, pieceEnd) - pieceStart);
+        auto bytes = _bytes(n.piece);
+        sb.append(Str{reinterpret_cast<char const *>(bytes.buf()) + from, to - from});
+    }
+
+    if (end > pieceEnd)
+        _slice(n.right, max(start, pieceEnd) - pieceEnd, end - pieceEnd, sb);
+}
+
+String Buffer::str(urange range) const {
+    StringBuilder sb;
+    _slice(_root, range.start, min(range.end(), len()), sb);
+    return sb.take();
+}
+
+String Buffer::str() const {
+    return str({0, len()});
+}
+
+// MARK: Edits -----------------------------------------------------------------
+
+Piece Buffer::insert(usize pos, Slice<Rune> runes) {
+    pos = min(pos, len());
+
+    usize start = _added.len();
+    for (auto rune : runes) {
+        Utf8::One one;
+        if (not Utf8::encodeUnit(rune, one))
+            continue;
+        for (auto unit : iter(one))
+            _added.pushBack(unit);
+    }
+
+    auto piece = _measure(Piece::ADDED, _added, start, _added.len() - start);
+    if (piece.bytes == 0)
+        return piece;
+
+    _version++;
+
+    // NOTE: Typing appends to the piece that was just typed in, so most
+    //       inserts don't need a new piece.
+    if (_extend(_root, pos, piece))
+        return piece;
+
+    u32 l, r;
+    _split(_root, pos, l, r);
+    _root = _merge(_merge(l, _alloc(piece)), r);
+    return piece;
+}
+
+void Buffer::insert(usize pos, Slice<Piece> pieces) {
+    pos = min(pos, len());
+    _version++;
+
+    u32 l, r;
+    _split(_root, pos, l, r);
+    for (auto const &piece : pieces)
+        if (piece.bytes)
+            l = _merge(l, _alloc(piece));
+    _root = _merge(l, r);
+}
+
+Vec<Piece> Buffer::remove(usize pos, usize len) {
+    pos = min(pos, this->len());
+    len = min(len, this->len() - pos);
+
+    Vec<Piece> pieces;
+    if (len == 0)
+        return pieces;
+
+    _version++;
+
+    u32 l, m, r;
+    _split(_root, pos, l, m);
+    _split(m, len, m, r);
+    _collect(m, pieces);
+    _release(m);
+    _root = _merge(l, r);
+
+    return pieces;
+}
+
+} // namespace Textbox
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <karm-base/clamp.h>
+#include <karm-base/cons.h>
+#include <karm-base/range.h>
+#include <karm-base/rune.h>
+#include <karm-base/string.h>
+#include <karm-base/vec.h>
+#include <karm-sys/mmap.h>
+
+namespace Textbox {
+
+// A span of utf-8 text in one of the two buffers of a Buffer. Both buffers
+// are append only, so a piece stays valid for as long as the buffer lives,
+// which is what lets undo records hold on to pieces instead of copies.
+struct Piece {
+    enum Src : u8 {
+        ORIGINAL, //< The text the buffer was loaded with
+        ADDED,    //< Everything that was inserted since
+    };
+
+    Src src;
+    usize start; //< In bytes, from the start of the source
+    usize bytes;
+    usize runes;
+    usize lines; //< Number of newlines
+};
+
+// Piece table over a balanced tree, each node keeps the number of runes
+// and newlines in its subtree, so converting between offsets and lines,
+// and finding where to edit, takes logarithmic time.
+struct Buffer {
+    // NOTE: Pieces never get longer than this when loading, so finding an
+    //       offset inside of a piece is bounded.
+    static constexpr usize CHUNK = 4096;
+
+    static constexpr u32 NIL = 0;
+
+    struct Node {
+        Piece piece;
+        u32 left = NIL;
+        u32 right = NIL;
+        u32 prio = 0;
+        usize runes = 0; //< Of the whole subtree
+        usize lines = 0; //< Of the whole subtree
+    };
+
+    Opt<Sys::Mmap> _mmap;
+    String _text;
+    Bytes _original;
+    Vec<u8> _added;
+
+    Vec<Node> _nodes;
+    Vec<u32> _free;
+    u32 _root = NIL;
+    u32 _seed = 0x2545f491;
+
+    // NOTE: Editors mostly look at runes next to each other, remember
+    //       where the last lookup landed to skip the walk down the tree.
+    struct _Hint {
+        usize version = 0;
+        u32 node = NIL;
+        usize start = 0; //< Offset of the piece in runes
+        usize rune = 0;  //< Offset of the hint in the piece, in runes
+        usize byte = 0;  //< Offset of the hint in the piece, in bytes
+    };
+
+    usize _version = 1;
+    mutable _Hint _hint;
+
+    Buffer();
+
+    Buffer(Str text);
+
+    Buffer(Sys::Mmap mmap);
+
+    Buffer(Buffer &&) = default;
+
+    Buffer &operator=(Buffer &&) = default;
+
+    // MARK: Pieces
+
+    Bytes _bytes(Piece const &p) const;
+
+    static Piece _measure(Piece::Src src, Bytes bytes, usize start, usize len);
+
+    Cons<Piece> _cut(Piece const &p, usize runes) const;
+
+    usize _byteOffset(Piece const &p, usize runes) const;
+
+    // MARK: Tree
+
+    u32 _alloc(Piece piece);
+
+    void _release(u32 t);
+
+    void _pull(u32 t);
+
+    u32 _merge(u32 a, u32 b);
+
+    void _split(u32 t, usize pos, u32 &l, u32 &r);
+
+    // Grows the piece ending at `pos` in place, if `add` directly follows
+    // it in the added buffer.
+    bool _extend(u32 t, usize pos, Piece const &add);
+
+    void _collect(u32 t, Vec<Piece> &pieces) const;
+
+    void _load(Bytes original);
+
+    // MARK: Queries
+
+    usize len() const;
+
+    usize lines() const;
+
+    Rune runeAt(usize pos) const;
+
+    Rune operator[](usize pos) const {
+        return runeAt(pos);
+    }
+
+    // Index of the line `pos` is on.
+    usize lineOf(usize pos) const;
+
+    // Offset of the first rune of `line`.
+    usize lineStart(usize line) const;
+
+    void _slice(u32 t, usize start, usize end, StringBuilder &sb) const;
+
+    String str(urange range) const;
+
+    String str() const;
+
+    // Calls `f` with every piece of text in order, as utf-8.
+    void iterChunks(auto f) const {
+        _iterChunks(_root, f);
+    }
+
+    void _iterChunks(u32 t, auto &f) const {
+        if (t == NIL)
+            return;
+        _iterChunks(_nodes[t].left, f);
+        auto bytes = _bytes(_nodes[t].piece);
+        f(Str{reinterpret_cast<char const *>(bytes.buf()), bytes.len()});
+        _iterChunks(_nodes[t].right, f);
+    }
+
+    // MARK: Edits
+
+    // Returns the piece the runes ended up in.
+    Piece insert(usize pos, Slice<Rune> runes);
+
+    Piece insert(usize pos, Rune rune) {
+        return insert(pos, Slice<Rune>{&rune, 1});
+    }
+
+    void insert(usize pos, Slice<Piece> pieces);
+
+    Vec<Piece> remove(usize pos, usize len);
+};
+
+} // namespace Textbox
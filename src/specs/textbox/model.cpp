@@ -1,4 +1,5 @@
 #include <karm-logger/logger.h>
+#include <karm-sys/file.h>
 
 #include "model.h"
 
@@ -96,10 +97,48 @@ Opt<Action> Action::fromEvent(Sys::Event &e) {
 
 // MARK: Model -----------------------------------------------------------------
 
+void Model::load(Str text) {
+    _buf = Buffer{text};
+    _records.clear();
+    _index = 0;
+    _cur = {};
+}
+
+Res<> Model::loadFile(Mime::Url const &url) {
+    auto file = try$(Sys::File::open(url));
+    auto stat = try$(file.stat());
+
+    // NOTE: Empty files can't be mapped.
+    if (stat.size == 0) {
+        load("");
+        return Ok();
+    }
+
+    auto map = try$(Sys::mmap().map(file));
+    _buf = Buffer{std::move(map)};
+    _records.clear();
+    _index = 0;
+    _cur = {};
+    return Ok();
+}
+
+usize Model::line() const {
+    return _buf.lineOf(_cur.head);
+}
+
+usize Model::col() const {
+    return _cur.head - _lineStart(_cur.head);
+}
+
 void Model::_do(Record &r) {
     switch (r.op) {
     case INSERT:
-        _buf.insert(r.pos, r.rune);
+        // NOTE: Redoing puts back the very same piece, instead of adding
+        //       the rune to the buffer once more.
+        if (r.pieces.len())
+            _buf.insert(r.pos, r.pieces);
+        else
+            r.pieces.pushBack(_buf.insert(r.pos, r.rune));
         break;
 
     case MOVE:
@@ -114,30 +153,32 @@ void Model::_do(Record &r) {
     case DELETE:
         auto start = min(_cur.head, r.pos);
         auto end = max(_cur.head, r.pos);
-        auto slice = sub(_buf, start, end);
-        r.buf = slice;
         r.pos = start;
 
         _cur.head = start;
         _cur.tail = start;
 
-        _buf.removeRange(start, end - start);
+        r.pieces = _buf.remove(start, end - start);
         break;
     }
 }
 
 void Model::_undo(Record &r) {
     switch (r.op) {
-    case INSERT:
-        _buf.removeAt(r.pos);
+    case INSERT: {
+        usize len = 0;
+        for (auto &p : r.pieces)
+            len += p.runes;
+        _buf.remove(r.pos, len);
         break;
+    }
 
     case MOVE:
     case SELECT:
         break;
 
     case DELETE:
-        _buf.insertMany(r.pos, r.buf);
+        _buf.insert(r.pos, r.pieces);
         break;
     }
 
@@ -245,17 +286,16 @@ usize Model::_nextWord(usize pos) const {
 }
 
 usize Model::_lineStart(usize pos) const {
-    while (pos != 0 and _buf[pos - 1] != '\n')
-        pos--;
-
-    return pos;
+    return _buf.lineStart(_buf.lineOf(pos));
 }
 
 usize Model::_lineEnd(usize pos) const {
-    while (pos != _buf.len() and _buf[pos] != '\n')
-        pos++;
+    auto line = _buf.lineOf(pos);
+    if (line + 1 >= _buf.lines())
+        return _buf.len();
 
-    return pos;
+    // NOTE: Right before the newline that starts the next line.
+    return _buf.lineStart(line + 1) - 1;
 }
 
 usize Model::_prevLine(usize pos) const {
@@ -403,9 +443,9 @@ void Model::selectAll() {
 }
 
 String Model::copy() {
-    StringBuilder sb;
-    sb.append(sub(_buf, _cur.head, _cur.tail));
-    return sb.take();
+    auto start = min(_cur.head, _cur.tail);
+    auto end = max(_cur.head, _cur.tail);
+    return _buf.str({start, end - start});
 }
 
 String Model::cut() {
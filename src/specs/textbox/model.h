@@ -4,8 +4,11 @@
 #include <karm-base/string.h>
 #include <karm-base/vec.h>
 #include <karm-events/events.h>
+#include <karm-mime/url.h>
 #include <karm-sys/async.h>
 
+#include "buffer.h"
+
 namespace Textbox {
 
 struct Action {
@@ -83,30 +86,39 @@ struct Model {
         usize pos;
         Rune rune;
         Cur cur;
-        Vec<Rune> buf;
+        Vec<Piece> pieces; //< What was inserted or deleted
         usize group;
     };
 
-    Vec<Rune> _buf;
+    Buffer _buf;
     Vec<Record> _records;
     usize _index{};
     usize _group{};
     Cur _cur{};
 
-    Model(Str text = "") {
-        for (auto r : iterRunes(text))
-            _buf.pushBack(r);
-    }
+    Model(Str text = "")
+        : _buf(text) {}
 
-    Slice<Rune> runes() const {
-        return _buf;
+    String str() const {
+        return _buf.str();
     }
 
-    void load(Str text) {
-        for (auto r : iterRunes(text))
-            _buf.pushBack(r);
+    // Calls `f` with every piece of the text in order, without copying it.
+    void iterChunks(auto f) const {
+        _buf.iterChunks(f);
     }
 
+    void load(Str text);
+
+    // Maps the file instead of reading it, so opening a large file doesn't
+    // copy it, only the parts that are edited end up in memory.
+    Res<> loadFile(Mime::Url const &url);
+
+    // Line and column of the cursor, both starting at zero.
+    usize line() const;
+
+    usize col() const;
+
     // MARK: Operations
 
     void _do(Record &r);
@@ -0,0 +1,122 @@
+#include <karm-test/macros.h>
+#include <textbox/model.h>
+
+namespace Textbox::Tests {
+
+test$("buffer-insert-remove") {
+    Buffer buf{"hello world"};
+    expectEq$(buf.len(), 11uz);
+
+    buf.insert(5, U',');
+    expectEq$(buf.str(), "hello, world"s);
+
+    buf.insert(buf.len(), U'!');
+    buf.insert(buf.len(), U'!');
+    expectEq$(buf.str(), "hello, world!!"s);
+
+    auto removed = buf.remove(0, 7);
+    expectEq$(buf.str(), "world!!"s);
+
+    buf.insert(0, removed);
+    expectEq$(buf.str(), "hello, world!!"s);
+    expectEq$(buf.str({7, 5}), "world"s);
+
+    return Ok();
+}
+
+test$("buffer-utf8") {
+    Buffer buf{"héllo wörld"};
+    expectEq$(buf.len(), 11uz);
+    expectEq$(buf[1], (Rune)U'é');
+    expectEq$(buf[7], (Rune)U'ö');
+    expectEq$(buf[0], (Rune)U'h');
+
+    buf.remove(1, 1);
+    expectEq$(buf.str(), "hllo wörld"s);
+    expectEq$(buf[6], (Rune)U'ö');
+
+    return Ok();
+}
+
+test$("buffer-lines") {
+    Buffer buf{"foo\nbar\n\nbaz"};
+    expectEq$(buf.lines(), 4uz);
+
+    expectEq$(buf.lineOf(0), 0uz);
+    expectEq$(buf.lineOf(3), 0uz);
+    expectEq$(buf.lineOf(4), 1uz);
+    expectEq$(buf.lineOf(9), 3uz);
+
+    expectEq$(buf.lineStart(0), 0uz);
+    expectEq$(buf.lineStart(1), 4uz);
+    expectEq$(buf.lineStart(2), 8uz);
+    expectEq$(buf.lineStart(3), 9uz);
+
+    buf.insert(1, U'\n');
+    expectEq$(buf.lines(), 5uz);
+    expectEq$(buf.lineStart(1), 2uz);
+    expectEq$(buf.lineOf(5), 2uz);
+
+    return Ok();
+}
+
+test$("buffer-large") {
+    StringBuilder sb;
+    for (usize i = 0; i < 10000; i++)
+        sb.append("line\n"s);
+    Buffer buf{sb.str()};
+
+    expectEq$(buf.lines(), 10001uz);
+    expectEq$(buf.lineStart(5000), 25000uz);
+    expectEq$(buf.lineOf(25002), 5000uz);
+
+    buf.remove(24995, 10);
+    expectEq$(buf.lines(), 9999uz);
+    expectEq$(buf.lineStart(4999), 24995uz);
+
+    return Ok();
+}
+
+test$("model-undo-redo") {
+    Model mdl{"foo bar"};
+
+    mdl.moveEnd();
+    mdl.insert('!');
+    expectEq$(mdl.str(), "foo bar!"s);
+
+    mdl.backspace();
+    mdl.backspace();
+    expectEq$(mdl.str(), "foo ba"s);
+
+    mdl.undo();
+    mdl.undo();
+    expectEq$(mdl.str(), "foo bar!"s);
+
+    mdl.undo();
+    expectEq$(mdl.str(), "foo bar"s);
+
+    mdl.redo();
+    expectEq$(mdl.str(), "foo bar!"s);
+
+    return Ok();
+}
+
+test$("model-lines") {
+    Model mdl{"foo\nlonger line\nx"};
+
+    mdl.moveDown();
+    expectEq$(mdl.line(), 1uz);
+    expectEq$(mdl._cur.head, 4uz);
+
+    mdl.moveLineEnd();
+    expectEq$(mdl._cur.head, 15uz);
+    expectEq$(mdl.col(), 11uz);
+
+    mdl.moveDown();
+    expectEq$(mdl.line(), 2uz);
+    expectEq$(mdl._cur.head, 17uz);
+
+    return Ok();
+}
+
+} // namespace Textbox::Tests
@@ -133,27 +133,39 @@ struct CoverageTable : public Io::BChunk {
 
     usize len() const { return get<GlyphCount>(); }
 
+    // NOTE: Both formats are sorted by glyph id, so they can be searched
+    //       in logarithmic time.
     Opt<usize> coverageIndex(usize glyphId) {
-        auto s = begin().skip(4);
-
         if (format() == 1) {
-            for (auto i : range(len())) {
-                auto glyph = s.nextU16be();
-                if (glyph == glyphId) {
-                    return i;
-                }
+            usize lo = 0;
+            usize hi = len();
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                auto glyph = begin().skip(4 + mid * 2).peekU16be();
+                if (glyph == glyphId)
+                    return mid;
+                if (glyph < glyphId)
+                    lo = mid + 1;
+                else
+                    hi = mid;
             }
         }
 
         if (format() == 2) {
-            for (auto i : range(len())) {
-                (void)i;
+            usize lo = 0;
+            usize hi = len();
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                auto s = begin().skip(4 + mid * 6);
                 auto start = s.nextU16be();
                 auto end = s.nextU16be();
                 auto index = s.nextU16be();
-                if (start <= glyphId and glyphId <= end) {
+                if (glyphId < start)
+                    hi = mid;
+                else if (glyphId > end)
+                    lo = mid + 1;
+                else
                     return index + glyphId - start;
-                }
             }
         }
 
@@ -247,20 +259,28 @@ struct GlyphPairAdjustment : public LookupSubtableBase {
         auto value2len = ValueRecord::len(valueFormat2);
         auto pairSetOffset = s.skip(coverageIndex.unwrap() * 2).nextU16be();
 
-        // Lookup the PairSet table for the second glyph
+        // Lookup the PairSet table for the second glyph, its records are
+        // sorted by glyph id.
         auto pairSetTable = begin().skip(pairSetOffset);
         auto pairValueCount = pairSetTable.nextU16be();
-
-        for (usize i : range(pairValueCount)) {
-            (void)i;
-            auto secondGlyph = pairSetTable.nextU16be();
+        auto recordLen = 2 + value1len + value2len;
+
+        usize lo = 0;
+        usize hi = pairValueCount;
+        while (lo < hi) {
+            usize mid = lo + (hi - lo) / 2;
+            auto record = pairSetTable.peek(mid * recordLen);
+            auto secondGlyph = record.nextU16be();
             if (secondGlyph == curr) {
-                ValueRecord value1 = ValueRecord::read(pairSetTable, valueFormat1);
-                ValueRecord value2 = ValueRecord::read(pairSetTable, valueFormat2);
+                ValueRecord value1 = ValueRecord::read(record, valueFormat1);
+                ValueRecord value2 = ValueRecord::read(record, valueFormat2);
                 return Pair<ValueRecord>{value1, value2};
             }
 
-            pairSetTable.skip(value1len + value2len);
+            if (secondGlyph < curr)
+                lo = mid + 1;
+            else
+                hi = mid;
         }
 
         return NONE;
@@ -282,15 +302,20 @@ struct ClassDef : public Io::BChunk {
         }
 
         if (format == 2) {
-            auto classRangeCount = s.nextU16be();
-            for (usize i : range(classRangeCount)) {
-                (void)i;
-                auto startGlyph = s.nextU16be();
-                auto endGlyph = s.nextU16be();
-                auto glyphClass = s.nextU16be();
-                if (startGlyph <= glyphId and glyphId <= endGlyph) {
+            usize lo = 0;
+            usize hi = s.nextU16be();
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                auto record = s.peek(mid * 6);
+                auto startGlyph = record.nextU16be();
+                auto endGlyph = record.nextU16be();
+                auto glyphClass = record.nextU16be();
+                if (glyphId < startGlyph)
+                    hi = mid;
+                else if (glyphId > endGlyph)
+                    lo = mid + 1;
+                else
                     return glyphClass;
-                }
             }
         }
 
@@ -351,7 +376,7 @@ struct LookupTable : public Io::BChunk {
         IGNORE_LIGATURES = 1 << 2,
         IGNORE_MARKS = 1 << 3,
         USE_MARK_FILTERING_SET = 1 << 4,
-        MARK_ATTACHMENT_TYPE = 1 << 5,
+        MARK_ATTACHMENT_TYPE = 0xff00, //< Class of the marks to keep, if any
     };
 
     u16 lookupType() const { return get<LookupType>(); }
@@ -364,9 +389,13 @@ struct LookupTable : public Io::BChunk {
                    : 0;
     }
 
-    LookupSubtable at(usize i) const {
+    Io::BScan subtable(usize i) const {
         auto off = begin().skip(6 + i * 2).nextU16be();
-        auto subtable = begin().skip(off);
+        return begin().skip(off);
+    }
+
+    LookupSubtable at(usize i) const {
+        auto subtable = this->subtable(i);
         auto format = subtable.peekU16be();
 
         switch (format) {
@@ -3,6 +3,7 @@
 #include <karm-logger/logger.h>
 
 #include "table-cmap.h"
+#include "table-gdef.h"
 #include "table-glyf.h"
 #include "table-gpos.h"
 #include "table-gsub.h"
@@ -11,6 +12,7 @@
 #include "table-hmtx.h"
 #include "table-loca.h"
 #include "table-maxp.h"
+#include "table-name.h"
 
 // https://tchayen.github.io/posts/ttf-file-parsing
 // http://stevehanov.ca/blog/?id=143
@@ -50,6 +52,8 @@ struct Font {
     Hmtx _hmtx;
     Gpos _gpos;
     Gsub _gsub;
+    Gdef _gdef;
+    Name _name;
 
     static Res<Cmap::Table> chooseCmap(Font &font) {
         Opt<Cmap::Table> bestCmap = NONE;
@@ -113,6 +117,8 @@ struct Font {
         font._hmtx = try$(font.requireTable<Hmtx>());
         font._gpos = font.lookupTable<Gpos>();
         font._gsub = font.lookupTable<Gsub>();
+        font._gdef = font.lookupTable<Gdef>();
+        font._name = font.lookupTable<Name>();
 
         return Ok(font);
     }
@@ -0,0 +1,197 @@
+#include <karm-base/align.h>
+
+#include "subset.h"
+
+namespace Ttf {
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/glyf#composite-glyph-description
+static constexpr u16 ARG_1_AND_2_ARE_WORDS = 0x0001;
+static constexpr u16 WE_HAVE_A_SCALE = 0x0008;
+static constexpr u16 MORE_COMPONENTS = 0x0020;
+static constexpr u16 WE_HAVE_AN_X_AND_Y_SCALE = 0x0040;
+static constexpr u16 WE_HAVE_A_TWO_BY_TWO = 0x0080;
+
+static constexpr usize HEAD_CHECKSUM_ADJUSTMENT = 8;
+static constexpr usize HEAD_LOCA_FORMAT = 50;
+
+static constexpr u32 CHECKSUM_MAGIC = 0xb1b0afba;
+
+// NOTE: The table directory has to be sorted by tag.
+static constexpr Array<Str, 9> TABLES = {
+    "cvt ", "fpgm", "glyf", "head", "hhea", "hmtx", "loca", "maxp", "prep"
+};
+
+static Bytes _table(Font &font, Str tag) {
+    for (auto table : font.iterTables())
+        if (table.tag == tag)
+            return sub(font._slice, table.offset, table.offset + table.length);
+    return {};
+}
+
+static void _putU16(Vec<u8> &out, u16 v) {
+    out.pushBack(v >> 8);
+    out.pushBack(v);
+}
+
+static void _putU32(Vec<u8> &out, u32 v) {
+    _putU16(out, v >> 16);
+    _putU16(out, v);
+}
+
+static void _setU32(Vec<u8> &out, usize off, u32 v) {
+    out[off + 0] = v >> 24;
+    out[off + 1] = v >> 16;
+    out[off + 2] = v >> 8;
+    out[off + 3] = v;
+}
+
+static void _pad(Vec<u8> &out) {
+    while (out.len() % 4)
+        out.pushBack(0);
+}
+
+static u32 _checksum(Bytes bytes) {
+    u32 sum = 0;
+    for (usize i = 0; i < bytes.len(); i += 4) {
+        u32 word = 0;
+        for (usize j = 0; j < 4; j++)
+            word = (word << 8) | (i + j < bytes.len() ? bytes[i + j] : 0);
+        sum += word;
+    }
+    return sum;
+}
+
+static void _components(Bytes outline, Vec<usize> &pending) {
+    Io::BScan s{outline};
+    if (s.nextI16be() >= 0)
+        return;
+    s.skip(8);
+
+    while (not s.ended()) {
+        u16 flags = s.nextU16be();
+        pending.pushBack(s.nextU16be());
+
+        s.skip(flags & ARG_1_AND_2_ARE_WORDS ? 4 : 2);
+        if (flags & WE_HAVE_A_SCALE)
+            s.skip(2);
+        else if (flags & WE_HAVE_AN_X_AND_Y_SCALE)
+            s.skip(4);
+        else if (flags & WE_HAVE_A_TWO_BY_TWO)
+            s.skip(8);
+
+        if (not(flags & MORE_COMPONENTS))
+            break;
+    }
+}
+
+Res<Vec<u8>> subset(Font &font, Slice<usize> glyphs) {
+    auto maxp = try$(font.requireTable<Maxp>());
+    usize numGlyphs = maxp.numGlyphs();
+
+    auto outline = [&](usize glyph) {
+        auto start = font._loca.glyfOffset(glyph, font._head);
+        auto end = font._loca.glyfOffset(glyph + 1, font._head);
+        return sub(font._glyf.bytes(), start, end);
+    };
+
+    // NOTE: Glyph 0 is the .notdef glyph, which renderers fall back on.
+    Vec<bool> keep;
+    keep.resize(numGlyphs, false);
+    Vec<usize> pending;
+    pending.pushBack(0);
+    for (auto g : glyphs)
+        pending.pushBack(g);
+
+    while (pending.len()) {
+        auto g = pending.popBack();
+        if (g >= numGlyphs or keep[g])
+            continue;
+        keep[g] = true;
+        _components(outline(g), pending);
+    }
+
+    Vec<u8> glyf;
+    Vec<u8> loca;
+    for (usize g = 0; g < numGlyphs; g++) {
+        _putU32(loca, glyf.len());
+        if (keep[g]) {
+            for (auto b : outline(g))
+                glyf.pushBack(b);
+            _pad(glyf);
+        }
+    }
+    _putU32(loca, glyf.len());
+
+    Vec<u8> head;
+    for (auto b : font._head.bytes())
+        head.pushBack(b);
+    if (head.len() < HEAD_LOCA_FORMAT + 2)
+        return Error::invalidData("head table too short");
+    _setU32(head, HEAD_CHECKSUM_ADJUSTMENT, 0);
+    head[HEAD_LOCA_FORMAT] = 0;
+    head[HEAD_LOCA_FORMAT + 1] = 1;
+
+    Array<Bytes, TABLES.len()> tables;
+    usize numTables = 0;
+    for (usize i = 0; i < TABLES.len(); i++) {
+        auto tag = TABLES[i];
+        if (tag == "glyf")
+            tables[i] = glyf;
+        else if (tag == "loca")
+            tables[i] = loca;
+        else if (tag == "head")
+            tables[i] = head;
+        else
+            tables[i] = _table(font, tag);
+
+        if (tables[i].len())
+            numTables++;
+    }
+
+    usize searchRange = 1;
+    usize entrySelector = 0;
+    while (searchRange * 2 <= numTables) {
+        searchRange *= 2;
+        entrySelector++;
+    }
+    searchRange *= 16;
+
+    Vec<u8> out;
+    _putU32(out, 0x00010000);
+    _putU16(out, numTables);
+    _putU16(out, searchRange);
+    _putU16(out, entrySelector);
+    _putU16(out, numTables * 16 - searchRange);
+
+    usize offset = out.len() + numTables * 16;
+    usize headOffset = 0;
+    for (usize i = 0; i < TABLES.len(); i++) {
+        if (not tables[i].len())
+            continue;
+
+        auto tag = TABLES[i];
+        for (auto c : iterRunes(tag))
+            out.pushBack(c);
+        _putU32(out, _checksum(tables[i]));
+        _putU32(out, offset);
+        _putU32(out, tables[i].len());
+
+        if (tag == "head")
+            headOffset = offset;
+        offset += alignUp(tables[i].len(), 4);
+    }
+
+    for (auto table : tables) {
+        if (not table.len())
+            continue;
+        for (auto b : table)
+            out.pushBack(b);
+        _pad(out);
+    }
+
+    _setU32(out, headOffset + HEAD_CHECKSUM_ADJUSTMENT, CHECKSUM_MAGIC - _checksum(out));
+
+    return Ok(std::move(out));
+}
+
+} // namespace Ttf
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "spec.h"
+
+namespace Ttf {
+
+// Builds a font that only has the outlines of `glyphs`, and of the glyphs
+// their composites are made of. Glyph ids stay the same, the outlines of
+// every other glyph are left empty, so that documents can keep addressing
+// glyphs by the ids of the original font, like pdf does with identity
+// cid to gid maps.
+Res<Vec<u8>> subset(Font &font, Slice<usize> glyphs);
+
+} // namespace Ttf
@@ -20,61 +20,86 @@ struct Cmap : public Io::BChunk {
             return slice;
         }
 
+        // NOTE: Segments are sorted by their end code, look for the first
+        //       one that ends at or after the rune.
         Media::Glyph _glyphIdForType4(Rune r) const {
-            u16 segCountX2 = begin().skip(6).nextU16be();
-            u16 segCount = segCountX2 / 2;
-
-            for (usize i = 0; i < segCount; i++) {
-                auto s = begin().skip(14);
-
-                u16 endCode = s.skip(i * 2).peekU16be();
+            if (r > 0xFFFF)
+                return Media::Glyph(0);
 
-                if (r >= endCode)
-                    continue;
+            u16 segCountX2 = begin().skip(6).nextU16be();
+            usize segCount = segCountX2 / 2;
+
+            usize lo = 0;
+            usize hi = segCount;
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                u16 endCode = begin().skip(14 + mid * 2).peekU16be();
+                if (endCode < r)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
 
-                // + 2 for reserved padding
-                u16 startCode = s.skip(segCountX2 + 2).peekU16be();
+            if (lo == segCount) {
+                logWarn("ttf: Glyph not found for rune {x}", r);
+                return Media::Glyph(0);
+            }
 
-                if (r < startCode)
-                    break;
+            // + 2 for reserved padding
+            auto s = begin().skip(14 + lo * 2);
+            u16 startCode = s.skip(segCountX2 + 2).peekU16be();
 
-                u16 idDelta = s.skip(segCountX2).peekI16be();
-                u16 idRangeOffset = s.skip(segCountX2).peekU16be();
+            if (r < startCode) {
+                logWarn("ttf: Glyph not found for rune {x}", r);
+                return Media::Glyph(0);
+            }
 
-                if (idRangeOffset == 0) {
-                    return Media::Glyph((r + idDelta) & 0xFFFF);
-                }
+            u16 idDelta = s.skip(segCountX2).peekI16be();
+            u16 idRangeOffset = s.skip(segCountX2).peekU16be();
 
-                auto offset = idRangeOffset + (r - startCode) * 2;
-                return Media::Glyph(s.skip(offset).nextU16be());
-            }
+            if (idRangeOffset == 0)
+                return Media::Glyph((r + idDelta) & 0xFFFF);
 
-            logWarn("ttf: Glyph not found for rune {x}", r);
-            return Media::Glyph(0);
+            auto offset = idRangeOffset + (r - startCode) * 2;
+            u16 glyph = s.skip(offset).nextU16be();
+            if (glyph == 0)
+                return Media::Glyph(0);
+            return Media::Glyph((glyph + idDelta) & 0xFFFF);
         }
 
+        // NOTE: Groups are sorted by their start code, and don't overlap.
         Media::Glyph _glyphForType12(Rune r) const {
-            auto s = begin().skip(12);
-            u32 nGroups = s.nextU32be();
-
-            for (u32 i = 0; i < nGroups; i++) {
-                u32 startCode = s.nextU32be();
-                u32 endCode = s.nextU32be();
-                u32 glyphOffset = s.nextU32be();
+            static constexpr usize GROUP_SIZE = 12;
+
+            u32 nGroups = begin().skip(12).nextU32be();
+
+            usize lo = 0;
+            usize hi = nGroups;
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                u32 endCode = begin().skip(16 + mid * GROUP_SIZE + 4).peekU32be();
+                if (endCode < r)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
 
-                if (r < startCode)
-                    break;
+            if (lo == nGroups) {
+                logWarn("ttf: glyph not found for rune {x}", r);
+                return Media::Glyph(0);
+            }
 
-                if (r > endCode)
-                    continue;
+            auto s = begin().skip(16 + lo * GROUP_SIZE);
+            u32 startCode = s.nextU32be();
+            /* endCode = */ s.nextU32be();
+            u32 glyphOffset = s.nextU32be();
 
-                if (r >= startCode and r <= endCode) {
-                    return Media::Glyph((r - startCode) + glyphOffset);
-                }
+            if (r < startCode) {
+                logWarn("ttf: glyph not found for rune {x}", r);
+                return Media::Glyph(0);
             }
 
-            logWarn("ttf: glyph not found for rune {x}", r);
-            return Media::Glyph(0);
+            return Media::Glyph((r - startCode) + glyphOffset);
         }
 
         Media::Glyph glyphIdFor(Rune r) const {
@@ -0,0 +1,86 @@
+#pragma once
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gdef
+
+#include "otlayout.h"
+
+namespace Ttf {
+
+enum struct GlyphClass : u16 {
+    NONE = 0,
+    BASE = 1,
+    LIGATURE = 2,
+    MARK = 3,
+    COMPONENT = 4,
+};
+
+struct Gdef : public Io::BChunk {
+    static constexpr Str SIG = "GDEF";
+
+    using MinorVersion = Io::BField<u16be, 2>;
+    using GlyphClassDefOffset = Io::BField<u16be, 4>;
+    using MarkAttachClassDefOffset = Io::BField<u16be, 10>;
+    using MarkGlyphSetsDefOffset = Io::BField<u16be, 12>;
+
+    GlyphClass glyphClass(usize glyph) const {
+        if (not present() or not get<GlyphClassDefOffset>())
+            return GlyphClass::NONE;
+        ClassDef classDef{begin().skip(get<GlyphClassDefOffset>()).remBytes()};
+        auto cls = classDef.classOf(glyph);
+        return cls ? (GlyphClass)*cls : GlyphClass::NONE;
+    }
+
+    usize markAttachClass(usize glyph) const {
+        if (not present() or not get<MarkAttachClassDefOffset>())
+            return 0;
+        ClassDef classDef{begin().skip(get<MarkAttachClassDefOffset>()).remBytes()};
+        auto cls = classDef.classOf(glyph);
+        return cls ? *cls : 0;
+    }
+
+    bool inMarkGlyphSet(usize set, usize glyph) const {
+        // NOTE: Mark glyph sets only exist from version 1.2 onward.
+        if (not present() or get<MinorVersion>() < 2 or not get<MarkGlyphSetsDefOffset>())
+            return false;
+
+        auto s = begin().skip(get<MarkGlyphSetsDefOffset>());
+        auto sets = s;
+        /* format = */ s.nextU16be();
+        auto count = s.nextU16be();
+        if (set >= count)
+            return false;
+
+        auto coverageOffset = s.skip(set * 4).nextU32be();
+        CoverageTable coverage{sets.skip(coverageOffset).remBytes()};
+        return coverage.coverageIndex(glyph).has();
+    }
+
+    // Whether a lookup with the given flags has to skip over `glyph`, as if
+    // it wasn't there.
+    bool ignored(LookupTable const &lookup, usize glyph) const {
+        auto flags = lookup.lookupFlag();
+        auto cls = glyphClass(glyph);
+
+        if (cls == GlyphClass::BASE)
+            return flags & LookupTable::IGNORE_BASE_GLYPHS;
+
+        if (cls == GlyphClass::LIGATURE)
+            return flags & LookupTable::IGNORE_LIGATURES;
+
+        if (cls != GlyphClass::MARK)
+            return false;
+
+        if (flags & LookupTable::IGNORE_MARKS)
+            return true;
+
+        if (flags & LookupTable::USE_MARK_FILTERING_SET)
+            return not inMarkGlyphSet(lookup.markFilteringSet(), glyph);
+
+        if (auto type = (flags & LookupTable::MARK_ATTACHMENT_TYPE) >> 8)
+            return markAttachClass(glyph) != type;
+
+        return false;
+    }
+};
+
+} // namespace Ttf
@@ -1,12 +1,108 @@
 #pragma once
 
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gsub
+
+#include <karm-base/vec.h>
+
 #include "otlayout.h"
+#include "table-gdef.h"
 
 namespace Ttf {
 
+enum struct GsubLookupType : u16 {
+    SINGLE = 1,
+    MULTIPLE = 2,
+    ALTERNATE = 3,
+    LIGATURE = 4,
+    CONTEXT = 5,
+    CHAINED_CONTEXT = 6,
+    EXTENSION = 7,
+    REVERSE_CHAINED_CONTEXT = 8,
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gsub#lookuptype-1-single-substitution-subtable
+struct SingleSubst : public LookupSubtableBase {
+    Opt<usize> substitute(usize glyph) {
+        auto s = begin();
+
+        auto format = s.nextU16be();
+        auto coverageOffset = s.nextU16be();
+
+        CoverageTable coverage{begin().skip(coverageOffset).remBytes()};
+        auto index = try$(coverage.coverageIndex(glyph));
+
+        if (format == 1) {
+            auto delta = s.nextI16be();
+            return (glyph + delta) & 0xffff;
+        }
+
+        if (format == 2) {
+            auto glyphCount = s.nextU16be();
+            if (index >= glyphCount)
+                return NONE;
+            return s.skip(index * 2).nextU16be();
+        }
+
+        return NONE;
+    }
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gsub#lookuptype-4-ligature-substitution-subtable
+struct LigatureSubst : public LookupSubtableBase {
+    // Returns the ligature starting the glyph sequence, if there is one,
+    // and how many glyphs it replaces.
+    Opt<Cons<usize>> ligature(Slice<usize> glyphs) {
+        if (isEmpty(glyphs))
+            return NONE;
+
+        auto s = begin();
+
+        /* format = */ s.nextU16be();
+        auto coverageOffset = s.nextU16be();
+        auto ligatureSetCount = s.nextU16be();
+
+        CoverageTable coverage{begin().skip(coverageOffset).remBytes()};
+        auto index = try$(coverage.coverageIndex(glyphs[0]));
+        if (index >= ligatureSetCount)
+            return NONE;
+
+        auto ligatureSetOffset = s.skip(index * 2).nextU16be();
+        auto ligatureSet = begin().skip(ligatureSetOffset);
+        auto ligatureCount = ligatureSet.nextU16be();
+
+        // NOTE: Ligatures are ordered by preference, the first one that
+        //       matches wins.
+        for (usize i = 0; i < ligatureCount; i++) {
+            auto ligatureOffset = ligatureSet.nextU16be();
+            auto ligature = begin().skip(ligatureSetOffset + ligatureOffset);
+            auto ligatureGlyph = ligature.nextU16be();
+            auto componentCount = ligature.nextU16be();
+
+            if (componentCount == 0 or componentCount > glyphs.len())
+                continue;
+
+            bool match = true;
+            for (usize j = 1; j < componentCount; j++) {
+                if (ligature.nextU16be() != glyphs[j]) {
+                    match = false;
+                    break;
+                }
+            }
+
+            if (match)
+                return Cons<usize>{ligatureGlyph, componentCount};
+        }
+
+        return NONE;
+    }
+};
+
 struct Gsub : public Io::BChunk {
     static constexpr Str SIG = "GSUB";
 
+    // NOTE: Longest ligature we try to match, in components.
+    static constexpr usize MAX_COMPONENTS = 16;
+
     using ScriptListOffset = Io::BField<u16be, 4>;
     using FeatureListOffset = Io::BField<u16be, 6>;
     using LookupListOffset = Io::BField<u16be, 8>;
@@ -23,6 +119,113 @@ struct Gsub : public Io::BChunk {
         return LookupList{begin().skip(get<LookupListOffset>()).remBytes()};
     }
 
+    // MARK: Substitution -----------------------------------------------------
+
+    // Collects the lookups of the given features, in the order they have
+    // to be applied.
+    Vec<usize> lookups(Slice<Str> features) const {
+        Vec<usize> res;
+
+        // FIXME: We assume that the script is always "latn", and fallback
+        //        to the default script otherwise.
+        auto scriptTable = scriptList().lookup("latn");
+        if (not scriptTable)
+            scriptTable = scriptList().lookup("DFLT");
+        if (not scriptTable)
+            return res;
+
+        // FIXME: We assume that the language system is always "dflt".
+        auto langSys = scriptTable.unwrap().defaultLangSys();
+
+        for (auto featureIndex : langSys.iterFeatures()) {
+            auto featureTable = featureList().at(featureIndex);
+
+            bool wanted = false;
+            for (auto feature : features)
+                wanted = wanted or featureTable.tag == feature;
+
+            if (not wanted)
+                continue;
+
+            for (auto lookupIndex : featureTable.iterLookups())
+                if (not contains(res, (usize)lookupIndex))
+                    res.pushBack(lookupIndex);
+        }
+
+        // FIXME: We don't support feature variations.
+
+        sort(res);
+        return res;
+    }
+
+    // `match` holds the index of the glyph being substituted, followed by
+    // the ones after it that the lookup doesn't ignore.
+    static bool _substitute(u16 type, Io::BScan subtable, Vec<usize> &glyphs, Vec<usize> &clusters, Slice<usize> match) {
+        if (type == (u16)GsubLookupType::EXTENSION) {
+            auto extension = subtable;
+            /* format = */ extension.nextU16be();
+            type = extension.nextU16be();
+            subtable.skip(extension.nextU32be());
+        }
+
+        if (type == (u16)GsubLookupType::SINGLE) {
+            auto subst = SingleSubst{subtable.remBytes()}.substitute(glyphs[match[0]]);
+            if (not subst)
+                return false;
+            glyphs[match[0]] = *subst;
+            return true;
+        }
+
+        if (type == (u16)GsubLookupType::LIGATURE) {
+            Array<usize, MAX_COMPONENTS> components;
+            for (usize k = 0; k < match.len(); k++)
+                components[k] = glyphs[match[k]];
+
+            auto lig = LigatureSubst{subtable.remBytes()}.ligature(sub(components, 0, match.len()));
+            if (not lig)
+                return false;
+
+            // NOTE: Ignored glyphs in between the components stay where
+            //       they are, right after the ligature.
+            glyphs[match[0]] = lig->car;
+            for (usize k = lig->cdr - 1; k > 0; k--) {
+                glyphs.removeAt(match[k]);
+                clusters.removeAt(match[k]);
+            }
+            return true;
+        }
+
+        // FIXME: Other lookup types are not supported.
+        return false;
+    }
+
+    // Applies a lookup to a glyph string, `clusters` holds for every glyph
+    // the index of the first rune it comes from, ligatures keep the
+    // cluster of their first component.
+    // Glyphs the lookup flags ask to ignore, according to their class in
+    // `gdef`, are skipped over.
+    void apply(usize lookupIndex, Gdef const &gdef, Vec<usize> &glyphs, Vec<usize> &clusters) const {
+        auto lookupTable = lookupList().at(lookupIndex);
+        auto type = lookupTable.lookupType();
+        bool filtered = lookupTable.lookupFlag() & ~LookupTable::RIGHT_TO_LEFT;
+
+        Array<usize, MAX_COMPONENTS> match;
+        for (usize i = 0; i < glyphs.len(); i++) {
+            if (filtered and gdef.ignored(lookupTable, glyphs[i]))
+                continue;
+
+            usize len = 0;
+            for (usize j = i; j < glyphs.len() and len < MAX_COMPONENTS; j++)
+                if (j == i or not filtered or not gdef.ignored(lookupTable, glyphs[j]))
+                    match[len++] = j;
+
+            // NOTE: Only the first subtable that applies to a glyph is used.
+            for (usize j = 0; j < lookupTable.len(); j++)
+                if (_substitute(type, lookupTable.subtable(j), glyphs, clusters, sub(match, 0, len)))
+                    break;
+        }
+    }
+
     // 1. Locate the current script in the GSUB ScriptList table.
 
     // 2. If the language system is known, search the script for the correct
@@ -10,8 +10,9 @@ struct Loca : public Io::BChunk {
     usize glyfOffset(isize glyphId, Head const &head) const {
         auto s = begin();
         if (head.locaFormat() == 0) {
+            // NOTE: Short offsets are stored halved.
             s.skip(glyphId * 2);
-            return s.nextU16be();
+            return s.nextU16be() * 2;
         } else {
             s.skip(glyphId * 4);
             return s.nextU32be();
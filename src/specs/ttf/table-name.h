@@ -0,0 +1,63 @@
+#pragma once
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/name
+
+#include <karm-base/string.h>
+#include <karm-io/bscan.h>
+
+namespace Ttf {
+
+struct Name : public Io::BChunk {
+    static constexpr Str SIG = "name";
+
+    static constexpr u16 POSTSCRIPT_NAME = 6;
+
+    using Count = Io::BField<u16be, 2>;
+    using StorageOffset = Io::BField<u16be, 4>;
+
+    static bool _allowed(u16 c) {
+        if (c <= ' ' or c >= 0x7f)
+            return false;
+        for (auto d : Str{"[](){}<>/%"})
+            if (c == (u16)d)
+                return false;
+        return true;
+    }
+
+    // NOTE: PostScript names are printable ascii whatever the platform,
+    //       utf-16 records only need their high bytes dropped.
+    Opt<String> postscriptName() const {
+        if (not present())
+            return NONE;
+
+        auto records = begin().skip(6);
+        for (usize i = 0; i < get<Count>(); i++) {
+            auto platformId = records.nextU16be();
+            /* encodingId = */ records.nextU16be();
+            /* languageId = */ records.nextU16be();
+            auto nameId = records.nextU16be();
+            auto length = records.nextU16be();
+            auto offset = records.nextU16be();
+
+            if (nameId != POSTSCRIPT_NAME)
+                continue;
+
+            auto s = begin().skip(get<StorageOffset>() + offset);
+            bool wide = platformId == 0 or platformId == 3;
+            StringBuilder sb;
+            for (usize j = 0; j < length and not s.ended(); j += wide ? 2 : 1) {
+                auto c = wide ? s.nextU16be() : s.nextU8be();
+                if (_allowed(c))
+                    sb.append((Rune)c);
+            }
+
+            auto name = sb.take();
+            if (name.len())
+                return name;
+        }
+
+        return NONE;
+    }
+};
+
+} // namespace Ttf
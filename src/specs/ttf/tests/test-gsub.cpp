@@ -0,0 +1,134 @@
+#include <karm-io/impls.h>
+#include <karm-test/macros.h>
+#include <ttf/table-gsub.h>
+
+namespace Ttf::Tests {
+
+static constexpr u16 F = 1;
+static constexpr u16 I = 2;
+static constexpr u16 X = 5;
+static constexpr u16 MARK = 9;
+static constexpr u16 FI = 50;
+
+static void _emit(Io::BEmit &e, std::initializer_list<u16> words) {
+    for (auto w : words)
+        e.writeU16be(w);
+}
+
+// A "liga" feature, for "latn", made of two lookups: the first one
+// substitutes X by X + 100, the second one ligates F and I into FI,
+// skipping over marks.
+static Buf<Byte> _gsub() {
+    Io::BufferWriter buf;
+    Io::BEmit e{buf};
+
+    _emit(e, {1, 0, 10, 30, 46});
+
+    // ScriptList, at 10
+    _emit(e, {1});
+    e.writeStr("latn");
+    _emit(e, {8});
+    _emit(e, {4, 0});            // Script
+    _emit(e, {0, 0xffff, 1, 0}); // Default LangSys
+
+    // FeatureList, at 30
+    _emit(e, {1});
+    e.writeStr("liga");
+    _emit(e, {8});
+    _emit(e, {0, 2, 0, 1});
+
+    // LookupList, at 46
+    _emit(e, {2, 6, 26});
+    _emit(e, {1, 0, 1, 8});                         // Single, no flags
+    _emit(e, {1, 6, 100, 1, 1, X});                 // Delta format, then its coverage
+    _emit(e, {4, LookupTable::IGNORE_MARKS, 1, 8}); // Ligature
+    _emit(e, {1, 8, 1, 14});
+    _emit(e, {1, 1, F});        // Coverage
+    _emit(e, {1, 4, FI, 2, I}); // LigatureSet, then its only ligature
+
+    return buf.take();
+}
+
+static Buf<Byte> _gdef() {
+    Io::BufferWriter buf;
+    Io::BEmit e{buf};
+    _emit(e, {1, 0, 12, 0, 0, 0});
+    _emit(e, {2, 1, MARK, MARK, (u16)GlyphClass::MARK});
+    return buf.take();
+}
+
+test$("ttf-gsub-lookups") {
+    auto table = _gsub();
+    Gsub gsub{bytes(table)};
+
+    Array<Str, 1> liga = {"liga"};
+    auto lookups = gsub.lookups(liga);
+    expectEq$(lookups.len(), 2uz);
+    expectEq$(lookups[0], 0uz);
+    expectEq$(lookups[1], 1uz);
+
+    Array<Str, 1> smcp = {"smcp"};
+    expectEq$(gsub.lookups(smcp).len(), 0uz);
+
+    return Ok();
+}
+
+test$("ttf-gsub-single") {
+    auto table = _gsub();
+    Gsub gsub{bytes(table)};
+
+    Vec<usize> glyphs = {X, F};
+    Vec<usize> clusters = {0, 1};
+    gsub.apply(0, Gdef{}, glyphs, clusters);
+
+    expectEq$(glyphs.len(), 2uz);
+    expectEq$(glyphs[0], X + 100uz);
+    expectEq$(glyphs[1], (usize)F);
+
+    return Ok();
+}
+
+test$("ttf-gsub-ligature") {
+    auto table = _gsub();
+    Gsub gsub{bytes(table)};
+
+    Vec<usize> glyphs = {X, F, I, F};
+    Vec<usize> clusters = {0, 1, 2, 3};
+    gsub.apply(1, Gdef{}, glyphs, clusters);
+
+    expectEq$(glyphs.len(), 3uz);
+    expectEq$(glyphs[1], (usize)FI);
+    expectEq$(glyphs[2], (usize)F);
+    expectEq$(clusters[1], 1uz);
+    expectEq$(clusters[2], 3uz);
+
+    return Ok();
+}
+
+test$("ttf-gsub-ignore-marks") {
+    auto table = _gsub();
+    Gsub gsub{bytes(table)};
+    auto gdefTable = _gdef();
+    Gdef gdef{bytes(gdefTable)};
+
+    expect$(gdef.glyphClass(MARK) == GlyphClass::MARK);
+    expect$(gdef.glyphClass(F) == GlyphClass::NONE);
+
+    // NOTE: Without glyph classes there is no telling what a mark is, so
+    //       it blocks the ligature.
+    Vec<usize> glyphs = {F, MARK, I};
+    Vec<usize> clusters = {0, 1, 2};
+    gsub.apply(1, Gdef{}, glyphs, clusters);
+    expectEq$(glyphs.len(), 3uz);
+
+    gsub.apply(1, gdef, glyphs, clusters);
+    expectEq$(glyphs.len(), 2uz);
+    expectEq$(glyphs[0], (usize)FI);
+    expectEq$(glyphs[1], (usize)MARK);
+    expectEq$(clusters[0], 0uz);
+    expectEq$(clusters[1], 1uz);
+
+    return Ok();
+}
+
+} // namespace Ttf::Tests
@@ -0,0 +1,132 @@
+#include <karm-io/impls.h>
+#include <karm-test/macros.h>
+#include <ttf/subset.h>
+
+namespace Ttf::Tests {
+
+static void _emit(Io::BEmit &e, std::initializer_list<u16> words) {
+    for (auto w : words)
+        e.writeU16be(w);
+}
+
+static Buf<Byte> _table(auto f) {
+    Io::BufferWriter buf;
+    Io::BEmit e{buf};
+    f(e);
+    return buf.take();
+}
+
+static u32 _checksum(Bytes bytes) {
+    u32 sum = 0;
+    for (usize i = 0; i < bytes.len(); i += 4) {
+        u32 word = 0;
+        for (usize j = 0; j < 4; j++)
+            word = (word << 8) | (i + j < bytes.len() ? bytes[i + j] : 0);
+        sum += word;
+    }
+    return sum;
+}
+
+// Four glyphs with short offsets: .notdef, a simple glyph, a composite
+// made of the simple one, and a simple glyph nobody uses.
+static Buf<Byte> _font() {
+    auto glyf = _table([](Io::BEmit &e) {
+        _emit(e, {1, 0, 0, 100, 100, 0xaaaa});
+        _emit(e, {1, 0, 0, 50, 50, 0xbbbb, 0xbbbb});
+        _emit(e, {0xffff, 0, 0, 50, 50, 0, 1, 0});
+        _emit(e, {1, 0, 0, 10, 10, 0xcccc});
+    });
+
+    auto loca = _table([](Io::BEmit &e) {
+        _emit(e, {0, 6, 13, 21, 27});
+    });
+
+    auto head = _table([](Io::BEmit &e) {
+        for (usize i = 0; i < 27; i++)
+            e.writeU16be(i == 9 ? 1000 : 0);
+    });
+
+    auto maxp = _table([](Io::BEmit &e) {
+        _emit(e, {0, 0x5000, 4});
+    });
+
+    struct Table {
+        Str tag;
+        Bytes data;
+    };
+
+    Array<Table, 4> tables = {
+        Table{"glyf", glyf},
+        Table{"head", head},
+        Table{"loca", loca},
+        Table{"maxp", maxp},
+    };
+
+    Io::BufferWriter buf;
+    Io::BEmit e{buf};
+    _emit(e, {1, 0, (u16)tables.len(), 64, 2, 0});
+
+    usize offset = 12 + tables.len() * 16;
+    for (auto &[tag, data] : tables) {
+        e.writeStr(tag);
+        e.writeU32be(_checksum(data));
+        e.writeU32be(offset);
+        e.writeU32be(data.len());
+        offset += data.len();
+    }
+
+    for (auto &[_, data] : tables)
+        for (auto b : data)
+            e.writeU8be(b);
+
+    return buf.take();
+}
+
+static Res<Font> _load(Bytes bytes) {
+    Font font{bytes};
+    font._head = try$(font.requireTable<Head>());
+    font._glyf = try$(font.requireTable<Glyf>());
+    font._loca = try$(font.requireTable<Loca>());
+    return Ok(font);
+}
+
+static Bytes _outline(Font const &font, usize glyph) {
+    auto start = font._loca.glyfOffset(glyph, font._head);
+    auto end = font._loca.glyfOffset(glyph + 1, font._head);
+    if (start > end or end > font._glyf.bytes().len())
+        return {};
+    return sub(font._glyf.bytes(), start, end);
+}
+
+test$("ttf-subset-glyf-loca") {
+    auto original = _font();
+    auto font = try$(_load(bytes(original)));
+
+    Array<usize, 1> glyphs = {2};
+    auto out = try$(subset(font, glyphs));
+    auto result = try$(_load(bytes(out)));
+
+    expectEq$(result._head.locaFormat(), 1);
+    expectEq$(try$(result.requireTable<Maxp>()).numGlyphs(), 4);
+
+    // NOTE: Offsets have to be increasing and stay within glyf, the last
+    //       one marks where the last glyph ends.
+    for (usize g = 0; g < 4; g++) {
+        auto start = result._loca.glyfOffset(g, result._head);
+        auto end = result._loca.glyfOffset(g + 1, result._head);
+        expect$(start <= end);
+        expectEq$(start % 4, 0uz);
+    }
+    expectEq$(result._loca.glyfOffset(4, result._head), result._glyf.bytes().len());
+
+    // NOTE: .notdef and the component of the composite glyph come along.
+    for (usize g : {0uz, 1uz, 2uz})
+        expect$(sub(_outline(result, g), 0, _outline(font, g).len()) == _outline(font, g));
+    expectEq$(_outline(result, 3).len(), 0uz);
+
+    expectEq$(_checksum(out), 0xb1b0afbau);
+
+    return Ok();
+}
+
+} // namespace Ttf::Tests
@@ -1,8 +1,106 @@
+#include <grund-net/api.h>
+#include <grund-netstack/dhcp.h>
 #include <karm-ipc/ipc.h>
 #include <karm-sys/entry.h>
+#include <karm-sys/mmap.h>
+#include <karm-sys/time.h>
+
+namespace Grund::Dhcp {
+
+static constexpr TimeSpan TIMEOUT = TimeSpan::fromSecs(4);
+static constexpr TimeSpan RETRY = TimeSpan::fromSecs(10);
+static constexpr TimeSpan DEFAULT_LEASE = TimeSpan::fromSecs(3600);
+
+struct Client {
+    INet &_net;
+    Sys::MutMmap _arena;
+    Netstack::Mac _mac;
+    u16 _port = Netstack::DHCP_CLIENT_PORT;
+
+    static Async::Task<Client> createAsync(INet &net) {
+        auto fd = co_trya$(net.arenaAsync());
+        auto cap = co_trya$(net.capAsync());
+        auto arena = co_try$(Sys::mmap().read().write().size(cap * Netstack::PacketPool::BUF_SIZE).mapMut(fd));
+        auto mac = co_trya$(net.macAsync());
+        co_trya$(net.udpBindAsync(Netstack::DHCP_CLIENT_PORT));
+        co_return Ok(Client{net, std::move(arena), mac});
+    }
+
+    MutBytes _bytes(Netstack::Buf buf) {
+        return {_arena.mutBytes().buf() + buf.slot * Netstack::PacketPool::BUF_SIZE + buf.off, buf.len};
+    }
+
+    Async::Task<> sendAsync(Netstack::DhcpMessage const &msg) {
+        auto buf = co_trya$(_net.allocAsync());
+        buf.len = Netstack::DhcpMessage::LEN;
+        msg.emit(_bytes(buf));
+        co_return co_trya$(_net.udpSendAsync(_port, {Netstack::LIMITED_BROADCAST, Netstack::DHCP_SERVER_PORT}, buf));
+    }
+
+    // Waits for a reply to `xid` of one of the given types, anything else
+    // that shows up in the meantime is dropped.
+    Async::Task<Netstack::DhcpMessage> recvAsync(u32 xid, Netstack::DhcpType type, Netstack::DhcpType alt) {
+        auto until = Sys::now() + TIMEOUT;
+        while (true) {
+            auto datagram = co_trya$(_net.udpRecvAsync(_port, until));
+            auto res = Netstack::DhcpMessage::parse(_bytes(datagram.buf));
+            co_trya$(_net.releaseAsync(datagram.buf));
+            if (not res)
+                continue;
+
+            auto msg = res.take();
+            if (msg.op != Netstack::DhcpMessage::BOOTREPLY or msg.xid != xid)
+                continue;
+
+            if (msg.type == type or msg.type == alt)
+                co_return Ok(msg);
+        }
+    }
+
+    // DISCOVER, OFFER, REQUEST then ACK.
+    Async::Task<Netstack::DhcpLease> acquireAsync() {
+        u32 xid = Sys::now().val();
+        co_trya$(sendAsync(Netstack::DhcpMessage::discover(_mac, xid)));
+        auto offer = co_trya$(recvAsync(xid, Netstack::DhcpType::OFFER, Netstack::DhcpType::OFFER));
+
+        co_trya$(sendAsync(Netstack::DhcpMessage::request(offer, _mac)));
+        auto ack = co_trya$(recvAsync(xid, Netstack::DhcpType::ACK, Netstack::DhcpType::NAK));
+        co_return ack.lease();
+    }
+
+    Async::Task<> runAsync() {
+        while (true) {
+            auto res = co_await acquireAsync();
+            if (not res) {
+                logWarn("dhcp: could not acquire a lease: {}", res.none());
+                co_trya$(Sys::globalSched().sleepAsync(Sys::now() + RETRY));
+                continue;
+            }
+
+            auto lease = res.take();
+            co_trya$(_net.configureAsync(lease.iface));
+            logInfo("dhcp: leased {} from {}", lease.iface.addr, lease.server);
+
+            // NOTE: There is no renewal, the whole exchange happens again
+            //       once half of the lease is gone.
+            auto duration = lease.duration.toUSecs() ? lease.duration : DEFAULT_LEASE;
+            co_trya$(Sys::globalSched().sleepAsync(Sys::now() + TimeSpan::fromUSecs(duration.toUSecs() / 2)));
+        }
+    }
+};
+
+} // namespace Grund::Dhcp
 
 Async::Task<> entryPointAsync(Sys::Context &ctx) {
     auto server = co_try$(Ipc::Server::create(ctx));
 
-    co_return co_trya$(server.runAsync());
+    // NOTE: Replies from grund-net only come in while the server runs.
+    auto clientAsync = [](Ipc::Server &server) -> Async::Task<> {
+        auto net = co_trya$(Ipc::locateAsync<Grund::INet>(server));
+        auto client = co_trya$(Grund::Dhcp::Client::createAsync(*net));
+        co_return co_await client.runAsync();
+    };
+
+    Async::Cancelation c;
+    co_return co_await Async::race(c, server.runAsync(), clientAsync(server));
 }
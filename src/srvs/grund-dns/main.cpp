@@ -1,8 +1,22 @@
+#include <grund-dns/api.h>
 #include <karm-ipc/ipc.h>
 #include <karm-sys/entry.h>
+#include <vaev-dns/resolver.h>
+
+namespace Grund::Dns {
+
+struct Service : public Ipc::Object<Grund::IDns> {
+    using Ipc::Object<Grund::IDns>::Object;
+
+    Async::Task<Vec<Sys::Ip>> resolveAsync(String host) override {
+        co_return co_await Vaev::Dns::globalResolver().resolveAllAsync(host);
+    }
+};
+
+} // namespace Grund::Dns
 
 Async::Task<> entryPointAsync(Sys::Context &ctx) {
     auto server = co_try$(Ipc::Server::create(ctx));
-
+    Grund::Dns::Service service{server};
     co_return co_trya$(server.runAsync());
 }
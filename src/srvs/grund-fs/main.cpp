@@ -1,8 +1,48 @@
+#include <grund-fs/api.h>
+#include <grund-vfs/vfs.h>
 #include <karm-ipc/ipc.h>
 #include <karm-sys/entry.h>
 
+namespace Grund::Fs {
+
+static constexpr usize PAGES = 16384;
+
+// NOTE: Clients map the arena once, then every read only carries the
+//       extents of the pages it covers.
+//
+// NOTE: Apps still open files through Sys::File and don't come here yet,
+//       a client side reader built on copyExtents() is left for later.
+struct Service : public Ipc::Object<Grund::IFs> {
+    Vfs::Vfs &_vfs;
+
+    Service(Ipc::Server &server, Vfs::Vfs &vfs)
+        : Ipc::Object<Grund::IFs>(server), _vfs(vfs) {}
+
+    Async::Task<Sys::Stat> statAsync(String path) override {
+        auto url = co_try$(Mime::parseUrlOrPath(path));
+        co_return _vfs.stat(url);
+    }
+
+    Async::Task<Vec<Sys::DirEntry>> readDirAsync(String path) override {
+        auto url = co_try$(Mime::parseUrlOrPath(path));
+        co_return _vfs.readDir(url);
+    }
+
+    Async::Task<Strong<Sys::Fd>> arenaAsync() override {
+        co_return Ok(_vfs.pages().fd());
+    }
+
+    Async::Task<Vec<Vfs::Extent>> readAsync(String path, usize off, usize len) override {
+        auto url = co_try$(Mime::parseUrlOrPath(path));
+        co_return _vfs.read(url, off, len);
+    }
+};
+
+} // namespace Grund::Fs
+
 Async::Task<> entryPointAsync(Sys::Context &ctx) {
+    auto vfs = co_try$(Grund::Vfs::Vfs::create(Grund::Fs::PAGES));
     auto server = co_try$(Ipc::Server::create(ctx));
-
+    Grund::Fs::Service service{server, *vfs};
     co_return co_trya$(server.runAsync());
 }
@@ -1,8 +1,162 @@
+#include <grund-net/api.h>
+#include <grund-netstack/stack.h>
 #include <karm-ipc/ipc.h>
 #include <karm-sys/entry.h>
 
+namespace Grund::Net {
+
+static constexpr usize PACKETS = 4096;
+static constexpr Netstack::Mac MAC = {0x02, 0x00, 0x00, 0x00, 0x00, 0x10};
+
+// Calls handled at the same time, receiving waits for datagrams to come in
+// and shouldn't hold up the other clients meanwhile.
+static constexpr usize CALLS = 64;
+
+// One per client connection.
+//
+// NOTE: Clients map the packet arena once, then datagrams only carry the
+//       buffer they are in. Whoever holds a buffer owns it, the service
+//       keeps track of the ones it lent to its client so that it can't
+//       hand back a buffer the stack, or another client, is still using.
+//       Sockets are only reachable from the connection that bound them.
+struct Service : public Ipc::Object<Grund::INet> {
+    Netstack::Stack &_stack;
+    Vec<bool> _lent;
+    Map<u16, Strong<Netstack::UdpSocket>> _sockets;
+
+    Service(Ipc::Server &server, Netstack::Stack &stack)
+        : Ipc::Object<Grund::INet>(server), _stack(stack) {
+        _lent.resize(stack.pool().cap());
+    }
+
+    // The client is gone, along with the buffers and sockets it held.
+    ~Service() {
+        for (auto &[_, socket] : _sockets.iter())
+            socket->close();
+
+        for (u32 slot = 0; slot < _lent.len(); slot++)
+            if (_lent[slot])
+                _stack.pool().free({slot, 0, 0});
+    }
+
+    // NOTE: A buffer is lent along with the response carrying it, it's
+    //       taken back if that response never makes it to the client.
+    Netstack::Buf _lend(Ipc::Call &call, Netstack::Buf buf) {
+        _lent[buf.slot] = true;
+        call.onUndelivered([this, buf] {
+            _lent[buf.slot] = false;
+            _stack.pool().free(buf);
+        });
+        return buf;
+    }
+
+    Res<Netstack::Buf> _reclaim(Netstack::Buf buf) {
+        if (buf.slot >= _lent.len() or not _lent[buf.slot])
+            return Error::invalidInput("buffer not lent");
+
+        // NOTE: Headers go in front of the payload, there must be room
+        //       left for them.
+        if (not _stack.pool().fits(buf))
+            return Error::invalidInput("buffer out of bounds");
+
+        _lent[buf.slot] = false;
+        return Ok(buf);
+    }
+
+    Res<Strong<Netstack::UdpSocket>> _socket(u16 port) {
+        auto socket = _sockets.get(port);
+        if (not socket)
+            return Error::notConnected("socket not bound");
+        return Ok(socket.take());
+    }
+
+    Async::Task<Strong<Sys::Fd>> arenaAsync() override {
+        co_return Ok(_stack.pool().fd());
+    }
+
+    Async::Task<usize> capAsync() override {
+        co_return Ok(_stack.pool().cap());
+    }
+
+    Async::Task<Netstack::Mac> macAsync() override {
+        co_return Ok(_stack.link().mac());
+    }
+
+    Async::Task<Netstack::Buf> allocAsync() override {
+        auto &call = _server.call();
+        auto buf = _stack.pool().alloc();
+        if (not buf)
+            co_return Error::outOfMemory("packet pool exhausted");
+        co_return Ok(_lend(call, *buf));
+    }
+
+    Async::Task<None> releaseAsync(Netstack::Buf buf) override {
+        _stack.pool().free(co_try$(_reclaim(buf)));
+        co_return Ok(NONE);
+    }
+
+    Async::Task<None> configureAsync(Netstack::Iface iface) override {
+        _stack.configure(iface);
+        co_return Ok(NONE);
+    }
+
+    Async::Task<u16> udpBindAsync(u16 port) override {
+        auto socket = co_try$(_stack.udpBind(port));
+        _sockets.put(socket->port(), socket);
+        co_return Ok(socket->port());
+    }
+
+    Async::Task<Netstack::Datagram> udpRecvAsync(u16 port, TimeStamp until) override {
+        auto &call = _server.call();
+        auto socket = co_try$(_socket(port));
+        Async::Cancelation c;
+        auto datagram = co_trya$(Sys::timeoutAsync(until, c, socket->recvAsync(c.token())));
+        _lend(call, datagram.buf);
+        co_return Ok(datagram);
+    }
+
+    Async::Task<None> udpSendAsync(u16 port, Netstack::Endpoint to, Netstack::Buf buf) override {
+        auto socket = co_try$(_socket(port));
+        co_try$(socket->send(to, co_try$(_reclaim(buf))));
+        co_return Ok(NONE);
+    }
+
+    Async::Task<None> udpCloseAsync(u16 port) override {
+        auto socket = co_try$(_socket(port));
+        socket->close();
+        _sockets.del(port);
+        co_return Ok(NONE);
+    }
+};
+
+static Async::Task<> _serveAsync(Netstack::Stack &stack, Ipc::Server server) {
+    server.concurrent(CALLS);
+    Service service{server, stack};
+    co_return co_await server.runAsync();
+}
+
+static Box<Netstack::Link> _openLink() {
+    if (auto tap = Netstack::TapLink::open("tap0", MAC))
+        return makeBox<Netstack::TapLink>(tap.take());
+
+    // NOTE: Without a device the stack is alone on its end of a cable, it
+    //       still answers on its own address.
+    return makeBox<Netstack::LoopbackLink>(Netstack::LoopbackLink::pair().car);
+}
+
+} // namespace Grund::Net
+
 Async::Task<> entryPointAsync(Sys::Context &ctx) {
+    auto link = Grund::Net::_openLink();
+    auto pool = co_try$(Grund::Netstack::PacketPool::create(Grund::Net::PACKETS));
+    Grund::Netstack::Stack stack{*link, pool};
+
     auto server = co_try$(Ipc::Server::create(ctx));
 
-    co_return co_trya$(server.runAsync());
+    Async::Cancelation c;
+    co_return co_await Async::race(
+        c,
+        stack.runAsync(c.token()),
+        Grund::Net::_serveAsync(stack, std::move(server))
+    );
 }
@@ -0,0 +1,123 @@
+#include <grund-netstack/stack.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+using namespace Grund;
+
+static constexpr usize SIZE = 64 * 1024 * 1024;
+static constexpr usize CHUNK = 64 * 1024;
+static constexpr usize ROUND_TRIPS = 10000;
+
+static constexpr Sys::Ip4 MASK = {255, 255, 255, 0};
+static constexpr Sys::Ip4 A = {10, 0, 0, 1};
+static constexpr Sys::Ip4 B = {10, 0, 0, 2};
+
+struct Hosts {
+    Pair<Netstack::LoopbackLink> links;
+    Netstack::PacketPool &poolA;
+    Netstack::PacketPool &poolB;
+    Netstack::Stack a{links.car, poolA};
+    Netstack::Stack b{links.cdr, poolB};
+
+    Hosts(Netstack::PacketPool &pa, Netstack::PacketPool &pb)
+        : links(Netstack::LoopbackLink::pair()), poolA(pa), poolB(pb) {
+        a.configure({A, MASK, A});
+        b.configure({B, MASK, B});
+    }
+
+    void pump() {
+        while (a.poll() or b.poll())
+            ;
+    }
+};
+
+// Pushes SIZE bytes through a single connection, reading them out on the
+// other end as soon as they arrive.
+Res<> benchTcp(Hosts &hosts) {
+    auto listener = try$(hosts.b.tcpListen(80));
+    auto client = try$(hosts.a.tcpConnect({B, 80}));
+    hosts.pump();
+    auto server = listener->tryAccept();
+    if (not server)
+        return Error::notConnected("handshake failed");
+
+    Vec<u8> buf;
+    buf.resize(CHUNK);
+    for (usize i = 0; i < CHUNK; i++)
+        buf[i] = (i * 2654435761u) >> 13;
+
+    auto start = Sys::now();
+    usize sent = 0;
+    usize received = 0;
+    while (received < SIZE) {
+        if (sent < SIZE)
+            sent += try$(client->write(sub(buf, 0, min(CHUNK, SIZE - sent))));
+        hosts.pump();
+
+        while (auto n = (*server)->read(buf))
+            received += n.unwrap();
+        hosts.pump();
+    }
+    auto elapsed = Sys::now() - start;
+    auto usecs = max(elapsed.toUSecs(), 1uz);
+
+    // NOTE: Bytes per microsecond are megabytes per second.
+    f64 throughput = (f64)SIZE / usecs;
+    Sys::println("tcp: {} MB/s ({} segments, {} retransmits)", throughput, client->stats().segmentsOut, client->stats().retransmits);
+
+    client->abort();
+    (*server)->abort();
+    return Ok();
+}
+
+// Bounces a small datagram back and forth, the address is resolved before
+// the clock starts.
+Res<> benchUdp(Hosts &hosts) {
+    auto server = try$(hosts.b.udpBind(7));
+    auto client = try$(hosts.a.udpBind(0));
+
+    auto roundTrip = [&]() -> Res<> {
+        auto buf = hosts.poolA.alloc();
+        if (not buf)
+            return Error::outOfMemory("pool exhausted");
+        buf->len = 64;
+        try$(client->send({B, 7}, *buf));
+        hosts.pump();
+
+        auto ping = server->tryRecv();
+        if (not ping)
+            return Error::timedOut("ping lost");
+        try$(server->send(ping->from, ping->buf));
+        hosts.pump();
+
+        auto pong = client->tryRecv();
+        if (not pong)
+            return Error::timedOut("pong lost");
+        hosts.poolA.free(pong->buf);
+        return Ok();
+    };
+
+    try$(roundTrip());
+
+    auto start = Sys::now();
+    for (usize i = 0; i < ROUND_TRIPS; i++)
+        try$(roundTrip());
+    auto elapsed = Sys::now() - start;
+
+    f64 latency = (f64)elapsed.toUSecs() / ROUND_TRIPS;
+    Sys::println("udp: {} us per round trip", latency);
+    return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    auto poolA = co_try$(Netstack::PacketPool::create(1024));
+    auto poolB = co_try$(Netstack::PacketPool::create(1024));
+    Hosts hosts{poolA, poolB};
+
+    co_try$(benchTcp(hosts));
+    co_try$(benchUdp(hosts));
+
+    Sys::println("pool: {} allocs, {} exhausted", poolA.stats().allocs + poolB.stats().allocs, poolA.stats().exhausted + poolB.stats().exhausted);
+
+    co_return Ok();
+}
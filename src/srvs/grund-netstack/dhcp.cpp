@@ -0,0 +1,211 @@
+#include <karm-io/bscan.h>
+#include <karm-io/impls.h>
+
+#include "dhcp.h"
+
+namespace Grund::Netstack {
+
+enum struct _Option : u8 {
+    PAD = 0,
+    MASK = 1,
+    ROUTER = 3,
+    DNS = 6,
+    REQUESTED = 50,
+    LEASE_TIME = 51,
+    TYPE = 53,
+    SERVER = 54,
+    PARAMS = 55,
+    END = 255,
+};
+
+static Sys::Ip4 _nextIp4(Io::BScan &s) {
+    auto ip = Sys::Ip4::unspecified();
+    s.readTo(ip.bytes.buf(), ip.bytes.len());
+    return ip;
+}
+
+static void _writeIp4(Io::BEmit &e, _Option opt, Opt<Sys::Ip4> const &ip) {
+    if (not ip)
+        return;
+    e.writeU8be((u8)opt);
+    e.writeU8be(4);
+    e.writeBytes(ip->bytes.bytes());
+}
+
+DhcpMessage DhcpMessage::discover(Mac mac, u32 xid) {
+    DhcpMessage msg;
+    msg.xid = xid;
+    msg.broadcast = true;
+    msg.chaddr = mac;
+    msg.type = DhcpType::DISCOVER;
+    return msg;
+}
+
+DhcpMessage DhcpMessage::request(DhcpMessage const &offer, Mac mac) {
+    DhcpMessage msg;
+    msg.xid = offer.xid;
+    msg.broadcast = true;
+    msg.chaddr = mac;
+    msg.type = DhcpType::REQUEST;
+    msg.requested = offer.yiaddr;
+    msg.server = offer.server;
+    return msg;
+}
+
+Res<DhcpMessage> DhcpMessage::parse(Bytes bytes) {
+    if (bytes.len() < HEADER_LEN)
+        return Error::invalidData("dhcp message too short");
+
+    Io::BScan s{bytes};
+    DhcpMessage msg;
+    msg.op = s.nextU8be();
+    u8 htype = s.nextU8be();
+    u8 hlen = s.nextU8be();
+    if (htype != 1 or hlen != 6)
+        return Error::notImplemented("unsupported hardware address");
+
+    s.skip(1);
+    msg.xid = s.nextU32be();
+    s.skip(2);
+    msg.broadcast = s.nextU16be() & 0x8000;
+    msg.ciaddr = _nextIp4(s);
+    msg.yiaddr = _nextIp4(s);
+    msg.siaddr = _nextIp4(s);
+    s.skip(4);
+    s.readTo(msg.chaddr.buf(), msg.chaddr.len());
+    s.skip(10 + 64 + 128);
+
+    if (s.nextU32be() != COOKIE)
+        return Error::invalidData("invalid dhcp cookie");
+
+    bool typed = false;
+    while (not s.ended()) {
+        auto opt = (_Option)s.nextU8be();
+        if (opt == _Option::END)
+            break;
+        if (opt == _Option::PAD)
+            continue;
+
+        if (s.ended())
+            return Error::invalidData("truncated dhcp option");
+
+        usize len = s.nextU8be();
+        if (len > s.rem())
+            return Error::invalidData("truncated dhcp option");
+
+        // NOTE: Options carrying several addresses only have their first
+        //       one looked at.
+        Io::BScan o{s.nextBytes(len)};
+        switch (opt) {
+        case _Option::MASK:
+        case _Option::ROUTER:
+        case _Option::DNS:
+        case _Option::SERVER:
+        case _Option::REQUESTED: {
+            if (len < 4)
+                return Error::invalidData("invalid dhcp option");
+            auto ip = _nextIp4(o);
+            if (opt == _Option::MASK)
+                msg.mask = ip;
+            else if (opt == _Option::ROUTER)
+                msg.router = ip;
+            else if (opt == _Option::DNS)
+                msg.dns = ip;
+            else if (opt == _Option::SERVER)
+                msg.server = ip;
+            else
+                msg.requested = ip;
+            break;
+        }
+
+        case _Option::LEASE_TIME:
+            if (len != 4)
+                return Error::invalidData("invalid dhcp option");
+            msg.leaseTime = o.nextU32be();
+            break;
+
+        case _Option::TYPE:
+            if (len != 1)
+                return Error::invalidData("invalid dhcp option");
+            msg.type = (DhcpType)o.nextU8be();
+            typed = true;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (not typed)
+        return Error::invalidData("not a dhcp message");
+
+    return Ok(msg);
+}
+
+void DhcpMessage::emit(MutBytes out) const {
+    fill(out, (u8)0);
+
+    Io::BufWriter w{out};
+    Io::BEmit e{w};
+    e.writeU8be(op);
+    e.writeU8be(1);
+    e.writeU8be(6);
+    e.writeU8be(0);
+    e.writeU32be(xid);
+    e.writeU16be(0);
+    e.writeU16be(broadcast ? 0x8000 : 0);
+    e.writeBytes(ciaddr.bytes.bytes());
+    e.writeBytes(yiaddr.bytes.bytes());
+    e.writeBytes(siaddr.bytes.bytes());
+    e.writeU32be(0);
+    e.writeBytes(chaddr.bytes());
+    (void)w.seek(Io::Seek::fromBegin(HEADER_LEN - 4));
+    e.writeU32be(COOKIE);
+
+    e.writeU8be((u8)_Option::TYPE);
+    e.writeU8be(1);
+    e.writeU8be((u8)type);
+
+    _writeIp4(e, _Option::REQUESTED, requested);
+    _writeIp4(e, _Option::SERVER, server);
+    _writeIp4(e, _Option::MASK, mask);
+    _writeIp4(e, _Option::ROUTER, router);
+    _writeIp4(e, _Option::DNS, dns);
+
+    if (leaseTime) {
+        e.writeU8be((u8)_Option::LEASE_TIME);
+        e.writeU8be(4);
+        e.writeU32be(*leaseTime);
+    }
+
+    if (op == BOOTREQUEST) {
+        e.writeU8be((u8)_Option::PARAMS);
+        e.writeU8be(3);
+        e.writeU8be((u8)_Option::MASK);
+        e.writeU8be((u8)_Option::ROUTER);
+        e.writeU8be((u8)_Option::DNS);
+    }
+
+    e.writeU8be((u8)_Option::END);
+}
+
+Res<DhcpLease> DhcpMessage::lease() const {
+    if (type != DhcpType::ACK)
+        return Error::invalidInput("not an acknowledgment");
+
+    if (yiaddr == Sys::Ip4::unspecified() or not mask or not server)
+        return Error::invalidData("incomplete lease");
+
+    return Ok(DhcpLease{
+        .iface = {
+            .addr = yiaddr,
+            .mask = *mask,
+            .gateway = router ? *router : Sys::Ip4::unspecified(),
+        },
+        .server = *server,
+        .dns = dns,
+        .duration = TimeSpan::fromSecs(leaseTime ? *leaseTime : 0),
+    });
+}
+
+} // namespace Grund::Netstack
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <karm-base/time.h>
+
+#include "wire.h"
+
+namespace Grund::Netstack {
+
+static constexpr u16 DHCP_SERVER_PORT = 67;
+static constexpr u16 DHCP_CLIENT_PORT = 68;
+
+enum struct DhcpType : u8 {
+    DISCOVER = 1,
+    OFFER = 2,
+    REQUEST = 3,
+    DECLINE = 4,
+    ACK = 5,
+    NAK = 6,
+    RELEASE = 7,
+};
+
+struct DhcpLease {
+    Iface iface;
+    Sys::Ip4 server = Sys::Ip4::unspecified();
+    Opt<Sys::Ip4> dns = NONE;
+    TimeSpan duration = TimeSpan::zero();
+};
+
+// The part of a DHCP message (RFC 2131) a client cares about, the fixed
+// fields and the few options it sends or looks at.
+struct DhcpMessage {
+    static constexpr u32 COOKIE = 0x63825363;
+    static constexpr usize HEADER_LEN = 240;
+
+    // Some servers ignore anything shorter than a BOOTP message.
+    static constexpr usize LEN = 300;
+
+    static constexpr u8 BOOTREQUEST = 1;
+    static constexpr u8 BOOTREPLY = 2;
+
+    u8 op = BOOTREQUEST;
+    u32 xid = 0;
+    bool broadcast = false;
+    Sys::Ip4 ciaddr = Sys::Ip4::unspecified();
+    Sys::Ip4 yiaddr = Sys::Ip4::unspecified();
+    Sys::Ip4 siaddr = Sys::Ip4::unspecified();
+    Mac chaddr{};
+    DhcpType type = DhcpType::DISCOVER;
+
+    Opt<Sys::Ip4> mask = NONE;
+    Opt<Sys::Ip4> router = NONE;
+    Opt<Sys::Ip4> dns = NONE;
+    Opt<Sys::Ip4> server = NONE;
+    Opt<Sys::Ip4> requested = NONE;
+    Opt<u32> leaseTime = NONE;
+
+    static DhcpMessage discover(Mac mac, u32 xid);
+
+    // Asks for the address in `offer`.
+    static DhcpMessage request(DhcpMessage const &offer, Mac mac);
+
+    static Res<DhcpMessage> parse(Bytes bytes);
+
+    // Fills exactly LEN bytes.
+    void emit(MutBytes out) const;
+
+    Res<DhcpLease> lease() const;
+};
+
+} // namespace Grund::Netstack
@@ -0,0 +1,113 @@
+#include <karm-base/defer.h>
+#include <karm-sys/tap.h>
+
+#include "link.h"
+
+namespace Grund::Netstack {
+
+// MARK: Loopback --------------------------------------------------------------
+
+_Cable::Ring::Ring() {
+    frames.resize(SLOTS * FRAME_SIZE);
+    lens.resize(SLOTS);
+}
+
+bool _Cable::Ring::push(Bytes frame) {
+    if (len == SLOTS) {
+        drops++;
+        return false;
+    }
+
+    usize slot = (head + len) % SLOTS;
+    auto dst = mutSub(frames, slot * FRAME_SIZE, slot * FRAME_SIZE + frame.len());
+    copy(frame, dst);
+    lens[slot] = frame.len();
+    len++;
+    return true;
+}
+
+Opt<usize> _Cable::Ring::pop(MutBytes buf) {
+    if (len == 0)
+        return NONE;
+
+    auto src = sub(frames, head * FRAME_SIZE, head * FRAME_SIZE + lens[head]);
+    usize n = copy(src, buf);
+    head = (head + 1) % SLOTS;
+    len--;
+    return n;
+}
+
+void _Cable::kick() {
+    if (kicking)
+        return;
+    kicking = true;
+    defer$(kicking = false);
+
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (auto &ring : rings) {
+            if (ring.len and ring.waiters.len()) {
+                ring.waiters.removeAt(0).resolve(Ok());
+                progress = true;
+            }
+        }
+    }
+}
+
+Pair<LoopbackLink> LoopbackLink::pair() {
+    auto cable = makeStrong<_Cable>();
+    return {
+        LoopbackLink{cable, 0, {0x02, 0, 0, 0, 0, 1}},
+        LoopbackLink{cable, 1, {0x02, 0, 0, 0, 0, 2}},
+    };
+}
+
+Res<> LoopbackLink::send(Bytes frame) {
+    if (frame.len() > _Cable::FRAME_SIZE)
+        return Error::invalidInput("frame too large");
+
+    if (_cable->rings[1 - _side].push(frame))
+        _cable->kick();
+    return Ok();
+}
+
+Opt<usize> LoopbackLink::tryRecv(MutBytes buf) {
+    return _cable->rings[_side].pop(buf);
+}
+
+Async::Task<usize> LoopbackLink::recvAsync(MutBytes buf, Async::Cancelation::Token ct) {
+    auto cable = _cable;
+    auto &ring = cable->rings[_side];
+    while (true) {
+        if (auto n = ring.pop(buf))
+            co_return Ok(*n);
+
+        co_try$(ct.check());
+
+        ring.waiters.pushBack(Async::Promise<>{});
+        auto future = ring.waiters[ring.waiters.len() - 1].future();
+        Async::OnCancel onCancel{ct, [&] {
+            for (usize n = ring.waiters.len(); n; n--)
+                ring.waiters.removeAt(0).resolve(Ok());
+        }};
+        (void)co_await future;
+    }
+}
+
+// MARK: TAP -------------------------------------------------------------------
+
+Res<TapLink> TapLink::open(Str name, Mac mac) {
+    return Ok(TapLink{try$(Sys::openTap(name)), mac});
+}
+
+Res<> TapLink::send(Bytes frame) {
+    try$(_fd->write(frame));
+    return Ok();
+}
+
+Async::Task<usize> TapLink::recvAsync(MutBytes buf, Async::Cancelation::Token ct) {
+    return Sys::globalSched().readAsync(_fd, buf, ct);
+}
+
+} // namespace Grund::Netstack
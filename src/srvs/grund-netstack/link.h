@@ -0,0 +1,109 @@
+#pragma once
+
+#include <karm-base/rc.h>
+#include <karm-sys/async.h>
+
+#include "wire.h"
+
+namespace Grund::Netstack {
+
+// Something ethernet frames go in and out of.
+struct Link {
+    virtual ~Link() = default;
+
+    virtual Mac mac() const = 0;
+
+    // Like on the wire, frames that can't go out right away are dropped.
+    virtual Res<> send(Bytes frame) = 0;
+
+    // The next frame if there's one ready, links that can't tell without
+    // blocking only hand out frames through recvAsync().
+    virtual Opt<usize> tryRecv(MutBytes buf) = 0;
+
+    virtual Async::Task<usize> recvAsync(MutBytes buf, Async::Cancelation::Token ct = {}) = 0;
+};
+
+// MARK: Loopback --------------------------------------------------------------
+
+struct _Cable : public Meta::NoCopy {
+    static constexpr usize SLOTS = 256;
+    static constexpr usize FRAME_SIZE = 1536;
+
+    struct Ring {
+        Vec<u8> frames;
+        Vec<usize> lens;
+        usize head = 0;
+        usize len = 0;
+        usize drops = 0;
+        Vec<Async::Promise<>> waiters;
+
+        Ring();
+
+        bool push(Bytes frame);
+
+        Opt<usize> pop(MutBytes buf);
+    };
+
+    Ring rings[2];
+    bool kicking = false;
+
+    // Wakes whoever waits on a ring that isn't empty. Receivers usually
+    // answer right away, so this runs as a trampoline instead of waking
+    // them from within each other.
+    void kick();
+};
+
+// Both ends of an in-process cable, frames sent through one end come out of
+// the other.
+struct LoopbackLink : public Link {
+    Strong<_Cable> _cable;
+    usize _side;
+    Mac _mac;
+
+    static Pair<LoopbackLink> pair();
+
+    LoopbackLink(Strong<_Cable> cable, usize side, Mac mac)
+        : _cable(cable), _side(side), _mac(mac) {}
+
+    usize drops() const {
+        return _cable->rings[_side].drops;
+    }
+
+    Mac mac() const override {
+        return _mac;
+    }
+
+    Res<> send(Bytes frame) override;
+
+    Opt<usize> tryRecv(MutBytes buf) override;
+
+    Async::Task<usize> recvAsync(MutBytes buf, Async::Cancelation::Token ct = {}) override;
+};
+
+// MARK: TAP -------------------------------------------------------------------
+
+// A TAP interface of the host, to run the stack on an actual network while
+// developing it.
+struct TapLink : public Link {
+    Strong<Sys::Fd> _fd;
+    Mac _mac;
+
+    static Res<TapLink> open(Str name, Mac mac);
+
+    TapLink(Strong<Sys::Fd> fd, Mac mac)
+        : _fd(fd), _mac(mac) {}
+
+    Mac mac() const override {
+        return _mac;
+    }
+
+    Res<> send(Bytes frame) override;
+
+    Opt<usize> tryRecv(MutBytes) override {
+        return NONE;
+    }
+
+    Async::Task<usize> recvAsync(MutBytes buf, Async::Cancelation::Token ct = {}) override;
+};
+
+} // namespace Grund::Netstack
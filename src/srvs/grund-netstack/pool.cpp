@@ -0,0 +1,71 @@
+#include "pool.h"
+
+namespace Grund::Netstack {
+
+Res<PacketPool> PacketPool::create(usize cap) {
+    if (cap == 0)
+        return Error::invalidInput("packet pool can't be empty");
+
+    auto fd = try$(Sys::createShm(cap * BUF_SIZE));
+    auto arena = try$(Sys::mmap().read().write().size(cap * BUF_SIZE).mapMut(fd));
+    return Ok(PacketPool{fd, std::move(arena), cap});
+}
+
+PacketPool::PacketPool(Strong<Sys::Fd> fd, Sys::MutMmap arena, usize cap)
+    : _fd(fd), _arena(std::move(arena)) {
+    // NOTE: Lowest slots are handed out first, so that a quiet stack keeps
+    //       touching the same few buffers.
+    _free.ensure(cap);
+    for (usize i = cap; i > 0; i--)
+        _free.pushBack(i - 1);
+}
+
+Opt<Buf> PacketPool::alloc() {
+    if (_free.len() == 0) {
+        _stats.exhausted++;
+        return NONE;
+    }
+
+    _stats.allocs++;
+    _stats.inUse++;
+    return Buf{_free.popBack(), HEADROOM, 0};
+}
+
+void PacketPool::free(Buf buf) {
+    if (buf.slot >= cap()) [[unlikely]]
+        panic("packet buffer out of the pool");
+
+    _stats.inUse--;
+    _free.pushBack(buf.slot);
+}
+
+bool PacketPool::fits(Buf buf) const {
+    // NOTE: off + len could wrap around, so neither is added to the other.
+    return buf.slot < cap() and
+           buf.off >= HEADROOM and
+           buf.off <= BUF_SIZE and
+           buf.len <= BUF_SIZE - buf.off;
+}
+
+MutBytes PacketPool::raw(u32 slot) {
+    if (slot >= cap()) [[unlikely]]
+        panic("packet buffer out of the pool");
+    return {_arena.mutBytes().buf() + slot * BUF_SIZE, BUF_SIZE};
+}
+
+MutBytes PacketPool::prepend(Buf &buf, usize len) {
+    if (len > buf.off) [[unlikely]]
+        panic("packet buffer out of headroom");
+
+    buf.off -= len;
+    buf.len += len;
+    return {raw(buf.slot).buf() + buf.off, len};
+}
+
+void PacketPool::consume(Buf &buf, usize len) {
+    len = min(len, (usize)buf.len);
+    buf.off += len;
+    buf.len -= len;
+}
+
+} // namespace Grund::Netstack
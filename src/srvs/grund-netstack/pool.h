@@ -0,0 +1,80 @@
+#pragma once
+
+#include <karm-base/vec.h>
+#include <karm-sys/mmap.h>
+#include <karm-sys/shm.h>
+
+namespace Grund::Netstack {
+
+// A packet buffer in the pool, `off` and `len` delimit the part of it that's
+// in use. Buffers are handed around by value, clients that mapped the arena
+// read and write them in place.
+struct Buf {
+    u32 slot = 0;
+    u32 off = 0;
+    u32 len = 0;
+};
+
+struct PacketPoolStats {
+    usize allocs;
+    usize exhausted;
+    usize inUse;
+};
+
+// A fixed number of fixed size packet buffers in shared memory, so that
+// nothing is allocated per packet. A buffer starts with some headroom,
+// headers are prepended in it as a packet moves down the stack.
+struct PacketPool : public Meta::NoCopy {
+    static constexpr usize BUF_SIZE = 2048;
+    static constexpr usize HEADROOM = 128;
+
+    Strong<Sys::Fd> _fd;
+    Sys::MutMmap _arena;
+    Vec<u32> _free;
+    PacketPoolStats _stats{};
+
+    static Res<PacketPool> create(usize cap);
+
+    PacketPool(Strong<Sys::Fd> fd, Sys::MutMmap arena, usize cap);
+
+    usize cap() const {
+        return _arena.bytes().len() / BUF_SIZE;
+    }
+
+    Strong<Sys::Fd> fd() {
+        return _fd;
+    }
+
+    PacketPoolStats const &stats() const {
+        return _stats;
+    }
+
+    // An empty buffer with all of the headroom left, or NONE when the pool
+    // is exhausted and the packet should be dropped.
+    Opt<Buf> alloc();
+
+    void free(Buf buf);
+
+    // Whether `buf` lies within its buffer of the pool, with all of the
+    // headroom still in front of it, for buffers that come from clients.
+    bool fits(Buf buf) const;
+
+    // The whole buffer regardless of what's in use.
+    MutBytes raw(u32 slot);
+
+    MutBytes buf(Buf buf) {
+        return {raw(buf.slot).buf() + buf.off, buf.len};
+    }
+
+    Bytes bytes(Buf buf) {
+        return {raw(buf.slot).buf() + buf.off, buf.len};
+    }
+
+    // Grows `buf` to the front by `len` bytes and returns them.
+    MutBytes prepend(Buf &buf, usize len);
+
+    // Drops the first `len` bytes of `buf`.
+    void consume(Buf &buf, usize len);
+};
+
+} // namespace Grund::Netstack
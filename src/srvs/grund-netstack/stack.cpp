@@ -0,0 +1,489 @@
+#include <karm-crypto/sha2.h>
+#include <karm-math/rand.h>
+
+#include "stack.h"
+
+namespace Grund::Netstack {
+
+// MARK: UDP -------------------------------------------------------------------
+
+Opt<Datagram> UdpSocket::tryRecv() {
+    if (_queue.len() == 0)
+        return NONE;
+    return _queue.removeAt(0);
+}
+
+Async::Task<Datagram> UdpSocket::recvAsync(Async::Cancelation::Token ct) {
+    while (true) {
+        if (auto datagram = tryRecv())
+            co_return Ok(datagram.take());
+
+        if (_closed)
+            co_return Error::notConnected("socket closed");
+
+        co_trya$(_waiters.waitAsync(ct));
+    }
+}
+
+Res<> UdpSocket::send(Endpoint to, Buf buf) {
+    if (_closed) {
+        _stack.pool().free(buf);
+        return Error::notConnected("socket closed");
+    }
+    return _stack._sendUdp(_port, to, buf);
+}
+
+void UdpSocket::close() {
+    if (_closed)
+        return;
+    _closed = true;
+
+    for (auto &datagram : _queue)
+        _stack.pool().free(datagram.buf);
+    _queue.clear();
+
+    _stack._udp.del(_port);
+    _waiters.wake();
+}
+
+void UdpSocket::_deliver(Datagram datagram) {
+    if (_closed or _queue.len() == QUEUE_LEN) {
+        _drops++;
+        _stack.pool().free(datagram.buf);
+        return;
+    }
+
+    _queue.pushBack(datagram);
+    _waiters.wake();
+}
+
+// MARK: Stack -----------------------------------------------------------------
+
+Stack::Stack(Link &link, PacketPool &pool)
+    : _link(link), _pool(pool) {
+    // NOTE: There is no entropy source to draw from yet, the secret is
+    //       seeded like the ids of vaev-dns.
+    Math::Rand rand{Sys::now().val() ^ (usize)this};
+    for (usize i = 0; i < _secret.len(); i++)
+        _secret[i] = rand.nextU8();
+}
+
+Res<Strong<UdpSocket>> Stack::udpBind(u16 port) {
+    if (port == 0)
+        port = _ephemeral();
+    else if (_udp.get(port))
+        return Error::addrInUse("port already bound");
+
+    auto socket = makeStrong<UdpSocket>(*this, port);
+    _udp.put(port, socket);
+    return Ok(socket);
+}
+
+Res<Strong<TcpListener>> Stack::tcpListen(u16 port) {
+    if (port == 0 or _listeners.get(port))
+        return Error::addrInUse("port already listened on");
+
+    auto listener = makeStrong<TcpListener>(*this, port);
+    _listeners.put(port, listener);
+    return Ok(listener);
+}
+
+Res<Strong<TcpConn>> Stack::tcpConnect(Endpoint remote, TimeStamp now) {
+    if (not _iface.configured())
+        return Error::notConnected("interface not configured");
+
+    auto port = _ephemeral();
+    auto conn = makeStrong<TcpConn>(*this, port, remote, _iss(port, remote, now));
+    conn->_state = TcpState::SYN_SENT;
+    conn->_allocate();
+    _conns.pushBack(conn);
+    conn->_sendSyn();
+    conn->_arm(now);
+    return Ok(conn);
+}
+
+void Stack::input(Buf buf, TimeStamp now) {
+    _stats.rxFrames++;
+
+    Opt<Buf> frame = buf;
+    auto res = _inputEth(frame, now);
+    if (frame)
+        _pool.free(frame.take());
+
+    if (not res)
+        _stats.rxDrops++;
+}
+
+bool Stack::poll(TimeStamp now) {
+    bool any = false;
+    while (auto buf = _rxBuf()) {
+        auto raw = _pool.raw(buf->slot);
+        auto n = _link.tryRecv(mutSub(raw, buf->off, PacketPool::BUF_SIZE));
+        if (not n) {
+            _pool.free(*buf);
+            break;
+        }
+
+        buf->len = *n;
+        input(*buf, now);
+        any = true;
+    }
+    return any;
+}
+
+void Stack::tick(TimeStamp now) {
+    // NOTE: Timers can wake up tasks that open or close connections, so
+    //       this goes over a copy.
+    auto conns = _conns;
+    for (auto &conn : conns)
+        conn->_tick(now);
+
+    for (usize i = 0; i < _conns.len();) {
+        if (_conns[i]->_state == TcpState::CLOSED)
+            _conns.removeAt(i);
+        else
+            i++;
+    }
+}
+
+Async::Task<> Stack::runAsync(Async::Cancelation::Token ct) {
+    // NOTE: Neither loop returns unless something went wrong, which takes
+    //       the other one down with it.
+    Async::Cancelation c{ct};
+    co_return co_await Async::race(c, _rxAsync(c.token()), _timersAsync(c.token()));
+}
+
+// MARK: Internals -------------------------------------------------------------
+
+Opt<Buf> Stack::_rxBuf() {
+    // NOTE: Frames are received after the headroom, so that a reply can be
+    //       built in place in front of what's left once headers are gone.
+    auto buf = _pool.alloc();
+    if (not buf)
+        _stats.rxDrops++;
+    return buf;
+}
+
+u16 Stack::_ephemeral() {
+    while (true) {
+        u16 port = _nextPort;
+        _nextPort = _nextPort == Limits<u16>::MAX ? EPHEMERAL : _nextPort + 1;
+        if (not _bound(port))
+            return port;
+    }
+}
+
+bool Stack::_bound(u16 port) {
+    if (_udp.get(port) or _listeners.get(port))
+        return true;
+
+    for (auto &conn : _conns)
+        if (conn->_port == port)
+            return true;
+
+    return false;
+}
+
+// RFC 6528, a clock ticking every 4us offset by a keyed hash of the
+// connection: sequence numbers keep moving forward for the same peer, but
+// can't be guessed from those of any other connection.
+u32 Stack::_iss(u16 port, Endpoint remote, TimeStamp now) {
+    Crypto::Sha256 sha;
+    sha.add(_iface.addr.bytes);
+    sha.add(u16be{port}.bytes());
+    sha.add(remote.addr.bytes);
+    sha.add(u16be{remote.port}.bytes());
+    sha.add(_secret);
+    auto digest = sha.digest();
+
+    u32 f = (u32)digest[0] | (u32)digest[1] << 8 | (u32)digest[2] << 16 | (u32)digest[3] << 24;
+    return (u32)(now.val() / 4) + f;
+}
+
+Res<> Stack::_sendEth(Mac dst, EtherType type, Buf buf) {
+    EthHeader{dst, _link.mac(), type}.emit(_pool.prepend(buf, EthHeader::LEN));
+
+    auto res = _link.send(_pool.bytes(buf));
+    _pool.free(buf);
+
+    if (res)
+        _stats.txFrames++;
+    else
+        _stats.txDrops++;
+    return res;
+}
+
+void Stack::_sendArp(u16 op, Mac tha, Sys::Ip4 tpa) {
+    auto buf = _pool.alloc();
+    if (not buf) {
+        _stats.txDrops++;
+        return;
+    }
+
+    buf->len = ArpPacket::LEN;
+    ArpPacket{op, _link.mac(), _iface.addr, tha, tpa}.emit(_pool.buf(*buf));
+    (void)_sendEth(op == ArpPacket::REQUEST ? BROADCAST_MAC : tha, EtherType::ARP, *buf);
+}
+
+Res<> Stack::_sendIp(Sys::Ip4 dst, Proto proto, Buf buf) {
+    Ip4Header header{
+        .len = Ip4Header::LEN + buf.len,
+        .id = _ipId++,
+        .ttl = 64,
+        .proto = proto,
+        .src = _iface.addr,
+        .dst = dst,
+    };
+    header.emit(_pool.prepend(buf, Ip4Header::LEN));
+
+    if (dst == LIMITED_BROADCAST or (_iface.configured() and dst == _iface.broadcast()))
+        return _sendEth(BROADCAST_MAC, EtherType::IP4, buf);
+
+    auto next = _iface.onLink(dst) ? dst : _iface.gateway;
+    if (auto mac = _arp.get(next))
+        return _sendEth(*mac, EtherType::IP4, buf);
+
+    // NOTE: Only the last few packets waiting on an address are kept, the
+    //       others would likely be resent anyway by the time it resolves.
+    _stats.arpMisses++;
+    if (_unresolved.len() == UNRESOLVED_LEN)
+        _pool.free(_unresolved.removeAt(0).cdr);
+    _unresolved.pushBack({next, buf});
+    _sendArp(ArpPacket::REQUEST, {}, next);
+    return Ok();
+}
+
+Res<> Stack::_sendUdp(u16 port, Endpoint to, Buf buf) {
+    if (buf.len > MTU - Ip4Header::LEN - UdpHeader::LEN) {
+        _pool.free(buf);
+        return Error::invalidInput("datagram too large");
+    }
+
+    UdpHeader header{port, to.port, UdpHeader::LEN + buf.len};
+    _pool.prepend(buf, UdpHeader::LEN);
+    header.emit(_pool.buf(buf), _iface.addr, to.addr);
+    return _sendIp(to.addr, Proto::UDP, buf);
+}
+
+void Stack::_sendRst(TcpHeader const &seg, Sys::Ip4 src, usize len) {
+    auto buf = _pool.alloc();
+    if (not buf) {
+        _stats.txDrops++;
+        return;
+    }
+
+    TcpHeader rst{
+        .src = seg.dst,
+        .dst = seg.src,
+        .seq = 0,
+        .ack = 0,
+        .flags = RST,
+        .wnd = 0,
+    };
+
+    if (seg.flags & ACK) {
+        rst.seq = seg.ack;
+    } else {
+        rst.ack = seg.seq + len + (seg.flags & SYN ? 1 : 0) + (seg.flags & FIN ? 1 : 0);
+        rst.flags |= ACK;
+    }
+
+    _pool.prepend(*buf, rst.size());
+    rst.emit(_pool.buf(*buf), _iface.addr, src);
+    (void)_sendIp(src, Proto::TCP, *buf);
+}
+
+Res<> Stack::_inputEth(Opt<Buf> &frame, TimeStamp now) {
+    auto eth = try$(EthHeader::parse(_pool.bytes(*frame)));
+    if (eth.dst != _link.mac() and eth.dst != BROADCAST_MAC)
+        return Ok();
+
+    _pool.consume(*frame, EthHeader::LEN);
+    if (eth.type == EtherType::ARP)
+        return _inputArp(_pool.bytes(*frame));
+    if (eth.type == EtherType::IP4)
+        return _inputIp(frame, now);
+    return Ok();
+}
+
+Res<> Stack::_inputArp(Bytes packet) {
+    auto arp = try$(ArpPacket::parse(packet));
+    if (not _iface.configured())
+        return Ok();
+
+    if (arp.tpa == _iface.addr or _arp.get(arp.spa)) {
+        if (not _arp.get(arp.spa) and _arp.len() == ARP_LEN)
+            _arp._els.removeAt(0);
+        _arp.put(arp.spa, arp.sha);
+    }
+
+    if (arp.op == ArpPacket::REQUEST and arp.tpa == _iface.addr)
+        _sendArp(ArpPacket::REPLY, arp.sha, arp.spa);
+
+    for (usize i = 0; i < _unresolved.len();) {
+        if (_unresolved[i].car == arp.spa)
+            (void)_sendEth(arp.sha, EtherType::IP4, _unresolved.removeAt(i).cdr);
+        else
+            i++;
+    }
+
+    return Ok();
+}
+
+Res<> Stack::_inputIp(Opt<Buf> &packet, TimeStamp now) {
+    usize headerLen = 0;
+    auto ip = try$(Ip4Header::parse(_pool.bytes(*packet), headerLen));
+
+    // NOTE: Until it's configured, the interface takes anything, the reply
+    //       to a DHCP request is addressed to what it's going to be.
+    bool ours = not _iface.configured() or
+                ip.dst == _iface.addr or
+                ip.dst == LIMITED_BROADCAST or
+                ip.dst == _iface.broadcast();
+    if (not ours)
+        return Ok();
+
+    // NOTE: Short frames are padded, what's past the packet isn't part of it.
+    packet->len = ip.len;
+    _pool.consume(*packet, headerLen);
+
+    switch (ip.proto) {
+    case Proto::ICMP:
+        return _inputIcmp(packet, ip);
+
+    case Proto::UDP:
+        return _inputUdp(packet, ip);
+
+    case Proto::TCP:
+        return _inputTcp(_pool.bytes(*packet), ip, now);
+
+    default:
+        return Ok();
+    }
+}
+
+Res<> Stack::_inputIcmp(Opt<Buf> &packet, Ip4Header const &ip) {
+    static constexpr u8 ECHO_REPLY = 0;
+    static constexpr u8 ECHO_REQUEST = 8;
+
+    auto msg = _pool.buf(*packet);
+    if (msg.len() < 8 or checksum(sum(msg)) != 0)
+        return Error::invalidData("invalid icmp message");
+
+    if (msg[0] != ECHO_REQUEST or not _iface.configured())
+        return Ok();
+
+    // NOTE: The reply is the request with another type, so it's sent back
+    //       in the very same buffer.
+    msg[0] = ECHO_REPLY;
+    msg[2] = msg[3] = 0;
+    u16 csum = checksum(sum(msg));
+    msg[2] = csum >> 8;
+    msg[3] = csum;
+    return _sendIp(ip.src, Proto::ICMP, packet.take());
+}
+
+Res<> Stack::_inputUdp(Opt<Buf> &datagram, Ip4Header const &ip) {
+    auto udp = try$(UdpHeader::parse(_pool.bytes(*datagram), ip.src, ip.dst));
+
+    auto socket = _udp.get(udp.dst);
+    if (not socket)
+        return Ok();
+
+    datagram->len = udp.len;
+    _pool.consume(*datagram, UdpHeader::LEN);
+    (*socket)->_deliver({{ip.src, udp.src}, datagram.take()});
+    return Ok();
+}
+
+Res<> Stack::_inputTcp(Bytes segment, Ip4Header const &ip, TimeStamp now) {
+    if (not _iface.configured())
+        return Ok();
+
+    auto seg = try$(TcpHeader::parse(segment, ip.src, ip.dst));
+    auto payload = sub(segment, seg.headerLen, segment.len());
+    Endpoint remote{ip.src, seg.src};
+
+    Opt<Strong<TcpConn>> found = NONE;
+    usize halfOpen = 0;
+    for (auto &conn : _conns) {
+        if (conn->_port != seg.dst or conn->_state == TcpState::CLOSED)
+            continue;
+        if (conn->_remote == remote) {
+            found = conn;
+            break;
+        }
+        if (conn->_state == TcpState::SYN_RCVD)
+            halfOpen++;
+    }
+
+    if (found) {
+        auto conn = found.take();
+        bool accepting = conn->_state == TcpState::SYN_RCVD;
+        conn->_input(seg, payload, now);
+        if (not accepting or not conn->established())
+            return Ok();
+
+        auto listener = _listeners.get(seg.dst);
+        if (not listener or (*listener)->_ready.len() == TcpListener::BACKLOG) {
+            conn->abort();
+            return Ok();
+        }
+
+        (*listener)->_ready.pushBack(conn);
+        (*listener)->_waiters.wake();
+        return Ok();
+    }
+
+    if (seg.flags & RST)
+        return Ok();
+
+    auto listener = _listeners.get(seg.dst);
+    if (listener and (seg.flags & (SYN | ACK)) == SYN) {
+        // NOTE: Anyone can send SYNs without ever answering ours, there
+        //       are only so many of them we keep track of. The peer sends
+        //       its SYN again if it's dropped.
+        if ((*listener)->_ready.len() == TcpListener::BACKLOG or
+            halfOpen == TcpListener::HALF_OPEN)
+            return Ok();
+
+        auto conn = makeStrong<TcpConn>(*this, seg.dst, remote, _iss(seg.dst, remote, now));
+        _conns.pushBack(conn);
+        conn->_inputSyn(seg, now);
+        return Ok();
+    }
+
+    _sendRst(seg, ip.src, payload.len());
+    return Ok();
+}
+
+Async::Task<> Stack::_rxAsync(Async::Cancelation::Token ct) {
+    while (true) {
+        auto buf = _rxBuf();
+        if (not buf) {
+            // NOTE: Everything is in use, give the sockets some time to
+            //       drain their queues.
+            co_trya$(Sys::globalSched().sleepAsync(Sys::now() + TICK, ct));
+            continue;
+        }
+
+        auto raw = _pool.raw(buf->slot);
+        auto n = co_await _link.recvAsync(mutSub(raw, buf->off, PacketPool::BUF_SIZE), ct);
+        if (not n) {
+            _pool.free(*buf);
+            co_return n.none();
+        }
+
+        buf->len = n.unwrap();
+        input(*buf);
+    }
+}
+
+Async::Task<> Stack::_timersAsync(Async::Cancelation::Token ct) {
+    while (true) {
+        co_trya$(Sys::globalSched().sleepAsync(Sys::now() + TICK, ct));
+        tick();
+    }
+}
+
+} // namespace Grund::Netstack
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <karm-base/map.h>
+#include <karm-sys/time.h>
+
+#include "link.h"
+#include "pool.h"
+#include "tcp.h"
+
+namespace Grund::Netstack {
+
+static constexpr Sys::Ip4 LIMITED_BROADCAST = {255, 255, 255, 255};
+
+// MARK: UDP -------------------------------------------------------------------
+
+// A datagram as it was received, `buf` only covers its payload and belongs
+// to whoever took it off the socket.
+struct Datagram {
+    Endpoint from;
+    Buf buf;
+};
+
+struct UdpSocket : public Meta::NoCopy {
+    static constexpr usize QUEUE_LEN = 256;
+
+    Stack &_stack;
+    u16 _port;
+    Vec<Datagram> _queue;
+    Waiters _waiters;
+    usize _drops = 0;
+    bool _closed = false;
+
+    UdpSocket(Stack &stack, u16 port)
+        : _stack(stack), _port(port) {}
+
+    u16 port() const {
+        return _port;
+    }
+
+    usize drops() const {
+        return _drops;
+    }
+
+    Opt<Datagram> tryRecv();
+
+    Async::Task<Datagram> recvAsync(Async::Cancelation::Token ct = {});
+
+    // Sends the content of `buf` as is, headers are put in its headroom.
+    // The buffer goes back to the pool whatever happens.
+    Res<> send(Endpoint to, Buf buf);
+
+    void close();
+
+    void _deliver(Datagram datagram);
+};
+
+// MARK: Stack -----------------------------------------------------------------
+
+struct StackStats {
+    usize rxFrames;
+    usize txFrames;
+    usize rxDrops;
+    usize txDrops;
+    usize arpMisses;
+};
+
+// An IPv4 host on a single link. Everything happens on the thread running
+// it: frames come in through input(), go through the layers in the buffer
+// they were received in, and end up in a socket queue or get dropped.
+struct Stack : public Meta::NoCopy {
+    static constexpr usize ARP_LEN = 64;
+    static constexpr usize UNRESOLVED_LEN = 16;
+    static constexpr u16 EPHEMERAL = 49152;
+    static constexpr TimeSpan TICK = TimeSpan::fromMSecs(50);
+
+    Link &_link;
+    PacketPool &_pool;
+    Iface _iface{};
+    Map<Sys::Ip4, Mac> _arp;
+    Vec<Cons<Sys::Ip4, Buf>> _unresolved;
+    Map<u16, Strong<UdpSocket>> _udp;
+    Map<u16, Strong<TcpListener>> _listeners;
+    Vec<Strong<TcpConn>> _conns;
+    u16 _ipId = 0;
+    u16 _nextPort = EPHEMERAL;
+    Array<u8, 16> _secret;
+    StackStats _stats{};
+
+    Stack(Link &link, PacketPool &pool);
+
+    Link &link() {
+        return _link;
+    }
+
+    PacketPool &pool() {
+        return _pool;
+    }
+
+    Iface const &iface() const {
+        return _iface;
+    }
+
+    void configure(Iface iface) {
+        _iface = iface;
+        _arp.clear();
+    }
+
+    StackStats const &stats() const {
+        return _stats;
+    }
+
+    // MARK: Sockets -----------------------------------------------------------
+
+    // Binds an ephemeral port when `port` is 0.
+    Res<Strong<UdpSocket>> udpBind(u16 port);
+
+    Res<Strong<TcpListener>> tcpListen(u16 port);
+
+    Res<Strong<TcpConn>> tcpConnect(Endpoint remote, TimeStamp now = Sys::now());
+
+    // MARK: Driving -----------------------------------------------------------
+
+    // Takes ownership of a buffer holding a frame fresh from the link.
+    void input(Buf frame, TimeStamp now = Sys::now());
+
+    // Handles the frames the link already has, returns whether there was
+    // any.
+    bool poll(TimeStamp now = Sys::now());
+
+    // Fires the timers that are due.
+    void tick(TimeStamp now = Sys::now());
+
+    Async::Task<> runAsync(Async::Cancelation::Token ct = {});
+
+    // MARK: Internals ---------------------------------------------------------
+
+    Opt<Buf> _rxBuf();
+
+    u16 _ephemeral();
+
+    bool _bound(u16 port);
+
+    u32 _iss(u16 port, Endpoint remote, TimeStamp now);
+
+    Res<> _sendEth(Mac dst, EtherType type, Buf buf);
+
+    void _sendArp(u16 op, Mac tha, Sys::Ip4 tpa);
+
+    Res<> _sendIp(Sys::Ip4 dst, Proto proto, Buf buf);
+
+    Res<> _sendUdp(u16 port, Endpoint to, Buf buf);
+
+    void _sendRst(TcpHeader const &seg, Sys::Ip4 src, usize len);
+
+    Res<> _inputEth(Opt<Buf> &frame, TimeStamp now);
+
+    Res<> _inputArp(Bytes packet);
+
+    Res<> _inputIp(Opt<Buf> &packet, TimeStamp now);
+
+    Res<> _inputIcmp(Opt<Buf> &packet, Ip4Header const &ip);
+
+    Res<> _inputUdp(Opt<Buf> &datagram, Ip4Header const &ip);
+
+    Res<> _inputTcp(Bytes segment, Ip4Header const &ip, TimeStamp now);
+
+    Async::Task<> _rxAsync(Async::Cancelation::Token ct);
+
+    Async::Task<> _timersAsync(Async::Cancelation::Token ct);
+};
+
+} // namespace Grund::Netstack
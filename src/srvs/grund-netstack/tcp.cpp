@@ -0,0 +1,532 @@
+#include <karm-base/defer.h>
+
+#include "stack.h"
+#include "tcp.h"
+
+namespace Grund::Netstack {
+
+// Sequence numbers wrap around, they compare by their distance.
+static bool _lt(u32 a, u32 b) {
+    return (i32)(a - b) < 0;
+}
+
+// MARK: Byte Ring -------------------------------------------------------------
+
+usize ByteRing::push(Bytes bytes) {
+    usize n = min(bytes.len(), rem());
+    if (n == 0)
+        return 0;
+    usize tail = (_head + _len) % cap();
+    usize first = min(n, cap() - tail);
+    copy(sub(bytes, 0, first), mutSub(_buf, tail, tail + first));
+    copy(sub(bytes, first, n), mutSub(_buf, 0, n - first));
+    _len += n;
+    return n;
+}
+
+usize ByteRing::peek(usize off, MutBytes buf) const {
+    if (off >= _len)
+        return 0;
+
+    usize n = min(buf.len(), _len - off);
+    usize start = (_head + off) % cap();
+    usize first = min(n, cap() - start);
+    copy(sub(_buf, start, start + first), buf);
+    auto rest = mutNext(buf, first);
+    copy(sub(_buf, 0, n - first), rest);
+    return n;
+}
+
+void ByteRing::pop(usize n) {
+    n = min(n, _len);
+    if (n == 0)
+        return;
+    _head = (_head + n) % cap();
+    _len -= n;
+}
+
+// MARK: Api -------------------------------------------------------------------
+
+TcpConn::TcpConn(Stack &stack, u16 port, Endpoint remote, u32 iss)
+    : _stack(stack), _port(port), _remote(remote),
+      _iss(iss), _sndUna(iss), _sndNxt(iss), _sndMax(iss) {}
+
+Res<usize> TcpConn::read(MutBytes buf) {
+    if (_rx.len() == 0) {
+        if (_finReceived)
+            return Ok(0uz);
+        if (_error)
+            return *_error;
+        if (_state == TcpState::CLOSED)
+            return Error::notConnected("connection closed");
+        return Error::wouldBlock("nothing to read");
+    }
+
+    usize n = _rx.peek(0, buf);
+    _rx.pop(n);
+
+    // NOTE: The peer stops sending once it filled the window, it has to be
+    //       told when there is room again.
+    if (established() and not _finReceived and _rx.rem() >= _advertised + 2 * _mss)
+        _send(_sndNxt, ACK);
+
+    return Ok(n);
+}
+
+Res<usize> TcpConn::write(Bytes bytes) {
+    if (_error)
+        return *_error;
+
+    bool open = _state == TcpState::SYN_SENT or
+                _state == TcpState::SYN_RCVD or
+                _state == TcpState::ESTABLISHED or
+                _state == TcpState::CLOSE_WAIT;
+    if (not open or _finQueued)
+        return Error::brokenPipe("connection closed for writing");
+
+    usize n = _tx.push(bytes);
+    if (n == 0 and bytes.len())
+        return Error::wouldBlock("send buffer full");
+
+    _output(Sys::now());
+    return Ok(n);
+}
+
+void TcpConn::close() {
+    if (_finQueued or _state == TcpState::CLOSED)
+        return;
+
+    if (_state == TcpState::SYN_SENT) {
+        _fail(Error::notConnected("connection closed"));
+        return;
+    }
+
+    _finQueued = true;
+    _output(Sys::now());
+}
+
+void TcpConn::abort() {
+    if (_state == TcpState::CLOSED)
+        return;
+
+    if (_state != TcpState::SYN_SENT)
+        _send(_sndNxt, RST | ACK);
+
+    _fail(Error::connectionReset("connection aborted"));
+}
+
+Async::Task<> TcpConn::connectedAsync(Async::Cancelation::Token ct) {
+    while (true) {
+        if (established())
+            co_return Ok();
+        if (_error)
+            co_return *_error;
+        if (_state == TcpState::CLOSED)
+            co_return Error::notConnected("connection closed");
+
+        co_trya$(_writers.waitAsync(ct));
+    }
+}
+
+Async::Task<usize> TcpConn::readAsync(MutBytes buf, Async::Cancelation::Token ct) {
+    while (_rx.len() == 0 and not _finReceived and not _error and _state != TcpState::CLOSED)
+        co_trya$(_readers.waitAsync(ct));
+    co_return read(buf);
+}
+
+Async::Task<> TcpConn::writeAsync(Bytes bytes, Async::Cancelation::Token ct) {
+    while (bytes.len()) {
+        if (_tx.rem() == 0 and not _error and _state != TcpState::CLOSED) {
+            co_trya$(_writers.waitAsync(ct));
+            continue;
+        }
+
+        usize n = co_try$(write(bytes));
+        bytes = sub(bytes, n, bytes.len());
+    }
+    co_return Ok();
+}
+
+// MARK: Protocol --------------------------------------------------------------
+
+void TcpConn::_allocate() {
+    _tx = ByteRing{BUF_SIZE};
+    _rx = ByteRing{BUF_SIZE};
+}
+
+usize TcpConn::_window() const {
+    return min(_rx.rem() >> _rcvShift, 0xffffuz);
+}
+
+void TcpConn::_send(u32 seq, u8 flags, usize off, usize len) {
+    auto &pool = _stack.pool();
+    auto buf = pool.alloc();
+    if (not buf)
+        return;
+
+    buf->len = len;
+    _tx.peek(off, pool.buf(*buf));
+
+    // NOTE: The window of a SYN is never scaled.
+    TcpHeader header{
+        .src = _port,
+        .dst = _remote.port,
+        .seq = seq,
+        .ack = _rcvNxt,
+        .flags = flags,
+        .wnd = (u16)(flags & SYN ? min(BUF_SIZE, 0xffffuz) : _window()),
+    };
+
+    if (flags & SYN) {
+        header.mss = MSS;
+        if (_state == TcpState::SYN_SENT or _rcvShift)
+            header.wscale = WSCALE;
+    }
+
+    _advertised = flags & SYN ? header.wnd : (usize)header.wnd << _rcvShift;
+
+    pool.prepend(*buf, header.size());
+    header.emit(pool.buf(*buf), _stack.iface().addr, _remote.addr);
+    _stats.segmentsOut++;
+    (void)_stack._sendIp(_remote.addr, Proto::TCP, *buf);
+}
+
+void TcpConn::_sendSyn() {
+    _send(_iss, _state == TcpState::SYN_SENT ? SYN : SYN | ACK);
+    _sndNxt = _sndMax = _iss + 1;
+}
+
+void TcpConn::_output(TimeStamp now) {
+    // NOTE: Sending on a loopback link can bring acknowledgments back before
+    //       this returns, the loop below picks them up as it goes.
+    if (_outputting or not established())
+        return;
+    _outputting = true;
+    defer$(_outputting = false);
+
+    while (not _finSent) {
+        usize inFlight = _sndNxt - _sndUna;
+        usize unsent = _tx.len() - inFlight;
+        usize wnd = _sndWnd > inFlight ? _sndWnd - inFlight : 0;
+        usize n = min(unsent, wnd, _mss);
+        if (n == 0) {
+            // NOTE: The peer's window is closed, keep probing it or
+            //       we'll never hear about it opening again.
+            if (unsent and inFlight == 0)
+                _arm(now);
+            break;
+        }
+
+        _send(_sndNxt, ACK | (n == unsent ? PSH : 0), inFlight, n);
+        if (not _rttProbe)
+            _rttProbe = Cons{_sndNxt + (u32)n, now};
+        _sndNxt += n;
+        if (_lt(_sndMax, _sndNxt))
+            _sndMax = _sndNxt;
+        _arm(now);
+    }
+
+    if (_finQueued and not _finSent and _sndNxt - _sndUna == _tx.len()) {
+        _send(_sndNxt, FIN | ACK);
+        _sndNxt++;
+        _sndMax = _sndNxt;
+        _finSent = true;
+
+        if (_state == TcpState::ESTABLISHED)
+            _state = TcpState::FIN_WAIT_1;
+        else if (_state == TcpState::CLOSE_WAIT)
+            _state = TcpState::LAST_ACK;
+        _arm(now);
+    }
+}
+
+void TcpConn::_arm(TimeStamp now) {
+    if (_rtoAt.isEndOfTime())
+        _rtoAt = now + _rto;
+}
+
+void TcpConn::_sample(u32 ack, TimeStamp now) {
+    if (not _rttProbe or _lt(ack, _rttProbe->car))
+        return;
+
+    u64 rtt = (now - _rttProbe->cdr).toUSecs();
+    _rttProbe = NONE;
+
+    if (not _srtt) {
+        _srtt = rtt;
+        _rttvar = rtt / 2;
+    } else {
+        u64 srtt = *_srtt;
+        u64 delta = srtt > rtt ? srtt - rtt : rtt - srtt;
+        _rttvar = (3 * _rttvar + delta) / 4;
+        _srtt = (7 * srtt + rtt) / 8;
+    }
+
+    _rto = clamp(TimeSpan::fromUSecs(*_srtt + 4 * _rttvar), MIN_RTO, MAX_RTO);
+}
+
+void TcpConn::_fail(Error err) {
+    _error = err;
+    _state = TcpState::CLOSED;
+    _rtoAt = TimeStamp::endOfTime();
+    _readers.wake();
+    _writers.wake();
+}
+
+void TcpConn::_input(TcpHeader const &seg, Bytes payload, TimeStamp now) {
+    _inputSegment(seg, payload, now);
+
+    // NOTE: Whoever is waiting only runs once the segment was handled, so
+    //       that they don't find the connection halfway through a change.
+    _readers.wake();
+    _writers.wake();
+}
+
+void TcpConn::_inputSegment(TcpHeader const &seg, Bytes payload, TimeStamp now) {
+    if (seg.flags & RST) {
+        // NOTE: Only believe resets that are in the window, anyone could
+        //       forge the others.
+        bool valid = _state == TcpState::SYN_SENT
+                         ? (seg.flags & ACK) and seg.ack == _sndNxt
+                         : seg.seq == _rcvNxt;
+        if (valid)
+            _fail(Error::connectionReset("connection reset by peer"));
+        return;
+    }
+
+    if (_state == TcpState::SYN_SENT) {
+        _inputSynSent(seg, now);
+        return;
+    }
+
+    if (seg.flags & SYN) {
+        // NOTE: Our SYN-ACK or the ACK that followed it got lost.
+        if (_state == TcpState::SYN_RCVD)
+            _send(_iss, SYN | ACK);
+        else
+            _send(_sndNxt, ACK);
+        return;
+    }
+
+    if (not(seg.flags & ACK))
+        return;
+
+    if (_state == TcpState::SYN_RCVD) {
+        if (seg.ack != _iss + 1)
+            return;
+
+        _state = TcpState::ESTABLISHED;
+        _allocate();
+        _sndUna = seg.ack;
+        _sndWnd = (usize)seg.wnd << _sndShift;
+        _rtoAt = TimeStamp::endOfTime();
+        _retries = 0;
+    } else {
+        _inputAck(seg, payload.len() == 0, now);
+    }
+
+    bool ack = false;
+    if (payload.len()) {
+        bool receiving = _state == TcpState::ESTABLISHED or
+                         _state == TcpState::FIN_WAIT_1 or
+                         _state == TcpState::FIN_WAIT_2;
+
+        // NOTE: Anything out of order is dropped, the duplicate
+        //       acknowledgment tells the peer where to resume from.
+        if (receiving and seg.seq == _rcvNxt) {
+            _rcvNxt += _rx.push(payload);
+        }
+        ack = true;
+    }
+
+    if (seg.flags & FIN) {
+        if (not _finReceived and seg.seq + payload.len() == _rcvNxt) {
+            _rcvNxt++;
+            _finReceived = true;
+
+            if (_state == TcpState::ESTABLISHED) {
+                _state = TcpState::CLOSE_WAIT;
+            } else if (_state == TcpState::FIN_WAIT_1) {
+                _state = TcpState::CLOSING;
+            } else if (_state == TcpState::FIN_WAIT_2) {
+                _state = TcpState::TIME_WAIT;
+                _closeAt = now + LINGER;
+            }
+        }
+        ack = true;
+    }
+
+    // NOTE: Data going out carries the acknowledgment along, only send one
+    //       on its own when there was none.
+    usize sent = _stats.segmentsOut;
+    _output(now);
+    if (ack and sent == _stats.segmentsOut)
+        _send(_sndNxt, ACK);
+}
+
+void TcpConn::_inputSyn(TcpHeader const &seg, TimeStamp now) {
+    _state = TcpState::SYN_RCVD;
+    _rcvNxt = seg.seq + 1;
+    _mss = min(seg.mss ? *seg.mss : DEFAULT_MSS, MSS);
+    _sndWnd = seg.wnd;
+    if (seg.wscale) {
+        _sndShift = *seg.wscale;
+        _rcvShift = WSCALE;
+    }
+
+    _sendSyn();
+    _arm(now);
+}
+
+void TcpConn::_inputSynSent(TcpHeader const &seg, TimeStamp now) {
+    if ((seg.flags & (SYN | ACK)) != (SYN | ACK) or seg.ack != _iss + 1)
+        return;
+
+    _state = TcpState::ESTABLISHED;
+    _rcvNxt = seg.seq + 1;
+    _sndUna = seg.ack;
+    _mss = min(seg.mss ? *seg.mss : DEFAULT_MSS, MSS);
+    _sndWnd = seg.wnd;
+    if (seg.wscale) {
+        _sndShift = *seg.wscale;
+        _rcvShift = WSCALE;
+    }
+
+    _rtoAt = TimeStamp::endOfTime();
+    _retries = 0;
+    _sample(seg.ack, now);
+
+    _send(_sndNxt, ACK);
+    _output(now);
+}
+
+void TcpConn::_inputAck(TcpHeader const &seg, bool empty, TimeStamp now) {
+    if (_lt(_sndMax, seg.ack)) {
+        _send(_sndNxt, ACK);
+        return;
+    }
+
+    if (_lt(seg.ack, _sndUna))
+        return;
+
+    usize wnd = (usize)seg.wnd << _sndShift;
+    u32 acked = seg.ack - _sndUna;
+
+    if (acked == 0) {
+        // NOTE: The same acknowledgment over and over means the peer is
+        //       missing a segment and drops everything after it, resend
+        //       right away instead of waiting for the timer.
+        if (empty and wnd == _sndWnd and _sndUna != _sndNxt and ++_dupAcks == DUP_ACKS) {
+            _stats.dupAcks++;
+            _stats.retransmits++;
+            _rttProbe = NONE;
+            _sndNxt = _sndUna;
+            _finSent = false;
+        }
+        _sndWnd = wnd;
+        return;
+    }
+
+    // NOTE: Our FIN was sent once we're in any of these states, even if a
+    //       retransmission since rewound `_sndNxt` before it.
+    bool finSent = _state == TcpState::FIN_WAIT_1 or
+                   _state == TcpState::CLOSING or
+                   _state == TcpState::LAST_ACK;
+    bool finAcked = finSent and seg.ack == _sndMax;
+
+    _tx.pop(min((usize)acked, _tx.len()));
+    _sndUna = seg.ack;
+    if (_lt(_sndNxt, _sndUna)) {
+        _sndNxt = _sndUna;
+        _finSent = finAcked;
+    }
+    _sndWnd = wnd;
+    _dupAcks = 0;
+    _retries = 0;
+    _sample(seg.ack, now);
+    _rtoAt = _sndUna == _sndNxt ? TimeStamp::endOfTime() : now + _rto;
+
+    if (not finAcked)
+        return;
+
+    if (_state == TcpState::FIN_WAIT_1) {
+        _state = TcpState::FIN_WAIT_2;
+    } else if (_state == TcpState::CLOSING) {
+        _state = TcpState::TIME_WAIT;
+        _closeAt = now + LINGER;
+    } else if (_state == TcpState::LAST_ACK) {
+        _state = TcpState::CLOSED;
+    }
+}
+
+void TcpConn::_tick(TimeStamp now) {
+    if (_state == TcpState::TIME_WAIT) {
+        if (now >= _closeAt)
+            _state = TcpState::CLOSED;
+        return;
+    }
+
+    if (_state == TcpState::CLOSED or now < _rtoAt)
+        return;
+
+    _rtoAt = TimeStamp::endOfTime();
+    _rttProbe = NONE;
+    _rto = min(_rto + _rto, MAX_RTO);
+
+    // NOTE: A closed window isn't the peer going away, probing it doesn't
+    //       count as a retry.
+    if (established() and _sndUna == _sndNxt) {
+        if (_tx.len() and _sndWnd == 0) {
+            _send(_sndNxt - 1, ACK);
+            _arm(now);
+        }
+        return;
+    }
+
+    if (++_retries > MAX_RETRIES) {
+        _fail(Error::timedOut("connection timed out"));
+        return;
+    }
+
+    _stats.retransmits++;
+    if (not established()) {
+        _sendSyn();
+        _arm(now);
+        return;
+    }
+
+    _sndNxt = _sndUna;
+    _finSent = false;
+    _output(now);
+}
+
+// MARK: Listener --------------------------------------------------------------
+
+Opt<Strong<TcpConn>> TcpListener::tryAccept() {
+    if (_ready.len() == 0)
+        return NONE;
+    return _ready.removeAt(0);
+}
+
+Async::Task<Strong<TcpConn>> TcpListener::acceptAsync(Async::Cancelation::Token ct) {
+    while (true) {
+        if (auto conn = tryAccept())
+            co_return Ok(conn.take());
+
+        if (not _stack._listeners.get(_port))
+            co_return Error::notConnected("listener closed");
+
+        co_trya$(_waiters.waitAsync(ct));
+    }
+}
+
+void TcpListener::close() {
+    for (auto &conn : _ready)
+        conn->abort();
+    _ready.clear();
+
+    _stack._listeners.del(_port);
+    _waiters.wake();
+}
+
+} // namespace Grund::Netstack
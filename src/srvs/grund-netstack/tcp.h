@@ -0,0 +1,222 @@
+#pragma once
+
+#include <karm-base/rc.h>
+#include <karm-base/time.h>
+
+#include "waiters.h"
+#include "wire.h"
+
+namespace Grund::Netstack {
+
+struct Stack;
+
+// A fixed amount of bytes in a circle, a connection's buffers are sized
+// once when it's established and never move after that.
+struct ByteRing {
+    Vec<u8> _buf;
+    usize _head = 0;
+    usize _len = 0;
+
+    ByteRing() = default;
+
+    ByteRing(usize cap) {
+        _buf.resize(cap);
+    }
+
+    usize cap() const {
+        return _buf.len();
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    usize rem() const {
+        return cap() - _len;
+    }
+
+    // Appends as much of `bytes` as fits.
+    usize push(Bytes bytes);
+
+    // Copies bytes starting `off` bytes in, without consuming them.
+    usize peek(usize off, MutBytes buf) const;
+
+    void pop(usize n);
+};
+
+enum struct TcpState {
+    CLOSED,
+    SYN_SENT,
+    SYN_RCVD,
+    ESTABLISHED,
+    FIN_WAIT_1,
+    FIN_WAIT_2,
+    CLOSE_WAIT,
+    CLOSING,
+    LAST_ACK,
+    TIME_WAIT,
+};
+
+struct TcpStats {
+    usize segmentsOut;
+    usize retransmits;
+    usize dupAcks;
+};
+
+// One end of a TCP connection. Data is copied in and out of rings large
+// enough to keep a fast link busy, the receive window is scaled to advertise
+// all of it. Connections that are only half open don't get any, they are
+// allocated once the handshake is done.
+//
+// Only in order segments are accepted, everything past a hole is dropped and
+// resent by the peer, on timeout everything that wasn't acknowledged is sent
+// again (go-back-N).
+struct TcpConn : public Meta::NoCopy {
+    static constexpr usize BUF_SIZE = 256 * 1024;
+    static constexpr u8 WSCALE = 3;
+    static constexpr usize MSS = MTU - Ip4Header::LEN - TcpHeader::LEN;
+    static constexpr usize DEFAULT_MSS = 536;
+    static constexpr usize MAX_RETRIES = 8;
+    static constexpr usize DUP_ACKS = 3;
+    static constexpr TimeSpan MIN_RTO = TimeSpan::fromMSecs(200);
+    static constexpr TimeSpan MAX_RTO = TimeSpan::fromSecs(8);
+    static constexpr TimeSpan LINGER = TimeSpan::fromSecs(1);
+
+    Stack &_stack;
+    u16 _port;
+    Endpoint _remote;
+    TcpState _state = TcpState::CLOSED;
+    Opt<Error> _error = NONE;
+
+    // Send side, `_tx` holds everything from `_sndUna` onward.
+    u32 _iss;
+    u32 _sndUna;
+    u32 _sndNxt;
+    u32 _sndMax;
+    usize _sndWnd = 0;
+    u8 _sndShift = 0;
+    usize _mss = DEFAULT_MSS;
+    ByteRing _tx;
+    bool _finQueued = false;
+    bool _finSent = false;
+    usize _dupAcks = 0;
+    bool _outputting = false;
+
+    // Receive side.
+    u32 _rcvNxt = 0;
+    u8 _rcvShift = 0;
+    ByteRing _rx;
+    usize _advertised = 0;
+    bool _finReceived = false;
+
+    // Retransmission, the round trip time is only sampled on segments that
+    // weren't resent (Karn's algorithm).
+    TimeStamp _rtoAt = TimeStamp::endOfTime();
+    TimeSpan _rto = TimeSpan::fromSecs(1);
+    Opt<u64> _srtt = NONE;
+    u64 _rttvar = 0;
+    Opt<Cons<u32, TimeStamp>> _rttProbe = NONE;
+    usize _retries = 0;
+    TimeStamp _closeAt = TimeStamp::endOfTime();
+
+    TcpStats _stats{};
+    Waiters _readers;
+    Waiters _writers;
+
+    TcpConn(Stack &stack, u16 port, Endpoint remote, u32 iss);
+
+    TcpState state() const {
+        return _state;
+    }
+
+    TcpStats const &stats() const {
+        return _stats;
+    }
+
+    bool established() const {
+        return _state != TcpState::CLOSED and
+               _state != TcpState::SYN_SENT and
+               _state != TcpState::SYN_RCVD;
+    }
+
+    // MARK: Api ---------------------------------------------------------------
+
+    // Reads what was received so far, 0 once the peer closed its side, and
+    // Error::wouldBlock when there is nothing to read yet.
+    Res<usize> read(MutBytes buf);
+
+    // Queues as much of `bytes` as there is room for, Error::wouldBlock when
+    // there is none at all.
+    Res<usize> write(Bytes bytes);
+
+    // No more data is going to be written, the peer is told once everything
+    // queued so far was sent.
+    void close();
+
+    void abort();
+
+    Async::Task<> connectedAsync(Async::Cancelation::Token ct = {});
+
+    Async::Task<usize> readAsync(MutBytes buf, Async::Cancelation::Token ct = {});
+
+    // Waits until all of `bytes` is queued.
+    Async::Task<> writeAsync(Bytes bytes, Async::Cancelation::Token ct = {});
+
+    // MARK: Protocol ----------------------------------------------------------
+
+    void _allocate();
+
+    usize _window() const;
+
+    void _send(u32 seq, u8 flags, usize off = 0, usize len = 0);
+
+    void _sendSyn();
+
+    void _output(TimeStamp now);
+
+    void _arm(TimeStamp now);
+
+    void _sample(u32 ack, TimeStamp now);
+
+    void _fail(Error err);
+
+    void _input(TcpHeader const &seg, Bytes payload, TimeStamp now);
+
+    void _inputSegment(TcpHeader const &seg, Bytes payload, TimeStamp now);
+
+    void _inputSyn(TcpHeader const &seg, TimeStamp now);
+
+    void _inputSynSent(TcpHeader const &seg, TimeStamp now);
+
+    void _inputAck(TcpHeader const &seg, bool empty, TimeStamp now);
+
+    void _tick(TimeStamp now);
+};
+
+// Connections that were established on a port someone listens on, waiting
+// to be accepted.
+struct TcpListener : public Meta::NoCopy {
+    static constexpr usize BACKLOG = 64;
+    static constexpr usize HALF_OPEN = 64;
+
+    Stack &_stack;
+    u16 _port;
+    Vec<Strong<TcpConn>> _ready;
+    Waiters _waiters;
+
+    TcpListener(Stack &stack, u16 port)
+        : _stack(stack), _port(port) {}
+
+    u16 port() const {
+        return _port;
+    }
+
+    Opt<Strong<TcpConn>> tryAccept();
+
+    Async::Task<Strong<TcpConn>> acceptAsync(Async::Cancelation::Token ct = {});
+
+    // Stops listening, connections that weren't accepted yet are reset.
+    void close();
+};
+
+} // namespace Grund::Netstack
@@ -0,0 +1,286 @@
+#include <grund-netstack/dhcp.h>
+#include <grund-netstack/stack.h>
+#include <karm-test/macros.h>
+
+namespace Grund::Netstack::Tests {
+
+static constexpr Sys::Ip4 MASK = {255, 255, 255, 0};
+static constexpr Sys::Ip4 A = {10, 0, 0, 1};
+static constexpr Sys::Ip4 B = {10, 0, 0, 2};
+
+// Two hosts on either end of a loopback cable, frames only move when they
+// are pumped.
+struct _Net {
+    Pair<LoopbackLink> links;
+    PacketPool poolA;
+    PacketPool poolB;
+    Stack a{links.car, poolA};
+    Stack b{links.cdr, poolB};
+
+    _Net(PacketPool pa, PacketPool pb)
+        : links(LoopbackLink::pair()), poolA(std::move(pa)), poolB(std::move(pb)) {
+        a.configure({A, MASK, A});
+        b.configure({B, MASK, B});
+    }
+
+    static Res<Box<_Net>> create() {
+        return Ok(makeBox<_Net>(try$(PacketPool::create(512)), try$(PacketPool::create(512))));
+    }
+
+    void pump() {
+        while (a.poll() or b.poll())
+            ;
+    }
+};
+
+test$("netstack-checksum") {
+    // NOTE: The header from the example on the wikipedia page of IPv4.
+    Array<u8, 20> header = {
+        0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11,
+        0xb8, 0x61, 0xc0, 0xa8, 0x00, 0x01, 0xc0, 0xa8, 0x00, 0xc7};
+    expectEq$(checksum(sum(header.bytes())), 0);
+
+    Array<u8, 0x73> packet{};
+    copy(header.bytes(), packet.mutBytes());
+
+    usize headerLen = 0;
+    auto ip = try$(Ip4Header::parse(packet.bytes(), headerLen));
+    expectEq$(headerLen, 20uz);
+    expectEq$(ip.proto, Proto::UDP);
+
+    Array<u8, 20> out{};
+    ip.id = 0;
+    ip.emit(out.mutBytes());
+    expectEq$(out[10], 0xb8);
+    expectEq$(out[11], 0x61);
+
+    packet[12] ^= 1;
+    expect$(not Ip4Header::parse(packet.bytes(), headerLen));
+
+    return Ok();
+}
+
+test$("netstack-pool-fits") {
+    auto pool = try$(PacketPool::create(4));
+    expect$(pool.fits({0, PacketPool::HEADROOM, 16}));
+    expect$(pool.fits({3, PacketPool::BUF_SIZE, 0}));
+
+    expect$(not pool.fits({4, PacketPool::HEADROOM, 16}));
+    expect$(not pool.fits({0, 0, 16}));
+    expect$(not pool.fits({0, PacketPool::HEADROOM, PacketPool::BUF_SIZE}));
+
+    // NOTE: Added up in 32 bits, these wrap around to 0x100.
+    expect$(not pool.fits({0, 0xffffff00, 0x200}));
+    expect$(not pool.fits({0, PacketPool::HEADROOM, 0xffffffff}));
+
+    return Ok();
+}
+
+test$("netstack-udp-loopback") {
+    auto net = try$(_Net::create());
+    auto server = try$(net->b.udpBind(7));
+    auto client = try$(net->a.udpBind(0));
+
+    auto buf = net->poolA.alloc().unwrap();
+    buf.len = 5;
+    copy(bytes("hello"s), net->poolA.buf(buf));
+    try$(client->send({B, 7}, buf));
+
+    // NOTE: The first datagram waits for the address to be resolved.
+    expectEq$(net->a.stats().arpMisses, 1uz);
+    net->pump();
+
+    auto datagram = server->tryRecv().unwrap();
+    expect$(datagram.from == (Endpoint{A, client->port()}));
+    expect$(net->poolB.bytes(datagram.buf) == bytes("hello"s));
+    net->poolB.free(datagram.buf);
+
+    expectEq$(net->poolA.stats().inUse, 0uz);
+    expectEq$(net->poolB.stats().inUse, 0uz);
+
+    return Ok();
+}
+
+static Res<> _transfer(_Net &net, TcpConn &from, TcpConn &to, Bytes data) {
+    Vec<u8> in;
+    in.resize(data.len());
+
+    usize sent = 0;
+    usize received = 0;
+    for (usize i = 0; i < 10000 and received < data.len(); i++) {
+        if (sent < data.len())
+            sent += try$(from.write(sub(data, sent, data.len())));
+        net.pump();
+
+        while (received < data.len()) {
+            auto n = to.read(mutSub(in, received, data.len()));
+            if (not n)
+                break;
+            received += n.unwrap();
+        }
+        net.pump();
+    }
+
+    if (sub(in) != data)
+        return Error::invalidData("data corrupted in transit");
+    return Ok();
+}
+
+test$("netstack-tcp-transfer") {
+    auto net = try$(_Net::create());
+    auto listener = try$(net->b.tcpListen(80));
+    auto client = try$(net->a.tcpConnect({B, 80}));
+    net->pump();
+
+    auto server = listener->tryAccept().unwrap();
+    expect$(client->established());
+    expect$(server->established());
+    expectEq$(client->_rcvShift, TcpConn::WSCALE);
+    expectEq$(client->_mss, TcpConn::MSS);
+
+    Vec<u8> data;
+    for (usize i = 0; i < 1024 * 1024; i++)
+        data.pushBack((i * 2654435761u) >> 13);
+
+    try$(_transfer(*net, *client, *server, data));
+    try$(_transfer(*net, *server, *client, sub(data, 0, 4096)));
+    expectEq$(client->stats().retransmits, 0uz);
+
+    client->close();
+    net->pump();
+    expectEq$(server->read(data).unwrap(), 0uz);
+    server->close();
+    net->pump();
+
+    expectEq$(server->state(), TcpState::CLOSED);
+    expectEq$(client->state(), TcpState::TIME_WAIT);
+    net->a.tick(Sys::now() + TcpConn::LINGER + TcpConn::LINGER);
+    expectEq$(client->state(), TcpState::CLOSED);
+
+    return Ok();
+}
+
+test$("netstack-tcp-retransmit") {
+    auto net = try$(_Net::create());
+    auto listener = try$(net->b.tcpListen(80));
+    auto client = try$(net->a.tcpConnect({B, 80}));
+    net->pump();
+    auto server = listener->tryAccept().unwrap();
+
+    // NOTE: Everything that's on the wire is lost before reaching the
+    //       server, it only shows up once the client times out.
+    try$(client->write(bytes("lost in transit"s)));
+    Array<u8, 2048> junk{};
+    while (net->links.cdr.tryRecv(junk.mutBytes()))
+        ;
+    net->pump();
+    expectEq$(server->read(junk.mutBytes()).none().code(), Error::WOULD_BLOCK);
+
+    net->a.tick(Sys::now() + TcpConn::MAX_RTO);
+    net->pump();
+    expectEq$(client->stats().retransmits, 1uz);
+
+    auto n = try$(server->read(junk.mutBytes()));
+    expect$(sub(junk.bytes(), 0, n) == bytes("lost in transit"s));
+
+    return Ok();
+}
+
+test$("netstack-tcp-refused") {
+    auto net = try$(_Net::create());
+    auto client = try$(net->a.tcpConnect({B, 81}));
+    net->pump();
+
+    expectEq$(client->state(), TcpState::CLOSED);
+    expect$(not client->write(bytes("nobody home"s)));
+
+    return Ok();
+}
+
+test$("netstack-tcp-syn-flood") {
+    auto net = try$(_Net::create());
+    auto listener = try$(net->b.tcpListen(80));
+    auto first = try$(net->a.tcpConnect({B, 80}));
+    net->pump();
+    auto server = listener->tryAccept().unwrap();
+    expectEq$(server->_rx.cap(), TcpConn::BUF_SIZE);
+
+    // NOTE: The SYN-ACKs never make it back, as if the SYNs came from
+    //       addresses that don't exist.
+    for (usize i = 0; i < TcpListener::HALF_OPEN * 2; i++)
+        try$(net->a.tcpConnect({B, 80}));
+    net->b.poll();
+    Array<u8, 2048> junk{};
+    while (net->links.car.tryRecv(junk.mutBytes()))
+        ;
+
+    usize halfOpen = 0;
+    for (auto &conn : net->b._conns) {
+        if (conn->state() != TcpState::SYN_RCVD)
+            continue;
+        halfOpen++;
+        expectEq$(conn->_rx.cap(), 0uz);
+        expectEq$(conn->_tx.cap(), 0uz);
+    }
+    expectEq$(halfOpen, TcpListener::HALF_OPEN);
+
+    return Ok();
+}
+
+test$("netstack-tcp-iss") {
+    auto net = try$(_Net::create());
+    auto other = try$(_Net::create());
+    auto now = Sys::now();
+
+    auto iss = net->a._iss(1234, {B, 80}, now);
+    expectEq$(net->a._iss(1234, {B, 80}, now), iss);
+    expectEq$(net->a._iss(1234, {B, 80}, now + TimeSpan::fromUSecs(400)), iss + 100);
+
+    // NOTE: Nothing can be told from the sequence numbers of another
+    //       connection, nor from those of another host.
+    expectNe$(net->a._iss(1235, {B, 80}, now), iss + 1);
+    expectNe$(other->a._iss(1234, {B, 80}, now), iss);
+
+    return Ok();
+}
+
+test$("netstack-dhcp-codec") {
+    Mac mac = {0x02, 0, 0, 0, 0, 1};
+    Array<u8, DhcpMessage::LEN> buf{};
+
+    DhcpMessage::discover(mac, 0x1234).emit(buf.mutBytes());
+    auto discover = try$(DhcpMessage::parse(buf.bytes()));
+    expectEq$(discover.type, DhcpType::DISCOVER);
+    expectEq$(discover.xid, 0x1234u);
+    expect$(discover.chaddr == mac);
+    expect$(discover.broadcast);
+
+    DhcpMessage ack;
+    ack.op = DhcpMessage::BOOTREPLY;
+    ack.xid = 0x1234;
+    ack.type = DhcpType::ACK;
+    ack.yiaddr = B;
+    ack.mask = MASK;
+    ack.router = A;
+    ack.server = A;
+    ack.dns = A;
+    ack.leaseTime = 3600;
+    ack.emit(buf.mutBytes());
+
+    auto lease = try$(try$(DhcpMessage::parse(buf.bytes())).lease());
+    expectEq$(lease.iface.addr, B);
+    expectEq$(lease.iface.mask, MASK);
+    expectEq$(lease.iface.gateway, A);
+    expectEq$(lease.server, A);
+    expectEq$(lease.duration, TimeSpan::fromSecs(3600));
+
+    auto request = DhcpMessage::request(try$(DhcpMessage::parse(buf.bytes())), mac);
+    expectEq$(request.requested.unwrap(), B);
+    expectEq$(request.server.unwrap(), A);
+
+    expect$(not DhcpMessage::parse(sub(buf.bytes(), 0, 100)));
+
+    return Ok();
+}
+
+} // namespace Grund::Netstack::Tests
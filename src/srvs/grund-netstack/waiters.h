@@ -0,0 +1,37 @@
+#pragma once
+
+#include <karm-base/async.h>
+
+namespace Grund::Netstack {
+
+// Tasks waiting for something to happen to a socket, they are all woken up
+// and are expected to check again whether it's what they wanted.
+struct Waiters : public Meta::NoCopy {
+    Vec<Async::Promise<>> _promises;
+
+    usize len() const {
+        return _promises.len();
+    }
+
+    Async::Task<> waitAsync(Async::Cancelation::Token ct) {
+        co_try$(ct.check());
+
+        _promises.pushBack(Async::Promise<>{});
+        auto future = _promises[_promises.len() - 1].future();
+        Async::OnCancel onCancel{ct, [&] {
+            wake();
+        }};
+        (void)co_await future;
+
+        co_return ct.check();
+    }
+
+    // NOTE: Only the tasks that were waiting when this was called are woken
+    //       up, the ones that start waiting again meanwhile are left alone.
+    void wake() {
+        for (usize n = _promises.len(); n and _promises.len(); n--)
+            _promises.removeAt(0).resolve(Ok());
+    }
+};
+
+} // namespace Grund::Netstack
@@ -0,0 +1,276 @@
+#include <karm-io/bscan.h>
+#include <karm-io/impls.h>
+
+#include "wire.h"
+
+namespace Grund::Netstack {
+
+static Mac _nextMac(Io::BScan &s) {
+    Mac mac{};
+    s.readTo(mac.buf(), mac.len());
+    return mac;
+}
+
+static Sys::Ip4 _nextIp4(Io::BScan &s) {
+    auto ip = Sys::Ip4::unspecified();
+    s.readTo(ip.bytes.buf(), ip.bytes.len());
+    return ip;
+}
+
+static void _putU16be(MutBytes out, usize off, u16 v) {
+    out[off] = v >> 8;
+    out[off + 1] = v;
+}
+
+// MARK: Checksums -------------------------------------------------------------
+
+u32 sum(Bytes bytes, u32 acc) {
+    usize i = 0;
+    for (; i + 1 < bytes.len(); i += 2)
+        acc += (bytes[i] << 8) | bytes[i + 1];
+    if (i < bytes.len())
+        acc += bytes[i] << 8;
+    return acc;
+}
+
+u32 pseudoSum(Sys::Ip4 src, Sys::Ip4 dst, u8 proto, usize len) {
+    u32 acc = sum(src.bytes.bytes());
+    acc = sum(dst.bytes.bytes(), acc);
+    return acc + proto + len;
+}
+
+u16 checksum(u32 acc) {
+    while (acc >> 16)
+        acc = (acc & 0xffff) + (acc >> 16);
+    return ~acc;
+}
+
+// MARK: Ethernet --------------------------------------------------------------
+
+Res<EthHeader> EthHeader::parse(Bytes frame) {
+    if (frame.len() < LEN)
+        return Error::invalidData("ethernet frame too short");
+
+    Io::BScan s{frame};
+    EthHeader header;
+    header.dst = _nextMac(s);
+    header.src = _nextMac(s);
+    header.type = (EtherType)s.nextU16be();
+    return Ok(header);
+}
+
+void EthHeader::emit(MutBytes out) const {
+    Io::BufWriter w{out};
+    Io::BEmit e{w};
+    e.writeBytes(dst.bytes());
+    e.writeBytes(src.bytes());
+    e.writeU16be((u16)type);
+}
+
+// MARK: ARP -------------------------------------------------------------------
+
+Res<ArpPacket> ArpPacket::parse(Bytes packet) {
+    if (packet.len() < LEN)
+        return Error::invalidData("arp packet too short");
+
+    Io::BScan s{packet};
+    u16 htype = s.nextU16be();
+    u16 ptype = s.nextU16be();
+    u8 hlen = s.nextU8be();
+    u8 plen = s.nextU8be();
+    if (htype != 1 or ptype != (u16)EtherType::IP4 or hlen != 6 or plen != 4)
+        return Error::notImplemented("unsupported arp packet");
+
+    ArpPacket arp;
+    arp.op = s.nextU16be();
+    arp.sha = _nextMac(s);
+    arp.spa = _nextIp4(s);
+    arp.tha = _nextMac(s);
+    arp.tpa = _nextIp4(s);
+    return Ok(arp);
+}
+
+void ArpPacket::emit(MutBytes out) const {
+    Io::BufWriter w{out};
+    Io::BEmit e{w};
+    e.writeU16be(1);
+    e.writeU16be((u16)EtherType::IP4);
+    e.writeU8be(6);
+    e.writeU8be(4);
+    e.writeU16be(op);
+    e.writeBytes(sha.bytes());
+    e.writeBytes(spa.bytes.bytes());
+    e.writeBytes(tha.bytes());
+    e.writeBytes(tpa.bytes.bytes());
+}
+
+// MARK: IPv4 ------------------------------------------------------------------
+
+Res<Ip4Header> Ip4Header::parse(Bytes packet, usize &headerLen) {
+    if (packet.len() < LEN)
+        return Error::invalidData("ip packet too short");
+
+    Io::BScan s{packet};
+    u8 vihl = s.nextU8be();
+    if ((vihl >> 4) != 4)
+        return Error::invalidData("not an ipv4 packet");
+
+    headerLen = (vihl & 0xf) * 4;
+    if (headerLen < LEN or headerLen > packet.len())
+        return Error::invalidData("invalid ip header length");
+
+    if (checksum(sum(sub(packet, 0, headerLen))) != 0)
+        return Error::invalidData("invalid ip checksum");
+
+    Ip4Header header;
+    s.skip(1);
+    header.len = s.nextU16be();
+    if (header.len < headerLen or header.len > packet.len())
+        return Error::invalidData("invalid ip packet length");
+
+    header.id = s.nextU16be();
+
+    // NOTE: Fragments are never reassembled, everything we send has DF set
+    //       and fits the MTU so they only come from other hosts.
+    if (s.nextU16be() & 0x3fff)
+        return Error::notImplemented("fragmented ip packet");
+
+    header.ttl = s.nextU8be();
+    header.proto = (Proto)s.nextU8be();
+    s.skip(2);
+    header.src = _nextIp4(s);
+    header.dst = _nextIp4(s);
+    return Ok(header);
+}
+
+void Ip4Header::emit(MutBytes out) const {
+    Io::BufWriter w{out};
+    Io::BEmit e{w};
+    e.writeU8be(0x45);
+    e.writeU8be(0);
+    e.writeU16be(len);
+    e.writeU16be(id);
+    e.writeU16be(0x4000);
+    e.writeU8be(ttl);
+    e.writeU8be((u8)proto);
+    e.writeU16be(0);
+    e.writeBytes(src.bytes.bytes());
+    e.writeBytes(dst.bytes.bytes());
+
+    _putU16be(out, 10, checksum(sum(sub(out, 0, LEN))));
+}
+
+// MARK: UDP -------------------------------------------------------------------
+
+Res<UdpHeader> UdpHeader::parse(Bytes datagram, Sys::Ip4 src, Sys::Ip4 dst) {
+    if (datagram.len() < LEN)
+        return Error::invalidData("udp datagram too short");
+
+    Io::BScan s{datagram};
+    UdpHeader header;
+    header.src = s.nextU16be();
+    header.dst = s.nextU16be();
+    header.len = s.nextU16be();
+    if (header.len < LEN or header.len > datagram.len())
+        return Error::invalidData("invalid udp length");
+
+    // NOTE: A zero checksum means the sender didn't compute one.
+    u16 csum = s.nextU16be();
+    auto acc = pseudoSum(src, dst, (u8)Proto::UDP, header.len);
+    if (csum != 0 and checksum(sum(sub(datagram, 0, header.len), acc)) != 0)
+        return Error::invalidData("invalid udp checksum");
+
+    return Ok(header);
+}
+
+void UdpHeader::emit(MutBytes datagram, Sys::Ip4 src, Sys::Ip4 dst) const {
+    Io::BufWriter w{datagram};
+    Io::BEmit e{w};
+    e.writeU16be(this->src);
+    e.writeU16be(this->dst);
+    e.writeU16be(len);
+    e.writeU16be(0);
+
+    auto acc = pseudoSum(src, dst, (u8)Proto::UDP, len);
+    u16 csum = checksum(sum(sub(datagram, 0, len), acc));
+    _putU16be(datagram, 6, csum ? csum : 0xffff);
+}
+
+// MARK: TCP -------------------------------------------------------------------
+
+Res<TcpHeader> TcpHeader::parse(Bytes segment, Sys::Ip4 src, Sys::Ip4 dst) {
+    if (segment.len() < LEN)
+        return Error::invalidData("tcp segment too short");
+
+    auto acc = pseudoSum(src, dst, (u8)Proto::TCP, segment.len());
+    if (checksum(sum(segment, acc)) != 0)
+        return Error::invalidData("invalid tcp checksum");
+
+    Io::BScan s{segment};
+    TcpHeader header;
+    header.src = s.nextU16be();
+    header.dst = s.nextU16be();
+    header.seq = s.nextU32be();
+    header.ack = s.nextU32be();
+    header.headerLen = (s.nextU8be() >> 4) * 4;
+    header.flags = s.nextU8be();
+    header.wnd = s.nextU16be();
+    s.skip(4);
+
+    if (header.headerLen < LEN or header.headerLen > segment.len())
+        return Error::invalidData("invalid tcp header length");
+
+    Io::BScan opts{sub(segment, LEN, header.headerLen)};
+    while (not opts.ended()) {
+        u8 kind = opts.nextU8be();
+        if (kind == 0)
+            break;
+        if (kind == 1)
+            continue;
+
+        u8 len = opts.nextU8be();
+        if (len < 2 or len - 2uz > opts.rem())
+            return Error::invalidData("invalid tcp option");
+
+        if (kind == 2 and len == 4)
+            header.mss = opts.nextU16be();
+        else if (kind == 3 and len == 3)
+            header.wscale = min(opts.nextU8be(), 14);
+        else
+            opts.skip(len - 2);
+    }
+
+    return Ok(header);
+}
+
+void TcpHeader::emit(MutBytes segment, Sys::Ip4 src, Sys::Ip4 dst) const {
+    Io::BufWriter w{segment};
+    Io::BEmit e{w};
+    e.writeU16be(this->src);
+    e.writeU16be(this->dst);
+    e.writeU32be(seq);
+    e.writeU32be(ack);
+    e.writeU8be((size() / 4) << 4);
+    e.writeU8be(flags);
+    e.writeU16be(wnd);
+    e.writeU16be(0);
+    e.writeU16be(0);
+
+    if (mss) {
+        e.writeU8be(2);
+        e.writeU8be(4);
+        e.writeU16be(*mss);
+    }
+
+    if (wscale) {
+        e.writeU8be(1);
+        e.writeU8be(3);
+        e.writeU8be(3);
+        e.writeU8be(*wscale);
+    }
+
+    auto acc = pseudoSum(src, dst, (u8)Proto::TCP, segment.len());
+    _putU16be(segment, 16, checksum(sum(segment, acc)));
+}
+
+} // namespace Grund::Netstack
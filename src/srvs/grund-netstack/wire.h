@@ -0,0 +1,167 @@
+#pragma once
+
+#include <karm-sys/addr.h>
+
+namespace Grund::Netstack {
+
+using Mac = Array<u8, 6>;
+
+static constexpr Mac BROADCAST_MAC = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+static constexpr usize MTU = 1500;
+
+// An IPv4 address and a port, unlike Sys::SocketAddr it's trivially
+// copyable so it can be sent as is over IPC.
+struct Endpoint {
+    Sys::Ip4 addr = Sys::Ip4::unspecified();
+    u16 port = 0;
+
+    bool operator==(Endpoint const &other) const = default;
+};
+
+struct Iface {
+    Sys::Ip4 addr = Sys::Ip4::unspecified();
+    Sys::Ip4 mask = Sys::Ip4::unspecified();
+    Sys::Ip4 gateway = Sys::Ip4::unspecified();
+
+    bool configured() const {
+        return addr != Sys::Ip4::unspecified();
+    }
+
+    bool onLink(Sys::Ip4 ip) const {
+        return (ip._raw.value() & mask._raw.value()) == (addr._raw.value() & mask._raw.value());
+    }
+
+    Sys::Ip4 broadcast() const {
+        auto ip = Sys::Ip4::unspecified();
+        ip._raw = addr._raw.value() | ~mask._raw.value();
+        return ip;
+    }
+};
+
+// MARK: Checksums -------------------------------------------------------------
+
+// Running sum of 16-bit big endian words, folded by checksum().
+u32 sum(Bytes bytes, u32 acc = 0);
+
+// Sum of the pseudo header UDP and TCP checksums start from.
+u32 pseudoSum(Sys::Ip4 src, Sys::Ip4 dst, u8 proto, usize len);
+
+u16 checksum(u32 acc);
+
+// MARK: Ethernet --------------------------------------------------------------
+
+enum struct EtherType : u16 {
+    IP4 = 0x0800,
+    ARP = 0x0806,
+};
+
+struct EthHeader {
+    static constexpr usize LEN = 14;
+
+    Mac dst;
+    Mac src;
+    EtherType type;
+
+    static Res<EthHeader> parse(Bytes frame);
+
+    void emit(MutBytes out) const;
+};
+
+// MARK: ARP -------------------------------------------------------------------
+
+struct ArpPacket {
+    static constexpr usize LEN = 28;
+    static constexpr u16 REQUEST = 1;
+    static constexpr u16 REPLY = 2;
+
+    u16 op;
+    Mac sha;
+    Sys::Ip4 spa = Sys::Ip4::unspecified();
+    Mac tha;
+    Sys::Ip4 tpa = Sys::Ip4::unspecified();
+
+    static Res<ArpPacket> parse(Bytes packet);
+
+    void emit(MutBytes out) const;
+};
+
+// MARK: IPv4 ------------------------------------------------------------------
+
+enum struct Proto : u8 {
+    ICMP = 1,
+    TCP = 6,
+    UDP = 17,
+};
+
+struct Ip4Header {
+    static constexpr usize LEN = 20;
+
+    usize len;
+    u16 id;
+    u8 ttl;
+    Proto proto;
+    Sys::Ip4 src = Sys::Ip4::unspecified();
+    Sys::Ip4 dst = Sys::Ip4::unspecified();
+
+    // Only accepts unfragmented packets with a valid checksum, the header
+    // length tells where the payload starts.
+    static Res<Ip4Header> parse(Bytes packet, usize &headerLen);
+
+    void emit(MutBytes out) const;
+};
+
+// MARK: UDP -------------------------------------------------------------------
+
+struct UdpHeader {
+    static constexpr usize LEN = 8;
+
+    u16 src;
+    u16 dst;
+    usize len;
+
+    static Res<UdpHeader> parse(Bytes datagram, Sys::Ip4 src, Sys::Ip4 dst);
+
+    // Also fills the checksum in, `datagram` is the header followed by the
+    // payload.
+    void emit(MutBytes datagram, Sys::Ip4 src, Sys::Ip4 dst) const;
+};
+
+// MARK: TCP -------------------------------------------------------------------
+
+enum TcpFlags : u8 {
+    FIN = 1 << 0,
+    SYN = 1 << 1,
+    RST = 1 << 2,
+    PSH = 1 << 3,
+    ACK = 1 << 4,
+};
+
+struct TcpHeader {
+    static constexpr usize LEN = 20;
+    static constexpr usize MAX_LEN = 60;
+
+    u16 src;
+    u16 dst;
+    u32 seq;
+    u32 ack;
+    u8 flags;
+    u16 wnd;
+    usize headerLen = LEN;
+
+    // Options, only sent and looked at on SYN segments.
+    Opt<u16> mss = NONE;
+    Opt<u8> wscale = NONE;
+
+    static Res<TcpHeader> parse(Bytes segment, Sys::Ip4 src, Sys::Ip4 dst);
+
+    usize size() const {
+        return LEN + (mss ? 4 : 0) + (wscale ? 4 : 0);
+    }
+
+    // Also fills the checksum in, `segment` is the header followed by the
+    // payload.
+    void emit(MutBytes segment, Sys::Ip4 src, Sys::Ip4 dst) const;
+};
+
+} // namespace Grund::Netstack
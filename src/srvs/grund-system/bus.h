@@ -56,11 +56,9 @@ struct Bus {
     Res<> run() {
         while (true) {
             try$(_listener.poll(TimeStamp::endOfTime()));
-            auto ev = _listener.next();
-            while (ev) {
-                logInfo("handling system event");
+            for (auto &ev : _listener.events()) {
+                logInfo("handling system event on cap {}", ev.cap.raw());
                 // ignore
-                ev = _listener.next();
             }
         }
     }
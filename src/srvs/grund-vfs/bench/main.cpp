@@ -0,0 +1,60 @@
+#include <grund-vfs/vfs.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/file.h>
+#include <karm-sys/time.h>
+
+using namespace Grund;
+
+static constexpr usize SIZE = 64 * 1024 * 1024;
+static constexpr usize CHUNK = 64 * 1024;
+static constexpr usize PAGES = 2 * SIZE / Vfs::PAGE_SIZE;
+
+// Reads the whole file the way a client would, copying each reply out of
+// the arena.
+Res<> bench(Str name, Vfs::Vfs &vfs, Mime::Url const &url) {
+    Vec<u8> buf;
+    buf.resize(CHUNK);
+
+    auto before = vfs.pages().stats();
+    auto start = Sys::now();
+    usize off = 0;
+    while (off < SIZE) {
+        auto extents = try$(vfs.read(url, off, CHUNK));
+        if (not Vfs::copyExtents(vfs.pages()._arena.bytes(), vfs.pages().cap(), extents, buf))
+            return Error::other("page recycled while reading");
+        for (auto &e : extents)
+            off += e.len;
+    }
+    auto elapsed = Sys::now() - start;
+    auto usecs = max(elapsed.toUSecs(), 1uz);
+    auto after = vfs.pages().stats();
+
+    // NOTE: Bytes per microsecond are megabytes per second.
+    f64 throughput = (f64)SIZE / usecs;
+    Sys::println("{}: {} MB/s ({} hits, {} misses)", name, throughput, after.hits - before.hits, after.misses - before.misses);
+    return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    auto url = co_try$(Mime::parseUrlOrPath("/tmp/grund-vfs-bench"));
+    {
+        Vec<u8> data;
+        data.ensure(SIZE);
+        for (usize i = 0; i < SIZE; i++)
+            data.pushBack((i * 2654435761u) >> 13);
+        auto file = co_try$(Sys::File::create(url));
+        co_try$(file.write(data));
+    }
+
+    auto vfs = co_try$(Vfs::Vfs::create(PAGES));
+
+    // NOTE: The first pass still goes through the host page cache, it
+    //       measures what a miss costs us rather than the disk.
+    co_try$(bench("cold", *vfs, url));
+    co_try$(bench("warm", *vfs, url));
+
+    auto const &stats = vfs->stats();
+    Sys::println("read ahead: {} pages", stats.readAheads);
+
+    co_return Ok();
+}
@@ -0,0 +1,155 @@
+#include "cache.h"
+
+namespace Grund::Vfs {
+
+Res<PageCache> PageCache::create(usize cap) {
+    if (cap == 0)
+        return Error::invalidInput("page cache can't be empty");
+
+    auto fd = try$(Sys::createShm(arenaSize(cap)));
+    auto arena = try$(Sys::mmap().read().write().size(arenaSize(cap)).mapMut(fd));
+    return Ok(PageCache{fd, std::move(arena), cap});
+}
+
+PageCache::PageCache(Strong<Sys::Fd> fd, Sys::MutMmap arena, usize cap)
+    : _fd(fd), _arena(std::move(arena)) {
+    _slots.resize(cap);
+
+    usize buckets = 1;
+    while (buckets < cap)
+        buckets *= 2;
+    _buckets.resize(buckets, NIL);
+}
+
+Bytes PageCache::bytes(usize slot) const {
+    auto base = headerSize(cap()) + slot * PAGE_SIZE;
+    return sub(_arena.bytes(), base, base + _slots[slot].len);
+}
+
+MutBytes PageCache::buf(usize slot) {
+    auto base = headerSize(cap()) + slot * PAGE_SIZE;
+    auto bytes = _arena.mutBytes();
+    return mutSub(bytes, base, base + PAGE_SIZE);
+}
+
+usize PageCache::_bucket(u64 file, usize page) const {
+    u64 h = (file * 0x9e3779b97f4a7c15) ^ page;
+    h ^= h >> 29;
+    return h & (_buckets.len() - 1);
+}
+
+void PageCache::_unlink(usize slot) {
+    auto &s = _slots[slot];
+    auto *link = &_buckets[_bucket(s.file, s.page)];
+    while (*link != slot)
+        link = &_slots[*link].next;
+    *link = s.next;
+    s.next = NIL;
+    s.file = 0;
+}
+
+Opt<usize> PageCache::_find(u64 file, usize page) {
+    for (usize i = _buckets[_bucket(file, page)]; i != NIL; i = _slots[i].next)
+        if (_slots[i].file == file and _slots[i].page == page)
+            return i;
+    return NONE;
+}
+
+Opt<usize> PageCache::lookup(u64 file, usize page) {
+    auto slot = _find(file, page);
+    if (not slot) {
+        _stats.misses++;
+        return NONE;
+    }
+
+    _slots[*slot].referenced = true;
+    _stats.hits++;
+    return slot;
+}
+
+usize PageCache::claim(u64 file, usize page) {
+    // NOTE: Each pass clears the bits it skips over, so this ends within two
+    //       turns of the hand.
+    usize slot;
+    while (true) {
+        slot = _hand;
+        _hand = (_hand + 1) % cap();
+
+        auto &s = _slots[slot];
+        if (s.file == 0)
+            break;
+
+        if (s.referenced) {
+            s.referenced = false;
+            continue;
+        }
+
+        _unlink(slot);
+        _stats.evictions++;
+        break;
+    }
+
+    auto &gen = _gen(slot);
+    gen.store(gen.load(RELAXED) + 1, RELAXED);
+    memoryBarier(RELEASE);
+
+    auto &s = _slots[slot];
+    s.file = file;
+    s.page = page;
+    s.len = 0;
+    s.referenced = false;
+
+    auto &bucket = _buckets[_bucket(file, page)];
+    s.next = bucket;
+    bucket = slot;
+
+    return slot;
+}
+
+void PageCache::commit(usize slot, usize len, bool referenced) {
+    auto &s = _slots[slot];
+    s.len = len;
+    s.referenced = referenced;
+
+    auto &gen = _gen(slot);
+    gen.store(gen.load(RELAXED) + 1, RELEASE);
+}
+
+void PageCache::abort(usize slot) {
+    _unlink(slot);
+    auto &gen = _gen(slot);
+    gen.store(gen.load(RELAXED) + 1, RELEASE);
+}
+
+void PageCache::invalidate(u64 file) {
+    for (usize i = 0; i < cap(); i++) {
+        if (_slots[i].file != file)
+            continue;
+        _unlink(i);
+        auto &gen = _gen(i);
+        gen.store(gen.load(RELAXED) + 2, RELEASE);
+    }
+}
+
+bool copyExtents(Bytes arena, usize cap, Slice<Extent> extents, MutBytes out) {
+    auto const *gens = reinterpret_cast<Atomic<u32> const *>(arena.buf());
+    auto header = PageCache::headerSize(cap);
+
+    usize at = 0;
+    for (auto const &e : extents) {
+        auto &gen = const_cast<Atomic<u32> &>(gens[e.slot]);
+        if (gen.load(ACQUIRE) != e.gen)
+            return false;
+
+        auto page = header + e.slot * PAGE_SIZE;
+        copy(sub(arena, page + e.off, page + e.off + e.len), mutSub(out, at, at + e.len));
+        at += e.len;
+
+        memoryBarier(ACQUIRE);
+        if (gen.load(RELAXED) != e.gen)
+            return false;
+    }
+    return true;
+}
+
+} // namespace Grund::Vfs
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <karm-base/atomic.h>
+#include <karm-base/limits.h>
+#include <karm-base/vec.h>
+#include <karm-sys/mmap.h>
+#include <karm-sys/shm.h>
+
+namespace Grund::Vfs {
+
+static constexpr usize PAGE_SIZE = 4096;
+
+// Where a piece of a read landed in the arena. Clients copy it out of their
+// own mapping and check that `gen` didn't move meanwhile, otherwise the page
+// was recycled under them and the read has to be retried.
+struct Extent {
+    usize slot;
+    u32 gen;
+    usize off;
+    usize len;
+};
+
+struct PageCacheStats {
+    usize hits;
+    usize misses;
+    usize evictions;
+};
+
+// A fixed number of pages in shared memory, recycled with the clock
+// algorithm: a page that was used since the hand last swept past it gets a
+// second chance.
+//
+// The arena starts with a generation counter per slot, followed by the pages
+// themselves. A counter is odd while its page is being filled, and moves
+// every time the page changes hands.
+struct PageCache : public Meta::NoCopy {
+    static constexpr usize NIL = Limits<usize>::MAX;
+
+    struct _Slot {
+        u64 file = 0;
+        usize page = 0;
+        usize len = 0;
+        bool referenced = false;
+        usize next = NIL;
+    };
+
+    Strong<Sys::Fd> _fd;
+    Sys::MutMmap _arena;
+    Vec<_Slot> _slots;
+    Vec<usize> _buckets;
+    usize _hand = 0;
+    PageCacheStats _stats{};
+
+    static Res<PageCache> create(usize cap);
+
+    PageCache(Strong<Sys::Fd> fd, Sys::MutMmap arena, usize cap);
+
+    static usize headerSize(usize cap) {
+        return alignUp(cap * sizeof(u32), PAGE_SIZE);
+    }
+
+    static usize arenaSize(usize cap) {
+        return headerSize(cap) + cap * PAGE_SIZE;
+    }
+
+    usize cap() const {
+        return _slots.len();
+    }
+
+    Strong<Sys::Fd> fd() {
+        return _fd;
+    }
+
+    PageCacheStats const &stats() const {
+        return _stats;
+    }
+
+    Atomic<u32> &_gen(usize slot) {
+        return _arena.as<Atomic<u32>>()[slot];
+    }
+
+    u32 gen(usize slot) {
+        return _gen(slot).load(ACQUIRE);
+    }
+
+    usize len(usize slot) const {
+        return _slots[slot].len;
+    }
+
+    Bytes bytes(usize slot) const;
+
+    usize _bucket(u64 file, usize page) const;
+
+    void _unlink(usize slot);
+
+    Opt<usize> _find(u64 file, usize page);
+
+    bool contains(u64 file, usize page) {
+        return _find(file, page).has();
+    }
+
+    // Looks up a page that is ready to be read, and marks it as used.
+    Opt<usize> lookup(u64 file, usize page);
+
+    // Takes a slot for the page, evicting another one if needed. The slot
+    // must be filled through buf() and handed back with commit().
+    usize claim(u64 file, usize page);
+
+    MutBytes buf(usize slot);
+
+    void commit(usize slot, usize len, bool referenced = true);
+
+    // Gives back a slot that couldn't be filled.
+    void abort(usize slot);
+
+    // Drops every page of the file, clients still holding extents to them
+    // will see their generation move.
+    void invalidate(u64 file);
+};
+
+// Copies the extents out of a mapping of the arena into `out`, returns
+// false if one of the pages was recycled while copying.
+bool copyExtents(Bytes arena, usize cap, Slice<Extent> extents, MutBytes out);
+
+} // namespace Grund::Vfs
@@ -0,0 +1,104 @@
+#include <grund-vfs/vfs.h>
+#include <karm-sys/file.h>
+#include <karm-test/macros.h>
+
+namespace Grund::Vfs::Tests {
+
+static void _fill(PageCache &cache, usize slot, u8 byte) {
+    fill<u8>(cache.buf(slot), byte);
+    cache.commit(slot, PAGE_SIZE, false);
+}
+
+test$("page-cache-lookup") {
+    auto cache = try$(PageCache::create(4));
+
+    expect$(not cache.lookup(1, 0));
+    auto slot = cache.claim(1, 0);
+    _fill(cache, slot, 0x2a);
+
+    expectEq$(cache.lookup(1, 0).unwrap(), slot);
+    expect$(not cache.lookup(2, 0));
+    expect$(not cache.lookup(1, 1));
+    expectEq$(cache.bytes(slot)[0], 0x2a);
+
+    expectEq$(cache.stats().hits, 1uz);
+    expectEq$(cache.stats().misses, 3uz);
+
+    return Ok();
+}
+
+test$("page-cache-second-chance") {
+    auto cache = try$(PageCache::create(4));
+    for (usize i = 0; i < 4; i++)
+        _fill(cache, cache.claim(1, i), i);
+
+    // Page 0 is used again, so the hand spares it and takes page 1 instead.
+    expect$(cache.lookup(1, 0));
+    _fill(cache, cache.claim(1, 4), 4);
+
+    expect$(cache.contains(1, 0));
+    expect$(not cache.contains(1, 1));
+    expect$(cache.contains(1, 4));
+    expectEq$(cache.stats().evictions, 1uz);
+
+    return Ok();
+}
+
+test$("page-cache-generations") {
+    auto cache = try$(PageCache::create(2));
+    auto slot = cache.claim(1, 0);
+    expectEq$(cache.gen(slot) % 2, 1u);
+    _fill(cache, slot, 0x11);
+
+    auto gen = cache.gen(slot);
+    expectEq$(gen % 2, 0u);
+
+    Array<Extent, 1> extents = {Extent{slot, gen, 16, 32}};
+    Array<u8, 32> out{};
+    expect$(copyExtents(cache._arena.bytes(), cache.cap(), extents, out));
+    expectEq$(out[0], 0x11);
+    expectEq$(out[31], 0x11);
+
+    cache.invalidate(1);
+    expect$(not cache.contains(1, 0));
+    expect$(not copyExtents(cache._arena.bytes(), cache.cap(), extents, out));
+
+    return Ok();
+}
+
+test$("vfs-read-ahead") {
+    auto url = try$(Mime::parseUrlOrPath("/tmp/grund-vfs-test"));
+    {
+        Vec<u8> data;
+        for (usize i = 0; i < 64 * PAGE_SIZE; i++)
+            data.pushBack(i / PAGE_SIZE);
+        auto file = try$(Sys::File::create(url));
+        try$(file.write(data));
+    }
+
+    auto vfs = try$(Vfs::create(64));
+
+    // A file that is read from the start grows its read-ahead window.
+    usize off = 0;
+    for (usize i = 0; i < 4; i++) {
+        auto extents = try$(vfs->read(url, off, PAGE_SIZE));
+        expectEq$(extents.len(), 1uz);
+        expectEq$(vfs->pages().bytes(extents[0].slot)[0], i);
+        off += PAGE_SIZE;
+    }
+
+    expect$(vfs->stats().readAheads > 0);
+    auto misses = vfs->pages().stats().misses;
+    try$(vfs->read(url, off, PAGE_SIZE));
+    expectEq$(vfs->pages().stats().misses, misses);
+
+    // Past the end of the file, reads come back short.
+    auto extents = try$(vfs->read(url, 64 * PAGE_SIZE - 10, PAGE_SIZE));
+    expectEq$(extents.len(), 1uz);
+    expectEq$(extents[0].len, 10uz);
+    expectEq$(try$(vfs->read(url, 64 * PAGE_SIZE, PAGE_SIZE)).len(), 0uz);
+
+    return Ok();
+}
+
+} // namespace Grund::Vfs::Tests
@@ -0,0 +1,152 @@
+#include <karm-sys/file.h>
+#include <karm-sys/time.h>
+
+#include "vfs.h"
+
+namespace Grund::Vfs {
+
+Res<Box<Vfs>> Vfs::create(usize pages) {
+    return Ok(makeBox<Vfs>(try$(PageCache::create(pages))));
+}
+
+Res<Sys::Stat> Vfs::stat(Mime::Url const &url) {
+    auto now = Sys::now();
+    auto &entry = _stats.access(url.str(), [] {
+        return _Dentry<Sys::Stat>{};
+    });
+
+    if (now < entry.until) {
+        _vstats.dentryHits++;
+        return Ok(entry.value);
+    }
+
+    _vstats.dentryMisses++;
+    entry.value = try$(Sys::stat(url));
+    entry.until = now + DENTRY_TTL;
+    return Ok(entry.value);
+}
+
+Res<Vec<Sys::DirEntry>> Vfs::readDir(Mime::Url const &url) {
+    auto now = Sys::now();
+    auto &entry = _dirs.access(url.str(), [] {
+        return _Dentry<Vec<Sys::DirEntry>>{};
+    });
+
+    if (now < entry.until) {
+        _vstats.dentryHits++;
+        return Ok(entry.value);
+    }
+
+    _vstats.dentryMisses++;
+    auto dir = try$(Sys::Dir::open(url));
+    entry.value = dir.entries();
+    entry.until = now + DENTRY_TTL;
+    return Ok(entry.value);
+}
+
+Res<Strong<Vfs::_File>> Vfs::_open(Mime::Url const &url) {
+    auto key = url.str();
+    auto stat = try$(this->stat(url));
+    if (stat.type != Sys::Stat::FILE)
+        return Error::isADirectory();
+
+    if (auto cached = _files.get(key)) {
+        auto file = *cached;
+        if (file->stat.modifyTime == stat.modifyTime and file->stat.size == stat.size)
+            return Ok(file);
+
+        // NOTE: The file changed behind our back, the pages we have for it
+        //       are stale. It might also have been replaced, so it's opened
+        //       again below.
+        _pages.invalidate(file->id);
+    }
+
+    auto reader = try$(Sys::File::open(url));
+    auto file = makeStrong<_File>(_nextId++, reader.fd(), stat);
+    _files.access(key, [&] {
+        return file;
+    }) = file;
+    return Ok(file);
+}
+
+static Res<usize> _readAt(Vfs::_File &file, usize pos, MutBytes buf) {
+    if (file.pos != pos) {
+        try$(file.fd->seek(Io::Seek::fromBegin(pos)));
+        file.pos = pos;
+    }
+
+    usize len = 0;
+    while (len < buf.len()) {
+        auto n = try$(file.fd->read(mutNext(buf, len)));
+        if (n == 0)
+            break;
+        len += n;
+        file.pos += n;
+    }
+    return Ok(len);
+}
+
+Res<usize> Vfs::_fill(_File &file, usize page, bool referenced) {
+    auto slot = _pages.claim(file.id, page);
+    auto len = _readAt(file, page * PAGE_SIZE, _pages.buf(slot));
+    if (not len) {
+        _pages.abort(slot);
+        file.pos = Limits<usize>::MAX;
+        return len.none();
+    }
+
+    _pages.commit(slot, len.unwrap(), referenced);
+    return Ok(slot);
+}
+
+Res<Vec<Extent>> Vfs::read(Mime::Url const &url, usize off, usize len) {
+    auto file = try$(_open(url));
+    auto size = file->stat.size;
+    if (off >= size or len == 0)
+        return Ok(Vec<Extent>{});
+
+    auto budget = max(_pages.cap() / 4, 1uz);
+    len = min(len, size - off, budget * PAGE_SIZE - off % PAGE_SIZE);
+
+    usize first = off / PAGE_SIZE;
+    usize last = (off + len - 1) / PAGE_SIZE;
+
+    // NOTE: Small reads that stay on the page where the last one stopped
+    //       are still sequential.
+    if (first == file->next or first + 1 == file->next)
+        file->window = clamp(file->window * 2, READ_AHEAD_MIN, READ_AHEAD_MAX);
+    else
+        file->window = 0;
+    file->next = last + 1;
+
+    Vec<Extent> extents;
+    for (usize page = first; page <= last; page++) {
+        auto slot = _pages.lookup(file->id, page);
+        if (not slot)
+            slot = try$(_fill(*file, page, true));
+
+        usize start = page == first ? off % PAGE_SIZE : 0;
+        usize end = page == last ? (off + len - 1) % PAGE_SIZE + 1 : PAGE_SIZE;
+        end = min(end, _pages.len(*slot));
+        if (end <= start)
+            break;
+
+        extents.pushBack(Extent{*slot, _pages.gen(*slot), start, end - start});
+    }
+
+    // NOTE: Pages read ahead aren't marked as used, so the ones nobody ends
+    //       up reading are the first to go.
+    usize pages = alignUp(size, PAGE_SIZE) / PAGE_SIZE;
+    usize until = min(last + 1 + min(file->window, budget), pages);
+    for (usize page = last + 1; page < until; page++) {
+        if (_pages.contains(file->id, page))
+            continue;
+        if (not _fill(*file, page, false))
+            break;
+        _vstats.readAheads++;
+    }
+
+    return Ok(extents);
+}
+
+} // namespace Grund::Vfs
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <karm-base/box.h>
+#include <karm-base/lru.h>
+#include <karm-sys/dir.h>
+#include <karm-sys/stat.h>
+
+#include "cache.h"
+
+namespace Grund::Vfs {
+
+struct VfsStats {
+    usize readAheads;
+    usize dentryHits;
+    usize dentryMisses;
+};
+
+// Serves reads out of a PageCache filled from the host file system, and
+// keeps recent stat() and readDir() results around for a short while.
+//
+// A read that picks up where the previous one on the same file stopped
+// grows a read-ahead window, so sequential readers find the next pages
+// already cached.
+struct Vfs : public Meta::NoCopy {
+    static constexpr usize MAX_FILES = 64;
+    static constexpr usize MAX_DENTRIES = 256;
+    static constexpr usize READ_AHEAD_MIN = 4;
+    static constexpr usize READ_AHEAD_MAX = 64;
+    static constexpr TimeSpan DENTRY_TTL = TimeSpan::fromSecs(1);
+
+    struct _File {
+        u64 id;
+        Strong<Sys::Fd> fd;
+        Sys::Stat stat;
+        usize pos = 0;
+        usize next = 0;
+        usize window = 0;
+    };
+
+    template <typename T>
+    struct _Dentry {
+        T value{};
+        TimeStamp until = TimeStamp::epoch();
+    };
+
+    PageCache _pages;
+    Lru<String, Strong<_File>> _files{MAX_FILES};
+    Lru<String, _Dentry<Sys::Stat>> _stats{MAX_DENTRIES};
+    Lru<String, _Dentry<Vec<Sys::DirEntry>>> _dirs{MAX_DENTRIES};
+    u64 _nextId = 1;
+    VfsStats _vstats{};
+
+    // Creates a file system with a cache of `pages` pages.
+    static Res<Box<Vfs>> create(usize pages);
+
+    Vfs(PageCache pages)
+        : _pages(std::move(pages)) {}
+
+    PageCache &pages() {
+        return _pages;
+    }
+
+    VfsStats const &stats() const {
+        return _vstats;
+    }
+
+    Res<Sys::Stat> stat(Mime::Url const &url);
+
+    Res<Vec<Sys::DirEntry>> readDir(Mime::Url const &url);
+
+    // Makes sure the pages covering the range are cached and returns where
+    // they are. Reads past the end of the file come back short, and so do
+    // reads too large to fit in a quarter of the cache.
+    Res<Vec<Extent>> read(Mime::Url const &url, usize off, usize len);
+
+    Res<Strong<_File>> _open(Mime::Url const &url);
+
+    Res<usize> _fill(_File &file, usize page, bool referenced);
+};
+
+} // namespace Grund::Vfs
@@ -1,4 +1,4 @@
-#include <karm-sys/file.h>
+#include <karm-sys/resource.h>
 
 #include "builder.h"
 #include "mod.h"
@@ -15,8 +15,8 @@ Style::StyleSheet parseStylesheet(Io::SScan &s) {
 }
 
 Res<Style::StyleSheet> fetchStylesheet(Mime::Url url) {
-    auto file = try$(Sys::File::open(url));
-    auto buf = try$(Io::readAllUtf8(file));
+    auto map = try$(Sys::mapResource(url));
+    Str buf{reinterpret_cast<char const *>(map->bytes().buf()), map->bytes().len()};
     Io::SScan s{buf};
     return Ok(parseStylesheet(s));
 }
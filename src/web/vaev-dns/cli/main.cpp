@@ -1,5 +1,5 @@
 #include <karm-sys/entry.h>
-#include <vaev-dns/dns.h>
+#include <vaev-dns/resolver.h>
 
 Async::Task<> entryPointAsync(Sys::Context &ctx) {
     auto &args = Sys::useArgs(ctx);
@@ -7,8 +7,8 @@ Async::Task<> entryPointAsync(Sys::Context &ctx) {
         Sys::println("usage: {} <domain>", args.self());
         co_return Error::invalidInput("invalid number of arguments");
     }
-    auto dns = co_try$(Vaev::Dns::Client::connect(Vaev::Dns::GOOGLE));
-    auto addr = co_try$(dns.resolve(args[0]));
-    Sys::println("dns resolved domain '{}' to {}", args[0], addr);
+    auto addrs = co_trya$(Vaev::Dns::globalResolver().resolveAllAsync(args[0]));
+    for (auto &addr : addrs)
+        Sys::println("dns resolved domain '{}' to {}", args[0], addr);
     co_return Ok();
 }
@@ -66,12 +66,12 @@ enum OpCode : u16 {
     RCODE(NOTZONE, 9)
 
 enum RCode : u16 {
-#define ITER(NAME, VAL) NAME = VAL << 12,
+#define ITER(NAME, VAL) NAME = VAL,
     FOREACH_RCODE(ITER)
 #undef ITER
 };
 
-Str toStr(RCode code) {
+static inline Str toStr(RCode code) {
     switch (code) {
 #define ITER(NAME, VAL) \
     case RCode::NAME:   \
@@ -118,7 +118,7 @@ struct Answer {
     Buf<Byte> data;
 };
 
-Res<> encodeName(Io::BEmit &e, Str name) {
+static inline Res<> encodeName(Io::BEmit &e, Str name) {
     for (auto part : iterSplit(name, '.')) {
         e.writeU8be(part.len());
         e.writeStr(part);
@@ -127,7 +127,7 @@ Res<> encodeName(Io::BEmit &e, Str name) {
     return Ok();
 }
 
-Res<usize> decodeName(Cursor<Byte> const start, Cursor<Byte> curr, StringBuilder &out) {
+static inline Res<usize> decodeName(Cursor<Byte> const start, Cursor<Byte> curr, StringBuilder &out) {
     usize len = 0;
     while (not curr.ended()) {
         auto b = curr.next();
@@ -172,6 +172,7 @@ struct Packet {
     Flags _flags;
     Vec<Question> _qs;
     Vec<Answer> _ans;
+    Vec<Answer> _ns;
 
     Packet() = default;
 
@@ -181,15 +182,44 @@ struct Packet {
 
     Header header() const {
         Header hdr;
-        hdr.id = 420;
+        hdr.id = _id;
         hdr.flags = _flags;
         hdr.qdcount = _qs.len();
         hdr.ancount = _ans.len();
-        hdr.nscount = 0;
+        hdr.nscount = _ns.len();
         hdr.arcount = 0;
         return hdr;
     }
 
+    static Res<> _encodeRecord(Io::BEmit &e, Answer const &a) {
+        try$(encodeName(e, a.name));
+        e.writeU16be(a.type);
+        e.writeU16be(a.class_);
+        e.writeU32be(a.ttl.toSecs());
+        e.writeU16be(a.data.len());
+        e.writeBytes(a.data);
+        return Ok();
+    }
+
+    static Res<Answer> _decodeRecord(Bytes buf, Io::BScan &s) {
+        StringBuilder name;
+        s.skip(try$(decodeName(buf, s.remBytes(), name)));
+
+        if (s.rem() < 10)
+            return Error::unexpectedEof("record too short");
+
+        Answer a;
+        a.name = name.take();
+        a.type = (Type)s.nextU16be();
+        a.class_ = (Class)s.nextU16be();
+        a.ttl = TimeSpan::fromSecs(s.nextU32be());
+        auto len = s.nextU16be();
+        if (s.rem() < len)
+            return Error::unexpectedEof("record data too short");
+        a.data = s.nextBytes(len);
+        return Ok(std::move(a));
+    }
+
     static Res<Buf<Byte>> encode(Packet const &p) {
         Io::BufferWriter buf;
         Io::BEmit e(buf);
@@ -202,14 +232,11 @@ struct Packet {
             e.writeU16be(q.class_);
         }
 
-        for (auto &a : p._ans) {
-            try$(encodeName(e, a.name));
-            e.writeU16be(a.type);
-            e.writeU16be(a.class_);
-            e.writeU32be(a.ttl.toSecs());
-            e.writeU16be(a.data.len());
-            e.writeBytes(a.data);
-        }
+        for (auto &a : p._ans)
+            try$(_encodeRecord(e, a));
+
+        for (auto &a : p._ns)
+            try$(_encodeRecord(e, a));
 
         return Ok(buf.take());
     }
@@ -229,6 +256,9 @@ struct Packet {
             StringBuilder name;
             s.skip(try$(decodeName(buf, s.remBytes(), name)));
 
+            if (s.rem() < 4)
+                return Error::unexpectedEof("question too short");
+
             Question q{
                 name.take(),
                 (Type)s.nextU16be(),
@@ -238,89 +268,14 @@ struct Packet {
             qs.pushBack(std::move(q));
         }
 
-        Vec<Answer> &ans = pkt._ans;
-        for (auto i = 0; i < hdr.ancount; i++) {
-            StringBuilder name;
-            s.skip(try$(decodeName(buf, s.remBytes(), name)));
-
-            Answer a;
-            a.name = name.take();
-            a.type = (Type)s.nextU16be();
-            a.class_ = (Class)s.nextU16be();
-            a.ttl = TimeSpan::fromSecs(s.nextU32be());
-            auto len = s.nextU16be();
-            a.data = s.nextBytes(len);
+        for (auto i = 0; i < hdr.ancount; i++)
+            pkt._ans.pushBack(try$(_decodeRecord(buf, s)));
 
-            ans.pushBack(std::move(a));
-        }
+        for (auto i = 0; i < hdr.nscount; i++)
+            pkt._ns.pushBack(try$(_decodeRecord(buf, s)));
 
         return Ok(std::move(pkt));
     }
 };
 
-struct Client {
-    Sys::SocketAddr _server;
-    Sys::UdpConnection _conn;
-
-    Client(Sys::SocketAddr server, Sys::UdpConnection conn)
-        : _server(server),
-          _conn(std::move(conn)) {}
-
-    static Res<Client> connect(Sys::SocketAddr server = GOOGLE) {
-        auto conn = try$(Sys::UdpConnection::listen({Sys::Ip4::unspecified(), 0}));
-        return Ok(Client(server, std::move(conn)));
-    }
-
-    Res<Vec<Answer>> ask(Slice<Question> qs) {
-        Packet req{420, Flags::RD};
-        req._qs = qs;
-
-        logDebug("sending dns request to {}", _server);
-        try$(_conn.send(try$(Packet::encode(req)), _server));
-
-        logDebug("waiting for dns response");
-        Array<Byte, 4096> buf;
-        auto [len, addr] = try$(_conn.recv(buf));
-
-        logDebug("received dns response from {}", addr);
-        if (addr != _server)
-            return Error::invalidData("received response from wrong address");
-
-        Packet resp = try$(Packet::decode(sub(buf, 0, len)));
-
-        if (resp._id != req._id)
-            return Error::invalidData("received response with wrong id");
-
-        if (resp.header().rcode() != RCode::NO_ERROR)
-            return Error::invalidData("received response with error code");
-
-        return Ok(std::move(resp._ans));
-    }
-
-    Res<Sys::Ip> resolve(Str host) {
-        auto qs = Vec<Question>{};
-        qs.pushBack(Question{host, Type::A, Class::IN});
-
-        auto answers = try$(ask(qs));
-        if (answers.len() == 0)
-            return Error::invalidData("no answers");
-
-        auto ans = answers[0];
-        if (ans.type != Type::A)
-            return Error::invalidData("invalid answer type");
-
-        if (ans.data.len() != 4)
-            return Error::invalidData("invalid answer data");
-
-        Sys::Ip4 ip{
-            ans.data[0],
-            ans.data[1],
-            ans.data[2],
-            ans.data[3],
-        };
-
-        return Ok(ip);
-    }
-};
-
 } // namespace Vaev::Dns
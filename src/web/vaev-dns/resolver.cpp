@@ -0,0 +1,340 @@
+#include <karm-io/funcs.h>
+#include <karm-logger/logger.h>
+#include <karm-sys/file.h>
+#include <karm-sys/time.h>
+
+#include "resolver.h"
+
+namespace Vaev::Dns {
+
+// MARK: Transport -------------------------------------------------------------
+
+u16 Resolver::_Transport::nextId() {
+    while (true) {
+        u16 id = rand.nextU16();
+        if (not pending.get(id))
+            return id;
+    }
+}
+
+static Async::Task<> _receiveAsync(Strong<Resolver::_Transport> transport) {
+    Array<Byte, 4096> buf;
+    while (true) {
+        auto received = co_await transport->conn.recvAsync(mutBytes(buf));
+        if (not received) {
+            logError("dns: receive failed: {}", received.none());
+            transport->closed = true;
+
+            // NOTE: Resolving the promises resumes their queries right away,
+            //       which might start new ones.
+            auto failed = std::move(transport->pending);
+            transport->pending = {};
+            for (auto &p : failed._els)
+                p.cdr->promise.resolve(received.none());
+            co_return received.none();
+        }
+
+        auto [len, _, addr] = received.take();
+        auto pkt = Packet::decode(sub(buf, 0, len));
+        if (not pkt)
+            continue;
+
+        // NOTE: Only accept answers from the server that was asked, to the
+        //       question that was asked, anything else could be spoofed.
+        auto pending = transport->pending.get(pkt.unwrap()._id);
+        if (not pending or pending.unwrap()->server != addr)
+            continue;
+
+        auto const &qs = pkt.unwrap()._qs;
+        if (qs.len() != 1 or
+            qs[0].type != pending.unwrap()->question.type or
+            not eqCi(qs[0].name.str(), pending.unwrap()->question.name.str()))
+            continue;
+
+        transport->pending.del(pkt.unwrap()._id);
+        pending.unwrap()->promise.resolve(Ok(pkt.take()));
+    }
+}
+
+// Fails the query once `until` is reached, unless it's canceled first
+// because the query was answered.
+static Async::Task<Packet> _expireAsync(Strong<Resolver::_Transport> transport, u16 id, Strong<Resolver::_Pending> pending, TimeStamp until, Async::Cancelation::Token ct) {
+    co_trya$(Sys::globalSched().sleepAsync(until, ct));
+
+    // NOTE: Already answered, the id might belong to another query by now.
+    if (not pending->promise._state)
+        co_return Error::interrupted("dns query already done");
+
+    transport->pending.del(id);
+    pending->promise.resolve(Error::timedOut("dns query timed out"));
+    co_return Error::timedOut("dns query timed out");
+}
+
+Res<Strong<Resolver::_Transport>> Resolver::_ensureTransport() {
+    if (_transport and not _transport.unwrap()->closed)
+        return Ok(_transport.unwrap());
+
+    // NOTE: Queries go out from a random port with random ids, which is
+    //       what makes guessing them to spoof an answer hard.
+    auto conn = try$(Sys::UdpConnection::listen(Sys::Ip4::unspecified(0)));
+    auto transport = makeStrong<_Transport>(std::move(conn), Sys::now()._value ^ (usize)this);
+    Async::detach(_receiveAsync(transport));
+    _transport = transport;
+    return Ok(transport);
+}
+
+// MARK: Hosts -----------------------------------------------------------------
+
+static String _normalize(Str host) {
+    usize len = host.len();
+    if (len and host[len - 1] == '.')
+        len--;
+
+    StringBuilder sb;
+    for (usize i = 0; i < len; i++)
+        sb.append((Rune)toAsciiLower(host[i]));
+    return sb.take();
+}
+
+static Str _nextWord(Io::SScan &s) {
+    while (not s.ended() and isAsciiBlank(s.peek()))
+        s.next();
+
+    if (s.ended() or s.peek() == '#')
+        return {};
+
+    s.begin();
+    while (not s.ended() and not isAsciiBlank(s.peek()))
+        s.next();
+    return s.end();
+}
+
+void Resolver::loadHosts(Str text) {
+    for (auto line : iterSplit(text, '\n')) {
+        Io::SScan s{line};
+        auto ip = Sys::Ip::parse(_nextWord(s));
+        if (not ip)
+            continue;
+
+        while (true) {
+            auto word = _nextWord(s);
+            if (not word)
+                break;
+
+            auto name = _normalize(word);
+            auto ips = tryOr(_hosts.get(name), Vec<Sys::Ip>{});
+            ips.pushBack(ip.unwrap());
+            _hosts.put(name, ips);
+        }
+    }
+}
+
+void Resolver::_ensureHosts() {
+    if (_hostsLoaded or not _options.hosts)
+        return;
+    _hostsLoaded = true;
+
+    auto file = Sys::File::open(_options.hosts.unwrap());
+    auto hosts = file ? Io::readAllUtf8(file.unwrap()) : Res<String>{file.none()};
+    if (hosts)
+        loadHosts(hosts.unwrap());
+}
+
+// MARK: Lookup ----------------------------------------------------------------
+
+static Vec<Sys::Ip> _filter(Slice<Sys::Ip> ips, Type type) {
+    Vec<Sys::Ip> res;
+    for (auto const &ip : ips)
+        if (ip.is<Sys::Ip4>() == (type == Type::A))
+            res.pushBack(ip);
+    return res;
+}
+
+static Res<Vec<Sys::Ip>> _collect(Packet const &resp, Type type, ResolverOptions const &options, TimeStamp now, TimeStamp &expires) {
+    auto rcode = resp.header().rcode();
+    if (rcode != RCode::NO_ERROR and rcode != RCode::NAME_ERROR)
+        return Error::invalidData("dns query failed");
+
+    Vec<Sys::Ip> ips;
+    TimeSpan ttl = options.maxTtl;
+    for (auto const &a : resp._ans) {
+        // NOTE: The answer holds the whole CNAME chain, it's only valid as
+        //       long as every link of it is.
+        if (a.type == Type::CNAME) {
+            ttl = min(ttl, a.ttl);
+            continue;
+        }
+
+        if (a.type != type)
+            continue;
+
+        if (type == Type::A and a.data.len() == 4) {
+            ips.pushBack(Sys::Ip4{a.data[0], a.data[1], a.data[2], a.data[3]});
+        } else if (type == Type::AAAA and a.data.len() == 16) {
+            Array<u16, 8> words;
+            for (usize i = 0; i < 8; i++)
+                words[i] = a.data[i * 2] << 8 | a.data[i * 2 + 1];
+            ips.pushBack(Sys::Ip6{words});
+        } else {
+            continue;
+        }
+
+        ttl = min(ttl, a.ttl);
+    }
+
+    if (ips.len()) {
+        expires = now + clamp(ttl, options.minTtl, options.maxTtl);
+        return Ok(ips);
+    }
+
+    // NOTE: Negative answers are cached for as long as the SOA record of
+    //       the zone says (RFC 2308 5).
+    TimeSpan negativeTtl = options.negativeTtl;
+    for (auto const &a : resp._ns) {
+        if (a.type != Type::SOA)
+            continue;
+
+        negativeTtl = min(negativeTtl, a.ttl);
+        if (a.data.len() >= 4) {
+            auto minimum = sub(a.data, a.data.len() - 4, a.data.len());
+            negativeTtl = min(negativeTtl, TimeSpan::fromSecs(minimum[0] << 24 | minimum[1] << 16 | minimum[2] << 8 | minimum[3]));
+        }
+    }
+    expires = now + negativeTtl;
+
+    if (rcode == RCode::NAME_ERROR)
+        return Error::notFound("no such host");
+
+    return Ok(ips);
+}
+
+Async::Task<Vec<Sys::Ip>> Resolver::_queryAsync(String name, Type type, TimeStamp &expires) {
+    auto transport = co_try$(_ensureTransport());
+
+    Res<Vec<Sys::Ip>> res = Error::invalidInput("no dns servers");
+    for (usize attempt = 0; attempt < _options.attempts and _options.servers.len(); attempt++) {
+        auto server = _options.servers[attempt % _options.servers.len()];
+        auto id = transport->nextId();
+
+        Packet req{id, Flags::RD};
+        req._qs.pushBack(Question{name, type, Class::IN});
+        auto buf = co_try$(Packet::encode(req));
+
+        auto pending = makeStrong<_Pending>(server, req._qs[0]);
+        auto future = pending->promise.future();
+        transport->pending.put(id, pending);
+
+        auto sent = co_await transport->conn.sendAsync(buf, server);
+        if (not sent) {
+            transport->pending.del(id);
+            res = sent.none();
+            continue;
+        }
+
+        // NOTE: The answer cancels the timeout, so nothing outlives the
+        //       query.
+        Async::Cancelation c;
+        auto resp = co_await Async::race(
+            c,
+            Async::makeTask(std::move(future)),
+            _expireAsync(transport, id, pending, Sys::now() + _options.timeout, c.token())
+        );
+        if (not resp) {
+            logDebug("dns: {} {} to {}: {}", name, (usize)type, server, resp.none());
+            res = resp.none();
+            continue;
+        }
+
+        // NOTE: A server that fails might not be the only one.
+        res = _collect(resp.unwrap(), type, _options, Sys::now(), expires);
+        auto rcode = resp.unwrap().header().rcode();
+        if (rcode == RCode::SERVER_FAILURE or rcode == RCode::REFUSED)
+            continue;
+
+        co_return res;
+    }
+
+    co_return res;
+}
+
+Async::Task<Vec<Sys::Ip>> Resolver::lookupAsync(Str host, Type type) {
+    if (type != Type::A and type != Type::AAAA)
+        co_return Error::invalidInput("only A and AAAA records are supported");
+
+    if (auto ip = Sys::Ip::parse(host))
+        co_return Ok(_filter({&ip.unwrap(), 1}, type));
+
+    // NOTE: Names from the hosts file resolve even when there is no
+    //       network to reach a server through.
+    auto name = _normalize(host);
+    _ensureHosts();
+    if (auto ips = _hosts.get(name)) {
+        auto res = _filter(ips.unwrap(), type);
+        if (res.len())
+            co_return Ok(res);
+    }
+
+    auto key = co_try$(Io::format("{} {}", (usize)type, name));
+    auto now = Sys::now();
+    if (auto entry = _cache.get(key); entry and now < entry.unwrap().expires)
+        co_return entry.unwrap().result;
+
+    // NOTE: Someone is already asking, wait for their answer instead of
+    //       asking again.
+    if (auto waiters = _inflight.get(key)) {
+        Async::Promise<Vec<Sys::Ip>> promise;
+        auto future = promise.future();
+        waiters.unwrap()->pushBack(std::move(promise));
+        co_return co_await future;
+    }
+
+    auto waiters = makeStrong<Vec<Async::Promise<Vec<Sys::Ip>>>>();
+    _inflight.put(key, waiters);
+
+    TimeStamp expires = now;
+    auto res = co_await _queryAsync(name, type, expires);
+    if (expires > now)
+        _cache.access(key, [&] {
+            return _Entry{res, expires};
+        }) = _Entry{res, expires};
+
+    _inflight.del(key);
+    for (auto &promise : *waiters)
+        promise.resolve(res);
+
+    co_return res;
+}
+
+Async::Task<Vec<Sys::Ip>> Resolver::resolveAllAsync(Str host) {
+    auto v4 = co_await lookupAsync(host, Type::A);
+    auto v6 = co_await lookupAsync(host, Type::AAAA);
+    if (not v4 and not v6)
+        co_return v4;
+
+    Vec<Sys::Ip> res;
+    if (v4)
+        res.pushBack(v4.unwrap());
+    if (v6)
+        res.pushBack(v6.unwrap());
+    co_return Ok(res);
+}
+
+Async::Task<Sys::Ip> Resolver::resolveAsync(Str host) {
+    auto v4 = co_await lookupAsync(host, Type::A);
+    if (v4 and v4.unwrap().len())
+        co_return Ok(v4.unwrap()[0]);
+
+    auto v6 = co_trya$(lookupAsync(host, Type::AAAA));
+    if (v6.len())
+        co_return Ok(v6[0]);
+
+    co_return v4 ? Error::notFound("no address for host") : v4.none();
+}
+
+Resolver &globalResolver() {
+    // NOTE: The resolver lives on the loop it's used from, see Sys::Executor.
+    static threadLocal$ Resolver resolver;
+    return resolver;
+}
+
+} // namespace Vaev::Dns
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <karm-base/lru.h>
+#include <karm-base/map.h>
+#include <karm-base/rc.h>
+#include <karm-math/rand.h>
+#include <karm-mime/url.h>
+#include <karm-sys/async.h>
+
+#include "dns.h"
+
+namespace Vaev::Dns {
+
+struct ResolverOptions {
+    Vec<Sys::SocketAddr> servers = {GOOGLE, CLOUDFLARE};
+
+    // Every attempt goes to the next server.
+    usize attempts = 3;
+    TimeSpan timeout = TimeSpan::fromSecs(2);
+
+    TimeSpan minTtl = TimeSpan::fromSecs(5);
+    TimeSpan maxTtl = TimeSpan::fromDays(1);
+
+    // Upper bound on how long a name that doesn't exist is remembered,
+    // the SOA record of the zone usually asks for less.
+    TimeSpan negativeTtl = TimeSpan::fromMinutes(5);
+
+    usize cacheSize = 1024;
+
+    Opt<Mime::Url> hosts = "file:/etc/hosts"_url;
+};
+
+// A caching stub resolver.
+//
+// All queries go through one socket, answers are matched back to their
+// query by a random transaction id, and concurrent lookups of the same
+// name share the same query.
+struct Resolver : public Meta::NoCopy {
+    struct _Pending {
+        Sys::SocketAddr server;
+        Question question;
+        Async::Promise<Packet> promise;
+
+        _Pending(Sys::SocketAddr server, Question question)
+            : server(server), question(std::move(question)) {}
+    };
+
+    struct _Transport {
+        Sys::UdpConnection conn;
+        Map<u16, Strong<_Pending>> pending;
+        Math::Rand rand;
+        bool closed = false;
+
+        _Transport(Sys::UdpConnection conn, u64 seed)
+            : conn(std::move(conn)), rand(seed) {}
+
+        u16 nextId();
+    };
+
+    struct _Entry {
+        Res<Vec<Sys::Ip>> result;
+        TimeStamp expires;
+    };
+
+    ResolverOptions _options;
+    Opt<Strong<_Transport>> _transport;
+    Map<String, Vec<Sys::Ip>> _hosts;
+    bool _hostsLoaded = false;
+    Lru<String, _Entry> _cache;
+    Map<String, Strong<Vec<Async::Promise<Vec<Sys::Ip>>>>> _inflight;
+
+    Resolver(ResolverOptions options = {})
+        : _options(std::move(options)), _cache(_options.cacheSize) {
+        _hosts.put("localhost"s, {Sys::Ip4::localhost(), Sys::Ip6::localhost()});
+    }
+
+    // Adds overrides in the format of /etc/hosts.
+    void loadHosts(Str text);
+
+    // Returns the addresses of `host` from records of `type`, either A or
+    // AAAA.
+    Async::Task<Vec<Sys::Ip>> lookupAsync(Str host, Type type = Type::A);
+
+    // Returns the first address of `host`, preferring IPv4.
+    Async::Task<Sys::Ip> resolveAsync(Str host);
+
+    // Returns every address of `host`, IPv4 first.
+    Async::Task<Vec<Sys::Ip>> resolveAllAsync(Str host);
+
+    void _ensureHosts();
+
+    Res<Strong<_Transport>> _ensureTransport();
+
+    Async::Task<Vec<Sys::Ip>> _queryAsync(String name, Type type, TimeStamp &expires);
+};
+
+Resolver &globalResolver();
+
+} // namespace Vaev::Dns
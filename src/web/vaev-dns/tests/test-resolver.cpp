@@ -0,0 +1,135 @@
+#include <karm-test/macros.h>
+#include <vaev-dns/resolver.h>
+
+namespace Vaev::Dns::Tests {
+
+// A stand-in for a real server that knows about two names and counts how
+// many queries it was sent.
+struct _Server {
+    Sys::UdpConnection conn;
+    usize queries = 0;
+
+    _Server(Sys::UdpConnection conn)
+        : conn(std::move(conn)) {}
+};
+
+static Async::Task<> _serveAsync(Strong<_Server> server) {
+    Array<Byte, 512> buf;
+    while (true) {
+        auto [len, _, addr] = co_trya$(server->conn.recvAsync(mutBytes(buf)));
+        auto req = co_try$(Packet::decode(sub(buf, 0, len)));
+        server->queries++;
+
+        Packet resp{req._id, (Flags)(Flags::QR | Flags::RD | Flags::RA)};
+        resp._qs = req._qs;
+
+        auto const &q = req._qs[0];
+        if (q.name == "example.test" and q.type == Type::A) {
+            resp._ans.pushBack(Answer{q.name, Type::A, Class::IN, TimeSpan::fromSecs(60), {10, 0, 0, 1}});
+        } else if (q.name == "missing.test") {
+            resp._flags = (Flags)(resp._flags | RCode::NAME_ERROR);
+
+            // Everything but the last field, the minimum TTL, is zero.
+            Buf<Byte> soa = Buf<Byte>::init(22);
+            soa[21] = 30;
+            resp._ns.pushBack(Answer{"test"s, Type::SOA, Class::IN, TimeSpan::fromSecs(60), std::move(soa)});
+        }
+
+        co_trya$(server->conn.sendAsync(co_try$(Packet::encode(resp)), addr));
+    }
+}
+
+static Async::Task<> _lookupAsync(Resolver &resolver, Strong<_Server> server) {
+    // NOTE: Both lookups are started before the first one is answered, so
+    //       they should share the same query.
+    usize done = 0;
+    Async::Promise<> bothDone;
+    auto future = bothDone.future();
+    Res<Vec<Sys::Ip>> first = Error::other("not done");
+    Res<Vec<Sys::Ip>> second = Error::other("not done");
+
+    auto onDone = [&](Res<Vec<Sys::Ip>> &into) {
+        return [&](Res<Vec<Sys::Ip>> res) {
+            into = std::move(res);
+            if (++done == 2)
+                bothDone.resolve(Ok());
+        };
+    };
+    Async::detach(resolver.lookupAsync("example.test"), onDone(first));
+    Async::detach(resolver.lookupAsync("EXAMPLE.test."), onDone(second));
+    co_trya$(future);
+
+    auto ips = co_try$(first);
+    if (ips.len() != 1 or ips[0] != Sys::Ip4(10, 0, 0, 1) or co_try$(second).len() != 1)
+        co_return Error::other("unexpected answer");
+    if (server->queries != 1)
+        co_return Error::other("lookups were not coalesced");
+
+    // Answered from the cache.
+    co_trya$(resolver.lookupAsync("example.test"));
+    if (server->queries != 1)
+        co_return Error::other("answer was not cached");
+
+    // A name that doesn't exist is remembered too.
+    for (usize i = 0; i < 2; i++) {
+        auto res = co_await resolver.lookupAsync("missing.test");
+        if (res or res.none().code() != Error::NOT_FOUND)
+            co_return Error::other("expected the name to not be found");
+    }
+    if (server->queries != 2)
+        co_return Error::other("negative answer was not cached");
+
+    co_return Ok();
+}
+
+test$("dns-resolver-cache") {
+    auto addr = Sys::Ip4::localhost(53535);
+    auto server = makeStrong<_Server>(try$(Sys::UdpConnection::listen(addr)));
+    Async::detach(_serveAsync(server));
+
+    Resolver resolver{{.servers = {addr}, .timeout = TimeSpan::fromSecs(1), .hosts = NONE}};
+    try$(Sys::run(_lookupAsync(resolver, server)));
+
+    return Ok();
+}
+
+test$("dns-resolver-timeout") {
+    // NOTE: Nothing ever reads from this socket, so queries go unanswered.
+    auto addr = Sys::Ip4::localhost(53536);
+    auto silent = try$(Sys::UdpConnection::listen(addr));
+
+    Resolver resolver{{.servers = {addr}, .attempts = 1, .timeout = TimeSpan::fromMSecs(50), .hosts = NONE}};
+    auto res = Sys::run(resolver.lookupAsync("example.test"));
+    expect$(not res);
+    expectEq$(res.none().code(), Error::TIMED_OUT);
+
+    return Ok();
+}
+
+test$("dns-resolver-hosts") {
+    Resolver resolver{{.servers = {}, .hosts = NONE}};
+    resolver.loadHosts(
+        "# comment\n"
+        "10.0.0.1\texample.test alias.test # trailing\n"
+        "::1 example.test\n"
+        "not-an-ip other.test\n"
+    );
+
+    auto v4 = try$(Sys::run(resolver.lookupAsync("Alias.Test.", Type::A)));
+    expectEq$(v4.len(), 1uz);
+    expect$(v4[0] == Sys::Ip4(10, 0, 0, 1));
+
+    auto all = try$(Sys::run(resolver.resolveAllAsync("example.test")));
+    expectEq$(all.len(), 2uz);
+    expect$(all[1] == Sys::Ip6::localhost());
+
+    auto literal = try$(Sys::run(resolver.resolveAsync("192.168.1.1")));
+    expect$(literal == Sys::Ip4(192, 168, 1, 1));
+
+    expect$(not Sys::run(resolver.lookupAsync("other.test")));
+    expect$(try$(Sys::run(resolver.resolveAsync("localhost"))) == Sys::Ip4::localhost());
+
+    return Ok();
+}
+
+} // namespace Vaev::Dns::Tests
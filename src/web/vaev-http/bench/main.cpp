@@ -0,0 +1,86 @@
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+#include <vaev-http/parser.h>
+
+using namespace Vaev;
+
+static constexpr usize ROUNDS = 200000;
+
+static Str const REQUEST =
+    "GET /wiki/Hypertext_Transfer_Protocol?action=view HTTP/1.1\r\n"
+    "Host: en.wikipedia.org\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: session=4f6a1c2e9b; theme=dark; lang=en\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Cache-Control: max-age=0\r\n"
+    "\r\n";
+
+static Str const RESPONSE =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/html; charset=UTF-8\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "Cache-Control: private, max-age=0\r\n"
+    "\r\n"
+    "1a\r\n<!DOCTYPE html><html lang>\r\n"
+    "20\r\n<head><title>HTTP</title></head>\r\n"
+    "19\r\n<body><p>Hello</p></body>\r\n"
+    "7\r\n</html>\r\n"
+    "0\r\n"
+    "\r\n";
+
+// Feeds `msg` to the parser `step` bytes at a time, the way it would
+// trickle in from a slow peer.
+static Res<usize> _parse(Http::Parser &parser, Bytes msg, usize step) {
+    usize off = 0;
+    auto feed = [&] {
+        off += parser.feed(sub(msg, off, min(off + step, msg.len())));
+    };
+
+    while (not try$(parser.parseHead()))
+        feed();
+
+    usize body = 0;
+    while (not parser.done()) {
+        auto piece = try$(parser.body());
+        body += piece.len();
+        if (not piece and not parser.done())
+            feed();
+    }
+
+    return Ok(body);
+}
+
+static Res<> bench(Str name, Http::Parser::Kind kind, Str msg, usize step) {
+    Http::Parser parser{kind};
+    usize headers = 0;
+
+    auto start = Sys::now();
+    for (usize i = 0; i < ROUNDS; i++) {
+        parser.reset();
+        try$(_parse(parser, bytes(msg), step));
+        headers += parser._headers.len();
+    }
+    auto elapsed = Sys::now() - start;
+    auto usecs = max(elapsed.toUSecs(), 1uz);
+
+    // NOTE: Bytes per microsecond are megabytes per second.
+    f64 throughput = (f64)(msg.len() * ROUNDS) / usecs;
+    f64 rate = (f64)ROUNDS / usecs;
+    Sys::println("{} ({} bytes at a time): {} MB/s, {} M msg/s ({} headers)", name, step, throughput, rate, headers);
+    return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    for (usize step : {usize{1} << 20, 64uz, 7uz}) {
+        co_try$(bench("request", Http::Parser::Kind::REQUEST, REQUEST, step));
+        co_try$(bench("chunked response", Http::Parser::Kind::RESPONSE, RESPONSE, step));
+    }
+
+    co_return Ok();
+}
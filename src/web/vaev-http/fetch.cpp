@@ -1,28 +1,60 @@
+#include <karm-base/defer.h>
 #include <karm-io/funcs.h>
 #include <karm-logger/logger.h>
 #include <karm-sys/file.h>
-#include <karm-sys/socket.h>
-#include <vaev-dns/dns.h>
-#include <vaev-http/http.h>
-#include <vaev-tls/tls.h>
+#include <karm-sys/time.h>
+#include <vaev-dns/resolver.h>
 
 #include "fetch.h"
 
 namespace Vaev::Client {
 
-Async::Task<Sys::Ip> resolve(Str host) {
-    auto res = Sys::Ip::parse(host);
-    if (res)
-        co_return res;
+static usize _port(Mime::Url const &url) {
+    if (url.port)
+        return url.port.unwrap();
+    return url.scheme == "https" ? 443 : 80;
+}
+
+static bool _keepAlive(Http::Response const &resp) {
+    auto connection = resp.header("Connection");
+    if (resp.version.major == 1 and resp.version.minor == 0)
+        return connection and eqCi(connection.unwrap(), Str{"keep-alive"});
+    return not connection or not eqCi(connection.unwrap(), Str{"close"});
+}
+
+// NOTE: Pipelined requests share the stream, so their writes are queued
+//       rather than interleaved, tls couldn't take them concurrently anyway.
+static Async::Task<> _send(Client::_Connection &conn, Bytes req) {
+    if (conn.writing) {
+        Async::Promise<> promise;
+        auto future = promise.future();
+        conn.writers.pushBack(std::move(promise));
+        co_trya$(future);
+    }
 
-    if (host == "localhost")
-        co_return Ok(Sys::Ip4::localhost());
+    conn.writing = true;
+    auto res = co_await Io::writeAllAsync(conn.stream(), req);
 
-    auto dns = co_try$(Dns::Client::connect(Dns::GOOGLE));
-    co_return Ok(co_try$(dns.resolve(host)));
+    // NOTE: The next writer inherits the stream, it stays marked as busy.
+    if (conn.writers.len())
+        conn.writers.popFront().resolve(Ok());
+    else
+        conn.writing = false;
+
+    co_try$(res);
+    co_return Ok();
 }
 
-Async::Task<usize> _fetch(Mime::Url const &url, Sys::_Connection &conn, Io::Writer &out) {
+static Async::Task<usize> _exchange(Client::_Connection &conn, Mime::Url const &url, Io::Writer &out, bool &started) {
+    // NOTE: Responses come back in the order the requests were sent, so
+    //       when pipelining this one waits for the ones before it.
+    Opt<Async::Future<>> turn;
+    if (conn.inflight > 1) {
+        Async::Promise<> promise;
+        turn = promise.future();
+        conn.turns.pushBack(std::move(promise));
+    }
+
     // Send request
     logDebug("GET {} HTTP/1.1", url.path);
     Io::StringWriter req;
@@ -30,65 +62,242 @@ Async::Task<usize> _fetch(Mime::Url const &url, Sys::_Connection &conn, Io::Writ
         req,
         "GET {} HTTP/1.1\r\n"
         "Host: {}\r\n"
-        "Connection: close\r\n"
         "User-Agent: Karm Web Fetch/" stringify$(__ck_version_value) "\r\n"
                                                                      "\r\n",
         url.path,
         url.host
     ));
 
-    co_try$(conn.write(req.bytes()));
+    co_trya$(_send(conn, req.bytes()));
+
+    if (turn)
+        co_trya$(turn.take());
 
     // Read response
-    Array<char, 4096> buf;
-    auto len = co_try$(conn.read(mutBytes(buf)));
-    logDebug("Response: {}", Str{buf.buf(), len});
+    auto &parser = conn.parser;
+    while (not co_try$(parser.parseHead()))
+        parser.commit(co_trya$(conn.stream().readAsync(parser.space())));
 
-    Str respStr{buf.buf(), len};
+    started = true;
+    auto resp = co_try$(parser.response());
+    logDebug("Response: {} {}", resp.version, resp.code);
 
-    auto s = Io::SScan({buf.buf(), len});
-    auto resp = co_try$(Http::Response::parse(s));
+    // NOTE: The body of an error still has to be read for the connection
+    //       to be reused.
+    bool ok = resp.code == Http::Code::OK;
+    conn.keepAlive = _keepAlive(resp) and
+                     parser._state != Http::Parser::State::BODY_UNTIL_CLOSE;
 
-    if (resp.code != Http::Code::OK)
+    usize written = 0;
+    while (not parser.done()) {
+        auto piece = co_try$(parser.body());
+        if (piece and ok)
+            written += co_try$(out.write(piece));
+        else if (not piece and not parser.done())
+            parser.commit(co_trya$(conn.stream().readAsync(parser.space())));
+    }
+
+    parser.reset();
+
+    if (not ok)
         co_return Error::invalidData("http error");
 
-    auto contentLength = co_try$(Io::atou(co_try$(resp.headers.get("Content-Length"))));
-    auto remData = bytes(s.remStr());
-    auto written = co_try$(out.write(sub(remData, 0, contentLength)));
-    if (written < contentLength)
-        co_try$(Io::copy(conn, out, contentLength - written));
-    co_return Ok(contentLength);
+    co_return Ok(written);
 }
 
-Async::Task<usize> fetch(Mime::Url const &url, Io::Writer &out) {
-    auto ip = co_trya$(resolve(url.host));
-    auto port = url.port ? *url.port : 80;
+// MARK: Client ----------------------------------------------------------------
+
+Async::Task<usize> Client::fetch(Mime::Url const &url, Io::Writer &out) {
+    if (url.scheme != "http" and url.scheme != "https")
+        co_return Error::invalidData("unsupported scheme");
+
+    auto host = _host(url);
+    bool fresh = false;
+    while (true) {
+        auto conn = co_trya$(_acquire(*host, url, fresh));
+        bool reused = conn->served++ > 0;
+        bool started = false;
+
+        auto res = co_await _exchange(*conn, url, out, started);
+        if (not res)
+            conn->broken = true;
+        _release(*host, conn);
+
+        // NOTE: The server might have closed an idle connection under our
+        //       feet, GET is idempotent so it's safe to try again once on a
+        //       new connection.
+        if (res or started or not reused or fresh)
+            co_return res;
+
+        logDebug("{}: retrying on a new connection: {}", url, res);
+        fresh = true;
+    }
+}
+
+Async::Task<String> Client::fetchString(Mime::Url const &url) {
+    Io::BufferWriter out;
+    co_trya$(fetch(url, out));
+    co_return Ok(String{Str{(char const *)out.bytes().buf(), out.bytes().len()}});
+}
+
+Async::Task<Json::Value> Client::fetchJson(Mime::Url const &url) {
+    auto str = co_trya$(fetchString(url));
+    co_return Ok(co_try$(Json::parse(str)));
+}
+
+void Client::prune() {
+    for (usize i = 0; i < _hosts._els.len(); i++) {
+        auto &host = _hosts._els[i].cdr;
+        _prune(*host);
+
+        // NOTE: A host that is referenced from elsewhere has a fetch going
+        //       on, forgetting it would split its connection cap in two.
+        if (not host->conns.len() and host.refs() == 1)
+            _hosts._els.removeAt(i--);
+    }
+}
+
+Strong<Client::_Host> Client::_host(Mime::Url const &url) {
+    auto origin = Io::format("{}://{}:{}", url.scheme, url.host, _port(url)).unwrap();
+    if (auto host = _hosts.get(origin))
+        return host.unwrap();
+
+    prune();
+    auto host = makeStrong<_Host>();
+    _hosts.put(origin, host);
+    return host;
+}
+
+void Client::_prune(_Host &host) {
+    auto now = Sys::now();
+    for (usize i = 0; i < host.conns.len(); i++) {
+        auto &conn = host.conns[i];
+        if (conn->inflight)
+            continue;
+
+        if (conn->broken or conn->lastUsed + _options.idleTimeout < now)
+            host.conns.removeAt(i--);
+    }
+}
+
+Async::Task<Strong<Client::_Connection>> Client::_connect(Mime::Url const &url) {
+    auto ip = co_trya$(Dns::globalResolver().resolveAsync(url.host));
+    auto port = _port(url);
     if (port > 65535)
         co_return Error::invalidData("port out of range");
 
     Sys::SocketAddr addr{ip, (u16)port};
+    auto conn = makeStrong<_Connection>(co_try$(Sys::TcpConnection::connect(addr)));
+    if (url.scheme == "https")
+        conn->tls.emplace(co_try$(Tls::TlsConnection::connect(conn->tcp)));
+    co_return Ok(conn);
+}
 
-    if (url.scheme == "http") {
-        auto conn = co_try$(Sys::TcpConnection::connect(addr));
-        co_return co_await _fetch(url, conn, out);
-    } else if (url.scheme == "https") {
-        auto conn = co_try$(Sys::TcpConnection::connect(addr));
-        auto tls = co_try$(Vaev::Tls::TlsConnection::connect(conn));
-        co_return co_await _fetch(url, tls, out);
-    } else {
-        co_return Error::invalidData("unsupported scheme");
+Async::Task<Strong<Client::_Connection>> Client::_acquire(_Host &host, Mime::Url const &url, bool fresh) {
+    while (true) {
+        _prune(host);
+
+        if (not fresh) {
+            for (auto &conn : host.conns) {
+                if (not conn->broken and conn->inflight == 0) {
+                    conn->inflight++;
+                    co_return Ok(conn);
+                }
+            }
+        }
+
+        if (host.conns.len() + host.connecting < _options.maxConnectionsPerHost) {
+            // NOTE: If connecting fails or gets canceled, the slot goes to
+            //       whoever is waiting for one.
+            host.connecting++;
+            ArmedDefer giveBack{[&] {
+                host.connecting--;
+                _wake(host);
+            }};
+
+            auto conn = co_trya$(_connect(url));
+            giveBack.disarm();
+            host.connecting--;
+
+            conn->inflight++;
+            host.conns.pushBack(conn);
+            co_return Ok(conn);
+        }
+
+        // NOTE: Only pipeline on connections the server said it would keep
+        //       open, and to the least busy of them.
+        if (not fresh) {
+            Opt<Strong<_Connection>> best;
+            for (auto &conn : host.conns) {
+                if (conn->broken or not conn->keepAlive)
+                    continue;
+                if (conn->inflight >= _options.maxPipelineDepth)
+                    continue;
+                if (not best or conn->inflight < best.unwrap()->inflight)
+                    best = conn;
+            }
+
+            if (best) {
+                best.unwrap()->inflight++;
+                co_return Ok(best.take());
+            }
+        }
+
+        Async::Promise<> promise;
+        auto future = promise.future();
+        host.waiters.pushBack(std::move(promise));
+        co_trya$(future);
     }
 }
 
+void Client::_release(_Host &host, Strong<_Connection> conn) {
+    conn->inflight--;
+    conn->lastUsed = Sys::now();
+
+    if (not conn->keepAlive)
+        conn->broken = true;
+
+    // NOTE: Resolving the promises resumes whoever waits on them right
+    //       away, so they are taken out first.
+    Vec<Async::Promise<>> turns;
+    if (conn->broken) {
+        turns = std::move(conn->turns);
+        if (conn->inflight == 0)
+            _prune(host);
+    } else if (conn->turns.len()) {
+        turns.pushBack(conn->turns.popFront());
+    }
+
+    for (auto &turn : turns)
+        turn.resolve(conn->broken ? Res<>{Error::brokenPipe("connection closed")} : Res<>{Ok()});
+
+    _wake(host);
+}
+
+void Client::_wake(_Host &host) {
+    if (host.waiters.len())
+        host.waiters.popFront().resolve(Ok());
+}
+
+Client &globalClient() {
+    // NOTE: Connections belong to the loop that opened them, so each loop
+    //       has its own pool, see Sys::Executor.
+    static threadLocal$ Client client;
+    return client;
+}
+
+// MARK: Fetch -----------------------------------------------------------------
+
+Async::Task<usize> fetch(Mime::Url const &url, Io::Writer &out) {
+    return globalClient().fetch(url, out);
+}
+
 Async::Task<String> fetchString(Mime::Url const &url) {
-    Io::StringWriter out;
-    co_trya$(fetch(url, out));
-    co_return Ok(out.take());
+    return globalClient().fetchString(url);
 }
 
 Async::Task<Json::Value> fetchJson(Mime::Url const &url) {
-    auto str = co_trya$(fetchString(url));
-    co_return Ok(co_try$(Json::parse(str)));
+    return globalClient().fetchJson(url);
 }
 
 } // namespace Vaev::Client
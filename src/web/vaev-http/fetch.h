@@ -1,11 +1,94 @@
 #pragma once
 
+#include <karm-base/map.h>
+#include <karm-base/rc.h>
 #include <karm-mime/url.h>
 #include <karm-sys/async.h>
+#include <karm-sys/socket.h>
 #include <vaev-json/json.h>
+#include <vaev-tls/tls.h>
+
+#include "parser.h"
 
 namespace Vaev::Client {
 
+struct Options {
+    usize maxConnectionsPerHost = 6;
+
+    // How many requests can be in flight on one connection, one disables
+    // pipelining.
+    usize maxPipelineDepth = 4;
+
+    TimeSpan idleTimeout = TimeSpan::fromSecs(30);
+};
+
+// An HTTP/1.1 client that keeps connections to every origin open between
+// requests, so fetching many resources from the same host only pays for
+// the TCP and TLS handshakes once. It can be shared by any number of
+// coroutines on the same scheduler.
+struct Client : public Meta::NoCopy {
+    struct _Connection {
+        Sys::TcpConnection tcp;
+        Opt<Tls::TlsConnection> tls;
+        Http::Parser parser{Http::Parser::Kind::RESPONSE};
+
+        usize served = 0;
+        usize inflight = 0;
+        Vec<Async::Promise<>> turns;
+        bool writing = false;
+        Vec<Async::Promise<>> writers;
+        bool keepAlive = false;
+        bool broken = false;
+        TimeStamp lastUsed = TimeStamp::epoch();
+
+        _Connection(Sys::TcpConnection tcp)
+            : tcp(std::move(tcp)) {}
+
+        Sys::_Connection &stream() {
+            if (tls)
+                return tls.unwrap();
+            return tcp;
+        }
+    };
+
+    struct _Host {
+        Vec<Strong<_Connection>> conns;
+        usize connecting = 0;
+        Vec<Async::Promise<>> waiters;
+    };
+
+    Options _options;
+    Map<String, Strong<_Host>> _hosts;
+
+    Client(Options options = {})
+        : _options(options) {}
+
+    Async::Task<usize> fetch(Mime::Url const &url, Io::Writer &out);
+
+    Async::Task<String> fetchString(Mime::Url const &url);
+
+    Async::Task<Json::Value> fetchJson(Mime::Url const &url);
+
+    // Closes the connections that have been idle for longer than the
+    // timeout, and forgets the hosts that are left without any, this also
+    // happens whenever a host is fetched from or a new one is added.
+    void prune();
+
+    Strong<_Host> _host(Mime::Url const &url);
+
+    void _prune(_Host &host);
+
+    Async::Task<Strong<_Connection>> _connect(Mime::Url const &url);
+
+    Async::Task<Strong<_Connection>> _acquire(_Host &host, Mime::Url const &url, bool fresh);
+
+    void _release(_Host &host, Strong<_Connection> conn);
+
+    void _wake(_Host &host);
+};
+
+Client &globalClient();
+
 Async::Task<usize> fetch(Mime::Url const &url, Io::Writer &out);
 
 Async::Task<String> fetchString(Mime::Url const &url);
@@ -1,8 +1,8 @@
 #pragma once
 
 #include <karm-base/distinct.h>
-#include <karm-base/map.h>
 #include <karm-base/std.h>
+#include <karm-base/vec.h>
 #include <karm-io/fmt.h>
 #include <karm-mime/url.h>
 
@@ -173,40 +173,15 @@ struct Version {
 };
 
 struct Header {
-    Map<Str, Str> headers;
-
-    Res<> _parse(Io::SScan &s) {
-        while (not s.ended()) {
-            Str key, value;
-
-            auto RE_ENDLINE =
-                Re::zeroOrMore(' '_re) & "\r\n"_re;
-
-            auto RE_SEPARATOR =
-                Re::separator(':'_re);
-
-            auto RE_KEY_VALUE =
-                Re::token(
-                    key,
-                    Re::until(RE_SEPARATOR)
-                ) &
-                RE_SEPARATOR &
-                Re::token(
-                    value,
-                    Re::until(RE_ENDLINE)
-                ) &
-                RE_ENDLINE;
-
-            if (not s.skip(RE_KEY_VALUE))
-                return Error::invalidData("Expected header");
-
-            headers.put(key, value);
-
-            if (s.skip("\r\n"))
-                break;
-        }
-
-        return Ok();
+    // NOTE: These are views into the buffer the message was parsed from.
+    Vec<Cons<Str, Str>> headers;
+
+    // Field names are case-insensitive (RFC 9110 5.1).
+    Opt<Str> header(Str key) const {
+        for (auto const &h : headers)
+            if (eqCi(h.car, key))
+                return h.cdr;
+        return NONE;
     }
 };
 
@@ -214,57 +189,11 @@ struct Request : public Header {
     Method method;
     Mime::Path path;
     Version version;
-
-    static Res<Request> parse(Io::SScan &s) {
-        Request req;
-
-        req.method = try$(parseMethod(s));
-
-        if (not s.skip(' '))
-            return Error::invalidData("Expected space");
-
-        req.path = Mime::Path::parse(s, true, true);
-        req.path.rooted = true;
-        req.path.normalize();
-        req.path.rooted = false;
-
-        if (not s.skip(' '))
-            return Error::invalidData("Expected space");
-
-        req.version = try$(Version::parse(s));
-
-        if (not s.skip("\r\n"))
-            return Error::invalidData("Expected \"\\r\\n\"");
-
-        try$(req._parse(s));
-
-        return Ok(req);
-    }
 };
 
 struct Response : public Header {
     Version version;
     Code code;
-
-    static Res<Response> parse(Io::SScan &s) {
-        Response res;
-
-        res.version = try$(Version::parse(s));
-
-        if (not s.skip(' '))
-            return Error::invalidData("Expected space");
-
-        res.code = try$(parseCode(s));
-
-        if (not s.skip(' '))
-            return Error::invalidData("Expected space");
-
-        s.skip(Re::untilAndConsume("\r\n"_re));
-
-        try$(res._parse(s));
-
-        return Ok(res);
-    }
 };
 
 } // namespace Vaev::Http
@@ -0,0 +1,397 @@
+#include "parser.h"
+
+namespace Vaev::Http {
+
+Parser::Parser(Kind kind, Method method)
+    : _kind(kind), _bodyless(method == Method::HEAD) {
+    _buf.resize(MIN_READ);
+}
+
+// MARK: Input -----------------------------------------------------------------
+
+MutBytes Parser::space() {
+    if (_state == State::START_LINE or _state == State::HEADERS) {
+        // NOTE: The head has to stay in one piece for the views into it to
+        //       work, so the buffer grows until it fits.
+        if (_buf.len() - _len < MIN_READ / 2)
+            _buf.resize(clamp(_buf.len() * 2, MIN_READ, MAX_HEAD));
+    } else if (_pos > _head) {
+        // NOTE: The body is consumed as it's handed out, what's left of it
+        //       moves back to right after the head.
+        usize shift = _pos - _head;
+        copyWithin(mutSub(_buf), urange::fromStartEnd(_pos, _len), _head);
+        _len -= shift;
+        _scan -= shift;
+        _pos = _head;
+    }
+
+    return mutSub(_buf, _len, _buf.len());
+}
+
+void Parser::commit(usize len) {
+    if (len == 0)
+        _eof = true;
+    _len = min(_len + len, _buf.len());
+}
+
+usize Parser::feed(Bytes bytes) {
+    auto n = copy(bytes, space());
+    if (n)
+        commit(n);
+    return n;
+}
+
+void Parser::reset() {
+    _pos += _taken;
+    copyWithin(mutSub(_buf), urange::fromStartEnd(_pos, _len), 0);
+    _len -= _pos;
+    _pos = 0;
+    _scan = 0;
+    _head = 0;
+    _taken = 0;
+    _remaining = 0;
+    _startLine = {};
+    _headers.clear();
+    _state = State::START_LINE;
+}
+
+// MARK: Head ------------------------------------------------------------------
+
+Res<bool> Parser::parseHead() {
+    while (_state == State::START_LINE or _state == State::HEADERS) {
+        auto maybeLine = _nextLine();
+        if (not maybeLine) {
+            if (_len >= MAX_HEAD)
+                return Error::invalidData("head too large");
+            if (_eof)
+                return Error::invalidData("unexpected end of stream");
+            return Ok(false);
+        }
+
+        auto line = maybeLine.unwrap();
+        if (_state == State::START_LINE) {
+            // NOTE: Empty lines before the start line should be ignored
+            //       (RFC 9112 2.2).
+            if (line.empty())
+                continue;
+            try$(_parseStartLine(line));
+            _state = State::HEADERS;
+        } else if (line.empty()) {
+            try$(_parseFraming());
+        } else {
+            try$(_parseHeader(line));
+        }
+    }
+
+    return Ok(true);
+}
+
+Str Parser::_str(urange range) const {
+    return {(char const *)_buf.buf() + range.start, range.size};
+}
+
+Opt<urange> Parser::_nextLine() {
+    for (; _scan < _len; _scan++) {
+        if (_buf[_scan] != '\n')
+            continue;
+
+        // NOTE: A bare LF is accepted as a line ending (RFC 9112 2.2).
+        usize end = _scan;
+        if (end > _pos and _buf[end - 1] == '\r')
+            end--;
+
+        auto line = urange::fromStartEnd(_pos, end);
+        _pos = ++_scan;
+        return line;
+    }
+
+    return NONE;
+}
+
+Res<> Parser::_parseStartLine(urange line) {
+    usize sp1 = line.end();
+    usize sp2 = line.end();
+    for (usize i = line.start; i < line.end(); i++) {
+        if (_buf[i] != ' ')
+            continue;
+
+        if (sp1 == line.end()) {
+            sp1 = i;
+        } else {
+            sp2 = i;
+            break;
+        }
+    }
+
+    // NOTE: The reason phrase of a response can be missing, but not the
+    //       version of a request.
+    if (sp1 == line.end() or (_kind == Kind::REQUEST and sp2 == line.end()))
+        return Error::invalidData("malformed start line");
+
+    _startLine[0] = urange::fromStartEnd(line.start, sp1);
+    _startLine[1] = urange::fromStartEnd(sp1 + 1, sp2);
+    _startLine[2] = urange::fromStartEnd(min(sp2 + 1, line.end()), line.end());
+    return Ok();
+}
+
+Res<> Parser::_parseHeader(urange line) {
+    if (isAsciiBlank(_buf[line.start]))
+        return Error::invalidData("obsolete line folding");
+
+    if (_headers.len() >= MAX_HEADERS)
+        return Error::invalidData("too many headers");
+
+    usize colon = line.start;
+    while (colon < line.end() and _buf[colon] != ':')
+        colon++;
+
+    if (colon == line.end() or colon == line.start)
+        return Error::invalidData("expected header");
+
+    if (isAsciiBlank(_buf[colon - 1]))
+        return Error::invalidData("whitespace before colon");
+
+    usize start = colon + 1;
+    usize end = line.end();
+    while (start < end and isAsciiBlank(_buf[start]))
+        start++;
+    while (end > start and isAsciiBlank(_buf[end - 1]))
+        end--;
+
+    _headers.pushBack({
+        urange::fromStartEnd(line.start, colon),
+        urange::fromStartEnd(start, end),
+    });
+    return Ok();
+}
+
+static bool _endsWithChunked(Str codings) {
+    usize end = codings.len();
+    while (end and isAsciiBlank(codings[end - 1]))
+        end--;
+
+    usize start = end;
+    while (start and codings[start - 1] != ',')
+        start--;
+    while (start < end and isAsciiBlank(codings[start]))
+        start++;
+
+    return eqCi(Str{codings.buf() + start, end - start}, Str{"chunked"});
+}
+
+static Res<usize> _parseLength(Str str) {
+    // NOTE: Long enough for any sensible body, short enough to never
+    //       overflow.
+    if (not str or str.len() > 18)
+        return Error::invalidData("invalid content length");
+
+    usize len = 0;
+    for (usize i = 0; i < str.len(); i++) {
+        char c = str[i];
+        if (not isAsciiDigit(c))
+            return Error::invalidData("invalid content length");
+        len = len * 10 + (c - '0');
+    }
+    return Ok(len);
+}
+
+Res<> Parser::_parseFraming() {
+    // RFC 9112 6.3, Message Body Length
+    _head = _pos;
+
+    // NOTE: Leave room for the body, the buffer is never resized again
+    //       while the views into the head are handed out.
+    if (_buf.len() < _head + MIN_READ)
+        _buf.resize(_head + MIN_READ);
+
+    if (_kind == Kind::RESPONSE) {
+        Io::SScan s{_str(_startLine[1])};
+        auto code = (u16)try$(parseCode(s));
+        if (_bodyless or code < 200 or code == 204 or code == 304) {
+            _state = State::DONE;
+            return Ok();
+        }
+    }
+
+    if (auto te = header("Transfer-Encoding")) {
+        if (_endsWithChunked(te.unwrap())) {
+            _state = State::CHUNK_SIZE;
+            return Ok();
+        }
+
+        // NOTE: Anything else can only be delimited by closing the
+        //       connection, which a client can't do to a server.
+        if (_kind == Kind::REQUEST)
+            return Error::invalidData("unsupported transfer coding");
+
+        _state = State::BODY_UNTIL_CLOSE;
+        return Ok();
+    }
+
+    if (auto cl = header("Content-Length")) {
+        _remaining = try$(_parseLength(cl.unwrap()));
+        _state = _remaining ? State::BODY : State::DONE;
+        return Ok();
+    }
+
+    _state = _kind == Kind::REQUEST ? State::DONE : State::BODY_UNTIL_CLOSE;
+    return Ok();
+}
+
+Opt<Str> Parser::header(Str key) const {
+    for (auto const &h : _headers)
+        if (eqCi(_str(h.car), key))
+            return _str(h.cdr);
+    return NONE;
+}
+
+Res<Request> Parser::request() const {
+    if (_kind != Kind::REQUEST)
+        return Error::invalidInput("not a request");
+
+    Request req;
+
+    Io::SScan method{_str(_startLine[0])};
+    req.method = try$(parseMethod(method));
+    if (not method.ended())
+        return Error::invalidData("expected method");
+
+    Io::SScan path{_str(_startLine[1])};
+    req.path = Mime::Path::parse(path, true, true);
+    req.path.rooted = true;
+    req.path.normalize();
+    req.path.rooted = false;
+
+    Io::SScan version{_str(_startLine[2])};
+    req.version = try$(Version::parse(version));
+
+    for (auto const &h : _headers)
+        req.headers.pushBack({_str(h.car), _str(h.cdr)});
+
+    return Ok(req);
+}
+
+Res<Response> Parser::response() const {
+    if (_kind != Kind::RESPONSE)
+        return Error::invalidInput("not a response");
+
+    Response res;
+
+    Io::SScan version{_str(_startLine[0])};
+    res.version = try$(Version::parse(version));
+
+    Io::SScan code{_str(_startLine[1])};
+    res.code = try$(parseCode(code));
+
+    for (auto const &h : _headers)
+        res.headers.pushBack({_str(h.car), _str(h.cdr)});
+
+    return Ok(res);
+}
+
+// MARK: Body ------------------------------------------------------------------
+
+static Res<usize> _parseChunkSize(Str line) {
+    usize size = 0;
+    usize digits = 0;
+    for (usize i = 0; i < line.len(); i++) {
+        char c = line[i];
+        // NOTE: Chunk extensions are ignored.
+        if (c == ';' or isAsciiBlank(c))
+            break;
+
+        if (not isAsciiHexDigit(c) or ++digits > 15)
+            return Error::invalidData("invalid chunk size");
+
+        size = size * 16 + (isAsciiDigit(c) ? c - '0' : toAsciiLower(c) - 'a' + 10);
+    }
+
+    if (not digits)
+        return Error::invalidData("invalid chunk size");
+
+    return Ok(size);
+}
+
+Res<Bytes> Parser::body() {
+    _pos += _taken;
+    _scan = max(_scan, _pos);
+    _taken = 0;
+
+    while (true) {
+        switch (_state) {
+        case State::BODY:
+        case State::CHUNK_DATA: {
+            usize n = min(_remaining, _len - _pos);
+            if (n == 0)
+                return _needMore();
+
+            _remaining -= n;
+            if (_remaining == 0)
+                _state = _state == State::BODY ? State::DONE : State::CHUNK_END;
+
+            _taken = n;
+            return Ok(sub(_buf, _pos, _pos + n));
+        }
+
+        case State::BODY_UNTIL_CLOSE: {
+            if (_pos < _len) {
+                _taken = _len - _pos;
+                return Ok(sub(_buf, _pos, _len));
+            }
+
+            if (_eof)
+                _state = State::DONE;
+            return Ok(Bytes{});
+        }
+
+        case State::CHUNK_SIZE: {
+            auto line = _nextLine();
+            if (not line)
+                return _needMore();
+            _remaining = try$(_parseChunkSize(_str(line.unwrap())));
+            _state = _remaining ? State::CHUNK_DATA : State::TRAILERS;
+            break;
+        }
+
+        case State::CHUNK_END: {
+            auto line = _nextLine();
+            if (not line)
+                return _needMore();
+            if (line->any())
+                return Error::invalidData("expected end of chunk");
+            _state = State::CHUNK_SIZE;
+            break;
+        }
+
+        case State::TRAILERS: {
+            // NOTE: Trailer fields are dropped, nothing we do needs them.
+            auto line = _nextLine();
+            if (not line)
+                return _needMore();
+            if (line->empty())
+                _state = State::DONE;
+            break;
+        }
+
+        case State::DONE:
+            return Ok(Bytes{});
+
+        default:
+            return Error::invalidInput("head not parsed");
+        }
+    }
+}
+
+Res<Bytes> Parser::_needMore() const {
+    // NOTE: There is always room for this much after the head, a line that
+    //       doesn't fit is never going to end.
+    if (_len - _pos >= MIN_READ)
+        return Error::invalidData("line too long");
+
+    if (_eof)
+        return Error::invalidData("unexpected end of stream");
+
+    return Ok(Bytes{});
+}
+
+} // namespace Vaev::Http
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "http.h"
+
+namespace Vaev::Http {
+
+// Incremental HTTP/1.1 message parser.
+//
+// Bytes are read straight into the parser's own buffer, see space() and
+// commit(), and parsing resumes where it stopped every time more of them
+// arrive. The start line and the headers are kept as views into that buffer
+// and the body is handed out one piece at a time, so it can be larger than
+// the buffer, and chunked bodies are decoded in place.
+struct Parser {
+    enum struct Kind : u8 {
+        REQUEST,
+        RESPONSE,
+    };
+
+    enum struct State : u8 {
+        START_LINE,
+        HEADERS,
+        BODY,
+        BODY_UNTIL_CLOSE,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_END,
+        TRAILERS,
+        DONE,
+    };
+
+    static constexpr usize MIN_READ = 4096;
+    static constexpr usize MAX_HEAD = 64 * 1024;
+    static constexpr usize MAX_HEADERS = 128;
+
+    Kind _kind;
+    bool _bodyless = false;
+    bool _eof = false;
+    State _state = State::START_LINE;
+
+    Vec<u8> _buf;
+    usize _len = 0;   // Bytes read into the buffer
+    usize _pos = 0;   // Bytes consumed by the parser
+    usize _scan = 0;  // Where to resume looking for the end of the line
+    usize _head = 0;  // End of the head, the body is parsed after it
+    usize _taken = 0; // Length of the last piece of body handed out
+
+    Array<urange, 3> _startLine{};
+    Vec<Cons<urange, urange>> _headers;
+    usize _remaining = 0; // In the body or the current chunk
+
+    // NOTE: Whether a response has a body depends on the method of the
+    //       request it answers, responses to HEAD never have one.
+    Parser(Kind kind, Method method = Method::GET);
+
+    // MARK: Input -------------------------------------------------------------
+
+    // Where the next bytes should be read into.
+    MutBytes space();
+
+    // Marks `len` bytes of space() as read, committing zero bytes means the
+    // peer closed the connection.
+    void commit(usize len);
+
+    // Copies as much of `bytes` as fits in the buffer.
+    usize feed(Bytes bytes);
+
+    // Bytes that were read but not parsed yet.
+    Bytes pending() const {
+        return sub(_buf, _pos, _len);
+    }
+
+    // Starts over with the next message on the same connection, keeping
+    // whatever was read past the end of this one.
+    void reset();
+
+    // MARK: Head --------------------------------------------------------------
+
+    // Parses as much of the head as was read, returns true once it's
+    // complete. The views it hands out are valid until reset().
+    Res<bool> parseHead();
+
+    Str _str(urange range) const;
+
+    Opt<urange> _nextLine();
+
+    Res<> _parseStartLine(urange line);
+
+    Res<> _parseHeader(urange line);
+
+    Res<> _parseFraming();
+
+    Opt<Str> header(Str key) const;
+
+    Res<Request> request() const;
+
+    Res<Response> response() const;
+
+    // MARK: Body --------------------------------------------------------------
+
+    // Returns the next piece of the body, it is consumed by the next call. An
+    // empty piece means more bytes have to be read, unless done().
+    Res<Bytes> body();
+
+    Res<Bytes> _needMore() const;
+
+    bool done() const {
+        return _state == State::DONE;
+    }
+};
+
+} // namespace Vaev::Http
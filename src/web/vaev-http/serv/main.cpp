@@ -2,14 +2,48 @@
 #include <karm-logger/logger.h>
 #include <karm-mime/mime.h>
 #include <karm-sys/entry.h>
+#include <karm-sys/executor.h>
 #include <karm-sys/file.h>
 #include <karm-sys/socket.h>
-#include <vaev-http/http.h>
+#include <karm-sys/time.h>
+#include <vaev-http/parser.h>
 #include <vaev-tls/tls.h>
 
 namespace Vaev::Server {
 
-Async::Task<> respondFile(Sys::_Connection &conn, Mime::Url const &url, Http::Code code = Http::Code::OK) {
+// Connections served at the same time by each loop.
+static constexpr usize MAX_CONNECTIONS = 1024;
+
+// Time a client has to send the head of its request.
+static constexpr TimeSpan HEAD_TIMEOUT = TimeSpan::fromSecs(10);
+
+// Time a client has to take in the whole response.
+static constexpr TimeSpan RESPONSE_TIMEOUT = TimeSpan::fromSecs(60);
+
+// Reads more of the request, a client that is too slow to send it gets
+// disconnected instead of holding on to its connection.
+Async::Task<usize> readAsync(Sys::_Connection &conn, MutBytes buf, TimeStamp deadline, Async::Cancelation::Token ct) {
+    Async::Cancelation c{ct};
+    co_return co_await Sys::timeoutAsync(deadline, c, conn.readAsync(buf, c.token()));
+}
+
+// Writes the response, a client that stops reading it gets disconnected
+// as well, rather than keeping its slot forever.
+struct ResponseWriter : public Io::AsyncWriter {
+    Sys::_Connection &_conn;
+    TimeStamp _deadline;
+    Async::Cancelation::Token _ct;
+
+    ResponseWriter(Sys::_Connection &conn, TimeStamp deadline, Async::Cancelation::Token ct)
+        : _conn(conn), _deadline(deadline), _ct(ct) {}
+
+    Async::Task<usize> writeAsync(Bytes buf) override {
+        Async::Cancelation c{_ct};
+        co_return co_await Sys::timeoutAsync(_deadline, c, _conn.writeAsync(buf, c.token()));
+    }
+};
+
+Async::Task<> respondFile(ResponseWriter &out, Mime::Url const &url, Http::Code code = Http::Code::OK) {
     auto ct = tryOr(Mime::sniffSuffix(url.path.suffix()), "application/octet-stream"_mime);
     auto file = co_try$(Sys::File::open(url));
     auto stat = co_try$(file.stat());
@@ -29,13 +63,13 @@ Async::Task<> respondFile(Sys::_Connection &conn, Mime::Url const &url, Http::Co
         stat.size
     ));
 
-    co_try$(conn.write(header.bytes()));
-    co_try$(Io::copy(file, conn));
+    co_trya$(Io::writeAllAsync(out, header.bytes()));
+    co_trya$(Io::copyAsync(file, out));
     co_return Ok();
 }
 
-Async::Task<> respond404(Sys::_Connection &conn) {
-    auto res = co_await respondFile(conn, "bundle://vaev-http-serv/public/404.html"_url, Http::Code::NOT_FOUND);
+Async::Task<> respond404(ResponseWriter &out) {
+    auto res = co_await respondFile(out, "bundle://vaev-http-serv/public/404.html"_url, Http::Code::NOT_FOUND);
     if (res)
         co_return Ok();
 
@@ -51,48 +85,80 @@ Async::Task<> respond404(Sys::_Connection &conn) {
         "Not Found"
     ));
 
-    co_trya$(conn.writeAsync(header.bytes()));
+    co_trya$(Io::writeAllAsync(out, header.bytes()));
     co_return Ok();
 }
 
-Async::Task<> handleRequest(Sys::_Connection &conn, Str request, Sys::SocketAddr addr) {
-    Io::SScan scan{request};
-    auto req = co_try$(Http::Request::parse(scan));
+Async::Task<> handleRequest(Sys::_Connection &conn, Http::Parser &parser, Sys::SocketAddr addr, TimeStamp deadline, Async::Cancelation::Token ct) {
+    while (not co_try$(parser.parseHead()))
+        parser.commit(co_trya$(readAsync(conn, parser.space(), deadline, ct)));
+
+    auto req = co_try$(parser.request());
     auto url = "bundle://vaev-http-serv/public/"_url / req.path;
 
     logInfo("{}: {} {}", addr, req.method, req.path);
 
-    Res<> firstRes = co_await respondFile(conn, url, Http::Code::OK);
+    // NOTE: Once the loop is warmed up, the frames of a request should all
+    //       be recycled ones.
+    auto const &frames = Async::frameStats();
+    logDebug("{}: {} frames allocated, {} reused on this loop", addr, frames.allocs, frames.reuses);
+
+    ResponseWriter out{conn, Sys::now() + RESPONSE_TIMEOUT, ct};
+    Res<> firstRes = co_await respondFile(out, url, Http::Code::OK);
     if (firstRes) {
         co_return Ok();
     }
 
-    Res<> res = co_await respondFile(conn, url / "index.html", Http::Code::OK);
+    Res<> res = co_await respondFile(out, url / "index.html", Http::Code::OK);
     if (res)
         co_return Ok();
 
     logWarn("{}: {} {}: {}", addr, req.method, url, firstRes);
-    co_return co_await respond404(conn);
+    co_return co_await respond404(out);
 }
 
-Async::Task<> handleConnection(Sys::TcpConnection stream) {
-    Array<char, 4096> buf;
-    auto len = co_trya$(stream.readAsync(mutBytes(buf)));
-    if (not Tls::isHello(bytes(buf))) {
-        co_return co_await handleRequest(stream, Str{buf.buf(), len}, stream.addr());
+Async::Task<> handleConnection(Sys::TcpConnection stream, Async::Cancelation::Token ct) {
+    auto deadline = Sys::now() + HEAD_TIMEOUT;
+    Http::Parser parser{Http::Parser::Kind::REQUEST};
+    parser.commit(co_trya$(readAsync(stream, parser.space(), deadline, ct)));
+    if (not Tls::isHello(parser.pending())) {
+        co_return co_await handleRequest(stream, parser, stream.addr(), deadline, ct);
     } else {
         logDebug("{}: wants TLS", stream.addr());
-        auto tls = co_try$(Tls::TlsConnection::accept(stream, bytes(buf)));
-        len = co_trya$(tls.readAsync(mutBytes(buf)));
-        co_return co_await handleRequest(tls, Str{buf.buf(), len}, stream.addr());
+        auto tls = co_try$(Tls::TlsConnection::accept(stream, parser.pending()));
+        Http::Parser tlsParser{Http::Parser::Kind::REQUEST};
+        co_return co_await handleRequest(tls, tlsParser, stream.addr(), deadline, ct);
+    }
+}
+
+Async::Task<> serveAsync(Sys::SocketAddr addr) {
+    // NOTE: Every loop has its own listener on the same port and the kernel
+    //       spreads the connections between them.
+    auto listener = co_try$(Sys::TcpListener::listen(addr, true));
+
+    // NOTE: Accepting waits for a free slot, so a flood of clients queues
+    //       up in the kernel instead of piling up coroutines here.
+    Async::Group group{MAX_CONNECTIONS};
+    while (true) {
+        auto stream = co_await listener.acceptAsync(group.token());
+        if (not stream) {
+            group.cancel();
+            co_trya$(group.joinAsync());
+            co_return stream.none();
+        }
+        co_trya$(group.spawnAsync(handleConnection(stream.take(), group.token())));
     }
 }
 
 } // namespace Vaev::Server
 
 Async::Task<> entryPointAsync(Sys::Context &) {
-    auto listener = co_try$(Sys::TcpListener::listen(Sys::Ip4::localhost(8080)));
-    logInfo("Serving on http://{}", listener.addr());
-    while (true)
-        Async::detach(Vaev::Server::handleConnection(co_trya$(listener.acceptAsync())));
+    auto addr = Sys::Ip4::localhost(8080);
+    auto exec = co_try$(Sys::Executor::create());
+    exec->spawnEach([&](usize) {
+        return Vaev::Server::serveAsync(addr);
+    });
+
+    logInfo("Serving on http://{} from {} loops", addr, exec->len());
+    co_return exec->join();
 }
@@ -0,0 +1,127 @@
+#include <karm-sys/socket.h>
+#include <karm-sys/time.h>
+#include <karm-test/macros.h>
+#include <vaev-http/fetch.h>
+
+namespace Vaev::Client::Tests {
+
+// Answers every request with its own path, on the loopback.
+struct _Server {
+    Sys::TcpListener listener;
+    usize accepted = 0;
+    usize requests = 0;
+
+    // Requests are only answered once that many of them arrived on the
+    // connection, which never happens unless the client pipelines them.
+    usize batch = 1;
+
+    static Res<_Server> listen(u16 port) {
+        return Ok(_Server{try$(Sys::TcpListener::listen({Sys::Ip4::localhost(), port}))});
+    }
+};
+
+static Async::Task<> _serveAsync(_Server &server, Sys::TcpConnection conn) {
+    Http::Parser parser{Http::Parser::Kind::REQUEST};
+    Vec<String> paths;
+
+    while (true) {
+        while (not co_try$(parser.parseHead())) {
+            auto n = co_trya$(conn.readAsync(parser.space()));
+            if (not n)
+                co_return Ok();
+            parser.commit(n);
+        }
+
+        auto req = co_try$(parser.request());
+        paths.pushBack(co_try$(Io::format("{}", req.path)));
+        parser.reset();
+        server.requests++;
+
+        if (paths.len() < server.batch)
+            continue;
+
+        for (auto &path : paths) {
+            auto resp = co_try$(Io::format("HTTP/1.1 200 OK\r\nContent-Length: {}\r\n\r\n{}", path.len(), path));
+            co_trya$(Io::writeAllAsync(conn, bytes(resp)));
+        }
+        paths.clear();
+    }
+}
+
+static Async::Task<> _listenAsync(_Server &server, Async::Cancelation::Token ct) {
+    while (true) {
+        auto conn = co_trya$(server.listener.acceptAsync(ct));
+        server.accepted++;
+        Async::detach(_serveAsync(server, std::move(conn)));
+    }
+}
+
+static Mime::Url _url(u16 port, Str path) {
+    return Mime::Url::parse(Io::format("http://127.0.0.1:{}{}", port, path).unwrap());
+}
+
+testAsync$("fetch-keep-alive") {
+    auto server = co_try$(_Server::listen(18431));
+    Async::Cancelation c;
+    Async::detach(_listenAsync(server, c.token()));
+
+    Client client;
+    for (Str path : {"/a"s, "/b"s, "/c"s}) {
+        auto body = co_trya$(client.fetchString(_url(18431, path)));
+        co_expectEq$(body, path);
+    }
+
+    co_expectEq$(server.accepted, 1uz);
+    co_expectEq$(server.requests, 3uz);
+
+    c.cancel();
+    co_return Ok();
+}
+
+testAsync$("fetch-pipelining") {
+    auto server = co_try$(_Server::listen(18432));
+    Async::Cancelation c;
+    Async::detach(_listenAsync(server, c.token()));
+
+    Client client{{.maxConnectionsPerHost = 1, .maxPipelineDepth = 4}};
+
+    // NOTE: Nothing is pipelined until the server said it keeps the
+    //       connection open.
+    auto warm = co_trya$(client.fetchString(_url(18432, "/warm")));
+    co_expectEq$(warm, "/warm"s);
+
+    server.batch = 3;
+    auto a = _url(18432, "/a");
+    auto b = _url(18432, "/b");
+    auto d = _url(18432, "/d");
+    Async::Cancelation all;
+    auto bodies = co_trya$(Async::all(all, client.fetchString(a), client.fetchString(b), client.fetchString(d)));
+
+    co_expectEq$(bodies[0], "/a"s);
+    co_expectEq$(bodies[1], "/b"s);
+    co_expectEq$(bodies[2], "/d"s);
+    co_expectEq$(server.accepted, 1uz);
+    co_expectEq$(server.requests, 4uz);
+
+    c.cancel();
+    co_return Ok();
+}
+
+testAsync$("fetch-prune-hosts") {
+    auto server = co_try$(_Server::listen(18433));
+    Async::Cancelation c;
+    Async::detach(_listenAsync(server, c.token()));
+
+    Client client{{.idleTimeout = TimeSpan::zero()}};
+    co_trya$(client.fetchString(_url(18433, "/a")));
+    co_expectEq$(client._hosts._els.len(), 1uz);
+
+    co_trya$(Sys::globalSched().sleepAsync(Sys::now() + TimeSpan::fromMSecs(1)));
+    client.prune();
+    co_expectEq$(client._hosts._els.len(), 0uz);
+
+    c.cancel();
+    co_return Ok();
+}
+
+} // namespace Vaev::Client::Tests
@@ -0,0 +1,196 @@
+#include <karm-test/macros.h>
+#include <vaev-http/parser.h>
+
+namespace Vaev::Http::Tests {
+
+static Res<String> _readBody(Parser &parser) {
+    StringBuilder sb;
+    while (not parser.done()) {
+        auto piece = try$(parser.body());
+        if (not piece and not parser.done())
+            return Error::invalidData("needs more bytes");
+        sb.append(Str{(char const *)piece.buf(), piece.len()});
+    }
+    return Ok(sb.take());
+}
+
+test$("http-parse-request") {
+    Parser parser{Parser::Kind::REQUEST};
+    parser.feed(bytes(
+        "GET /foo/../bar HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "accept:   text/html  \r\n"
+        "\r\n"s
+    ));
+
+    expect$(try$(parser.parseHead()));
+    expect$(parser.done());
+
+    auto req = try$(parser.request());
+    expectEq$(req.method, Method::GET);
+    expectEq$(req.version.major, 1);
+    expectEq$(req.version.minor, 1);
+    expectEq$(req.headers.len(), 2uz);
+    expectEq$(try$(req.header("host")), "example.com"s);
+    expectEq$(try$(req.header("Accept")), "text/html"s);
+    expect$(not req.header("Content-Length"));
+
+    return Ok();
+}
+
+test$("http-parse-byte-by-byte") {
+    Str msg =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 11\r\n"
+        "\r\n"
+        "hello world";
+
+    Parser parser{Parser::Kind::RESPONSE};
+    usize i = 0;
+    while (not try$(parser.parseHead())) {
+        expect$(i < msg.len());
+        parser.feed(sub(bytes(msg), i, i + 1));
+        i++;
+    }
+
+    auto res = try$(parser.response());
+    expectEq$(res.code, Code::OK);
+    expectEq$(try$(res.header("Content-Length")), "11"s);
+
+    StringBuilder sb;
+    while (not parser.done()) {
+        auto piece = try$(parser.body());
+        if (piece) {
+            sb.append(Str{(char const *)piece.buf(), piece.len()});
+            continue;
+        }
+        expect$(i < msg.len());
+        parser.feed(sub(bytes(msg), i, i + 1));
+        i++;
+    }
+
+    expectEq$(sb.str(), "hello world"s);
+
+    return Ok();
+}
+
+test$("http-parse-chunked") {
+    Parser parser{Parser::Kind::RESPONSE};
+    parser.feed(bytes(
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: gzip, Chunked\r\n"
+        "\r\n"
+        "5\r\nhello\r\n"
+        "1;ext=1\r\n \r\n"
+        "5\r\nworld\r\n"
+        "0\r\n"
+        "Trailer: ignored\r\n"
+        "\r\n"s
+    ));
+
+    expect$(try$(parser.parseHead()));
+    expectEq$(try$(_readBody(parser)), "hello world"s);
+
+    return Ok();
+}
+
+test$("http-parse-large-body") {
+    usize const LEN = Parser::MIN_READ * 10;
+
+    Parser parser{Parser::Kind::RESPONSE};
+    parser.feed(bytes("HTTP/1.1 200 OK\r\nContent-Length: 40960\r\n\r\n"s));
+    expect$(try$(parser.parseHead()));
+
+    usize fed = 0;
+    usize read = 0;
+    while (not parser.done()) {
+        auto piece = try$(parser.body());
+        for (usize i = 0; i < piece.len(); i++)
+            expectEq$(piece[i], (u8)((read + i) % 251));
+        read += piece.len();
+
+        if (not piece) {
+            auto space = parser.space();
+            expect$(space.len() > 0);
+            usize n = min(space.len(), LEN - fed);
+            for (usize i = 0; i < n; i++)
+                space[i] = (fed + i) % 251;
+            parser.commit(n);
+            fed += n;
+        }
+    }
+
+    expectEq$(read, LEN);
+    expect$(parser._buf.len() < LEN);
+
+    return Ok();
+}
+
+test$("http-parse-until-close") {
+    Parser parser{Parser::Kind::RESPONSE};
+    parser.feed(bytes("HTTP/1.0 200 OK\r\n\r\nsome body"s));
+    expect$(try$(parser.parseHead()));
+
+    expectEq$(try$(parser.body()).len(), 9uz);
+    expect$(not parser.done());
+    expect$(not try$(parser.body()));
+
+    parser.commit(0);
+    expect$(not try$(parser.body()));
+    expect$(parser.done());
+
+    return Ok();
+}
+
+test$("http-parse-pipelined") {
+    Parser parser{Parser::Kind::REQUEST};
+    parser.feed(bytes(
+        "POST /a HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+        "GET /b HTTP/1.1\r\n\r\n"s
+    ));
+
+    expect$(try$(parser.parseHead()));
+    expectEq$(try$(_readBody(parser)), "abc"s);
+
+    parser.reset();
+    expect$(try$(parser.parseHead()));
+    auto req = try$(parser.request());
+    expectEq$(req.method, Method::GET);
+    expect$(parser.done());
+
+    return Ok();
+}
+
+test$("http-parse-no-body") {
+    Parser head{Parser::Kind::RESPONSE, Method::HEAD};
+    head.feed(bytes("HTTP/1.1 200 OK\r\nContent-Length: 42\r\n\r\n"s));
+    expect$(try$(head.parseHead()));
+    expect$(head.done());
+
+    Parser notModified{Parser::Kind::RESPONSE};
+    notModified.feed(bytes("HTTP/1.1 304 Not Modified\r\n\r\n"s));
+    expect$(try$(notModified.parseHead()));
+    expect$(notModified.done());
+
+    return Ok();
+}
+
+test$("http-parse-errors") {
+    auto parse = [](Str msg) -> Res<bool> {
+        Parser parser{Parser::Kind::REQUEST};
+        parser.feed(bytes(msg));
+        parser.commit(0);
+        return parser.parseHead();
+    };
+
+    expect$(not parse("GET\r\n\r\n"));
+    expect$(not parse("GET / HTTP/1.1\r\nHost : x\r\n\r\n"));
+    expect$(not parse("GET / HTTP/1.1\r\nHost: x\r\n folded\r\n\r\n"));
+    expect$(not parse("GET / HTTP/1.1\r\nContent-Length: -1\r\n\r\n"));
+    expect$(not parse("GET / HTTP/1.1\r\nHost: x\r\n"));
+    expect$(parse("\r\nGET / HTTP/1.1\nHost: x\n\n"));
+
+    return Ok();
+}
+
+} // namespace Vaev::Http::Tests
@@ -25,11 +25,16 @@ struct Flow : public Frag {
         _frags.pushBack(frag);
     }
 
+    // NOTE: Children are stacked one below the other, and the flow is as
+    //       tall as they are. There is no inline layout yet, each run of
+    //       text starts on a line of its own.
     void layout(RectPx bound) override {
-        Frag::layout(bound);
+        Px y = bound.y;
         for (auto &c : _frags) {
-            c->layout(bound);
+            c->layout({bound.x, y, bound.width, max(bound.bottom() - y, Px{0})});
+            y = max(y, c->_borderBox.bottom());
         }
+        _borderBox = {bound.x, bound.y, bound.width, y - bound.y};
     }
 
     void paint(Paint::Stack &stack) override {
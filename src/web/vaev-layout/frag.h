@@ -59,7 +59,7 @@ struct Frag {
         if (style().backgrounds.len()) {
             Paint::Box box;
             box.backgrounds = style().backgrounds;
-            box.bound.wh = {Px{100}, Px{100}};
+            box.bound = _borderBox;
             stack.add(makeStrong<Paint::Box>(std::move(box)));
         }
     }
@@ -0,0 +1,97 @@
+#include <karm-io/sscan.h>
+#include <karm-media/loader.h>
+
+#include "run.h"
+
+namespace Vaev::Layout {
+
+static constexpr f64 FONT_SIZE = 16;
+
+Run::Run(Strong<Style::Computed> style, String text)
+    : Frag(style),
+      _text(std::move(text)),
+      _font(defaultFont()) {
+}
+
+Media::Font Run::defaultFont() {
+    // NOTE: Documents might be laid out on several threads at the same
+    //       time, each of them loads its own copy.
+    static threadLocal$ Opt<Strong<Media::Fontface>> fontface = NONE;
+    if (not fontface)
+        fontface = Media::loadFontfaceOrFallback("bundle://inter-font/fonts/Inter-Regular.ttf"_url).unwrap();
+
+    return {
+        .fontface = *fontface,
+        .fontsize = FONT_SIZE,
+    };
+}
+
+static Str _nextWord(Io::SScan &s) {
+    while (not s.ended() and isAsciiSpace(s.peek()))
+        s.next();
+
+    s.begin();
+    while (not s.ended() and not isAsciiSpace(s.peek()))
+        s.next();
+    return s.end();
+}
+
+void Run::layout(RectPx bound) {
+    _lines.clear();
+
+    // NOTE: Runs of spaces collapse into one, lines are filled with as
+    //       many words as fit.
+    auto maxWidth = bound.width.toFloat<f64>();
+    auto space = _font.advance(_font.glyph(' '));
+    f64 width = 0;
+
+    StringBuilder line;
+    f64 lineWidth = 0;
+    auto flush = [&] {
+        width = max(width, lineWidth);
+        _lines.pushBack(_font.shape(line.take()));
+        lineWidth = 0;
+    };
+
+    Io::SScan s{_text};
+    while (true) {
+        auto word = _nextWord(s);
+        if (not word)
+            break;
+
+        auto wordWidth = _font.shape(word)->width * _font.scale();
+        if (lineWidth > 0 and lineWidth + space + wordWidth > maxWidth)
+            flush();
+
+        if (lineWidth > 0) {
+            line.append(' ');
+            lineWidth += space;
+        }
+        line.append(word);
+        lineWidth += wordWidth;
+    }
+
+    if (lineWidth > 0)
+        flush();
+
+    _borderBox = {
+        bound.x,
+        bound.y,
+        Px{width},
+        Px{_font.metrics().lineheight() * _lines.len()},
+    };
+}
+
+void Run::paint(Paint::Stack &stack) {
+    ColorContext cctx;
+    auto color = cctx.resolve(style().color);
+    auto lineheight = _font.metrics().lineheight();
+
+    auto baseline = _borderBox.xy.cast<f64>() + Math::Vec2f{0, _font.metrics().ascend};
+    for (auto &line : _lines) {
+        stack.add(makeStrong<Paint::Text>(baseline, _font, line, color));
+        baseline.y += lineheight;
+    }
+}
+
+} // namespace Vaev::Layout
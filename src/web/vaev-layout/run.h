@@ -1,26 +1,34 @@
 #pragma once
 
 #include <karm-media/font.h>
+#include <vaev-paint/text.h>
 
 #include "frag.h"
 
 namespace Vaev::Layout {
 
+// A run of text, broken into lines at spaces to fit the width it's given.
+//
+// NOTE: There is no font selection yet, runs are set in the default font,
+//       and a word wider than a line sticks out of it.
 struct Run : public Frag {
     static constexpr auto TYPE = RUN;
 
-    Run(Strong<Style::Computed> style, String)
-        : Frag(style) {
-    }
+    String _text;
+    Media::Font _font;
+    Vec<Strong<Media::GlyphRun>> _lines;
+
+    Run(Strong<Style::Computed> style, String text);
+
+    static Media::Font defaultFont();
 
     Type type() const override {
         return TYPE;
     }
 
-    void layout(RectPx) override {
-    }
+    void layout(RectPx bound) override;
 
-    void paint(Paint::Stack &) override {}
+    void paint(Paint::Stack &stack) override;
 };
 
 } // namespace Vaev::Layout
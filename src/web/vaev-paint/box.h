@@ -18,6 +18,12 @@ struct Box : public Node {
             ctx._fillRect(bound.cast<isize>(), cctx.resolve(background.paint));
     }
 
+    void print(Print::Context &ctx) override {
+        ColorContext cctx; // FIXME: Same as above
+        for (auto &background : backgrounds)
+            ctx.fill(bound.cast<f64>(), cctx.resolve(background.paint));
+    }
+
     void repr(Io::Emit &e) const override {
         e("(box {})", bound);
     }
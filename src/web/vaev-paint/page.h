@@ -1,15 +1,51 @@
 #pragma once
 
+#include <vaev-base/length.h>
+
 #include "stack.h"
 
 namespace Vaev::Paint {
 
+// Moves everything printed through it by `offset`.
+struct _Shifted : public Print::Context {
+    Print::Context &_ctx;
+    Math::Vec2f _offset;
+
+    _Shifted(Print::Context &ctx, Math::Vec2f offset)
+        : _ctx(ctx), _offset(offset) {}
+
+    void pageBreak() override {
+        _ctx.pageBreak();
+    }
+
+    void fill(Math::Rectf rect, Gfx::Color color) override {
+        _ctx.fill(rect.offset(_offset), color);
+    }
+
+    void fill(Math::Vec2f baseline, Media::Font const &font, Media::GlyphRun const &run, Gfx::Color color) override {
+        _ctx.fill(baseline + _offset, font, run, color);
+    }
+};
+
 struct Page : public Stack {
+    // The part of the document that goes on this page.
+    RectPx area;
+
     void print(Print::Context &ctx) override {
+        _Shifted shifted{ctx, -area.xy.cast<f64>()};
         for (auto &child : _children)
-            child->print(ctx);
+            child->print(shifted);
         ctx.pageBreak();
     }
+
+    void repr(Io::Emit &e) const override {
+        e("(page {}", area);
+        for (auto &child : _children) {
+            e(" ");
+            child->repr(e);
+        }
+        e(")");
+    }
 };
 
 } // namespace Vaev::Paint
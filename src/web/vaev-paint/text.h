@@ -1,10 +1,48 @@
 #pragma once
 
+#include <karm-media/font.h>
+
 #include "base.h"
 
 namespace Vaev::Paint {
 
+// A run of shaped text sitting on its baseline.
 struct Text : public Node {
+    Math::Vec2f baseline;
+    Media::Font font;
+    Strong<Media::GlyphRun> run;
+    Gfx::Color color;
+
+    Text(Math::Vec2f baseline, Media::Font font, Strong<Media::GlyphRun> run, Gfx::Color color)
+        : baseline(baseline), font(font), run(run), color(color) {}
+
+    Math::Recti bound() override {
+        auto m = font.metrics();
+        return Math::Rectf{
+            baseline.x,
+            baseline.y - m.ascend,
+            run->width * font.scale(),
+            m.lineheight(),
+        }
+            .cast<isize>();
+    }
+
+    void paint(Gfx::Context &ctx) override {
+        ctx.save();
+        ctx.textFont(font);
+        ctx.fillStyle(color);
+        for (auto const &g : run->glyphs)
+            ctx.fill(baseline + Math::Vec2f{g.pos * font.scale(), 0}, g.glyph);
+        ctx.restore();
+    }
+
+    void print(Print::Context &ctx) override {
+        ctx.fill(baseline, font, *run, color);
+    }
+
+    void repr(Io::Emit &e) const override {
+        e("(text {} {})", baseline, run->runes.len());
+    }
 };
 
 } // namespace Vaev::Paint
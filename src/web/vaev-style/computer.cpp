@@ -7,7 +7,7 @@ Strong<Computed> Computer::computeFor(Dom::Element const &el) {
 
     // Collect matching styles rules
     for (auto const &sheet : _styleBook.styleSheets) {
-        for (auto const &rule : sheet.rules) {
+        for (auto const &rule : sheet->rules) {
             if (
                 auto const *styleRule = rule.is<StyleRule>();
                 styleRule and match(styleRule->selector, el)
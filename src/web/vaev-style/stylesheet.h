@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/rc.h>
 #include <karm-base/string.h>
 #include <karm-base/vec.h>
 #include <karm-logger/logger.h>
@@ -111,14 +112,23 @@ struct StyleSheet {
 };
 
 struct StyleBook {
-    Vec<StyleSheet> styleSheets;
+    // NOTE: Sheets are shared so that the user agent stylesheet can be parsed
+    //       once and used by every document.
+    Vec<Strong<StyleSheet>> styleSheets;
 
     void repr(Io::Emit &e) const {
-        e("(style-book {})", styleSheets);
+        e("(style-book");
+        for (auto const &sheet : styleSheets)
+            e(" {}", *sheet);
+        e(")");
     }
 
     void add(StyleSheet &&sheet) {
-        styleSheets.pushBack(std::move(sheet));
+        styleSheets.pushBack(makeStrong<StyleSheet>(std::move(sheet)));
+    }
+
+    void add(Strong<StyleSheet> sheet) {
+        styleSheets.pushBack(sheet);
     }
 };
 
@@ -73,10 +73,18 @@ struct TlsConnection : public Sys::_Connection {
         return _conn.readAsync(buf);
     }
 
+    Async::Task<usize> readAsync(MutBytes buf, Async::Cancelation::Token ct) override {
+        return _conn.readAsync(buf, ct);
+    }
+
     Async::Task<usize> writeAsync(Bytes buf) override {
         return _conn.writeAsync(buf);
     }
 
+    Async::Task<usize> writeAsync(Bytes buf, Async::Cancelation::Token ct) override {
+        return _conn.writeAsync(buf, ct);
+    }
+
     Async::Task<usize> flushAsync() override {
         return _conn.flushAsync();
     }
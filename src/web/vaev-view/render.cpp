@@ -2,7 +2,7 @@
 #include <vaev-css/mod.h>
 #include <vaev-dom/element.h>
 #include <vaev-layout/builder.h>
-#include <vaev-paint/stack.h>
+#include <vaev-paint/page.h>
 #include <vaev-style/computer.h>
 
 #include "render.h"
@@ -21,22 +21,85 @@ static void _collectStyle(Dom::Node const &node, Style::StyleBook &sb) {
     }
 }
 
+Res<Strong<Style::StyleSheet>> fetchUserAgentStylesheet() {
+    auto sheet = try$(Css::fetchStylesheet("bundle://vaev-view/user-agent.css"_url));
+    return Ok(makeStrong<Style::StyleSheet>(std::move(sheet)));
+}
+
 RenderResult render(Dom::Document const &dom, Vec2Px viewport) {
+    return render(dom, viewport, fetchUserAgentStylesheet().take());
+}
+
+static Strong<Layout::Flow> _build(Dom::Document const &dom, Strong<Style::StyleSheet> userAgent) {
     Style::StyleBook stylebook;
-    stylebook.add(Css::fetchStylesheet("bundle://vaev-view/user-agent.css"_url).take());
+    stylebook.add(userAgent);
     _collectStyle(dom, stylebook);
 
     Style::Computer computer{stylebook};
     Strong<Layout::Flow> layoutRoot = makeStrong<Layout::BlockFlow>(makeStrong<Style::Computed>());
     Layout::build(computer, dom, *layoutRoot);
+    return layoutRoot;
+}
 
+RenderResult render(Dom::Document const &dom, Vec2Px viewport, Strong<Style::StyleSheet> userAgent) {
+    RenderStats stats;
+
+    auto start = Sys::now();
+    auto layoutRoot = _build(dom, userAgent);
+    stats.style = Sys::now() - start;
+
+    start = Sys::now();
     layoutRoot->layout(viewport);
+    stats.layout = Sys::now() - start;
 
+    start = Sys::now();
     auto paintRoot = makeStrong<Paint::Stack>();
     layoutRoot->paint(*paintRoot);
     paintRoot->prepare();
+    stats.paint = Sys::now() - start;
+
+    return {layoutRoot, paintRoot, stats};
+}
+
+RenderResult print(Dom::Document const &dom, Vec2Px pageSize, Strong<Style::StyleSheet> userAgent) {
+    RenderStats stats;
+
+    auto start = Sys::now();
+    auto layoutRoot = _build(dom, userAgent);
+    stats.style = Sys::now() - start;
+
+    // NOTE: Flows grow past the bottom of the page to fit their content,
+    //       the document is then cut into pages, nothing is kept from
+    //       breaking across two of them yet.
+    start = Sys::now();
+    layoutRoot->layout(pageSize);
+    stats.layout = Sys::now() - start;
+
+    start = Sys::now();
+    Paint::Stack content;
+    layoutRoot->paint(content);
+    content.prepare();
+
+    auto height = layoutRoot->_borderBox.height.toFloat<f64>();
+    auto pages = max(Math::ceil(height / pageSize.y.toFloat<f64>()), 1.0);
+
+    auto paintRoot = makeStrong<Paint::Stack>();
+    for (isize i = 0; i < (isize)pages; i++) {
+        auto page = makeStrong<Paint::Page>();
+        page->area = {Px{0}, pageSize.y * Px{i}, pageSize.x, pageSize.y};
+
+        // NOTE: What straddles two pages goes on both, each of them only
+        //       shows their part of it.
+        auto area = page->area.cast<isize>();
+        for (auto &child : content._children)
+            if (child->bound().colide(area))
+                page->add(child);
+
+        paintRoot->add(page);
+    }
+    stats.paint = Sys::now() - start;
 
-    return {layoutRoot, paintRoot};
+    return {layoutRoot, paintRoot, stats};
 }
 
 } // namespace Vaev::View
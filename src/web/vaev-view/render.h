@@ -1,17 +1,37 @@
 #pragma once
 
+#include <karm-base/time.h>
 #include <vaev-base/length.h>
 #include <vaev-dom/document.h>
 #include <vaev-layout/frag.h>
 #include <vaev-paint/base.h>
+#include <vaev-style/stylesheet.h>
 
 namespace Vaev::View {
 
+// Time spent in each stage of the last render.
+struct RenderStats {
+    TimeSpan style;  //< Computing styles and building the box tree.
+    TimeSpan layout; //< Laying out the box tree.
+    TimeSpan paint;  //< Building and preparing the paint tree.
+};
+
 struct RenderResult {
     Strong<Layout::Frag> layout;
     Strong<Paint::Node> paint;
+    RenderStats stats = {};
 };
 
+Res<Strong<Style::StyleSheet>> fetchUserAgentStylesheet();
+
 RenderResult render(Dom::Document const &dom, Vec2Px viewport);
 
+// Render using an already parsed user agent stylesheet, it's only read from
+// so it can be shared between documents rendered at the same time.
+RenderResult render(Dom::Document const &dom, Vec2Px viewport, Strong<Style::StyleSheet> userAgent);
+
+// Render for print on pages of `pageSize`, the paint tree holds one
+// Paint::Page per page, in order.
+RenderResult print(Dom::Document const &dom, Vec2Px pageSize, Strong<Style::StyleSheet> userAgent);
+
 } // namespace Vaev::View
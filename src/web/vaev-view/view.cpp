@@ -22,7 +22,8 @@ struct View : public Ui::View<View> {
         g.clip(bound().size());
         g.clear(bound().size(), WHITE);
 
-        auto [layout, paint] = *_renderResult;
+        auto &layout = _renderResult->layout;
+        auto &paint = _renderResult->paint;
 
         paint->paint(g);
         if (Ui::debugShowLayoutBounds)